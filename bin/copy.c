@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 int main(int argc, const char *argv[])
 {
@@ -17,8 +18,16 @@ int main(int argc, const char *argv[])
 
     las_error_t las_err;
     las_reader_t *reader = NULL;
-    las_raw_point_t point = {0};
+    uint8_t *points_bytes = NULL;
     las_writer_t *writer = NULL;
+    const uint64_t chunk_size = 100000;
+
+    // Uncompressed files can be copied without even reading the points
+    las_err = las_copy_file_path(path, "lol.las", NULL);
+    if (las_err.kind != LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA)
+    {
+        goto main_exit;
+    }
 
     las_err = las_reader_open_file_path(path, &reader);
     if (las_error_is_failure(&las_err))
@@ -39,30 +48,47 @@ int main(int argc, const char *argv[])
         goto main_exit;
     }
 
-    las_raw_point_prepare(&point, header->point_format);
+    // The input and output point formats are the same,
+    // so points records can be copied without decoding them
+    const uint16_t point_size = las_point_format_point_size(header->point_format);
+    points_bytes = malloc(sizeof(uint8_t) * point_size * chunk_size);
+    if (points_bytes == NULL)
+    {
+        fprintf(stderr, "Not enough memory\n");
+        goto main_exit;
+    }
+
     las_header_t *writer_header;
     // TODO handle error
     las_header_clone(header, &writer_header);
-    las_err = las_writer_open_file_path("lol.las", writer_header, &writer);
+    // The EVLRs payloads are copied from the input when the writer closes
+    las_writer_options_t writer_options = {0};
+    writer_options.evlr_source_path = path;
+    las_err =
+        las_writer_open_file_path_with_options("lol.las", writer_header, &writer_options, &writer);
 
     if (las_error_is_failure(&las_err))
     {
         goto main_exit;
     }
 
-    for (uint64_t i = 0; i < point_count; i++)
+    uint64_t points_left = point_count;
+    while (points_left != 0)
     {
-        las_err = las_reader_read_next_raw(reader, &point);
+        const uint64_t num_points = (chunk_size > points_left) ? points_left : chunk_size;
+        las_err = las_reader_read_many_next_bytes(reader, points_bytes, num_points);
         if (las_error_is_failure(&las_err))
         {
             goto main_exit;
         }
 
-        las_err = las_writer_write_raw_point(writer, &point);
+        las_err = las_writer_write_many_bytes(writer, points_bytes, num_points);
         if (las_error_is_failure(&las_err))
         {
             goto main_exit;
         }
+
+        points_left -= num_points;
     }
 
 main_exit:
@@ -71,7 +97,7 @@ main_exit:
         las_error_fprintf(&las_err, stderr);
     }
     las_writer_delete(writer);
-    las_raw_point_deinit(&point);
+    free(points_bytes);
     las_reader_destroy(reader);
     return las_error_is_failure(&las_err);
 }
@@ -8,6 +8,10 @@
 
 const char *point_format_arg_str = "--point-format";
 const char *version_arg_str = "--version";
+const char *num_workers_arg_str = "--num-workers";
+
+/// Number of points converted at once
+const uint64_t batch_size = 65536;
 
 typedef struct
 {
@@ -16,6 +20,7 @@ typedef struct
 
     uint8_t target_format_id;
     las_version_t target_version;
+    uint32_t num_workers;
 } argument_t;
 
 argument_t parse_arguments(const int argc, char *argv[])
@@ -24,6 +29,7 @@ argument_t parse_arguments(const int argc, char *argv[])
         .input_file = NULL,
         .output_file = NULL,
         .target_format_id = 255,
+        .num_workers = 0,
     };
 
     for (int i = 1; i < argc; ++i)
@@ -105,6 +111,25 @@ argument_t parse_arguments(const int argc, char *argv[])
             args.target_version.major = (uint8_t)major;
             args.target_version.minor = (uint8_t)minor;
         }
+        else if (strcmp(arg, num_workers_arg_str) == 0)
+        {
+            ++i;
+            if (i >= argc)
+            {
+                fprintf(stderr, "Expected number after '%s'\n", num_workers_arg_str);
+                exit(1);
+            }
+            char *end;
+            errno = 0;
+            unsigned long num_workers = strtoul(argv[i], &end, 10);
+            if (errno != 0 || *end != '\0' || num_workers > (unsigned long)UINT32_MAX)
+            {
+                fprintf(stderr, "'%s' is not a valid number of workers\n", argv[i]);
+                exit(1);
+            }
+
+            args.num_workers = (uint32_t)num_workers;
+        }
         else if (args.input_file == NULL)
         {
             args.input_file = arg;
@@ -123,7 +148,9 @@ argument_t parse_arguments(const int argc, char *argv[])
     if (args.input_file == NULL || args.output_file == NULL || args.target_format_id == 255)
     {
         fprintf(stderr, "Not enough arguments\n");
-        fprintf(stderr, "Usage: %s [--point_format] [--version] INPUT_FILE OUTPUT_FILE\n", argv[0]);
+        fprintf(stderr,
+                "Usage: %s [--point_format] [--version] [--num-workers] INPUT_FILE OUTPUT_FILE\n",
+                argv[0]);
         exit(1);
     }
 
@@ -138,8 +165,8 @@ int main(int argc, char *argv[])
 
     las_reader_t *reader = NULL;
     las_writer_t *writer = NULL;
-    las_raw_point_t source_point = {0};
-    las_raw_point_t dest_point = {0};
+    uint8_t *source_records = NULL;
+    uint8_t *dest_records = NULL;
 
     las_err = las_reader_open_file_path(args.input_file, &reader);
     if (las_error_is_failure(&las_err))
@@ -160,26 +187,41 @@ int main(int argc, char *argv[])
         header->version = args.target_version;
     }
 
-    las_raw_point_prepare(&source_point, reader_header->point_format);
-    las_raw_point_prepare(&dest_point, header->point_format);
+    const las_point_format_t source_format = reader_header->point_format;
+    const las_point_format_t dest_format = header->point_format;
+    source_records = malloc((size_t)las_point_format_point_size(source_format) * batch_size);
+    dest_records = malloc((size_t)las_point_format_point_size(dest_format) * batch_size);
+    if (source_records == NULL || dest_records == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
 
-    las_err = las_writer_open_file_path(args.output_file, header, &writer);
+    las_writer_options_t writer_options = {0};
+    writer_options.num_workers = args.num_workers;
+    writer_options.evlr_source_path = args.input_file;
+    las_err = las_writer_open_file_path_with_options(
+        args.output_file, header, &writer_options, &writer);
     if (las_error_is_failure(&las_err))
     {
         goto out;
     }
 
-    for (uint64_t i = 0; i < reader_header->point_count; ++i)
+    const uint64_t point_count = reader_header->point_count;
+    for (uint64_t i = 0; i < point_count; i += batch_size)
     {
-        las_err = las_reader_read_next_raw(reader, &source_point);
+        const uint64_t left = point_count - i;
+        const uint64_t num_points = left < batch_size ? left : batch_size;
+
+        las_err = las_reader_read_many_next_bytes(reader, source_records, num_points);
         if (las_error_is_failure(&las_err))
         {
             goto out;
         }
 
-        las_raw_point_copy_from_raw(&dest_point, &source_point);
+        las_transcode_records(source_format, dest_format, source_records, dest_records, num_points);
 
-        las_err = las_writer_write_raw_point(writer, &dest_point);
+        las_err = las_writer_write_many_bytes(writer, dest_records, num_points);
         if (las_error_is_failure(&las_err))
         {
             goto out;
@@ -187,8 +229,8 @@ int main(int argc, char *argv[])
     }
 
 out:
-    las_raw_point_deinit(&source_point);
-    las_raw_point_deinit(&dest_point);
+    free(source_records);
+    free(dest_records);
     las_reader_destroy(reader);
     las_writer_delete(writer);
 
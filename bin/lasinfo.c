@@ -59,7 +59,7 @@ int main(int argc, char * argv[]) {
     if (hdr->version.major == 1 && hdr->version.minor == 4)
     {
         printf("Start of EVLRs: %" PRIu64 "\n", hdr->start_of_evlrs);
-        printf("Number of EVLRs: %" PRIu64 "\n", hdr->start_of_evlrs);
+        printf("Number of EVLRs: %" PRIu32 "\n", hdr->number_of_evlrs);
     }
 
     printf("---\n");
@@ -74,6 +74,21 @@ int main(int argc, char * argv[]) {
         printf("\tData Size: %" PRIu16 "\n", vlr->data_size);
     }
 
+    if (hdr->number_of_evlrs != 0)
+    {
+        printf("---\n");
+        printf("Number of EVLRs: %" PRIu32 "\n", hdr->number_of_evlrs);
+    }
+    for (uint32_t i = 0; i < hdr->number_of_evlrs; ++i)
+    {
+        const las_evlr_t *evlr = &hdr->evlrs[i];
+        printf("EVLR %" PRIu32 " / %" PRIu32 "\n", i + 1, hdr->number_of_evlrs);
+        printf("\tUser ID: %.*s\n", LAS_VLR_USER_ID_SIZE, evlr->user_id);
+        printf("\tRecord ID: %" PRIu16 "\n", evlr->record_id);
+        printf("\tDescription: %.*s\n", LAS_VLR_DESCRIPTION_SIZE, evlr->description);
+        printf("\tData Size: %" PRIu64 "\n", evlr->data_size);
+    }
+
 out:
     las_reader_destroy(reader);
 
@@ -26,7 +26,7 @@ int main(int argc, char *argv[])
     las_error_t err = {.kind = LAS_ERROR_OK};
     las_reader_t *reader = NULL;
     las_writer_t *writer = NULL;
-    las_raw_point_t *raw_points = NULL;
+    uint8_t *points_bytes = NULL;
 
     err = las_reader_open_file_path(filename, &reader);
     if (las_error_is_failure(&err))
@@ -42,16 +42,21 @@ int main(int argc, char *argv[])
         goto main_exit;
     }
 
-    // Prepare the point buffer for "chunked" reading
-    raw_points = malloc(sizeof(las_raw_point_t) * chunk_size);
-    if (raw_points == NULL)
+    // Prepare the buffer for "chunked" reading,
+    // as the point format does not change, points are not decoded
+    const uint16_t point_size = las_point_format_point_size(reader_header->point_format);
+    points_bytes = malloc(sizeof(uint8_t) * point_size * chunk_size);
+    if (points_bytes == NULL)
     {
         fprintf(stderr, "Not enough memory\n");
         goto main_exit;
     }
-    las_raw_point_prepare_many(raw_points, chunk_size, reader_header->point_format);
 
-    err = las_writer_open_file_path(dest_filename, writer_header, &writer);
+    // The EVLRs payloads are copied from the input when the writer closes
+    las_writer_options_t writer_options = {0};
+    writer_options.evlr_source_path = filename;
+    err = las_writer_open_file_path_with_options(
+        dest_filename, writer_header, &writer_options, &writer);
     if (las_error_is_failure(&err))
     {
         goto main_exit;
@@ -61,13 +66,13 @@ int main(int argc, char *argv[])
     while (points_left != 0)
     {
         const uint64_t num_points_to_read = (chunk_size > points_left) ? points_left : chunk_size;
-        err = las_reader_read_many_next_raw(reader, raw_points, num_points_to_read);
+        err = las_reader_read_many_next_bytes(reader, points_bytes, num_points_to_read);
         if (las_error_is_failure(&err))
         {
             goto main_exit;
         }
 
-        err = las_writer_write_many_raw_points(writer, raw_points, num_points_to_read);
+        err = las_writer_write_many_bytes(writer, points_bytes, num_points_to_read);
         if (las_error_is_failure(&err))
         {
             goto main_exit;
@@ -80,11 +85,7 @@ main_exit:
     las_reader_destroy(reader);
     las_writer_delete(writer);
 
-    if (raw_points != NULL)
-    {
-        las_raw_point_deinit_many(raw_points, chunk_size);
-        free(raw_points);
-    }
+    free(points_bytes);
 
     if (las_error_is_failure(&err))
     {
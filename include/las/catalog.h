@@ -0,0 +1,99 @@
+#ifndef LAS_C_CATALOG_H
+#define LAS_C_CATALOG_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <las/error.h>
+#include <las/header.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+    /// Summary of the headers of many LAS/LAZ files
+    ///
+    /// Only the headers (and VLRs) are read, so building a catalog of many
+    /// tiles is cheap, it can then be saved to a compact binary file
+    /// and queried to know which files cover an area.
+    typedef struct las_catalog las_catalog_t;
+
+    /// What the catalog knows about one file
+    typedef struct
+    {
+        /// NUL terminated, owned by the catalog
+        const char *path;
+        /// `LAS_ERROR_OK`, or the reason why the header could not be read,
+        /// the other fields are then zero
+        las_error_kind_t status;
+        las_version_t version;
+        las_point_format_t point_format;
+        bool is_compressed;
+        uint64_t point_count;
+        las_vector_3_t mins;
+        las_vector_3_t maxs;
+        /// Hash of the coordinate reference system VLRs (user id "LASF_Projection"),
+        /// 0 if the file has none.
+        ///
+        /// Files with the same non-zero hash have the same CRS VLRs.
+        uint64_t crs_hash;
+    } las_catalog_entry_t;
+
+    /// Area to look for in a catalog, in the x/y plane
+    typedef struct las_catalog_bbox
+    {
+        double min_x;
+        double min_y;
+        double max_x;
+        double max_y;
+    } las_catalog_bbox_t;
+
+    /// Reads the headers of the `num_paths` files and builds a catalog of them
+    ///
+    /// The headers are read concurrently by `num_threads` threads,
+    /// 0 means as many as the machine can run in parallel.
+    ///
+    /// Files whose header cannot be read are still part of the catalog
+    /// (with their `status` set), they never match queries.
+    /// An error is only returned if the catalog itself could not be built.
+    las_error_t las_catalog_build(const char *const *paths,
+                                  uint64_t num_paths,
+                                  uint32_t num_threads,
+                                  las_catalog_t **out_catalog);
+
+    /// Saves the catalog to a binary file
+    las_error_t las_catalog_write_file_path(const las_catalog_t *self, const char *file_path);
+
+    /// Loads a catalog saved by `las_catalog_write_file_path`
+    ///
+    /// Returns `LAS_ERROR_INVALID_CATALOG` if the file is not a catalog,
+    /// or is truncated.
+    las_error_t las_catalog_read_file_path(const char *file_path, las_catalog_t **out_catalog);
+
+    /// Returns the number of files in the catalog
+    uint64_t las_catalog_num_entries(const las_catalog_t *self);
+
+    /// Returns the entry of the file at `index`, in the order the paths were given
+    const las_catalog_entry_t *las_catalog_entry(const las_catalog_t *self, uint64_t index);
+
+    /// Finds the files whose x/y bounds intersect the `bbox` (bounds touching count)
+    ///
+    /// The indices of the first `max_indices` matching files are written
+    /// in `out_indices` (which can be NULL if `max_indices` is 0),
+    /// the total number of matching files is returned.
+    uint64_t las_catalog_query_bbox(const las_catalog_t *self,
+                                    las_catalog_bbox_t bbox,
+                                    uint64_t *out_indices,
+                                    uint64_t max_indices);
+
+    /// Frees the catalog
+    ///
+    /// \param self __can__ be null
+    void las_catalog_delete(las_catalog_t *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LAS_C_CATALOG_H
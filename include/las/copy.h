@@ -0,0 +1,35 @@
+#ifndef LAS_C_COPY_H
+#define LAS_C_COPY_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <las/error.h>
+
+    typedef struct las_header_t las_header_t;
+
+    /// Copies a LAS file without decoding its points
+    ///
+    /// The new header and VLRs are written, then the point data
+    /// (and everything that follows it, like EVLRs) is copied as is.
+    /// When possible, the copy is done by the kernel (`copy_file_range`, `sendfile`)
+    /// without the bytes going through user space, otherwise large buffered copies are used.
+    ///
+    /// - `input_path`: path to the LAS file to copy, its points must not be compressed
+    /// - `output_path`: path where the copy will be created
+    /// - `header`: can be NULL, in that case the input file's header is used.
+    ///             Otherwise, the header (and VLRs) to write in the copy,
+    ///             its point format and scaling must be the same as the input's.
+    ///             Fields that describe the point data (point count, bounds,
+    ///             number of points by return, EVLRs) are always taken from the input.
+    ///             The header is not modified nor freed.
+    las_error_t
+    las_copy_file_path(const char *input_path, const char *output_path, const las_header_t *header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LAS_C_COPY_H
@@ -0,0 +1,88 @@
+#ifndef LAS_C_EDITOR_H
+#define LAS_C_EDITOR_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <las/error.h>
+#include <las/header.h>
+
+#include <stdint.h>
+
+    /// Changes fields of the points of a LAS file in place
+    ///
+    /// Only the bytes of the changed fields are written, the rest of the file
+    /// (header, other fields, EVLRs) is left untouched.
+    typedef struct las_editor las_editor_t;
+
+    /// Fields that can be changed by an editor
+    ///
+    /// They are at the same offset in every point record of a file,
+    /// so changing them does not require decoding the points.
+    enum las_point_field_t
+    {
+        /// Values in [0, 31] for point formats 0 to 5, [0, 255] for 6 to 10
+        LAS_POINT_FIELD_CLASSIFICATION = 0,
+        /// Values in [0, 255]
+        LAS_POINT_FIELD_USER_DATA,
+        /// Values in [0, 65535]
+        LAS_POINT_FIELD_POINT_SOURCE_ID,
+        /// Values in [0, 1]
+        LAS_POINT_FIELD_SYNTHETIC,
+        /// Values in [0, 1]
+        LAS_POINT_FIELD_KEY_POINT,
+        /// Values in [0, 1]
+        LAS_POINT_FIELD_WITHHELD,
+        /// Values in [0, 1], only for point formats 6 to 10
+        LAS_POINT_FIELD_OVERLAP,
+    };
+
+    typedef enum las_point_field_t las_point_field_t;
+
+    /// Opens an existing LAS file to change its points in place
+    ///
+    /// - `file_path`: path to the file, its points must not be compressed
+    ///
+    /// On POSIX systems the point data is memory mapped,
+    /// so changing the points of a range only touches the pages it spans.
+    las_error_t las_editor_open_file_path(const char *file_path, las_editor_t **out_editor);
+
+    /// Returns the header of the file being edited
+    const las_header_t *las_editor_header(const las_editor_t *self);
+
+    /// Sets the `field` of the points in [`first`, `first` + `count`) to `value`
+    ///
+    /// Nothing is changed if the range is not fully within the file
+    /// (`LAS_ERROR_POINT_INDEX_OUT_OF_RANGE`) or if the value does not fit
+    /// in the field (`LAS_ERROR_INVALID_FIELD_VALUE`).
+    las_error_t las_editor_set_range(las_editor_t *self,
+                                     las_point_field_t field,
+                                     uint64_t first,
+                                     uint64_t count,
+                                     uint16_t value);
+
+    /// Sets the `field` of the points at the given indices to `value`
+    ///
+    /// `indices` do not need to be sorted, and may contain duplicates.
+    /// All indices are checked before any point is changed.
+    las_error_t las_editor_set_selection(las_editor_t *self,
+                                         las_point_field_t field,
+                                         const uint64_t *indices,
+                                         uint64_t num_indices,
+                                         uint16_t value);
+
+    /// Makes sure the changes made so far are written to the file
+    las_error_t las_editor_flush(las_editor_t *self);
+
+    /// Closes the file, and deletes the editor
+    ///
+    /// Changes that were not flushed are still written back by the system.
+    void las_editor_delete(las_editor_t *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LAS_C_EDITOR_H
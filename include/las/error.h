@@ -29,6 +29,18 @@ extern "C"
         LAS_ERROR_INCOMPATIBLE_VERSION_AND_FORMAT,
         LAS_ERROR_POINT_COUNT_TOO_HIGH,
         LAS_ERROR_INCOMPATIBLE_POINT_FORMAT,
+        LAS_ERROR_INCOMPATIBLE_VERSION_AND_EVLRS,
+        LAS_ERROR_EVLR_DATA_NOT_LOADED,
+        LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA,
+        LAS_ERROR_INCOMPATIBLE_SCALING,
+        LAS_ERROR_UNSUPPORTED_HEADER_LAYOUT,
+        LAS_ERROR_POINT_INDEX_OUT_OF_RANGE,
+        LAS_ERROR_INVALID_FIELD_VALUE,
+        LAS_ERROR_INVALID_EXTRA_BYTES_VLR,
+        LAS_ERROR_UNSUPPORTED_EXTRA_BYTES_TYPE,
+        LAS_ERROR_COORDINATE_OVERFLOW,
+        LAS_ERROR_INVALID_CATALOG,
+        LAS_ERROR_INVALID_LAZ_CHUNK_TABLE,
 #ifdef WITH_LAZRS
         LAS_ERROR_LAZRS,
 #else
@@ -55,6 +67,7 @@ extern "C"
                 uint16_t minimum;
             } point_size;
             /// Active for LAS_ERROR_INVALID_VERSION
+            /// and LAS_ERROR_INCOMPATIBLE_VERSION_AND_EVLRS
             las_version_t version;
             /// Active for LAS_ERROR_INVALID_POINT_FORMAT
             uint8_t point_format_id;
@@ -68,6 +81,8 @@ extern "C"
             int errno_;
             /// Active for LAS_ERROR_POINT_COUNT_TOO_HIGH
             uint64_t point_count;
+            /// Active for LAS_ERROR_POINT_INDEX_OUT_OF_RANGE
+            uint64_t point_index;
             /// Active for LAS_ERROR_INVALID_SIGNATURE
             // +1 for the null terminator
             char signature[LAS_SIGNATURE_SIZE + 1];
@@ -0,0 +1,125 @@
+#ifndef LAS_C_EXTRA_BYTES_H
+#define LAS_C_EXTRA_BYTES_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <las/error.h>
+#include <las/header.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// User id of the VLR describing the extra bytes
+#define LAS_EXTRA_BYTES_VLR_USER_ID "LASF_Spec"
+/// Record id of the VLR describing the extra bytes
+#define LAS_EXTRA_BYTES_VLR_RECORD_ID 4
+/// Size of the description of one dimension in the VLR
+#define LAS_EXTRA_BYTES_DESCRIPTOR_SIZE 192
+/// Size of the name and description of a dimension (without the NUL terminator)
+#define LAS_EXTRA_BYTES_NAME_SIZE 32
+
+    /// Data types of extra bytes dimensions
+    ///
+    /// Values 11 to 30 (arrays of 2 or 3 values) are deprecated since LAS 1.4,
+    /// they are parsed, but their values cannot be read as columns.
+    enum las_extra_bytes_type_t
+    {
+        /// `options` is the number of bytes, their meaning is unknown
+        LAS_EXTRA_BYTES_UNDOCUMENTED = 0,
+        LAS_EXTRA_BYTES_U8,
+        LAS_EXTRA_BYTES_I8,
+        LAS_EXTRA_BYTES_U16,
+        LAS_EXTRA_BYTES_I16,
+        LAS_EXTRA_BYTES_U32,
+        LAS_EXTRA_BYTES_I32,
+        LAS_EXTRA_BYTES_U64,
+        LAS_EXTRA_BYTES_I64,
+        LAS_EXTRA_BYTES_F32,
+        LAS_EXTRA_BYTES_F64,
+    };
+
+    typedef enum las_extra_bytes_type_t las_extra_bytes_type_t;
+
+    /// One dimension stored in the extra bytes of the points
+    typedef struct las_extra_bytes_dimension
+    {
+        /// NUL terminated
+        char name[LAS_EXTRA_BYTES_NAME_SIZE + 1];
+        /// NUL terminated
+        char description[LAS_EXTRA_BYTES_NAME_SIZE + 1];
+        /// A `las_extra_bytes_type_t`, or a deprecated array type
+        uint8_t data_type;
+        /// Bit field telling which of no_data, min, max, scale, offset are set
+        uint8_t options;
+        /// Position of the dimension's bytes in the extra bytes of a point
+        uint16_t byte_offset;
+        /// Number of bytes of the dimension
+        uint16_t size;
+        /// 1.0 when the VLR does not set it
+        double scale;
+        /// 0.0 when the VLR does not set it
+        double offset;
+        /// Whether `no_data` is set
+        bool has_no_data;
+        /// Value (before scaling) that marks points without data
+        double no_data;
+    } las_extra_bytes_dimension_t;
+
+    /// Description of the extra bytes of the points, from the extra bytes VLR
+    typedef struct las_extra_bytes_schema
+    {
+        uint16_t num_dimensions;
+        las_extra_bytes_dimension_t *dimensions;
+    } las_extra_bytes_schema_t;
+
+    /// Parses the extra bytes VLR (user id "LASF_Spec", record id 4) of the header
+    ///
+    /// The schema has no dimensions if the header has no such VLR.
+    /// Returns `LAS_ERROR_INVALID_EXTRA_BYTES_VLR` if the VLR is truncated,
+    /// or describes more bytes than the point format has.
+    ///
+    /// Call `las_extra_bytes_schema_deinit` once done with the schema.
+    las_error_t las_extra_bytes_schema_from_header(const las_header_t *header,
+                                                   las_extra_bytes_schema_t *out_schema);
+
+    /// Frees the dimensions of the schema
+    void las_extra_bytes_schema_deinit(las_extra_bytes_schema_t *self);
+
+    /// Returns the dimension with the given name, NULL if there is none
+    const las_extra_bytes_dimension_t *
+    las_extra_bytes_schema_find(const las_extra_bytes_schema_t *self, const char *name);
+
+    /// Reads the values of a dimension from `num_points` point records
+    ///
+    /// `records` are full point records of `point_format`
+    /// (e.g. from `las_reader_read_many_next_bytes`).
+    /// The values are converted to double, then `scale` and `offset` are applied.
+    /// Values equal to the dimension's no data value are written as NaN.
+    ///
+    /// Returns `LAS_ERROR_UNSUPPORTED_EXTRA_BYTES_TYPE` for undocumented
+    /// and deprecated array dimensions.
+    las_error_t las_extra_bytes_read_scaled(const las_extra_bytes_dimension_t *dimension,
+                                            las_point_format_t point_format,
+                                            const uint8_t *records,
+                                            uint64_t num_points,
+                                            double *values);
+
+    /// Copies the values of a dimension from `num_points` point records, as stored
+    ///
+    /// `values` must hold `num_points` values of the dimension's type
+    /// (`num_points * dimension->size` bytes), e.g. an `int16_t` array
+    /// for a `LAS_EXTRA_BYTES_I16` dimension.
+    las_error_t las_extra_bytes_read_raw(const las_extra_bytes_dimension_t *dimension,
+                                         las_point_format_t point_format,
+                                         const uint8_t *records,
+                                         uint64_t num_points,
+                                         void *values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LAS_C_EXTRA_BYTES_H
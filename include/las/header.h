@@ -58,10 +58,13 @@ extern "C"
         return (((double)value) * scale) + offset;
     }
 
+    /// Rounds to the nearest integer (halfway cases away from zero),
+    /// truncating would turn e.g. 0.29 with a scale of 0.01 into 28.
     static inline int32_t
     scaling_unapply(const double scale, const double offset, const double value)
     {
-        return (int32_t)((value - offset) / scale);
+        const double unscaled = (value - offset) / scale;
+        return (int32_t)((unscaled >= 0.0) ? unscaled + 0.5 : unscaled - 0.5);
     }
 
     static inline double las_scaling_apply_x(const las_scaling_t self, const int32_t x)
@@ -94,6 +97,9 @@ extern "C"
         return scaling_unapply(self.scales.z, self.offsets.z, z);
     }
 
+    /// Storage shared by the VLR payloads of a header and its clones
+    typedef struct las_vlr_arena las_vlr_arena_t;
+
     /// LAS header
     ///
     /// Contains metadata describing the points contained in the file
@@ -134,22 +140,43 @@ extern "C"
         // version >= 1.4
         uint64_t start_of_evlrs;
         uint32_t number_of_evlrs;
+        las_evlr_t *evlrs;
 
         uint32_t num_extra_header_bytes;
         uint8_t *extra_header_bytes;
 
         /// Internal information
         uint32_t offset_to_point_data;
+
+        /// Internal information
+        ///
+        /// Holds the VLR payloads of headers read from a file, clones share it
+        /// instead of copying the payloads. NULL when each payload is its own allocation
+        /// (e.g. headers built by the user).
+        las_vlr_arena_t *vlr_arena;
     };
 
     typedef struct las_header_t las_header_t;
 
     /// Clones and returns the header in out_header
     ///
+    /// The VLR payloads stored in the header's arena are shared, not copied,
+    /// cloning is proportional to the number of VLRs.
+    ///
     /// - returns 0 if everything was ok.
     /// - returns 1 if allocation failed
     int las_header_clone(const las_header_t *self, las_header_t **out_header);
 
+    /// Gives the VLR at `index` a payload of its own, so it can be modified
+    ///
+    /// The payloads of VLRs read from a file are shared by the header
+    /// and its clones (copy-on-write), they must not be modified in place
+    /// without calling this first.
+    ///
+    /// - returns 0 if everything was ok.
+    /// - returns 1 if allocation failed
+    int las_header_vlr_make_writable(las_header_t *self, uint32_t index);
+
     /// frees the header and everything that it contains
     ///
     /// \param self __can__ be null
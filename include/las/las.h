@@ -5,6 +5,10 @@
 extern "C" {
 #endif
 
+#include <las/catalog.h>
+#include <las/copy.h>
+#include <las/editor.h>
+#include <las/extra_bytes.h>
 #include <las/header.h>
 #include <las/point.h>
 #include <las/reader.h>
@@ -6,6 +6,7 @@
 extern "C" {
 #endif
 
+#include <las/error.h>
 #include <las/header.h>
 
 #include <stdint.h>
@@ -144,6 +145,51 @@ void las_raw_point_copy_from_raw(
 
 int las_raw_point_eq(const las_raw_point_t *lhs, const las_raw_point_t *rhs);
 
+/// Converts `num_points` point records from `source_format` to `dest_format`
+///
+/// The records are converted directly, without being decoded: the fields
+/// both formats have are copied with a field map computed once for the pair of formats.
+/// The result is the same as decoding the records, converting the points
+/// with `las_raw_point_copy_from_raw` and encoding them.
+///
+/// The scan angle rank of formats 0 to 5 is in degrees, the scan angle of formats
+/// 6 to 10 in steps of 0.006 degree: it is converted, rounded to the nearest,
+/// and clamped to [-90, 90] degrees when going to formats 0 to 5.
+///
+/// Fields the source format does not have are zeroed. When the formats
+/// have a different number of extra bytes, the common ones are copied.
+///
+/// `source` holds `num_points` records of the source format,
+/// `dest` must be able to hold `num_points` records of the destination format.
+void las_transcode_records(las_point_format_t source_format,
+                           las_point_format_t dest_format,
+                           const uint8_t *source,
+                           uint8_t *dest,
+                           uint64_t num_points);
+
+/// Rewrites the coordinates of `num_points` point records of `point_format`
+/// from `source_scaling` to `dest_scaling`
+///
+/// Each coordinate becomes the integer `las_scaling_unapply` would give for the
+/// coordinate `las_scaling_apply` gives, computed for the whole batch with vectorized
+/// kernels, without going through `las_point_t`. E.g. to merge files that use
+/// different scales.
+///
+/// Returns `LAS_ERROR_COORDINATE_OVERFLOW`, and leaves the records untouched,
+/// if a coordinate does not fit in 32 bits with the new scaling.
+las_error_t las_rescale_records(las_point_format_t point_format,
+                                uint8_t *records,
+                                uint64_t num_points,
+                                las_scaling_t source_scaling,
+                                las_scaling_t dest_scaling);
+
+/// Same as `las_rescale_records`, for raw points of the same point format family
+/// (0-5 or 6-10)
+las_error_t las_raw_point_rescale_many(las_raw_point_t *points,
+                                       uint64_t num_points,
+                                       las_scaling_t source_scaling,
+                                       las_scaling_t dest_scaling);
+
 /// Prepares the point to match the description from the header
 ///
 /// Call `las_raw_point_deinit` once you are done with the point
@@ -170,6 +216,97 @@ static inline void las_raw_point_deinit_many(las_raw_point_t *points, const uint
     }
 }
 
+/// Prepares `num_points` points, like `las_raw_point_prepare_many`,
+/// but the extra bytes of all the points are allocated as one contiguous slab
+///
+/// A batch needs a single allocation instead of one per point,
+/// and the extra bytes of consecutive points are next to each other.
+///
+/// Call `las_raw_point_deinit_slab` (not `las_raw_point_deinit`)
+/// once you are done with the points, the `extra_bytes` pointers
+/// of the points must not be changed in the meantime.
+void las_raw_point_prepare_slab(las_raw_point_t *points,
+                                uint64_t num_points,
+                                las_point_format_t point_format);
+
+/// Frees the extra bytes slab of points prepared with `las_raw_point_prepare_slab`
+///
+/// Does __not__ free the `points`
+void las_raw_point_deinit_slab(las_raw_point_t *points, uint64_t num_points);
+
+/// Bits of `las_packed_point_t::flags`
+enum las_packed_point_flag_t
+{
+    LAS_PACKED_POINT_SYNTHETIC = 1 << 0,
+    LAS_PACKED_POINT_KEY_POINT = 1 << 1,
+    LAS_PACKED_POINT_WITHHELD = 1 << 2,
+    /// fmt 6 to 10
+    LAS_PACKED_POINT_OVERLAP = 1 << 3,
+    LAS_PACKED_POINT_SCAN_DIRECTION = 1 << 6,
+    LAS_PACKED_POINT_EDGE_OF_FLIGHT_LINE = 1 << 7,
+};
+
+/// Compact point, without bit fields nor pointers
+///
+/// Works for all point formats, except for the wave packet
+/// of formats 4, 5, 9 and 10, which is not stored.
+///
+/// It is 48 bytes (less than half a `las_raw_point_t`) and trivially copyable:
+/// arrays of packed points can be sorted, partitioned, or moved
+/// between threads with plain `memcpy`.
+/// The most used fields come first.
+///
+/// The extra bytes are stored in a side buffer, the point only
+/// holds their offset in it, which stays valid when points are moved around.
+typedef struct las_packed_point
+{
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    uint16_t intensity;
+    uint8_t return_number;
+    uint8_t number_of_returns;
+    uint8_t classification;
+    /// `las_packed_point_flag_t` bits
+    uint8_t flags;
+    uint8_t user_data;
+    /// fmt 6 to 10
+    uint8_t scanner_channel;
+    /// For fmt 0 to 5, the scan angle rank byte
+    uint16_t scan_angle;
+    uint16_t point_source_id;
+    double gps_time;
+    uint16_t red;
+    uint16_t green;
+    uint16_t blue;
+    uint16_t nir;
+    /// Offset, in bytes, of the point's extra bytes in the side buffer
+    uint32_t extra_bytes_offset;
+    /// Always 0, so that packed points can be compared with `memcmp`
+    uint32_t reserved;
+} las_packed_point_t;
+
+/// Converts `num_points` raw points into packed points
+///
+/// The extra bytes of the i-th point are copied into `extra_bytes`
+/// at offset `i * num_extra_bytes`, which is stored in the packed point.
+/// `extra_bytes` must hold `num_points * num_extra_bytes` bytes
+/// (it can be NULL when the points have no extra bytes).
+void las_packed_point_from_raw_many(const las_raw_point_t *points,
+                                    uint64_t num_points,
+                                    las_packed_point_t *packed_points,
+                                    uint8_t *extra_bytes);
+
+/// Converts `num_points` packed points back into raw points
+///
+/// `points` must have been prepared for the point format,
+/// their extra bytes are copied from `extra_bytes` at the offsets
+/// stored in the packed points.
+void las_packed_point_to_raw_many(const las_packed_point_t *packed_points,
+                                  uint64_t num_points,
+                                  const uint8_t *extra_bytes,
+                                  las_raw_point_t *points);
+
 /// A more general point type
 ///
 /// Works for all point formats
@@ -222,10 +359,128 @@ void las_point_copy_from_raw(las_point_t *self,
                              const las_raw_point_t *raw_point,
                              las_scaling_t scaling);
 
+/// Converts `num_points` raw points into `points`, as `las_point_copy_from_raw` would
+///
+/// All the raw points must be of the same point format family (0-5 or 6-10),
+/// the format is only looked at once for the whole batch, and the
+/// coordinates are scaled with vectorized kernels.
+void las_point_copy_many_from_raw(las_point_t *points,
+                                  const las_raw_point_t *raw_points,
+                                  uint64_t num_points,
+                                  las_scaling_t scaling);
+
+/// Converts `num_points` points into `raw_points`, as `las_raw_point_copy_from_point` would
+///
+/// The raw points must have been prepared for point formats of the same family
+/// (0-5 or 6-10).
+void las_raw_point_copy_many_from_point(las_raw_point_t *raw_points,
+                                        const las_point_t *points,
+                                        uint64_t num_points,
+                                        las_scaling_t scaling);
+
 void las_point_prepare(las_point_t *self, las_point_format_t point_format);
 
 void las_point_deinit(las_point_t *self);
 
+/// Points given as one array per dimension
+///
+/// Every non-NULL array must hold one value per point,
+/// dimensions left NULL are written as zeros.
+/// Dimensions the point format does not have are ignored.
+///
+/// Zero initialize it, then set the dimensions you have.
+typedef struct las_point_columns
+{
+    /// Scaled coordinates, converted with the header's scaling
+    const double *x;
+    const double *y;
+    const double *z;
+
+    const uint16_t *intensity;
+
+    const uint8_t *return_number;
+    const uint8_t *number_of_returns;
+
+    /// Flags, 0 or 1
+    const uint8_t *synthetic;
+    const uint8_t *key_point;
+    const uint8_t *withheld;
+    /// fmt 6 to 10
+    const uint8_t *overlap;
+    /// fmt 6 to 10
+    const uint8_t *scanner_channel;
+    const uint8_t *scan_direction_flag;
+    const uint8_t *edge_of_flight_line;
+
+    const uint8_t *classification;
+    const uint8_t *user_data;
+    /// For fmt 0 to 5, only the low byte is written (scan angle rank)
+    const uint16_t *scan_angle;
+    const uint16_t *point_source_id;
+    const double *gps_time;
+
+    const uint16_t *red;
+    const uint16_t *green;
+    const uint16_t *blue;
+
+    const uint16_t *nir;
+
+    const las_wave_packet_t *wave_packet;
+
+    /// `num_extra_bytes` bytes per point, point after point
+    const uint8_t *extra_bytes;
+} las_point_columns_t;
+
+/// Points as stored in records, with one array per dimension
+///
+/// Every non-NULL array must be able to hold one value per point.
+/// When reading, dimensions left NULL are not decoded, and dimensions
+/// the point format does not have are left untouched.
+/// When writing, dimensions left NULL are written as zeros.
+///
+/// Zero initialize it, then set the dimensions you need.
+typedef struct las_raw_point_columns
+{
+    /// Coordinates as stored (not scaled)
+    int32_t *x;
+    int32_t *y;
+    int32_t *z;
+
+    uint16_t *intensity;
+
+    uint8_t *return_number;
+    uint8_t *number_of_returns;
+
+    /// Flags, 0 or 1
+    uint8_t *synthetic;
+    uint8_t *key_point;
+    uint8_t *withheld;
+    /// fmt 6 to 10
+    uint8_t *overlap;
+    /// fmt 6 to 10
+    uint8_t *scanner_channel;
+    uint8_t *scan_direction_flag;
+    uint8_t *edge_of_flight_line;
+
+    uint8_t *classification;
+    uint8_t *user_data;
+    /// For fmt 0 to 5, the scan angle rank byte
+    uint16_t *scan_angle;
+    uint16_t *point_source_id;
+    double *gps_time;
+
+    uint16_t *red;
+    uint16_t *green;
+    uint16_t *blue;
+
+    uint16_t *nir;
+
+    las_wave_packet_t *wave_packet;
+
+    /// `num_extra_bytes` bytes per point, point after point
+    uint8_t *extra_bytes;
+} las_raw_point_columns_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,8 @@ extern "C"
 
     typedef struct las_point_t las_point_t;
 
+    typedef struct las_raw_point_columns las_raw_point_columns_t;
+
     typedef struct las_reader las_reader_t;
 
     /// Creates a reader that reads from a file
@@ -39,6 +41,48 @@ extern "C"
     /// The reader still owns the header.
     const las_header_t *las_reader_header(const las_reader_t *reader);
 
+    /// Loads the payload of the EVLR at `index` in the reader's header
+    ///
+    /// When the reader is opened, only the EVLRs descriptions are read,
+    /// their payload stays NULL until this function is called.
+    /// Once loaded, the payload is available in `header->evlrs[index].data`,
+    /// calling this function again does nothing.
+    ///
+    /// This does not change the position of the next point to be read.
+    las_error_t las_reader_read_evlr_data(las_reader_t *self, uint32_t index);
+
+    /// Loads the payload of all EVLRs
+    ///
+    /// Useful before cloning the header to give it to a writer
+    /// that does not have the file as `evlr_source_path` (see `las_writer_options_t`),
+    /// as EVLRs can then only be written if their payload is loaded.
+    las_error_t las_reader_read_all_evlr_data(las_reader_t *self);
+
+    /// A chunk of LAZ data
+    ///
+    /// Chunks are compressed independently, so a chunk can be decompressed
+    /// without the ones before it.
+    typedef struct las_laz_chunk
+    {
+        /// Number of points in the chunk
+        uint64_t point_count;
+        /// Position of the chunk's first byte in the file
+        uint64_t byte_offset;
+        /// Size of the compressed chunk, in bytes
+        uint64_t byte_count;
+    } las_laz_chunk_t;
+
+    /// Returns the chunks of the LAZ data, in the order of the points
+    ///
+    /// The chunk table is read the first time this is called, this does not change
+    /// the position of the next point to be read.
+    /// There are no chunks (`*out_num_chunks` is 0) when the data is not compressed.
+    ///
+    /// The reader owns the chunks, they are valid until it is destroyed.
+    las_error_t las_reader_laz_chunks(las_reader_t *self,
+                                      const las_laz_chunk_t **out_chunks,
+                                      uint64_t *out_num_chunks);
+
     /// Reads the next point into a raw point struct
     ///
     /// `point` must have been 'prepared' with
@@ -48,6 +92,28 @@ extern "C"
     las_error_t
     las_reader_read_many_next_raw(las_reader_t *self, las_raw_point_t *points, uint64_t num_points);
 
+    /// Reads the next `num_points` points into columns
+    ///
+    /// The first `num_points` values of each non-NULL member of `columns`
+    /// are written, NULL members are skipped. Members for fields the point format
+    /// does not have are left untouched.
+    ///
+    /// `extra_bytes` must be able to hold `num_points` times the number of
+    /// extra bytes per point.
+    ///
+    /// The records are decoded in blocks with SIMD instructions when the CPU supports them,
+    /// which is faster than decoding each record into a `las_raw_point_t`.
+    las_error_t las_reader_read_many_next_columns(las_reader_t *self,
+                                                  const las_raw_point_columns_t *columns,
+                                                  uint64_t num_points);
+
+    /// Reads the next `num_points` point records without decoding them
+    ///
+    /// `bytes` must be able to hold `num_points * las_point_format_point_size(...)` bytes,
+    /// the records are in the header's point format (decompressed, if the data is LAZ).
+    las_error_t
+    las_reader_read_many_next_bytes(las_reader_t *self, uint8_t *bytes, uint64_t num_points);
+
     /// Reads the newt point into a point struct
     ///
     /// `point` must have been 'prepared' with
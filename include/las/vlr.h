@@ -29,6 +29,29 @@ typedef struct las_vlr
 /// - returns 1 if allocation failed
 int las_vlr_clone(const las_vlr_t *self, las_vlr_t **out_vlr);
 
+/// Extended Variable Length Record (EVLR)
+///
+/// EVLRs are stored after the point data (LAS >= 1.4),
+/// their payload can be very large (waveform data, hierarchies, etc),
+/// so readers only load it when asked to (see `las_reader_read_evlr_data`).
+typedef struct las_evlr
+{
+    char user_id[LAS_VLR_USER_ID_SIZE];
+    uint16_t record_id;
+    char description[LAS_VLR_DESCRIPTION_SIZE];
+
+    uint64_t data_size;
+    /// Raws data bytes
+    ///
+    /// NULL as long as the payload was not loaded
+    uint8_t *data;
+
+    /// Internal information
+    ///
+    /// Position of the payload in the source the EVLR was read from
+    uint64_t offset_to_data;
+} las_evlr_t;
+
 
 #ifdef __cplusplus
 }
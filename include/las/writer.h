@@ -5,9 +5,56 @@
 extern "C" {
 #endif
 
+#include <las/error.h>
+#include <las/header.h>
+#include <stdint.h>
+
 typedef struct las_writer las_writer_t;
 
 typedef struct las_raw_point_t las_raw_point_t;
+typedef struct las_point_t las_point_t;
+typedef struct las_point_columns las_point_columns_t;
+typedef struct las_raw_point_columns las_raw_point_columns_t;
+
+/// Options to tune how a writer writes its file
+///
+/// Zero initialize it to get the defaults.
+typedef struct las_writer_options
+{
+    /// Number of threads that compress LAZ chunks in the background
+    /// while the caller keeps writing points.
+    ///
+    /// 0 means chunks are compressed by the thread calling the write functions.
+    /// The compressed bytes are the same regardless of this value.
+    ///
+    /// Only used when the library is built with `WITH_LAZ_CHUNKED_WRITER`,
+    /// otherwise the points go to a single lazrs compressor, which compresses
+    /// the chunks on its own threads.
+    uint32_t num_workers;
+    /// Number of points per LAZ chunk
+    ///
+    /// 0 means the default of 50 000 points. Each chunk is compressed by a lazrs
+    /// compressor which has that chunk size, and would split bigger chunks,
+    /// so bigger values are lowered to it.
+    ///
+    /// Only supported when the library is built with `WITH_LAZ_CHUNKED_WRITER`,
+    /// opening a LAZ file with a non zero value otherwise returns
+    /// `LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA`.
+    uint32_t chunk_size;
+    /// Number of threads that help the calling thread encode
+    /// large batches given to `las_writer_write_many_raw_points`.
+    ///
+    /// 0 means points are only encoded by the thread calling the write functions.
+    /// The written bytes are the same regardless of this value.
+    uint32_t num_encoding_threads;
+    /// Path of the file the EVLRs of the header were read from, can be NULL
+    ///
+    /// The payloads of the EVLRs that are not loaded (e.g. in a header cloned
+    /// from a reader) are copied from this file when the writer is closed,
+    /// in blocks of bounded size, so they never need to be loaded in memory.
+    /// Without it, all the payloads must be loaded (`LAS_ERROR_EVLR_DATA_NOT_LOADED`).
+    const char *evlr_source_path;
+} las_writer_options_t;
 
 /// Creates a LAS/LAZ file for writing
 ///
@@ -18,6 +65,37 @@ typedef struct las_raw_point_t las_raw_point_t;
 las_error_t
 las_writer_open_file_path(const char *file_path, las_header_t *header, las_writer_t **out_writer);
 
+/// Same as `las_writer_open_file_path`, with options
+///
+/// `options` can be NULL, the defaults are used in that case.
+las_error_t las_writer_open_file_path_with_options(const char *file_path,
+                                                   las_header_t *header,
+                                                   const las_writer_options_t *options,
+                                                   las_writer_t **out_writer);
+
+
+/// Opens an existing LAS file to add points after the ones it already has
+///
+/// - `file_path`: path to the file, its points must not be compressed
+/// - `point_format`: format of the points that will be written,
+///                   it must be the same as the file's
+///
+/// The file's EVLRs (if any) are moved after the new points: until the writer is closed,
+/// their payloads are kept in a temporary file, copied in blocks of bounded size.
+/// Files with internal waveform data packets are not supported
+/// (`LAS_ERROR_UNSUPPORTED_HEADER_LAYOUT`).
+/// The point count, bounds and number of points by return of the header
+/// are updated when the writer is closed.
+las_error_t las_writer_open_append(const char *file_path,
+                                   las_point_format_t point_format,
+                                   las_writer_t **out_writer);
+
+/// Returns the header of the file being written
+///
+/// Useful with `las_writer_open_append` to know the scaling of the file.
+/// The writer still owns the header, its point count and bounds
+/// are only updated when the writer is closed.
+const las_header_t *las_writer_header(const las_writer_t *self);
 
 /// Closes the file, and deletes the writer
 void las_writer_delete(las_writer_t *self);
@@ -30,6 +108,74 @@ las_error_t las_writer_write_raw_point(las_writer_t *self, const las_raw_point_t
 las_error_t las_writer_write_many_raw_points(
     las_writer_t *self, const las_raw_point_t *points, const uint64_t num_points);
 
+/// Write points records that are already packed in the header's point format
+///
+/// `bytes` must contain `num_points` records of `las_point_format_point_size` bytes
+/// each (e.g. bytes obtained from `las_reader_read_many_next_bytes`),
+/// they are written as is, without being decoded.
+/// The point count and the number of points by return are updated from the records
+/// once they are written.
+las_error_t
+las_writer_write_many_bytes(las_writer_t *self, const uint8_t *bytes, uint64_t num_points);
+
+/// Write points with scaled coordinates
+///
+/// The points are encoded directly in the header's point format,
+/// the coordinates are converted with the header's scaling,
+/// rounded to the nearest integer.
+/// Points without extra bytes get zeroed extra bytes.
+///
+/// Returns `LAS_ERROR_COORDINATE_OVERFLOW`, and writes none of the points,
+/// if a coordinate does not fit in 32 bits once converted.
+las_error_t
+las_writer_write_many_points(las_writer_t *self, const las_point_t *points, uint64_t num_points);
+
+/// Write points given as columns of scaled coordinates
+///
+/// `xs`, `ys` and `zs` must each hold `num_points` values,
+/// they are converted like in `las_writer_write_many_points`.
+/// All the other fields of the points are zero.
+las_error_t las_writer_write_many_xyz(las_writer_t *self,
+                                      const double *xs,
+                                      const double *ys,
+                                      const double *zs,
+                                      uint64_t num_points);
+
+/// Write points given as one array per dimension
+///
+/// The arrays are packed directly into records of the header's point format,
+/// dimensions whose array is NULL are zeroed (see `las_point_columns_t`).
+/// Coordinates are converted like in `las_writer_write_many_points`.
+las_error_t las_writer_write_columns(las_writer_t *self,
+                                     const las_point_columns_t *columns,
+                                     uint64_t num_points);
+
+/// Write points given as one array per dimension, with coordinates as stored
+///
+/// Same as `las_writer_write_columns`, but the coordinates are not scaled,
+/// dimensions whose array is NULL are zeroed.
+/// The records are packed in blocks with SIMD instructions when the CPU supports them,
+/// they are the same bytes as `las_writer_write_many_raw_points` would write.
+las_error_t las_writer_write_raw_columns(las_writer_t *self,
+                                         const las_raw_point_columns_t *columns,
+                                         uint64_t num_points);
+
+/// Closes the LAZ chunk being filled, the next points written go in a new chunk
+///
+/// This lets producers align chunks with spatial cells or time windows,
+/// so that readers can skip whole chunks using the chunk table
+/// (see `las_reader_laz_chunks`).
+/// A chunk is still closed automatically once it has `chunk_size` points
+/// (see `las_writer_options_t`).
+///
+/// Once a chunk is closed before being full, the file is written with
+/// variable size chunks: the chunk table stores the point count of each chunk.
+///
+/// Does nothing when the current chunk is empty, or when writing a LAS file.
+/// Returns `LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA` for LAZ files when the library
+/// is not built with `WITH_LAZ_CHUNKED_WRITER`, lazrs only closes full chunks.
+las_error_t las_writer_finish_chunk(las_writer_t *self);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,542 @@
+#include "las/catalog.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "private/atomic.h"
+#include "private/dest.h"
+#include "private/header.h"
+#include "private/macro.h"
+#include "private/source.h"
+#include "private/thread_pool.h"
+#include "private/utils.h"
+
+/// User id of the VLRs describing the coordinate reference system
+#define LAS_CATALOG_CRS_USER_ID "LASF_Projection"
+
+/// Number of paths a worker claims at once
+#define LAS_CATALOG_BATCH_SIZE 16
+
+/// Catalog file layout (little endian):
+///
+/// - magic "LASCATLG" (8 bytes)
+/// - format version (uint32), entry size (uint32)
+/// - number of entries (uint64), size of the paths (uint64)
+/// - the entries, `LAS_CATALOG_ENTRY_SIZE` bytes each:
+///   status (u8), version major (u8), version minor (u8), point format id (u8),
+///   num extra bytes (u16), is compressed (u8), reserved (u8), point count (u64),
+///   mins x y z (f64), maxs x y z (f64), crs hash (u64)
+/// - the paths, each one NUL terminated, in the order of the entries
+#define LAS_CATALOG_MAGIC "LASCATLG"
+#define LAS_CATALOG_MAGIC_SIZE 8
+#define LAS_CATALOG_FORMAT_VERSION 1
+#define LAS_CATALOG_PREAMBLE_SIZE 32
+#define LAS_CATALOG_ENTRY_SIZE 72
+
+struct las_catalog
+{
+    uint64_t num_entries;
+    las_catalog_entry_t *entries;
+    /// The paths of the entries, NUL separated, entries point into it
+    char *paths;
+    uint64_t paths_size;
+    /// The x/y bounds of the entries, kept apart so queries scan compact memory
+    ///
+    /// Entries with a failure status have an empty bbox (min > max).
+    las_catalog_bbox_t *bboxes;
+};
+
+/// Shared by the workers reading the headers
+typedef struct las_catalog_job
+{
+    const char *const *paths;
+    las_catalog_entry_t *entries;
+    uint64_t num_paths;
+    las_atomic_u64_t next_index;
+} las_catalog_job_t;
+
+static inline las_error_t las_catalog_errno_error(void)
+{
+    las_error_t las_err;
+    las_err.kind = LAS_ERROR_ERRNO;
+    las_err.errno_ = errno;
+    return las_err;
+}
+
+/// FNV-1a
+static uint64_t las_catalog_hash(uint64_t hash, const uint8_t *bytes, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= UINT64_C(0x100000001b3);
+    }
+    return hash;
+}
+
+/// Hashes the record id and payload of the CRS VLRs of the header, 0 if it has none
+static uint64_t las_catalog_crs_hash(const las_header_t *header)
+{
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    bool has_crs = false;
+
+    for (uint32_t i = 0; i < header->number_of_vlrs; ++i)
+    {
+        const las_vlr_t *vlr = &header->vlrs[i];
+        if (strncmp(vlr->user_id, LAS_CATALOG_CRS_USER_ID, LAS_VLR_USER_ID_SIZE) != 0)
+        {
+            continue;
+        }
+        has_crs = true;
+        hash = las_catalog_hash(hash, (const uint8_t *)&vlr->record_id, sizeof(uint16_t));
+        hash = las_catalog_hash(hash, (const uint8_t *)&vlr->data_size, sizeof(uint16_t));
+        if (vlr->data != NULL)
+        {
+            hash = las_catalog_hash(hash, vlr->data, vlr->data_size);
+        }
+    }
+
+    if (!has_crs)
+    {
+        return 0;
+    }
+    // 0 means no CRS
+    return (hash == 0) ? 1 : hash;
+}
+
+/// Reads the header of the file at `path` and fills the entry (except its path)
+static void las_catalog_entry_read(const char *path, las_catalog_entry_t *entry)
+{
+    las_source_t source;
+    if (las_source_new_file(path, &source) != 0)
+    {
+        las_source_deinit(&source);
+        entry->status = LAS_ERROR_ERRNO;
+        return;
+    }
+
+    las_header_t header;
+    memset(&header, 0, sizeof(las_header_t));
+    bool is_compressed = false;
+
+    las_error_t las_err = las_header_read_from(&source, &header, &is_compressed);
+    if (las_error_is_ok(&las_err) && (header.version.major != 1 || header.version.minor > 4))
+    {
+        las_err.kind = LAS_ERROR_INVALID_VERSION;
+    }
+
+    entry->status = las_err.kind;
+    if (las_error_is_ok(&las_err))
+    {
+        entry->version = header.version;
+        entry->point_format = header.point_format;
+        entry->is_compressed = is_compressed;
+        entry->point_count = header.point_count;
+        entry->mins = header.mins;
+        entry->maxs = header.maxs;
+        entry->crs_hash = las_catalog_crs_hash(&header);
+    }
+
+    las_header_deinit(&header);
+    las_source_close(&source);
+    las_source_deinit(&source);
+}
+
+static void las_catalog_job_run(void *arg)
+{
+    las_catalog_job_t *job = arg;
+
+    for (;;)
+    {
+        const uint64_t start = las_atomic_u64_fetch_add(&job->next_index, LAS_CATALOG_BATCH_SIZE);
+        if (start >= job->num_paths)
+        {
+            return;
+        }
+        const uint64_t end = (job->num_paths - start < LAS_CATALOG_BATCH_SIZE)
+                                 ? job->num_paths
+                                 : start + LAS_CATALOG_BATCH_SIZE;
+        for (uint64_t i = start; i < end; ++i)
+        {
+            las_catalog_entry_read(job->paths[i], &job->entries[i]);
+        }
+    }
+}
+
+/// Allocates a catalog of `num_entries` zeroed entries and `paths_size` bytes of paths
+static las_catalog_t *las_catalog_new(const uint64_t num_entries, const uint64_t paths_size)
+{
+    las_catalog_t *self = calloc(1, sizeof(las_catalog_t));
+    if (self == NULL)
+    {
+        return NULL;
+    }
+    self->num_entries = num_entries;
+    self->paths_size = paths_size;
+    self->entries = calloc(num_entries + 1, sizeof(las_catalog_entry_t));
+    self->bboxes = malloc((num_entries + 1) * sizeof(las_catalog_bbox_t));
+    self->paths = malloc(paths_size + 1);
+    if (self->entries == NULL || self->bboxes == NULL || self->paths == NULL)
+    {
+        las_catalog_delete(self);
+        return NULL;
+    }
+    return self;
+}
+
+/// Points the entries to their path in the paths and fills the bboxes
+static void las_catalog_finish(las_catalog_t *self)
+{
+    const char *path = self->paths;
+    for (uint64_t i = 0; i < self->num_entries; ++i)
+    {
+        las_catalog_entry_t *entry = &self->entries[i];
+        entry->path = path;
+        path += strlen(path) + 1;
+
+        las_catalog_bbox_t *bbox = &self->bboxes[i];
+        if (entry->status == LAS_ERROR_OK)
+        {
+            bbox->min_x = entry->mins.x;
+            bbox->min_y = entry->mins.y;
+            bbox->max_x = entry->maxs.x;
+            bbox->max_y = entry->maxs.y;
+        }
+        else
+        {
+            bbox->min_x = bbox->min_y = INFINITY;
+            bbox->max_x = bbox->max_y = -INFINITY;
+        }
+    }
+}
+
+las_error_t las_catalog_build(const char *const *paths,
+                              const uint64_t num_paths,
+                              const uint32_t num_threads,
+                              las_catalog_t **out_catalog)
+{
+    LAS_DEBUG_ASSERT(paths != NULL || num_paths == 0);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_catalog);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    *out_catalog = NULL;
+
+    uint64_t paths_size = 0;
+    for (uint64_t i = 0; i < num_paths; ++i)
+    {
+        paths_size += strlen(paths[i]) + 1;
+    }
+
+    las_catalog_t *self = las_catalog_new(num_paths, paths_size);
+    if (self == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    char *path = self->paths;
+    for (uint64_t i = 0; i < num_paths; ++i)
+    {
+        const size_t size = strlen(paths[i]) + 1;
+        memcpy(path, paths[i], size);
+        path += size;
+    }
+
+    las_catalog_job_t job;
+    job.paths = paths;
+    job.entries = self->entries;
+    job.num_paths = num_paths;
+    las_atomic_u64_init(&job.next_index, 0);
+
+    // The calling thread works too, the pool provides the other workers
+    const uint32_t requested = (num_threads == 0) ? las_thread_pool_available_parallelism()
+                                                  : num_threads;
+    const uint64_t num_batches = (num_paths + LAS_CATALOG_BATCH_SIZE - 1) / LAS_CATALOG_BATCH_SIZE;
+    uint32_t num_workers = (requested < num_batches) ? requested : (uint32_t)num_batches;
+    num_workers = (num_workers == 0) ? 1 : num_workers;
+
+    las_thread_pool_t *pool = NULL;
+    las_task_t *tasks = NULL;
+    if (num_workers > 1)
+    {
+        pool = las_thread_pool_new(num_workers - 1);
+        tasks = calloc(num_workers - 1, sizeof(las_task_t));
+        if (pool == NULL || tasks == NULL)
+        {
+            las_thread_pool_delete(pool);
+            free(tasks);
+            las_catalog_delete(self);
+            las_err.kind = LAS_ERROR_MEMORY;
+            return las_err;
+        }
+
+        for (uint32_t i = 0; i + 1 < num_workers; ++i)
+        {
+            tasks[i].fn = las_catalog_job_run;
+            tasks[i].arg = &job;
+            las_thread_pool_submit(pool, &tasks[i]);
+        }
+    }
+
+    las_catalog_job_run(&job);
+
+    for (uint32_t i = 0; i + 1 < num_workers; ++i)
+    {
+        las_thread_pool_wait(pool, &tasks[i]);
+    }
+    las_thread_pool_delete(pool);
+    free(tasks);
+
+    las_catalog_finish(self);
+    *out_catalog = self;
+    return las_err;
+}
+
+las_error_t las_catalog_write_file_path(const las_catalog_t *self, const char *file_path)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(file_path);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    las_dest_t dest = {0};
+
+    const uint64_t size =
+        LAS_CATALOG_PREAMBLE_SIZE + self->num_entries * LAS_CATALOG_ENTRY_SIZE + self->paths_size;
+    uint8_t *buffer = malloc(size);
+    if (buffer == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    buffer_writer_t wtr = {buffer};
+    const uint32_t format_version = LAS_CATALOG_FORMAT_VERSION;
+    const uint32_t entry_size = LAS_CATALOG_ENTRY_SIZE;
+    write_into(&wtr, LAS_CATALOG_MAGIC, LAS_CATALOG_MAGIC_SIZE);
+    write_intog(&wtr, &format_version);
+    write_intog(&wtr, &entry_size);
+    write_intog(&wtr, &self->num_entries);
+    write_intog(&wtr, &self->paths_size);
+
+    for (uint64_t i = 0; i < self->num_entries; ++i)
+    {
+        const las_catalog_entry_t *entry = &self->entries[i];
+        const uint8_t status = (uint8_t)entry->status;
+        const uint8_t is_compressed = entry->is_compressed;
+        const uint8_t reserved = 0;
+        write_intog(&wtr, &status);
+        write_intog(&wtr, &entry->version.major);
+        write_intog(&wtr, &entry->version.minor);
+        write_intog(&wtr, &entry->point_format.id);
+        write_intog(&wtr, &entry->point_format.num_extra_bytes);
+        write_intog(&wtr, &is_compressed);
+        write_intog(&wtr, &reserved);
+        write_intog(&wtr, &entry->point_count);
+        write_intog(&wtr, &entry->mins.x);
+        write_intog(&wtr, &entry->mins.y);
+        write_intog(&wtr, &entry->mins.z);
+        write_intog(&wtr, &entry->maxs.x);
+        write_intog(&wtr, &entry->maxs.y);
+        write_intog(&wtr, &entry->maxs.z);
+        write_intog(&wtr, &entry->crs_hash);
+    }
+    write_into(&wtr, self->paths, self->paths_size);
+    LAS_DEBUG_ASSERT((uint64_t)(wtr.ptr - buffer) == size);
+
+    if (las_dest_new_file(file_path, &dest) != 0)
+    {
+        las_err = las_catalog_errno_error();
+        goto out;
+    }
+
+    if (las_dest_write(&dest, buffer, size) != size)
+    {
+        las_err = las_dest_err(&dest);
+        goto out;
+    }
+
+    const int close_failed = las_dest_close(&dest);
+    las_dest_deinit(&dest);
+    if (close_failed)
+    {
+        las_err = las_catalog_errno_error();
+    }
+
+out:
+    if (dest.inner != NULL)
+    {
+        las_dest_close(&dest);
+        las_dest_deinit(&dest);
+    }
+    free(buffer);
+    return las_err;
+}
+
+/// Checks that the paths are exactly `num_entries` NUL terminated strings
+static bool las_catalog_paths_are_valid(const char *paths,
+                                        const uint64_t paths_size,
+                                        const uint64_t num_entries)
+{
+    if (paths_size == 0)
+    {
+        return num_entries == 0;
+    }
+    if (paths[paths_size - 1] != '\0')
+    {
+        return false;
+    }
+    uint64_t num_terminators = 0;
+    for (uint64_t i = 0; i < paths_size; ++i)
+    {
+        num_terminators += (paths[i] == '\0');
+    }
+    return num_terminators == num_entries;
+}
+
+las_error_t las_catalog_read_file_path(const char *file_path, las_catalog_t **out_catalog)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(file_path);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_catalog);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    las_catalog_t *self = NULL;
+    uint8_t *entries_bytes = NULL;
+    *out_catalog = NULL;
+
+    las_source_t source;
+    if (las_source_new_file(file_path, &source) != 0)
+    {
+        las_err = las_catalog_errno_error();
+        las_source_deinit(&source);
+        return las_err;
+    }
+
+    uint8_t preamble[LAS_CATALOG_PREAMBLE_SIZE];
+    if (las_source_read(&source, LAS_CATALOG_PREAMBLE_SIZE, preamble) != LAS_CATALOG_PREAMBLE_SIZE)
+    {
+        las_err.kind = LAS_ERROR_INVALID_CATALOG;
+        goto out;
+    }
+
+    buffer_reader_t rdr = {preamble};
+    char magic[LAS_CATALOG_MAGIC_SIZE];
+    uint32_t format_version, entry_size;
+    uint64_t num_entries, paths_size;
+    read_into(&rdr, magic, LAS_CATALOG_MAGIC_SIZE);
+    read_intog(&rdr, &format_version);
+    read_intog(&rdr, &entry_size);
+    read_intog(&rdr, &num_entries);
+    read_intog(&rdr, &paths_size);
+
+    if (memcmp(magic, LAS_CATALOG_MAGIC, LAS_CATALOG_MAGIC_SIZE) != 0 ||
+        format_version != LAS_CATALOG_FORMAT_VERSION || entry_size != LAS_CATALOG_ENTRY_SIZE ||
+        num_entries > UINT64_MAX / LAS_CATALOG_ENTRY_SIZE / 2 || paths_size > UINT64_MAX / 2)
+    {
+        las_err.kind = LAS_ERROR_INVALID_CATALOG;
+        goto out;
+    }
+
+    const uint64_t entries_size = num_entries * LAS_CATALOG_ENTRY_SIZE;
+    entries_bytes = malloc(entries_size + 1);
+    self = las_catalog_new(num_entries, paths_size);
+    if (entries_bytes == NULL || self == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    if (las_source_read(&source, entries_size, entries_bytes) != entries_size ||
+        las_source_read(&source, paths_size, (uint8_t *)self->paths) != paths_size ||
+        !las_catalog_paths_are_valid(self->paths, paths_size, num_entries))
+    {
+        las_err.kind = LAS_ERROR_INVALID_CATALOG;
+        goto out;
+    }
+
+    rdr.ptr = entries_bytes;
+    for (uint64_t i = 0; i < num_entries; ++i)
+    {
+        las_catalog_entry_t *entry = &self->entries[i];
+        uint8_t status, is_compressed, reserved;
+        read_intog(&rdr, &status);
+        read_intog(&rdr, &entry->version.major);
+        read_intog(&rdr, &entry->version.minor);
+        read_intog(&rdr, &entry->point_format.id);
+        read_intog(&rdr, &entry->point_format.num_extra_bytes);
+        read_intog(&rdr, &is_compressed);
+        read_intog(&rdr, &reserved);
+        read_intog(&rdr, &entry->point_count);
+        read_intog(&rdr, &entry->mins.x);
+        read_intog(&rdr, &entry->mins.y);
+        read_intog(&rdr, &entry->mins.z);
+        read_intog(&rdr, &entry->maxs.x);
+        read_intog(&rdr, &entry->maxs.y);
+        read_intog(&rdr, &entry->maxs.z);
+        read_intog(&rdr, &entry->crs_hash);
+        entry->status = (las_error_kind_t)status;
+        entry->is_compressed = is_compressed != 0;
+    }
+
+    las_catalog_finish(self);
+    *out_catalog = self;
+    self = NULL;
+
+out:
+    las_catalog_delete(self);
+    free(entries_bytes);
+    las_source_close(&source);
+    las_source_deinit(&source);
+    return las_err;
+}
+
+uint64_t las_catalog_num_entries(const las_catalog_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    return self->num_entries;
+}
+
+const las_catalog_entry_t *las_catalog_entry(const las_catalog_t *self, const uint64_t index)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT(index < self->num_entries);
+    return &self->entries[index];
+}
+
+uint64_t las_catalog_query_bbox(const las_catalog_t *self,
+                                const las_catalog_bbox_t bbox,
+                                uint64_t *out_indices,
+                                const uint64_t max_indices)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT(out_indices != NULL || max_indices == 0);
+
+    uint64_t num_matches = 0;
+    for (uint64_t i = 0; i < self->num_entries; ++i)
+    {
+        const las_catalog_bbox_t *b = &self->bboxes[i];
+        if (b->min_x <= bbox.max_x && b->max_x >= bbox.min_x && b->min_y <= bbox.max_y &&
+            b->max_y >= bbox.min_y)
+        {
+            if (num_matches < max_indices)
+            {
+                out_indices[num_matches] = i;
+            }
+            ++num_matches;
+        }
+    }
+    return num_matches;
+}
+
+void las_catalog_delete(las_catalog_t *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+    free(self->entries);
+    free(self->bboxes);
+    free(self->paths);
+    free(self);
+}
@@ -0,0 +1,438 @@
+// Needed for copy_file_range
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#define _FILE_OFFSET_BITS 64
+
+#include <las/copy.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <stdio.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+#include "private/dest.h"
+#include "private/header.h"
+#include "private/macro.h"
+#include "private/source.h"
+
+/// Size of the buffer used when the kernel cannot do the copy for us
+#define LAS_COPY_BUFFER_SIZE (8 * 1024 * 1024)
+
+/// Maximum number of bytes given to one copy syscall
+#define LAS_COPY_MAX_SYSCALL_SIZE ((uint64_t)1 << 30)
+
+static inline uint64_t las_copy_min(const uint64_t a, const uint64_t b)
+{
+    return (a < b) ? a : b;
+}
+
+static inline las_error_t las_errno_error(void)
+{
+    las_error_t las_err;
+    las_err.kind = LAS_ERROR_ERRNO;
+    las_err.errno_ = errno;
+    return las_err;
+}
+
+#if defined(_WIN32)
+
+/// Copies `size` bytes from `input_path` at `input_offset`
+/// to `output_path` at `output_offset`.
+///
+/// The output file must already exist.
+static las_error_t las_copy_region(const char *input_path,
+                                   const char *output_path,
+                                   const uint64_t input_offset,
+                                   const uint64_t output_offset,
+                                   const uint64_t size)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+    FILE *input = NULL;
+    FILE *output = NULL;
+    uint8_t *buffer = NULL;
+
+    input = fopen(input_path, "rb");
+    output = fopen(output_path, "r+b");
+    buffer = malloc(sizeof(uint8_t) * LAS_COPY_BUFFER_SIZE);
+    if (input == NULL || output == NULL)
+    {
+        las_err = las_errno_error();
+        goto out;
+    }
+    if (buffer == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    if (_fseeki64(input, (int64_t)input_offset, SEEK_SET) != 0 ||
+        _fseeki64(output, (int64_t)output_offset, SEEK_SET) != 0)
+    {
+        las_err = las_errno_error();
+        goto out;
+    }
+
+    uint64_t bytes_left = size;
+    while (bytes_left > 0)
+    {
+        const size_t to_read = (size_t)las_copy_min(bytes_left, LAS_COPY_BUFFER_SIZE);
+        const size_t n = fread(buffer, sizeof(uint8_t), to_read, input);
+        if (n == 0)
+        {
+            las_err.kind = ferror(input) ? LAS_ERROR_ERRNO : LAS_ERROR_UNEXPECTED_EOF;
+            las_err.errno_ = errno;
+            goto out;
+        }
+        if (fwrite(buffer, sizeof(uint8_t), n, output) != n)
+        {
+            las_err = las_errno_error();
+            goto out;
+        }
+        bytes_left -= n;
+    }
+
+out:
+    free(buffer);
+    if (input != NULL)
+    {
+        fclose(input);
+    }
+    if (output != NULL && fclose(output) != 0 && las_error_is_ok(&las_err))
+    {
+        las_err = las_errno_error();
+    }
+    return las_err;
+}
+
+#else
+
+/// Copies `size` bytes from `input_path` at `input_offset`
+/// to `output_path` at `output_offset`.
+///
+/// The output file must already exist.
+static las_error_t las_copy_region(const char *input_path,
+                                   const char *output_path,
+                                   const uint64_t input_offset,
+                                   const uint64_t output_offset,
+                                   const uint64_t size)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+    int input_fd = -1;
+    int output_fd = -1;
+    uint8_t *buffer = NULL;
+
+    input_fd = open(input_path, O_RDONLY);
+    if (input_fd < 0)
+    {
+        las_err = las_errno_error();
+        goto out;
+    }
+
+    output_fd = open(output_path, O_WRONLY);
+    if (output_fd < 0)
+    {
+        las_err = las_errno_error();
+        goto out;
+    }
+
+    off_t input_pos = (off_t)input_offset;
+    off_t output_pos = (off_t)output_offset;
+    uint64_t bytes_left = size;
+
+#if defined(__linux__)
+    // The kernel moves the bytes itself, they never go through user space
+    // (and some filesystems can even share the blocks instead of copying them).
+    while (bytes_left > 0)
+    {
+        const size_t to_copy = (size_t)las_copy_min(bytes_left, LAS_COPY_MAX_SYSCALL_SIZE);
+        const ssize_t n =
+            copy_file_range(input_fd, &input_pos, output_fd, &output_pos, to_copy, 0);
+        if (n <= 0)
+        {
+            // Not supported (e.g. across filesystems on older kernels),
+            // or end of input, which is reported by the fallbacks
+            break;
+        }
+        bytes_left -= (uint64_t)n;
+    }
+
+    if (bytes_left > 0 && lseek(output_fd, output_pos, SEEK_SET) == output_pos)
+    {
+        while (bytes_left > 0)
+        {
+            const size_t to_copy = (size_t)las_copy_min(bytes_left, LAS_COPY_MAX_SYSCALL_SIZE);
+            const ssize_t n = sendfile(output_fd, input_fd, &input_pos, to_copy);
+            if (n <= 0)
+            {
+                break;
+            }
+            output_pos += n;
+            bytes_left -= (uint64_t)n;
+        }
+    }
+#endif
+
+    if (bytes_left == 0)
+    {
+        goto out;
+    }
+
+    buffer = malloc(sizeof(uint8_t) * LAS_COPY_BUFFER_SIZE);
+    if (buffer == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    while (bytes_left > 0)
+    {
+        const size_t to_read = (size_t)las_copy_min(bytes_left, LAS_COPY_BUFFER_SIZE);
+        const ssize_t n = pread(input_fd, buffer, to_read, input_pos);
+        if (n < 0)
+        {
+            las_err = las_errno_error();
+            goto out;
+        }
+        if (n == 0)
+        {
+            las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+            goto out;
+        }
+
+        ssize_t written = 0;
+        while (written < n)
+        {
+            const ssize_t w =
+                pwrite(output_fd, buffer + written, (size_t)(n - written), output_pos + written);
+            if (w < 0)
+            {
+                las_err = las_errno_error();
+                goto out;
+            }
+            written += w;
+        }
+
+        input_pos += n;
+        output_pos += n;
+        bytes_left -= (uint64_t)n;
+    }
+
+out:
+    free(buffer);
+    if (input_fd >= 0)
+    {
+        close(input_fd);
+    }
+    if (output_fd >= 0 && close(output_fd) != 0 && las_error_is_ok(&las_err))
+    {
+        las_err = las_errno_error();
+    }
+    return las_err;
+}
+
+#endif
+
+/// Shifts the `position` if it points somewhere after the start of the point data
+static inline uint64_t
+las_copy_shift_position(const uint64_t position, const uint64_t old_start, const uint64_t new_start)
+{
+    if (position == 0 || position < old_start)
+    {
+        return position;
+    }
+    return position - old_start + new_start;
+}
+
+las_error_t
+las_copy_file_path(const char *input_path, const char *output_path, const las_header_t *header)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(input_path);
+    LAS_DEBUG_ASSERT_NOT_NULL(output_path);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    las_source_t source = {0};
+    las_dest_t dest = {0};
+    las_header_t input_header;
+    memset(&input_header, 0, sizeof(las_header_t));
+    bool is_compressed = false;
+
+    //
+    // Read the input's header, we need it to know where the data is
+    //
+    if (las_source_new_file(input_path, &source) != 0)
+    {
+        las_err = las_errno_error();
+        las_source_deinit(&source);
+        return las_err;
+    }
+
+    las_err = las_header_read_from(&source, &input_header, &is_compressed);
+    if (las_error_is_ok(&las_err) && input_header.version.minor >= 4)
+    {
+        las_err = las_evlrs_read_from(&source, &input_header);
+    }
+    if (las_error_is_ok(&las_err))
+    {
+        las_err = las_header_validate(&input_header);
+    }
+
+    if (las_error_is_ok(&las_err) && is_compressed)
+    {
+        // The chunk table offset stored in the compressed data is an absolute
+        // position, it would not be correct anymore if the header size changes
+        las_err.kind = LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA;
+    }
+
+    uint64_t file_size = 0;
+    if (las_error_is_ok(&las_err))
+    {
+        if (las_source_seek(&source, 0, LAS_SEEK_FROM_END) != 0)
+        {
+            las_err = las_errno_error();
+        }
+        file_size = las_source_tell(&source);
+    }
+
+    las_source_close(&source);
+    las_source_deinit(&source);
+
+    if (las_error_is_failure(&las_err))
+    {
+        goto out;
+    }
+
+    const uint64_t point_data_size =
+        input_header.point_count * las_point_format_point_size(input_header.point_format);
+    if (file_size < input_header.offset_to_point_data ||
+        file_size - input_header.offset_to_point_data < point_data_size)
+    {
+        las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+        goto out;
+    }
+
+    //
+    // Prepare the output header, the caller can change everything
+    // except what describes the point data, as the data is copied as is.
+    //
+    las_header_t output_header = (header != NULL) ? *header : input_header;
+    if (header != NULL)
+    {
+        if (header->point_format.id != input_header.point_format.id ||
+            header->point_format.num_extra_bytes != input_header.point_format.num_extra_bytes)
+        {
+            las_err.kind = LAS_ERROR_INCOMPATIBLE_POINT_FORMAT;
+            goto out;
+        }
+
+        if (memcmp(&header->scaling, &input_header.scaling, sizeof(las_scaling_t)) != 0)
+        {
+            las_err.kind = LAS_ERROR_INCOMPATIBLE_SCALING;
+            goto out;
+        }
+    }
+
+    output_header.point_count = input_header.point_count;
+    memcpy(output_header.number_of_points_by_return,
+           input_header.number_of_points_by_return,
+           sizeof(uint64_t) * LAS_NUMBER_OF_POINTS_BY_RETURN_SIZE);
+    output_header.mins = input_header.mins;
+    output_header.maxs = input_header.maxs;
+    output_header.number_of_evlrs = 0;
+    output_header.evlrs = NULL;
+
+    las_err = las_header_validate_for_writing(&output_header);
+    if (las_error_is_failure(&las_err))
+    {
+        goto out;
+    }
+
+    if (input_header.number_of_evlrs != 0 && output_header.version.minor < 4)
+    {
+        las_err.kind = LAS_ERROR_INCOMPATIBLE_VERSION_AND_EVLRS;
+        las_err.version = output_header.version;
+        goto out;
+    }
+
+    // EVLRs (and waveform data) are copied with the points,
+    // only their position may change
+    output_header.number_of_evlrs = input_header.number_of_evlrs;
+    output_header.start_of_evlrs = input_header.start_of_evlrs;
+    output_header.start_of_waveform_datapacket = input_header.start_of_waveform_datapacket;
+
+    //
+    // Write the new header
+    //
+    if (las_dest_new_file(output_path, &dest) != 0)
+    {
+        las_err = las_errno_error();
+        goto out;
+    }
+
+    las_err = las_header_write_to(&output_header, &dest);
+    if (las_error_is_failure(&las_err))
+    {
+        goto out;
+    }
+
+    const uint64_t offset_to_point_data = las_dest_tell(&dest);
+    if (offset_to_point_data != input_header.offset_to_point_data)
+    {
+        output_header.start_of_evlrs = las_copy_shift_position(
+            input_header.start_of_evlrs, input_header.offset_to_point_data, offset_to_point_data);
+        output_header.start_of_waveform_datapacket =
+            las_copy_shift_position(input_header.start_of_waveform_datapacket,
+                                    input_header.offset_to_point_data,
+                                    offset_to_point_data);
+
+        if (las_dest_seek(&dest, 0, LAS_SEEK_FROM_START) != 0)
+        {
+            las_err = las_dest_err(&dest);
+            goto out;
+        }
+
+        las_err = las_header_write_to(&output_header, &dest);
+        if (las_error_is_failure(&las_err))
+        {
+            goto out;
+        }
+    }
+
+    const int close_failed = las_dest_close(&dest);
+    las_dest_deinit(&dest);
+    if (close_failed)
+    {
+        las_err = las_errno_error();
+        goto out;
+    }
+
+    //
+    // Copy the points and everything after them
+    //
+    las_err = las_copy_region(input_path,
+                              output_path,
+                              input_header.offset_to_point_data,
+                              offset_to_point_data,
+                              file_size - input_header.offset_to_point_data);
+
+out:
+    if (dest.inner != NULL)
+    {
+        las_dest_close(&dest);
+        las_dest_deinit(&dest);
+    }
+    las_header_deinit(&input_header);
+    return las_err;
+}
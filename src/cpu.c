@@ -0,0 +1,83 @@
+#include "private/cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/// Returns the level requested by the `LAS_C_SIMD` environment variable
+static las_simd_level_t las_cpu_requested_simd_level(void)
+{
+    const char *requested = getenv("LAS_C_SIMD");
+    if (requested == NULL)
+    {
+        return LAS_SIMD_AVX2;
+    }
+
+    if (strcmp(requested, "none") == 0)
+    {
+        return LAS_SIMD_NONE;
+    }
+    if (strcmp(requested, "sse4.1") == 0)
+    {
+        return LAS_SIMD_SSE41;
+    }
+    return LAS_SIMD_AVX2;
+}
+
+static las_simd_level_t las_cpu_detected_simd_level = LAS_SIMD_NONE;
+
+static void las_cpu_detect_simd_level(void)
+{
+    las_simd_level_t supported = LAS_SIMD_NONE;
+
+#if LAS_WITH_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        supported = LAS_SIMD_AVX2;
+    }
+    else if (__builtin_cpu_supports("sse4.1"))
+    {
+        supported = LAS_SIMD_SSE41;
+    }
+#endif
+
+    const las_simd_level_t requested = las_cpu_requested_simd_level();
+    las_cpu_detected_simd_level = (requested < supported) ? requested : supported;
+}
+
+#if defined(_WIN32)
+
+static INIT_ONCE las_cpu_detect_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK las_cpu_detect_simd_level_once(PINIT_ONCE once, PVOID param, PVOID *context)
+{
+    (void)once;
+    (void)param;
+    (void)context;
+    las_cpu_detect_simd_level();
+    return TRUE;
+}
+
+las_simd_level_t las_cpu_simd_level(void)
+{
+    InitOnceExecuteOnce(&las_cpu_detect_once, las_cpu_detect_simd_level_once, NULL, NULL);
+    return las_cpu_detected_simd_level;
+}
+
+#else
+
+static pthread_once_t las_cpu_detect_once = PTHREAD_ONCE_INIT;
+
+las_simd_level_t las_cpu_simd_level(void)
+{
+    pthread_once(&las_cpu_detect_once, las_cpu_detect_simd_level);
+    return las_cpu_detected_simd_level;
+}
+
+#endif
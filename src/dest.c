@@ -3,6 +3,7 @@
 
 #include <errno.h>
 #include <limits.h>
+#include <string.h>
 
 struct las_file_dest_t
 {
@@ -74,6 +75,117 @@ las_error_t las_file_dest_err_fn(las_file_dest_t *self)
 
 //=============================================================================
 
+uint64_t las_memory_dest_write(las_memory_dest_t *self, const uint8_t *buffer, const uint64_t n)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(buffer);
+
+    const uint64_t end = self->pos + n;
+    if (end > self->capacity)
+    {
+        uint64_t new_capacity = (self->capacity == 0) ? 4096 : self->capacity;
+        while (new_capacity < end)
+        {
+            new_capacity *= 2;
+        }
+
+        uint8_t *data = realloc(self->data, sizeof(uint8_t) * new_capacity);
+        if (data == NULL)
+        {
+            self->has_failed = 1;
+            return 0;
+        }
+        self->data = data;
+        self->capacity = new_capacity;
+    }
+
+    if (self->pos > self->size)
+    {
+        // We seeked past the end, the gap is zeroed like files do
+        memset(self->data + self->size, 0, self->pos - self->size);
+    }
+
+    memcpy(self->data + self->pos, buffer, n);
+    self->pos = end;
+    if (end > self->size)
+    {
+        self->size = end;
+    }
+
+    return n;
+}
+
+int las_memory_dest_seek(las_memory_dest_t *self, const int64_t pos, const las_seek_from_t from)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    int64_t base = 0;
+    switch (from)
+    {
+    case LAS_SEEK_FROM_START:
+        base = 0;
+        break;
+    case LAS_SEEK_FROM_CURRENT:
+        base = (int64_t)self->pos;
+        break;
+    case LAS_SEEK_FROM_END:
+        base = (int64_t)self->size;
+        break;
+    default:
+        LAS_DEBUG_ASSERT_M(0, "invalid seek from value");
+        return 1;
+    }
+
+    if (base + pos < 0)
+    {
+        return 1;
+    }
+
+    self->pos = (uint64_t)(base + pos);
+    return 0;
+}
+
+uint64_t las_memory_dest_tell(las_memory_dest_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    return self->pos;
+}
+
+int las_memory_dest_flush(las_memory_dest_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    return 0;
+}
+
+int las_memory_dest_close(las_memory_dest_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    free(self->data);
+    self->data = NULL;
+    self->size = 0;
+    self->capacity = 0;
+    self->pos = 0;
+    return 0;
+}
+
+las_error_t las_memory_dest_err_fn(las_memory_dest_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    if (self->has_failed)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+    }
+
+    return las_err;
+}
+
+//=============================================================================
+
 uint64_t las_dest_write(las_dest_t *self, const uint8_t *buffer, const uint64_t n)
 {
     LAS_DEBUG_ASSERT(self != NULL);
@@ -137,7 +249,8 @@ void las_dest_deinit(las_dest_t *self)
     self->inner = NULL;
 }
 
-int las_dest_new_file(const char *filename, las_dest_t *dest)
+/// Creates a file dest, `mode` is the fopen mode
+static int las_dest_new_file_with_mode(const char *filename, const char *mode, las_dest_t *dest)
 {
     LAS_DEBUG_ASSERT(filename != NULL);
     LAS_DEBUG_ASSERT(dest != NULL);
@@ -148,7 +261,7 @@ int las_dest_new_file(const char *filename, las_dest_t *dest)
         return 1;
     }
 
-    FILE *file = fopen(filename, "wb");
+    FILE *file = fopen(filename, mode);
     if (file == NULL)
     {
         free(inner);
@@ -167,3 +280,35 @@ int las_dest_new_file(const char *filename, las_dest_t *dest)
 
     return 0;
 }
+
+int las_dest_new_file(const char *filename, las_dest_t *dest)
+{
+    return las_dest_new_file_with_mode(filename, "wb", dest);
+}
+
+int las_dest_open_file(const char *filename, las_dest_t *dest)
+{
+    return las_dest_new_file_with_mode(filename, "r+b", dest);
+}
+
+int las_dest_new_memory(las_dest_t *dest)
+{
+    LAS_DEBUG_ASSERT(dest != NULL);
+
+    las_memory_dest_t *inner = calloc(1, sizeof(las_memory_dest_t));
+    if (inner == NULL)
+    {
+        return 1;
+    }
+
+    dest->inner = (void *)inner;
+    // The casts are to cast the first param of the fn a void*
+    dest->write_fn = (las_dest_write_fn)las_memory_dest_write;
+    dest->seek_fn = (las_dest_seek_fn)las_memory_dest_seek;
+    dest->tell_fn = (las_dest_tell_fn)las_memory_dest_tell;
+    dest->close_fn = (las_dest_close_fn)las_memory_dest_close;
+    dest->flush_fn = (las_dest_flush_fn)las_memory_dest_flush;
+    dest->err_fn = (las_dest_err_fn)las_memory_dest_err_fn;
+
+    return 0;
+}
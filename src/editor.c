@@ -0,0 +1,442 @@
+#define _FILE_OFFSET_BITS 64
+
+#include <las/editor.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <stdio.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "private/header.h"
+#include "private/macro.h"
+#include "private/source.h"
+
+/// Where a field is in a point record
+typedef struct las_field_location
+{
+    /// Offset of the field's first byte in the record
+    uint16_t offset;
+    /// Number of bytes to read-modify-write, 1 or 2
+    uint8_t size;
+    /// Bits of the (little-endian) bytes that belong to the field
+    uint16_t mask;
+    /// Position of the field's lowest bit in the bytes
+    uint8_t shift;
+} las_field_location_t;
+
+struct las_editor
+{
+    las_header_t header;
+    uint16_t point_size;
+#if defined(_WIN32)
+    FILE *file;
+#else
+    int fd;
+    /// Start of the mapping, it is page aligned so it may
+    /// begin a bit before the point data.
+    uint8_t *mapping;
+    size_t mapping_size;
+    /// First byte of the first point record, within the mapping
+    uint8_t *points;
+#endif
+};
+
+static inline las_error_t las_errno_error(void)
+{
+    las_error_t las_err;
+    las_err.kind = LAS_ERROR_ERRNO;
+    las_err.errno_ = errno;
+    return las_err;
+}
+
+/// Finds where `field` is stored for the given point format,
+/// and checks that `value` fits in it.
+static las_error_t las_field_location_get(const uint8_t point_format_id,
+                                          const las_point_field_t field,
+                                          const uint16_t value,
+                                          las_field_location_t *location)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+    const bool is_legacy = point_format_id <= 5;
+
+    // Legacy formats pack the flags with the classification,
+    // newer ones have a byte for the flags and one for the classification.
+    switch (field)
+    {
+    case LAS_POINT_FIELD_CLASSIFICATION:
+        *location = is_legacy ? (las_field_location_t){15, 1, 0x1F, 0}
+                              : (las_field_location_t){16, 1, 0xFF, 0};
+        break;
+    case LAS_POINT_FIELD_USER_DATA:
+        *location = (las_field_location_t){17, 1, 0xFF, 0};
+        break;
+    case LAS_POINT_FIELD_POINT_SOURCE_ID:
+        *location = is_legacy ? (las_field_location_t){18, 2, 0xFFFF, 0}
+                              : (las_field_location_t){20, 2, 0xFFFF, 0};
+        break;
+    case LAS_POINT_FIELD_SYNTHETIC:
+        *location = is_legacy ? (las_field_location_t){15, 1, 0x20, 5}
+                              : (las_field_location_t){15, 1, 0x01, 0};
+        break;
+    case LAS_POINT_FIELD_KEY_POINT:
+        *location = is_legacy ? (las_field_location_t){15, 1, 0x40, 6}
+                              : (las_field_location_t){15, 1, 0x02, 1};
+        break;
+    case LAS_POINT_FIELD_WITHHELD:
+        *location = is_legacy ? (las_field_location_t){15, 1, 0x80, 7}
+                              : (las_field_location_t){15, 1, 0x04, 2};
+        break;
+    case LAS_POINT_FIELD_OVERLAP:
+        if (is_legacy)
+        {
+            las_err.kind = LAS_ERROR_INCOMPATIBLE_POINT_FORMAT;
+            return las_err;
+        }
+        *location = (las_field_location_t){15, 1, 0x08, 3};
+        break;
+    default:
+        las_err.kind = LAS_ERROR_INVALID_FIELD_VALUE;
+        return las_err;
+    }
+
+    if ((value & (location->mask >> location->shift)) != value)
+    {
+        las_err.kind = LAS_ERROR_INVALID_FIELD_VALUE;
+    }
+    return las_err;
+}
+
+/// Changes the field in the `bytes` of a record, leaving the other bits untouched
+static inline void las_field_location_apply(const las_field_location_t *location,
+                                            uint8_t *bytes,
+                                            const uint16_t value)
+{
+    const uint16_t shifted = (uint16_t)(value << location->shift);
+    if (location->size == 1)
+    {
+        bytes[0] = (uint8_t)((bytes[0] & ~location->mask) | (shifted & location->mask));
+    }
+    else
+    {
+        // The only 2-byte field is the point source id, which takes the whole bytes
+        bytes[0] = (uint8_t)(shifted & 0xFF);
+        bytes[1] = (uint8_t)(shifted >> 8);
+    }
+}
+
+#if defined(_WIN32)
+
+static las_error_t las_editor_open_points(las_editor_t *self, const char *file_path)
+{
+    self->file = fopen(file_path, "r+b");
+    if (self->file == NULL)
+    {
+        return las_errno_error();
+    }
+    las_error_t las_err = {LAS_ERROR_OK};
+    return las_err;
+}
+
+static void las_editor_close_points(las_editor_t *self)
+{
+    if (self->file != NULL)
+    {
+        fclose(self->file);
+        self->file = NULL;
+    }
+}
+
+/// Read-modify-write of the field bytes of the point at `index`
+static las_error_t las_editor_update_point(las_editor_t *self,
+                                           const las_field_location_t *location,
+                                           const uint64_t index,
+                                           const uint16_t value)
+{
+    const int64_t position = (int64_t)(self->header.offset_to_point_data +
+                                       index * self->point_size + location->offset);
+    uint8_t bytes[2];
+
+    if (_fseeki64(self->file, position, SEEK_SET) != 0)
+    {
+        return las_errno_error();
+    }
+    if (fread(bytes, sizeof(uint8_t), location->size, self->file) != location->size)
+    {
+        las_error_t las_err = {LAS_ERROR_UNEXPECTED_EOF};
+        return las_err;
+    }
+
+    las_field_location_apply(location, bytes, value);
+
+    // A seek is required when switching from reading to writing
+    if (_fseeki64(self->file, position, SEEK_SET) != 0 ||
+        fwrite(bytes, sizeof(uint8_t), location->size, self->file) != location->size)
+    {
+        return las_errno_error();
+    }
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    return las_err;
+}
+
+las_error_t las_editor_flush(las_editor_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    if (fflush(self->file) != 0)
+    {
+        return las_errno_error();
+    }
+    las_error_t las_err = {LAS_ERROR_OK};
+    return las_err;
+}
+
+#else
+
+static las_error_t las_editor_open_points(las_editor_t *self, const char *file_path)
+{
+    self->fd = open(file_path, O_RDWR);
+    if (self->fd < 0)
+    {
+        return las_errno_error();
+    }
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    const uint64_t point_data_size = self->header.point_count * self->point_size;
+    if (point_data_size == 0)
+    {
+        // mmap does not accept empty mappings, there is nothing to edit anyway
+        return las_err;
+    }
+
+    const uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+    const uint64_t map_offset = self->header.offset_to_point_data & ~(page_size - 1);
+    const uint64_t map_size = self->header.offset_to_point_data - map_offset + point_data_size;
+    if (map_size > SIZE_MAX)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    void *mapping = mmap(
+        NULL, (size_t)map_size, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd, (off_t)map_offset);
+    if (mapping == MAP_FAILED)
+    {
+        return las_errno_error();
+    }
+
+    self->mapping = mapping;
+    self->mapping_size = (size_t)map_size;
+    self->points = self->mapping + (self->header.offset_to_point_data - map_offset);
+    return las_err;
+}
+
+static void las_editor_close_points(las_editor_t *self)
+{
+    if (self->mapping != NULL)
+    {
+        munmap(self->mapping, self->mapping_size);
+        self->mapping = NULL;
+        self->points = NULL;
+    }
+    if (self->fd >= 0)
+    {
+        close(self->fd);
+        self->fd = -1;
+    }
+}
+
+static inline las_error_t las_editor_update_point(las_editor_t *self,
+                                                  const las_field_location_t *location,
+                                                  const uint64_t index,
+                                                  const uint16_t value)
+{
+    las_field_location_apply(
+        location, self->points + index * self->point_size + location->offset, value);
+    las_error_t las_err = {LAS_ERROR_OK};
+    return las_err;
+}
+
+las_error_t las_editor_flush(las_editor_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    if (self->mapping != NULL && msync(self->mapping, self->mapping_size, MS_SYNC) != 0)
+    {
+        return las_errno_error();
+    }
+    las_error_t las_err = {LAS_ERROR_OK};
+    return las_err;
+}
+
+#endif
+
+las_error_t las_editor_open_file_path(const char *file_path, las_editor_t **out_editor)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(file_path);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_editor);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    las_source_t source = {0};
+    bool is_compressed = false;
+
+    las_editor_t *editor = calloc(1, sizeof(las_editor_t));
+    if (editor == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+#if !defined(_WIN32)
+    editor->fd = -1;
+#endif
+
+    if (las_source_new_file(file_path, &source) != 0)
+    {
+        las_err = las_errno_error();
+        las_source_deinit(&source);
+        free(editor);
+        return las_err;
+    }
+
+    las_err = las_header_read_from(&source, &editor->header, &is_compressed);
+    if (las_error_is_ok(&las_err))
+    {
+        las_err = las_header_validate(&editor->header);
+    }
+
+    if (las_error_is_ok(&las_err) && is_compressed)
+    {
+        las_err.kind = LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA;
+    }
+
+    uint64_t file_size = 0;
+    if (las_error_is_ok(&las_err))
+    {
+        if (las_source_seek(&source, 0, LAS_SEEK_FROM_END) != 0)
+        {
+            las_err = las_errno_error();
+        }
+        file_size = las_source_tell(&source);
+    }
+
+    las_source_close(&source);
+    las_source_deinit(&source);
+
+    if (las_error_is_failure(&las_err))
+    {
+        goto fail;
+    }
+
+    editor->point_size = las_point_format_point_size(editor->header.point_format);
+    const uint64_t point_data_size = editor->header.point_count * editor->point_size;
+    if (file_size < editor->header.offset_to_point_data ||
+        file_size - editor->header.offset_to_point_data < point_data_size)
+    {
+        las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+        goto fail;
+    }
+
+    las_err = las_editor_open_points(editor, file_path);
+    if (las_error_is_failure(&las_err))
+    {
+        goto fail;
+    }
+
+    *out_editor = editor;
+    return las_err;
+
+fail:
+    las_editor_close_points(editor);
+    las_header_deinit(&editor->header);
+    free(editor);
+    return las_err;
+}
+
+const las_header_t *las_editor_header(const las_editor_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    return &self->header;
+}
+
+las_error_t las_editor_set_range(las_editor_t *self,
+                                 const las_point_field_t field,
+                                 const uint64_t first,
+                                 const uint64_t count,
+                                 const uint16_t value)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    las_field_location_t location;
+    las_error_t las_err =
+        las_field_location_get(self->header.point_format.id, field, value, &location);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    const uint64_t point_count = self->header.point_count;
+    if (first > point_count || count > point_count - first)
+    {
+        las_err.kind = LAS_ERROR_POINT_INDEX_OUT_OF_RANGE;
+        las_err.point_index = (first > point_count) ? first : point_count;
+        return las_err;
+    }
+
+    for (uint64_t i = first; i < first + count && las_error_is_ok(&las_err); ++i)
+    {
+        las_err = las_editor_update_point(self, &location, i, value);
+    }
+    return las_err;
+}
+
+las_error_t las_editor_set_selection(las_editor_t *self,
+                                     const las_point_field_t field,
+                                     const uint64_t *indices,
+                                     const uint64_t num_indices,
+                                     const uint16_t value)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT(indices != NULL || num_indices == 0);
+
+    las_field_location_t location;
+    las_error_t las_err =
+        las_field_location_get(self->header.point_format.id, field, value, &location);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    for (uint64_t i = 0; i < num_indices; ++i)
+    {
+        if (indices[i] >= self->header.point_count)
+        {
+            las_err.kind = LAS_ERROR_POINT_INDEX_OUT_OF_RANGE;
+            las_err.point_index = indices[i];
+            return las_err;
+        }
+    }
+
+    for (uint64_t i = 0; i < num_indices && las_error_is_ok(&las_err); ++i)
+    {
+        las_err = las_editor_update_point(self, &location, indices[i], value);
+    }
+    return las_err;
+}
+
+void las_editor_delete(las_editor_t *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+    las_editor_close_points(self);
+    las_header_deinit(&self->header);
+    free(self);
+}
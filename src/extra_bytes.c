@@ -0,0 +1,324 @@
+#include "las/extra_bytes.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "private/macro.h"
+
+/// Bits of the `options` of a dimension
+#define LAS_EXTRA_BYTES_OPTION_NO_DATA (1 << 0)
+#define LAS_EXTRA_BYTES_OPTION_SCALE (1 << 3)
+#define LAS_EXTRA_BYTES_OPTION_OFFSET (1 << 4)
+
+/// Offsets of the members of a dimension descriptor in the VLR
+#define LAS_EXTRA_BYTES_DATA_TYPE_OFFSET 2
+#define LAS_EXTRA_BYTES_OPTIONS_OFFSET 3
+#define LAS_EXTRA_BYTES_NAME_OFFSET 4
+#define LAS_EXTRA_BYTES_NO_DATA_OFFSET 40
+#define LAS_EXTRA_BYTES_SCALE_OFFSET 112
+#define LAS_EXTRA_BYTES_OFFSET_OFFSET 136
+#define LAS_EXTRA_BYTES_DESCRIPTION_OFFSET 160
+
+/// Size of one value of the (non-array) data type
+static uint16_t las_extra_bytes_type_size(const uint8_t data_type)
+{
+    static const uint16_t sizes[11] = {0, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8};
+    LAS_DEBUG_ASSERT(data_type <= LAS_EXTRA_BYTES_F64);
+    return sizes[data_type];
+}
+
+/// Returns the number of bytes of a dimension, 0 if the data type is invalid
+static uint16_t las_extra_bytes_dimension_size(const uint8_t data_type, const uint8_t options)
+{
+    if (data_type == LAS_EXTRA_BYTES_UNDOCUMENTED)
+    {
+        return options;
+    }
+    if (data_type <= LAS_EXTRA_BYTES_F64)
+    {
+        return las_extra_bytes_type_size(data_type);
+    }
+    // Deprecated arrays of 2 (11 to 20) or 3 (21 to 30) values
+    if (data_type <= 20)
+    {
+        return (uint16_t)(2 * las_extra_bytes_type_size((uint8_t)(data_type - 10)));
+    }
+    if (data_type <= 30)
+    {
+        return (uint16_t)(3 * las_extra_bytes_type_size((uint8_t)(data_type - 20)));
+    }
+    return 0;
+}
+
+/// Reads an 'anytype' member of a descriptor (8 bytes, interpreted following the data type)
+static double las_extra_bytes_read_anytype(const uint8_t *bytes, const uint8_t data_type)
+{
+    switch (data_type)
+    {
+    case LAS_EXTRA_BYTES_U8:
+    case LAS_EXTRA_BYTES_U16:
+    case LAS_EXTRA_BYTES_U32:
+    case LAS_EXTRA_BYTES_U64:
+    {
+        uint64_t value;
+        memcpy(&value, bytes, sizeof(uint64_t));
+        return (double)value;
+    }
+    case LAS_EXTRA_BYTES_I8:
+    case LAS_EXTRA_BYTES_I16:
+    case LAS_EXTRA_BYTES_I32:
+    case LAS_EXTRA_BYTES_I64:
+    {
+        int64_t value;
+        memcpy(&value, bytes, sizeof(int64_t));
+        return (double)value;
+    }
+    default:
+    {
+        double value;
+        memcpy(&value, bytes, sizeof(double));
+        return value;
+    }
+    }
+}
+
+static void las_extra_bytes_dimension_from_descriptor(const uint8_t *descriptor,
+                                                      las_extra_bytes_dimension_t *dimension)
+{
+    memset(dimension, 0, sizeof(las_extra_bytes_dimension_t));
+    dimension->data_type = descriptor[LAS_EXTRA_BYTES_DATA_TYPE_OFFSET];
+    dimension->options = descriptor[LAS_EXTRA_BYTES_OPTIONS_OFFSET];
+    dimension->size = las_extra_bytes_dimension_size(dimension->data_type, dimension->options);
+    memcpy(dimension->name, descriptor + LAS_EXTRA_BYTES_NAME_OFFSET, LAS_EXTRA_BYTES_NAME_SIZE);
+    memcpy(dimension->description,
+           descriptor + LAS_EXTRA_BYTES_DESCRIPTION_OFFSET,
+           LAS_EXTRA_BYTES_NAME_SIZE);
+
+    // For undocumented bytes, the options are the size
+    const uint8_t options =
+        dimension->data_type == LAS_EXTRA_BYTES_UNDOCUMENTED ? 0 : dimension->options;
+
+    dimension->scale = 1.0;
+    if (options & LAS_EXTRA_BYTES_OPTION_SCALE)
+    {
+        memcpy(&dimension->scale, descriptor + LAS_EXTRA_BYTES_SCALE_OFFSET, sizeof(double));
+    }
+    dimension->offset = 0.0;
+    if (options & LAS_EXTRA_BYTES_OPTION_OFFSET)
+    {
+        memcpy(&dimension->offset, descriptor + LAS_EXTRA_BYTES_OFFSET_OFFSET, sizeof(double));
+    }
+    dimension->has_no_data = (options & LAS_EXTRA_BYTES_OPTION_NO_DATA) != 0;
+    if (dimension->has_no_data)
+    {
+        dimension->no_data = las_extra_bytes_read_anytype(
+            descriptor + LAS_EXTRA_BYTES_NO_DATA_OFFSET, dimension->data_type);
+    }
+}
+
+las_error_t las_extra_bytes_schema_from_header(const las_header_t *header,
+                                               las_extra_bytes_schema_t *out_schema)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(header);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_schema);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    memset(out_schema, 0, sizeof(las_extra_bytes_schema_t));
+
+    const las_vlr_t *vlr = NULL;
+    for (uint32_t i = 0; i < header->number_of_vlrs; ++i)
+    {
+        const las_vlr_t *current = &header->vlrs[i];
+        if (strncmp(current->user_id, LAS_EXTRA_BYTES_VLR_USER_ID, LAS_VLR_USER_ID_SIZE) == 0 &&
+            current->record_id == LAS_EXTRA_BYTES_VLR_RECORD_ID)
+        {
+            vlr = current;
+            break;
+        }
+    }
+
+    if (vlr == NULL)
+    {
+        return las_err;
+    }
+
+    if (vlr->data_size % LAS_EXTRA_BYTES_DESCRIPTOR_SIZE != 0 ||
+        (vlr->data_size != 0 && vlr->data == NULL))
+    {
+        las_err.kind = LAS_ERROR_INVALID_EXTRA_BYTES_VLR;
+        return las_err;
+    }
+
+    const uint16_t num_dimensions = vlr->data_size / LAS_EXTRA_BYTES_DESCRIPTOR_SIZE;
+    if (num_dimensions == 0)
+    {
+        return las_err;
+    }
+
+    las_extra_bytes_dimension_t *dimensions =
+        malloc(sizeof(las_extra_bytes_dimension_t) * num_dimensions);
+    if (dimensions == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    // Dimensions are stored one after the other, in the order of the descriptors
+    uint32_t byte_offset = 0;
+    for (uint16_t i = 0; i < num_dimensions; ++i)
+    {
+        las_extra_bytes_dimension_t *dimension = &dimensions[i];
+        las_extra_bytes_dimension_from_descriptor(
+            vlr->data + (size_t)i * LAS_EXTRA_BYTES_DESCRIPTOR_SIZE, dimension);
+        dimension->byte_offset = (uint16_t)byte_offset;
+        byte_offset += dimension->size;
+
+        if (dimension->size == 0 || byte_offset > header->point_format.num_extra_bytes)
+        {
+            free(dimensions);
+            las_err.kind = LAS_ERROR_INVALID_EXTRA_BYTES_VLR;
+            return las_err;
+        }
+    }
+
+    out_schema->num_dimensions = num_dimensions;
+    out_schema->dimensions = dimensions;
+    return las_err;
+}
+
+void las_extra_bytes_schema_deinit(las_extra_bytes_schema_t *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+    free(self->dimensions);
+    self->dimensions = NULL;
+    self->num_dimensions = 0;
+}
+
+const las_extra_bytes_dimension_t *las_extra_bytes_schema_find(const las_extra_bytes_schema_t *self,
+                                                               const char *name)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(name);
+
+    for (uint16_t i = 0; i < self->num_dimensions; ++i)
+    {
+        if (strncmp(self->dimensions[i].name, name, LAS_EXTRA_BYTES_NAME_SIZE) == 0)
+        {
+            return &self->dimensions[i];
+        }
+    }
+    return NULL;
+}
+
+/// Converts and scales the values of `type` at the same position in each record
+///
+/// The loop has no branch, so that the compiler can vectorize the conversion and scaling.
+#define LAS_READ_SCALED(type)                                                                      \
+    do                                                                                             \
+    {                                                                                              \
+        for (uint64_t i_ = 0; i_ < num_points; ++i_)                                               \
+        {                                                                                          \
+            type value_;                                                                           \
+            memcpy(&value_, field, sizeof(type));                                                  \
+            const double v_ = (double)value_;                                                      \
+            const double scaled_ = v_ * scale + offset;                                            \
+            values[i_] = (has_no_data && v_ == no_data) ? (double)NAN : scaled_;                   \
+            field += point_size;                                                                   \
+        }                                                                                          \
+    } while (0)
+
+las_error_t las_extra_bytes_read_scaled(const las_extra_bytes_dimension_t *dimension,
+                                        const las_point_format_t point_format,
+                                        const uint8_t *records,
+                                        const uint64_t num_points,
+                                        double *values)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(dimension);
+    LAS_DEBUG_ASSERT(records != NULL || num_points == 0);
+    LAS_DEBUG_ASSERT(values != NULL || num_points == 0);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    if (dimension->data_type == LAS_EXTRA_BYTES_UNDOCUMENTED ||
+        dimension->data_type > LAS_EXTRA_BYTES_F64)
+    {
+        las_err.kind = LAS_ERROR_UNSUPPORTED_EXTRA_BYTES_TYPE;
+        return las_err;
+    }
+
+    const uint16_t point_size = las_point_format_point_size(point_format);
+    const uint8_t *field =
+        records + las_point_standard_size(point_format.id) + dimension->byte_offset;
+    const double scale = dimension->scale;
+    const double offset = dimension->offset;
+    const bool has_no_data = dimension->has_no_data;
+    const double no_data = dimension->no_data;
+
+    switch ((las_extra_bytes_type_t)dimension->data_type)
+    {
+    case LAS_EXTRA_BYTES_U8:
+        LAS_READ_SCALED(uint8_t);
+        break;
+    case LAS_EXTRA_BYTES_I8:
+        LAS_READ_SCALED(int8_t);
+        break;
+    case LAS_EXTRA_BYTES_U16:
+        LAS_READ_SCALED(uint16_t);
+        break;
+    case LAS_EXTRA_BYTES_I16:
+        LAS_READ_SCALED(int16_t);
+        break;
+    case LAS_EXTRA_BYTES_U32:
+        LAS_READ_SCALED(uint32_t);
+        break;
+    case LAS_EXTRA_BYTES_I32:
+        LAS_READ_SCALED(int32_t);
+        break;
+    case LAS_EXTRA_BYTES_U64:
+        LAS_READ_SCALED(uint64_t);
+        break;
+    case LAS_EXTRA_BYTES_I64:
+        LAS_READ_SCALED(int64_t);
+        break;
+    case LAS_EXTRA_BYTES_F32:
+        LAS_READ_SCALED(float);
+        break;
+    case LAS_EXTRA_BYTES_F64:
+        LAS_READ_SCALED(double);
+        break;
+    case LAS_EXTRA_BYTES_UNDOCUMENTED:
+        break;
+    }
+
+    return las_err;
+}
+
+las_error_t las_extra_bytes_read_raw(const las_extra_bytes_dimension_t *dimension,
+                                     const las_point_format_t point_format,
+                                     const uint8_t *records,
+                                     const uint64_t num_points,
+                                     void *values)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(dimension);
+    LAS_DEBUG_ASSERT(records != NULL || num_points == 0);
+    LAS_DEBUG_ASSERT(values != NULL || num_points == 0);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    const uint16_t point_size = las_point_format_point_size(point_format);
+    const uint16_t size = dimension->size;
+    const uint8_t *field =
+        records + las_point_standard_size(point_format.id) + dimension->byte_offset;
+    uint8_t *out = values;
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        memcpy(out, field, size);
+        field += point_size;
+        out += size;
+    }
+
+    return las_err;
+}
@@ -7,8 +7,12 @@
 #include "private/point.h"
 #include "private/source.h"
 #include "private/utils.h"
+#include "private/vlr_arena.h"
 
 #define LAS_VLR_HEADER_SIZE 54
+#define LAS_EVLR_HEADER_SIZE 60
+/// Size of the buffer through which EVLR payloads that are not loaded are copied
+#define LAS_EVLR_COPY_BLOCK_SIZE (1024 * 1024)
 #define LAS_SIGNATURE "LASF"
 
 #define LAS_HEADER_1_0_SIZE 227
@@ -82,16 +86,58 @@ static int las_version_is_compatible_with_point_format(const las_version_t versi
     return 0;
 }
 
-static las_error_t las_vlr_read_into(las_source_t *source, las_vlr_t *vlr)
+static las_error_t las_vlr_write_to(const las_vlr_t *self, las_dest_t *dest)
 {
-    LAS_DEBUG_ASSERT(vlr != NULL);
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(dest);
 
     las_error_t error;
     error.kind = LAS_ERROR_OK;
     uint8_t header_bytes[LAS_VLR_HEADER_SIZE];
 
-    uint64_t n = las_source_read(source, LAS_VLR_HEADER_SIZE, &header_bytes[0]);
-    if (n != LAS_VLR_HEADER_SIZE)
+    buffer_writer_t wrt = {&header_bytes[0]};
+
+    const uint16_t reserved = 0;
+    write_intog(&wrt, &reserved);
+    write_into(&wrt, &self->user_id[0], LAS_VLR_USER_ID_SIZE);
+    write_intog(&wrt, &self->record_id);
+    write_intog(&wrt, &self->data_size);
+    write_into(&wrt, &self->description[0], LAS_VLR_DESCRIPTION_SIZE);
+
+    LAS_DEBUG_ASSERT((wrt.ptr - header_bytes) == LAS_VLR_HEADER_SIZE);
+
+    uint64_t n = las_dest_write(dest, &header_bytes[0], LAS_VLR_HEADER_SIZE);
+    if (self->data_size != 0 && self->data != NULL)
+    {
+        n += las_dest_write(dest, self->data, self->data_size);
+    }
+
+    if (n != self->data_size + LAS_VLR_HEADER_SIZE)
+    {
+        error.kind = LAS_ERROR_UNEXPECTED_EOF;
+    }
+
+    return error;
+}
+
+static uint16_t las_vlr_size(const las_vlr_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    LAS_ASSERT(self->data_size < (UINT16_MAX - LAS_VLR_HEADER_SIZE));
+
+    return self->data_size + LAS_VLR_HEADER_SIZE;
+}
+
+static las_error_t las_evlr_header_read_into(las_source_t *source, las_evlr_t *evlr)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(evlr);
+
+    las_error_t error = {LAS_ERROR_OK};
+    uint8_t header_bytes[LAS_EVLR_HEADER_SIZE];
+
+    const uint64_t n = las_source_read(source, LAS_EVLR_HEADER_SIZE, &header_bytes[0]);
+    if (n != LAS_EVLR_HEADER_SIZE)
     {
         error.kind = LAS_ERROR_UNEXPECTED_EOF;
         return error;
@@ -99,41 +145,176 @@ static las_error_t las_vlr_read_into(las_source_t *source, las_vlr_t *vlr)
 
     // First two bytes are reserved
     buffer_reader_t rdr = {&header_bytes[2]};
-    read_into(&rdr, (uint8_t *)&vlr->user_id, LAS_VLR_USER_ID_SIZE);
-    read_intog(&rdr, &vlr->record_id);
-    read_intog(&rdr, &vlr->data_size);
-    read_into(&rdr, (uint8_t *)&vlr->description, LAS_VLR_DESCRIPTION_SIZE);
+    read_into(&rdr, (uint8_t *)&evlr->user_id, LAS_VLR_USER_ID_SIZE);
+    read_intog(&rdr, &evlr->record_id);
+    read_intog(&rdr, &evlr->data_size);
+    read_into(&rdr, (uint8_t *)&evlr->description, LAS_VLR_DESCRIPTION_SIZE);
+
+    LAS_DEBUG_ASSERT((rdr.ptr - header_bytes) == LAS_EVLR_HEADER_SIZE);
 
-    LAS_DEBUG_ASSERT((rdr.ptr - header_bytes) == LAS_VLR_HEADER_SIZE);
+    evlr->data = NULL;
+    evlr->offset_to_data = las_source_tell(source);
+
+    return error;
+}
 
-    vlr->data = malloc(sizeof(uint8_t) * vlr->data_size);
-    if (vlr->data == NULL)
+las_error_t las_evlrs_read_from(las_source_t *source, las_header_t *header)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(source);
+    LAS_DEBUG_ASSERT_NOT_NULL(header);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    if (header->number_of_evlrs == 0)
     {
-        error.kind = LAS_ERROR_MEMORY;
-        return error;
+        return las_err;
     }
 
-    n = las_source_read(source, vlr->data_size, vlr->data);
+    if (header->start_of_evlrs > (uint64_t)INT64_MAX ||
+        las_source_seek(source, (int64_t)header->start_of_evlrs, LAS_SEEK_FROM_START) != 0)
+    {
+        las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+        return las_err;
+    }
 
-    if (n != vlr->data_size)
+    // Only the fixed size part of each EVLR is read here, the payload
+    // is skipped so that opening a file stays cheap.
+    las_evlr_t *evlrs = calloc(header->number_of_evlrs, sizeof(las_evlr_t));
+    if (evlrs == NULL)
     {
-        error.kind = LAS_ERROR_UNEXPECTED_EOF;
-        vlr->data_size = 0;
-        free(vlr->data);
-        vlr->data = NULL;
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
     }
 
-    return error;
+    for (uint32_t i = 0; i < header->number_of_evlrs; ++i)
+    {
+        las_err = las_evlr_header_read_into(source, &evlrs[i]);
+        if (las_error_is_failure(&las_err))
+        {
+            free(evlrs);
+            return las_err;
+        }
+
+        const uint64_t next_evlr_pos = evlrs[i].offset_to_data + evlrs[i].data_size;
+        if (next_evlr_pos < evlrs[i].offset_to_data || next_evlr_pos > (uint64_t)INT64_MAX ||
+            las_source_seek(source, (int64_t)next_evlr_pos, LAS_SEEK_FROM_START) != 0)
+        {
+            free(evlrs);
+            las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+            return las_err;
+        }
+    }
+
+    header->evlrs = evlrs;
+    return las_err;
 }
 
-static las_error_t las_vlr_write_to(const las_vlr_t *self, las_dest_t *dest)
+las_error_t las_evlr_read_data_from(las_evlr_t *self, las_source_t *source)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(source);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    if (self->data != NULL || self->data_size == 0)
+    {
+        return las_err;
+    }
+
+    if (self->data_size > (uint64_t)SIZE_MAX)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    if (self->offset_to_data > (uint64_t)INT64_MAX ||
+        las_source_seek(source, (int64_t)self->offset_to_data, LAS_SEEK_FROM_START) != 0)
+    {
+        las_err.kind = LAS_ERROR_ERRNO;
+        return las_err;
+    }
+
+    uint8_t *data = malloc(sizeof(uint8_t) * (size_t)self->data_size);
+    if (data == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    const uint64_t n = las_source_read(source, self->data_size, data);
+    if (n != self->data_size)
+    {
+        free(data);
+        las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+        return las_err;
+    }
+
+    self->data = data;
+    return las_err;
+}
+
+/// Copies `size` bytes from the `source` (at its current position) to the `dest`,
+/// through a buffer of at most `LAS_EVLR_COPY_BLOCK_SIZE` bytes
+static las_error_t las_evlr_copy_data(las_source_t *source, las_dest_t *dest, uint64_t size)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    const size_t block_size =
+        (size < LAS_EVLR_COPY_BLOCK_SIZE) ? (size_t)size : LAS_EVLR_COPY_BLOCK_SIZE;
+    uint8_t *block = malloc(sizeof(uint8_t) * block_size);
+    if (block == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    while (size != 0)
+    {
+        const uint64_t to_copy = (size < block_size) ? size : block_size;
+        if (las_source_read(source, to_copy, block) != to_copy)
+        {
+            las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+            break;
+        }
+        if (las_dest_write(dest, block, to_copy) != to_copy)
+        {
+            las_err = las_dest_err(dest);
+            if (las_error_is_ok(&las_err))
+            {
+                las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+            }
+            break;
+        }
+        size -= to_copy;
+    }
+
+    free(block);
+    return las_err;
+}
+
+las_error_t
+las_evlr_write_to(const las_evlr_t *self, las_source_t *data_source, las_dest_t *dest)
 {
     LAS_DEBUG_ASSERT_NOT_NULL(self);
     LAS_DEBUG_ASSERT_NOT_NULL(dest);
 
-    las_error_t error;
-    error.kind = LAS_ERROR_OK;
-    uint8_t header_bytes[LAS_VLR_HEADER_SIZE];
+    las_error_t error = {LAS_ERROR_OK};
+    uint8_t header_bytes[LAS_EVLR_HEADER_SIZE];
+
+    const bool is_loaded = self->data_size == 0 || self->data != NULL;
+    if (!is_loaded && data_source == NULL)
+    {
+        error.kind = LAS_ERROR_EVLR_DATA_NOT_LOADED;
+        return error;
+    }
+    if (!is_loaded && (self->offset_to_data > (uint64_t)INT64_MAX ||
+                       las_source_seek(data_source,
+                                       (int64_t)self->offset_to_data,
+                                       LAS_SEEK_FROM_START) != 0))
+    {
+        error.kind = LAS_ERROR_ERRNO;
+        return error;
+    }
 
     buffer_writer_t wrt = {&header_bytes[0]};
 
@@ -144,29 +325,82 @@ static las_error_t las_vlr_write_to(const las_vlr_t *self, las_dest_t *dest)
     write_intog(&wrt, &self->data_size);
     write_into(&wrt, &self->description[0], LAS_VLR_DESCRIPTION_SIZE);
 
-    LAS_DEBUG_ASSERT((wrt.ptr - header_bytes) == LAS_VLR_HEADER_SIZE);
+    LAS_DEBUG_ASSERT((wrt.ptr - header_bytes) == LAS_EVLR_HEADER_SIZE);
 
-    uint64_t n = las_dest_write(dest, &header_bytes[0], LAS_VLR_HEADER_SIZE);
-    if (self->data_size != 0 && self->data != NULL)
+    uint64_t n = las_dest_write(dest, &header_bytes[0], LAS_EVLR_HEADER_SIZE);
+    if (n != LAS_EVLR_HEADER_SIZE)
     {
-        n += las_dest_write(dest, self->data, self->data_size);
+        error = las_dest_err(dest);
+        if (las_error_is_ok(&error))
+        {
+            error.kind = LAS_ERROR_UNEXPECTED_EOF;
+        }
+        return error;
     }
 
-    if (n != self->data_size + LAS_VLR_HEADER_SIZE)
+    if (!is_loaded)
     {
-        error.kind = LAS_ERROR_UNEXPECTED_EOF;
+        return las_evlr_copy_data(data_source, dest, self->data_size);
+    }
+
+    n = (self->data_size != 0) ? las_dest_write(dest, self->data, self->data_size) : 0;
+    if (n != self->data_size)
+    {
+        error = las_dest_err(dest);
+        if (las_error_is_ok(&error))
+        {
+            error.kind = LAS_ERROR_UNEXPECTED_EOF;
+        }
     }
 
     return error;
 }
 
-static uint16_t las_vlr_size(const las_vlr_t *self)
+static int las_evlr_clone_into(const las_evlr_t *self, las_evlr_t *out_evlr)
 {
-    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT(self != NULL);
+    LAS_DEBUG_ASSERT(out_evlr != NULL);
 
-    LAS_ASSERT(self->data_size < (UINT16_MAX - LAS_VLR_HEADER_SIZE));
+    *out_evlr = *self;
 
-    return self->data_size + LAS_VLR_HEADER_SIZE;
+    // The payload may not be loaded, in that case the clone does not have it either
+    if (self->data == NULL || self->data_size == 0)
+    {
+        return 0;
+    }
+
+    out_evlr->data = malloc(sizeof(uint8_t) * (size_t)self->data_size);
+    if (out_evlr->data == NULL)
+    {
+        return 1;
+    }
+    memcpy(out_evlr->data, self->data, (size_t)self->data_size);
+
+    return 0;
+}
+
+static void las_evlr_deinit(las_evlr_t *self)
+{
+    LAS_DEBUG_ASSERT(self != NULL);
+
+    if (self->data != NULL)
+    {
+        free(self->data);
+        self->data = NULL;
+    }
+}
+
+static void las_evlr_array_delete(las_evlr_t *evlrs, uint32_t size)
+{
+    if (evlrs == NULL)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        las_evlr_deinit(&evlrs[i]);
+    }
+    free(evlrs);
 }
 
 int las_vlr_clone_into(const las_vlr_t *self, las_vlr_t *out_vlr)
@@ -224,6 +458,21 @@ void las_vlr_deinit(las_vlr_t *self)
     }
 }
 
+void las_vlr_deinit_shared(las_vlr_t *self, const las_vlr_arena_t *arena)
+{
+    LAS_DEBUG_ASSERT(self != NULL);
+
+    if (las_vlr_arena_owns(arena, self->data))
+    {
+        self->data = NULL;
+        self->data_size = 0;
+    }
+    else
+    {
+        las_vlr_deinit(self);
+    }
+}
+
 const las_vlr_t *las_header_find_laszip_vlr(const las_header_t *las_header)
 {
     const las_vlr_t *vlr = NULL;
@@ -303,6 +552,11 @@ las_error_t las_header_validate(const las_header_t *self)
         fprintf(stderr, "number_of_vlrs is non-zero, but vlrs is a NULL pointer\n");
         abort();
     }
+    if (self->number_of_evlrs != 0 && self->evlrs == NULL)
+    {
+        fprintf(stderr, "number_of_evlrs is non-zero, but evlrs is a NULL pointer\n");
+        abort();
+    }
 #endif
 
     if (self->version.major != 1 || self->version.minor > 4)
@@ -340,6 +594,13 @@ las_error_t las_header_validate_for_writing(const las_header_t *self)
         return las_err;
     }
 
+    if (self->number_of_evlrs != 0 && self->version.minor < 4)
+    {
+        las_err.kind = LAS_ERROR_INCOMPATIBLE_VERSION_AND_EVLRS;
+        las_err.version = self->version;
+        return las_err;
+    }
+
     return las_err;
 }
 
@@ -348,32 +609,186 @@ static void las_header_reset(las_header_t *header)
     memset(header, 0, sizeof(las_header_t));
 }
 
-las_error_t
-las_header_read_from(las_source_t *source, las_header_t *header, bool *is_data_compressed)
+/// Number of bytes fetched by the first read of a header
+///
+/// With most files the header and all the VLRs fit, they are then
+/// read from the source with this single read.
+#define LAS_HEADER_SPECULATIVE_READ_SIZE 16384
+
+/// Size up to which the bytes of a header are fetched with one read
+///
+/// Past it, the buffer grows geometrically as the source delivers the bytes,
+/// so that a corrupt header cannot make us allocate much more than the source holds.
+#define LAS_HEADER_SINGLE_FETCH_MAX_SIZE (1024 * 1024)
+
+/// The first bytes of a source, fetched as the header is parsed
+typedef struct las_header_bytes
+{
+    las_source_t *source;
+    uint8_t *data;
+    /// Number of bytes fetched so far
+    uint64_t size;
+    uint64_t capacity;
+} las_header_bytes_t;
+
+/// Fetches the bytes up to `end`, with one read if they fit in
+/// `LAS_HEADER_SINGLE_FETCH_MAX_SIZE`
+///
+/// Returns an error if the source ends before `min_end`,
+/// reaching its end between `min_end` and `end` is not an error.
+static las_error_t
+las_header_bytes_fetch(las_header_bytes_t *self, const uint64_t min_end, const uint64_t end)
 {
-    uint64_t n = 0;
+    LAS_DEBUG_ASSERT(min_end <= end);
     las_error_t las_err = {LAS_ERROR_OK};
 
-    las_header_reset(header);
+    while (self->size < end)
+    {
+        if (self->size == self->capacity)
+        {
+            const uint64_t single_fetch_end =
+                (end < LAS_HEADER_SINGLE_FETCH_MAX_SIZE) ? end : LAS_HEADER_SINGLE_FETCH_MAX_SIZE;
+            const uint64_t capacity = (2 * self->capacity > single_fetch_end)
+                                          ? 2 * self->capacity
+                                          : single_fetch_end;
+            uint8_t *data = realloc(self->data, (size_t)capacity);
+            if (data == NULL)
+            {
+                las_err.kind = LAS_ERROR_MEMORY;
+                return las_err;
+            }
+            self->data = data;
+            self->capacity = capacity;
+        }
 
-    uint8_t header_bytes[LAS_HEADER_1_4_SIZE] = {0};
+        const uint64_t read_end = (end < self->capacity) ? end : self->capacity;
+        const uint64_t num_read =
+            las_source_read(self->source, read_end - self->size, &self->data[self->size]);
+        self->size += num_read;
+        if (self->size < read_end)
+        {
+            break;
+        }
+    }
 
-    buffer_reader_t rdr = {&header_bytes[0]};
+    if (self->size < min_end)
+    {
+        las_err.kind = las_source_eof(self->source) ? LAS_ERROR_UNEXPECTED_EOF : LAS_ERROR_ERRNO;
+    }
 
-    n += las_source_read(source, LAS_HEADER_1_2_SIZE, &header_bytes[0]);
-    if (n < LAS_HEADER_1_2_SIZE)
+    return las_err;
+}
+
+/// Parses the part of a VLR that precedes its payload
+static void las_vlr_parse_header(const uint8_t *bytes, las_vlr_t *vlr)
+{
+    // First two bytes are reserved
+    buffer_reader_t rdr = {&bytes[2]};
+    read_into(&rdr, (uint8_t *)&vlr->user_id, LAS_VLR_USER_ID_SIZE);
+    read_intog(&rdr, &vlr->record_id);
+    read_intog(&rdr, &vlr->data_size);
+    read_into(&rdr, (uint8_t *)&vlr->description, LAS_VLR_DESCRIPTION_SIZE);
+
+    LAS_DEBUG_ASSERT((rdr.ptr - bytes) == LAS_VLR_HEADER_SIZE);
+}
+
+/// Parses the VLRs starting at `vlrs_start` in the `bytes`, fetching what is missing
+///
+/// The payloads are copied in one arena.
+static las_error_t
+las_vlrs_parse(las_header_bytes_t *bytes, const uint64_t vlrs_start, las_header_t *header)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    // Checked before allocating for each VLR, as the count may be corrupt
+    const uint64_t min_vlrs_end =
+        vlrs_start + (uint64_t)header->number_of_vlrs * LAS_VLR_HEADER_SIZE;
+    las_err = las_header_bytes_fetch(bytes, min_vlrs_end, min_vlrs_end);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    header->vlrs = calloc(header->number_of_vlrs, sizeof(las_vlr_t));
+    if (header->vlrs == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    // The VLRs are normally all in [0, offset_to_point_data), which was fetched,
+    // fetching here only happens when the offset to point data is wrong
+    uint64_t pos = vlrs_start;
+    size_t payloads_size = 0;
+    for (uint32_t i = 0; i < header->number_of_vlrs; ++i)
     {
-        if (las_source_eof(source))
+        las_vlr_t *vlr = &header->vlrs[i];
+        const uint64_t vlr_header_end = pos + LAS_VLR_HEADER_SIZE;
+        las_err = las_header_bytes_fetch(bytes, vlr_header_end, vlr_header_end);
+        if (las_error_is_ok(&las_err))
         {
-            las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+            las_vlr_parse_header(&bytes->data[pos], vlr);
+            pos += LAS_VLR_HEADER_SIZE;
+            las_err = las_header_bytes_fetch(bytes, pos + vlr->data_size, pos + vlr->data_size);
         }
-        else
+        if (las_error_is_failure(&las_err))
         {
-            las_err.kind = LAS_ERROR_ERRNO;
+            return las_err;
         }
+        pos += vlr->data_size;
+        payloads_size += vlr->data_size;
+    }
+
+    if (payloads_size == 0)
+    {
+        return las_err;
+    }
+
+    header->vlr_arena = las_vlr_arena_new(payloads_size);
+    if (header->vlr_arena == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
         return las_err;
     }
 
+    pos = vlrs_start;
+    uint8_t *payload = las_vlr_arena_data(header->vlr_arena);
+    for (uint32_t i = 0; i < header->number_of_vlrs; ++i)
+    {
+        las_vlr_t *vlr = &header->vlrs[i];
+        pos += LAS_VLR_HEADER_SIZE;
+        if (vlr->data_size != 0)
+        {
+            memcpy(payload, &bytes->data[pos], vlr->data_size);
+            vlr->data = payload;
+            payload += vlr->data_size;
+        }
+        pos += vlr->data_size;
+    }
+
+    return las_err;
+}
+
+las_error_t
+las_header_read_from(las_source_t *source, las_header_t *header, bool *is_data_compressed)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    las_header_reset(header);
+
+    // The header, its extra bytes and the VLRs are fetched with the first read
+    // when they fit in it, with a second read of the rest of [0, offset_to_point_data)
+    // otherwise (more if it is large), and are parsed from memory.
+    // The position of the source after this function is not specified.
+    las_header_bytes_t bytes = {source, NULL, 0, 0};
+    las_err = las_header_bytes_fetch(&bytes, LAS_HEADER_1_2_SIZE, LAS_HEADER_SPECULATIVE_READ_SIZE);
+    if (las_error_is_failure(&las_err))
+    {
+        goto out;
+    }
+
+    buffer_reader_t rdr = {&bytes.data[0]};
+
     // + 1 so that it's a null terminated string we can print
     char signature[LAS_SIGNATURE_SIZE + 1] = "";
     read_into(&rdr, &signature[0], LAS_SIGNATURE_SIZE);
@@ -381,7 +796,7 @@ las_header_read_from(las_source_t *source, las_header_t *header, bool *is_data_c
     {
         las_err.kind = LAS_ERROR_INVALID_SIGNATURE;
         strcpy(las_err.signature, signature);
-        return las_err;
+        goto out;
     }
 
     read_intog(&rdr, &header->file_source_id);
@@ -411,7 +826,7 @@ las_header_read_from(las_source_t *source, las_header_t *header, bool *is_data_c
         point_format_id, point_size, &header->point_format, is_data_compressed);
     if (las_error_is_failure(&las_err))
     {
-        return las_err;
+        goto out;
     }
 
     uint32_t legacy_point_count;
@@ -443,23 +858,32 @@ las_header_read_from(las_source_t *source, las_header_t *header, bool *is_data_c
     read_intog(&rdr, &header->mins.z);
 
     // End of header for versions [1.0, 1.1, 1.2]
-    LAS_DEBUG_ASSERT((rdr.ptr - &header_bytes[0]) == LAS_HEADER_1_2_SIZE);
+    LAS_DEBUG_ASSERT((rdr.ptr - &bytes.data[0]) == LAS_HEADER_1_2_SIZE);
+    uint64_t standard_size = LAS_HEADER_1_2_SIZE;
 
+    // The first fetch is larger than any header, fetching does not move the data
     if (header->version.major >= 1 && header->version.minor >= 3)
     {
-        n += las_source_read(
-            source, LAS_HEADER_1_3_SIZE - LAS_HEADER_1_2_SIZE, &header_bytes[LAS_HEADER_1_2_SIZE]);
+        las_err = las_header_bytes_fetch(&bytes, LAS_HEADER_1_3_SIZE, LAS_HEADER_1_3_SIZE);
+        if (las_error_is_failure(&las_err))
+        {
+            goto out;
+        }
 
         read_intog(&rdr, &header->start_of_waveform_datapacket);
 
         // End of header for versions [1.3]
-        LAS_DEBUG_ASSERT((rdr.ptr - &header_bytes[0]) == LAS_HEADER_1_3_SIZE);
+        LAS_DEBUG_ASSERT((rdr.ptr - &bytes.data[0]) == LAS_HEADER_1_3_SIZE);
+        standard_size = LAS_HEADER_1_3_SIZE;
     }
 
     if (header->version.major >= 1 && header->version.minor >= 4)
     {
-        n += las_source_read(
-            source, LAS_HEADER_1_4_SIZE - LAS_HEADER_1_3_SIZE, &header_bytes[LAS_HEADER_1_3_SIZE]);
+        las_err = las_header_bytes_fetch(&bytes, LAS_HEADER_1_4_SIZE, LAS_HEADER_1_4_SIZE);
+        if (las_error_is_failure(&las_err))
+        {
+            goto out;
+        }
 
         read_intog(&rdr, &header->start_of_evlrs);
         read_intog(&rdr, &header->number_of_evlrs);
@@ -472,53 +896,66 @@ las_header_read_from(las_source_t *source, las_header_t *header, bool *is_data_c
         }
 
         // End of header for versions [1.4]
-        LAS_DEBUG_ASSERT((rdr.ptr - &header_bytes[0]) == LAS_HEADER_1_4_SIZE);
+        LAS_DEBUG_ASSERT((rdr.ptr - &bytes.data[0]) == LAS_HEADER_1_4_SIZE);
+        standard_size = LAS_HEADER_1_4_SIZE;
     }
 
-    if (las_source_eof(source))
+    // Fetch the rest of what precedes the points, if the first read did not get it all.
+    // The offset to point data is not trusted to fetch more
+    // than what the VLRs can hold, and the fetch stops where the source ends.
+    const uint64_t vlrs_start = (header_size > standard_size) ? header_size : standard_size;
+    const uint64_t max_vlrs_end =
+        vlrs_start + (uint64_t)header->number_of_vlrs * (LAS_VLR_HEADER_SIZE + UINT16_MAX);
+    const uint64_t expected_end = (header->offset_to_point_data < max_vlrs_end)
+                                      ? header->offset_to_point_data
+                                      : max_vlrs_end;
+    las_err = las_header_bytes_fetch(
+        &bytes, vlrs_start, (expected_end > vlrs_start) ? expected_end : vlrs_start);
+    if (las_error_is_failure(&las_err))
     {
-        las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
-        return las_err;
+        goto out;
     }
 
-    if (n < (uint64_t)header_size)
+    if (header_size > standard_size)
     {
         // There are some unknown extra header bytes
-        const uint32_t extra_size = (uint32_t)header_size - (uint32_t)n;
+        const uint32_t extra_size = (uint32_t)(header_size - standard_size);
         header->extra_header_bytes = malloc(sizeof(uint8_t) * extra_size);
         if (header->extra_header_bytes == NULL)
         {
             las_err.kind = LAS_ERROR_MEMORY;
-            return las_err;
+            goto out;
         }
-        (void)las_source_read(source, header->num_extra_header_bytes, header->extra_header_bytes);
         header->num_extra_header_bytes = extra_size;
+        memcpy(header->extra_header_bytes, &bytes.data[standard_size], extra_size);
     }
 
-    // Read the VLRs
     if (header->number_of_vlrs > 0)
     {
-        header->vlrs = malloc(sizeof(las_vlr_t) * header->number_of_vlrs);
-        if (header->vlrs == NULL)
+        las_err = las_vlrs_parse(&bytes, vlrs_start, header);
+        if (las_error_is_failure(&las_err))
         {
             las_header_deinit(header);
-            las_err.kind = LAS_ERROR_MEMORY;
-            return las_err;
-        }
-        for (uint32_t i = 0; i < header->number_of_vlrs; ++i)
-        {
-            las_err = las_vlr_read_into(source, &header->vlrs[i]);
-            if (las_error_is_failure(&las_err))
-            {
-                las_header_deinit(header);
-                break;
-            }
         }
     }
 
+out:
+    free(bytes.data);
     return las_err;
 }
 
+uint32_t las_header_written_offset_to_point_data(const las_header_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    uint32_t offset = las_header_size_for_version(self->version) + self->num_extra_header_bytes;
+    for (uint32_t i = 0; i < self->number_of_vlrs; ++i)
+    {
+        offset += las_vlr_size(&self->vlrs[i]);
+    }
+    return offset;
+}
+
 las_error_t las_header_write_to(const las_header_t *self, las_dest_t *dest)
 {
     LAS_DEBUG_ASSERT_NOT_NULL(self);
@@ -569,17 +1006,12 @@ las_error_t las_header_write_to(const las_header_t *self, las_dest_t *dest)
         las_header_size_for_version(self->version) + (uint16_t)self->num_extra_header_bytes;
     write_intog(wtr, (const uint16_t *)&header_size);
 
-    uint16_t total_vlr_byte_size = 0;
-    for (uint32_t i = 0; i < self->number_of_vlrs; ++i)
-    {
-        total_vlr_byte_size += las_vlr_size(&self->vlrs[i]);
-    }
-    const uint32_t offset_to_point_data = header_size + total_vlr_byte_size;
+    const uint32_t offset_to_point_data = las_header_written_offset_to_point_data(self);
 
     write_intog(wtr, &offset_to_point_data);
     write_intog(wtr, &self->number_of_vlrs);
     write_intog(wtr, &self->point_format.id);
-    const uint16_t point_size = las_point_standard_size(self->point_format.id);
+    const uint16_t point_size = las_point_format_point_size(self->point_format);
     write_intog(wtr, &point_size);
     write_intog(wtr, (const uint32_t *)&legacy_point_count);
 
@@ -624,14 +1056,15 @@ las_error_t las_header_write_to(const las_header_t *self, las_dest_t *dest)
         }
     }
 
-    LAS_DEBUG_ASSERT((wtr->ptr - &header_bytes[0]) == header_size);
-    uint64_t n = las_dest_write(dest, &header_bytes[0], header_size);
+    const uint16_t standard_header_size = las_header_size_for_version(self->version);
+    LAS_DEBUG_ASSERT((wtr->ptr - &header_bytes[0]) == standard_header_size);
+    uint64_t n = las_dest_write(dest, &header_bytes[0], standard_header_size);
     if (self->extra_header_bytes != NULL && self->num_extra_header_bytes > 0)
     {
         n += las_dest_write(dest, self->extra_header_bytes, self->num_extra_header_bytes);
     }
 
-    if (n < header_size + self->num_extra_header_bytes)
+    if (n < header_size)
     {
         las_err = las_dest_err(dest);
     }
@@ -647,22 +1080,22 @@ las_error_t las_header_write_to(const las_header_t *self, las_dest_t *dest)
     return las_err;
 }
 
-static void las_vlr_array_deinit(las_vlr_t *vlrs, uint32_t size)
+static void las_vlr_array_deinit(las_vlr_t *vlrs, uint32_t size, const las_vlr_arena_t *arena)
 {
     LAS_DEBUG_ASSERT(vlrs != NULL);
     for (uint32_t i = 0; i < size; ++i)
     {
-        las_vlr_deinit(&vlrs[i]);
+        las_vlr_deinit_shared(&vlrs[i], arena);
     }
 }
 
-static void las_vlr_array_delete(las_vlr_t *vlrs, uint32_t size)
+static void las_vlr_array_delete(las_vlr_t *vlrs, uint32_t size, const las_vlr_arena_t *arena)
 {
     if (vlrs == NULL)
     {
         return;
     }
-    las_vlr_array_deinit(vlrs, size);
+    las_vlr_array_deinit(vlrs, size, arena);
     free(vlrs);
 }
 
@@ -686,10 +1119,39 @@ int las_header_clone_into(const las_header_t *self, las_header_t *out_header)
 
         for (uint32_t i = 0; i < self->number_of_vlrs; ++i)
         {
+            // Payloads in the arena are shared, the others are copied
+            if (las_vlr_arena_owns(self->vlr_arena, self->vlrs[i].data))
+            {
+                vlrs[i] = self->vlrs[i];
+                continue;
+            }
+
             const int failed = las_vlr_clone_into(&self->vlrs[i], &vlrs[i]);
             if (failed)
             {
-                las_vlr_array_delete(vlrs, i);
+                las_vlr_array_delete(vlrs, i, self->vlr_arena);
+                return 1;
+            }
+        }
+    }
+
+    las_evlr_t *evlrs = NULL;
+    if (self->evlrs != NULL && self->number_of_evlrs != 0)
+    {
+        evlrs = malloc(self->number_of_evlrs * sizeof(las_evlr_t));
+        if (evlrs == NULL)
+        {
+            las_vlr_array_delete(vlrs, self->number_of_vlrs, self->vlr_arena);
+            return 1;
+        }
+
+        for (uint32_t i = 0; i < self->number_of_evlrs; ++i)
+        {
+            const int failed = las_evlr_clone_into(&self->evlrs[i], &evlrs[i]);
+            if (failed)
+            {
+                las_evlr_array_delete(evlrs, i);
+                las_vlr_array_delete(vlrs, self->number_of_vlrs, self->vlr_arena);
                 return 1;
             }
         }
@@ -701,7 +1163,8 @@ int las_header_clone_into(const las_header_t *self, las_header_t *out_header)
         extra_header_bytes = malloc(sizeof(uint8_t) * self->num_extra_header_bytes);
         if (extra_header_bytes == NULL)
         {
-            las_vlr_array_delete(vlrs, self->number_of_vlrs);
+            las_evlr_array_delete(evlrs, self->number_of_evlrs);
+            las_vlr_array_delete(vlrs, self->number_of_vlrs, self->vlr_arena);
             return 1;
         }
 
@@ -709,7 +1172,9 @@ int las_header_clone_into(const las_header_t *self, las_header_t *out_header)
     }
 
     out_header->vlrs = vlrs;
+    out_header->evlrs = evlrs;
     out_header->extra_header_bytes = extra_header_bytes;
+    las_vlr_arena_retain(out_header->vlr_arena);
 
     return 0;
 }
@@ -735,16 +1200,47 @@ int las_header_clone(const las_header_t *self, las_header_t **out_header)
     return 0;
 }
 
+int las_header_vlr_make_writable(las_header_t *self, const uint32_t index)
+{
+    LAS_DEBUG_ASSERT(self != NULL);
+    LAS_DEBUG_ASSERT(index < self->number_of_vlrs);
+
+    las_vlr_t *vlr = &self->vlrs[index];
+    if (!las_vlr_arena_owns(self->vlr_arena, vlr->data))
+    {
+        return 0;
+    }
+
+    uint8_t *data = malloc(sizeof(uint8_t) * vlr->data_size);
+    if (data == NULL)
+    {
+        return 1;
+    }
+    memcpy(data, vlr->data, vlr->data_size);
+    vlr->data = data;
+
+    return 0;
+}
+
 void las_header_deinit(las_header_t *self)
 {
     LAS_DEBUG_ASSERT(self != NULL);
 
     if (self->vlrs != NULL)
     {
-        las_vlr_array_delete(self->vlrs, self->number_of_vlrs);
+        las_vlr_array_delete(self->vlrs, self->number_of_vlrs, self->vlr_arena);
         self->vlrs = NULL;
         self->number_of_vlrs = 0;
     }
+    las_vlr_arena_release(self->vlr_arena);
+    self->vlr_arena = NULL;
+
+    if (self->evlrs != NULL)
+    {
+        las_evlr_array_delete(self->evlrs, self->number_of_evlrs);
+        self->evlrs = NULL;
+        self->number_of_evlrs = 0;
+    }
 }
 
 void las_header_delete(las_header_t *self)
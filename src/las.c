@@ -64,6 +64,59 @@ void las_error_fprintf(const las_error_t *self, FILE *stream)
     case LAS_ERROR_POINT_COUNT_TOO_HIGH:
         fprintf(stream, "The point_count `%" PRIu64 "` exceeds the maximum", self->point_count);
         break;
+    case LAS_ERROR_INCOMPATIBLE_VERSION_AND_EVLRS:
+        fprintf(stream,
+                "EVLRs cannot be written in a file with version `%d.%d`, version 1.4 is required\n",
+                (int)self->version.major,
+                (int)self->version.minor);
+        break;
+    case LAS_ERROR_EVLR_DATA_NOT_LOADED:
+        fprintf(stream, "The payload of an EVLR was not loaded\n");
+        break;
+
+    case LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA:
+        fprintf(stream, "The operation is not supported for compressed point data\n");
+        break;
+
+    case LAS_ERROR_INCOMPATIBLE_SCALING:
+        fprintf(stream, "The scaling (scales and offsets) are not compatible\n");
+        break;
+
+    case LAS_ERROR_UNSUPPORTED_HEADER_LAYOUT:
+        fprintf(stream,
+                "The file has bytes between its VLRs and its points, "
+                "or internal waveform data packets, "
+                "its header cannot be rewritten in place\n");
+        break;
+
+    case LAS_ERROR_POINT_INDEX_OUT_OF_RANGE:
+        fprintf(stream, "The point index `%" PRIu64 "` is out of range\n", self->point_index);
+        break;
+
+    case LAS_ERROR_INVALID_FIELD_VALUE:
+        fprintf(stream, "The value does not fit in the point field\n");
+        break;
+
+    case LAS_ERROR_INVALID_EXTRA_BYTES_VLR:
+        fprintf(stream,
+                "The extra bytes VLR is invalid, or describes more bytes than the points have\n");
+        break;
+
+    case LAS_ERROR_UNSUPPORTED_EXTRA_BYTES_TYPE:
+        fprintf(stream, "The data type of the extra bytes dimension is not supported\n");
+        break;
+
+    case LAS_ERROR_COORDINATE_OVERFLOW:
+        fprintf(stream, "A coordinate does not fit in 32 bits with the new scale and offset\n");
+        break;
+
+    case LAS_ERROR_INVALID_CATALOG:
+        fprintf(stream, "The file is not a catalog, or is truncated\n");
+        break;
+
+    case LAS_ERROR_INVALID_LAZ_CHUNK_TABLE:
+        fprintf(stream, "The chunk table of the LAZ data is invalid\n");
+        break;
 
 #ifdef WITH_LAZRS
     case LAS_ERROR_LAZRS:
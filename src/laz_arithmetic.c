@@ -0,0 +1,639 @@
+#include "private/laz_arithmetic.h"
+#include "private/macro.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Constants of LASzip's arithmetic coder
+#define AC_MIN_LENGTH 0x01000000U
+#define AC_MAX_LENGTH 0xFFFFFFFFU
+
+#define BM_LENGTH_SHIFT 13
+#define BM_MAX_COUNT (1U << BM_LENGTH_SHIFT)
+
+#define DM_LENGTH_SHIFT 15
+#define DM_MAX_COUNT (1U << DM_LENGTH_SHIFT)
+
+/// Configuration of the integer compressor used by the chunk table
+#define IC_CORR_BITS 32
+#define IC_BITS_HIGH 8
+
+//=============================================================================
+// Models
+//=============================================================================
+
+void las_arithmetic_bit_model_init(las_arithmetic_bit_model_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    self->bit_0_count = 1;
+    self->bit_count = 2;
+    self->bit_0_prob = 1U << (BM_LENGTH_SHIFT - 1);
+    self->update_cycle = 4;
+    self->bits_until_update = 4;
+}
+
+static void las_arithmetic_bit_model_update(las_arithmetic_bit_model_t *self)
+{
+    self->bit_count += self->update_cycle;
+    if (self->bit_count > BM_MAX_COUNT)
+    {
+        self->bit_count = (self->bit_count + 1) >> 1;
+        self->bit_0_count = (self->bit_0_count + 1) >> 1;
+        if (self->bit_0_count == self->bit_count)
+        {
+            ++self->bit_count;
+        }
+    }
+
+    const uint32_t scale = 0x80000000U / self->bit_count;
+    self->bit_0_prob = (self->bit_0_count * scale) >> (31 - BM_LENGTH_SHIFT);
+
+    self->update_cycle = (5 * self->update_cycle) >> 2;
+    if (self->update_cycle > 64)
+    {
+        self->update_cycle = 64;
+    }
+    self->bits_until_update = self->update_cycle;
+}
+
+static void las_arithmetic_model_update(las_arithmetic_model_t *self)
+{
+    self->total_count += self->update_cycle;
+    if (self->total_count > DM_MAX_COUNT)
+    {
+        self->total_count = 0;
+        for (uint32_t n = 0; n < self->num_symbols; ++n)
+        {
+            self->symbol_count[n] = (self->symbol_count[n] + 1) >> 1;
+            self->total_count += self->symbol_count[n];
+        }
+    }
+
+    const uint32_t scale = 0x80000000U / self->total_count;
+    uint32_t sum = 0;
+    for (uint32_t k = 0; k < self->num_symbols; ++k)
+    {
+        self->distribution[k] = (scale * sum) >> (31 - DM_LENGTH_SHIFT);
+        sum += self->symbol_count[k];
+    }
+
+    self->update_cycle = (5 * self->update_cycle) >> 2;
+    const uint32_t max_cycle = (self->num_symbols + 6) << 3;
+    if (self->update_cycle > max_cycle)
+    {
+        self->update_cycle = max_cycle;
+    }
+    self->symbols_until_update = self->update_cycle;
+}
+
+bool las_arithmetic_model_init(las_arithmetic_model_t *self, const uint32_t num_symbols)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT(num_symbols >= 2 && num_symbols <= (1U << 11));
+
+    // The decoder does not use LASzip's decoder table to speed up the search,
+    // which only changes the speed, not the decoded symbols.
+    self->distribution = malloc(sizeof(uint32_t) * 2 * num_symbols);
+    if (self->distribution == NULL)
+    {
+        return false;
+    }
+    self->symbol_count = self->distribution + num_symbols;
+    self->num_symbols = num_symbols;
+    self->last_symbol = num_symbols - 1;
+
+    self->total_count = 0;
+    self->update_cycle = num_symbols;
+    for (uint32_t k = 0; k < num_symbols; ++k)
+    {
+        self->symbol_count[k] = 1;
+    }
+
+    las_arithmetic_model_update(self);
+    self->update_cycle = (num_symbols + 6) >> 1;
+    self->symbols_until_update = self->update_cycle;
+
+    return true;
+}
+
+void las_arithmetic_model_deinit(las_arithmetic_model_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    free(self->distribution);
+    self->distribution = NULL;
+    self->symbol_count = NULL;
+}
+
+//=============================================================================
+// Encoder
+//=============================================================================
+
+void las_arithmetic_encoder_init(las_arithmetic_encoder_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    memset(self, 0, sizeof(las_arithmetic_encoder_t));
+    self->base = 0;
+    self->length = AC_MAX_LENGTH;
+}
+
+void las_arithmetic_encoder_deinit(las_arithmetic_encoder_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    free(self->data);
+    self->data = NULL;
+    self->size = 0;
+    self->capacity = 0;
+}
+
+static void las_arithmetic_encoder_put_byte(las_arithmetic_encoder_t *self, const uint8_t byte)
+{
+    if (self->size == self->capacity)
+    {
+        const uint64_t new_capacity = (self->capacity == 0) ? 256 : self->capacity * 2;
+        uint8_t *data = realloc(self->data, sizeof(uint8_t) * new_capacity);
+        if (data == NULL)
+        {
+            self->has_failed = true;
+            return;
+        }
+        self->data = data;
+        self->capacity = new_capacity;
+    }
+    self->data[self->size++] = byte;
+}
+
+static void las_arithmetic_encoder_propagate_carry(las_arithmetic_encoder_t *self)
+{
+    uint64_t i = self->size;
+    while (i > 0 && self->data[i - 1] == 0xFF)
+    {
+        self->data[i - 1] = 0;
+        --i;
+    }
+    if (i > 0)
+    {
+        ++self->data[i - 1];
+    }
+}
+
+static void las_arithmetic_encoder_renorm(las_arithmetic_encoder_t *self)
+{
+    do
+    {
+        las_arithmetic_encoder_put_byte(self, (uint8_t)(self->base >> 24));
+        self->base <<= 8;
+        self->length <<= 8;
+    } while (self->length < AC_MIN_LENGTH);
+}
+
+void las_arithmetic_encoder_encode_bit(las_arithmetic_encoder_t *self,
+                                       las_arithmetic_bit_model_t *model,
+                                       const uint32_t bit)
+{
+    const uint32_t x = model->bit_0_prob * (self->length >> BM_LENGTH_SHIFT);
+    if (bit == 0)
+    {
+        self->length = x;
+        ++model->bit_0_count;
+    }
+    else
+    {
+        const uint32_t init_base = self->base;
+        self->base += x;
+        self->length -= x;
+        if (init_base > self->base)
+        {
+            las_arithmetic_encoder_propagate_carry(self);
+        }
+    }
+
+    if (self->length < AC_MIN_LENGTH)
+    {
+        las_arithmetic_encoder_renorm(self);
+    }
+    if (--model->bits_until_update == 0)
+    {
+        las_arithmetic_bit_model_update(model);
+    }
+}
+
+void las_arithmetic_encoder_encode_symbol(las_arithmetic_encoder_t *self,
+                                          las_arithmetic_model_t *model,
+                                          const uint32_t symbol)
+{
+    LAS_DEBUG_ASSERT(symbol <= model->last_symbol);
+
+    const uint32_t init_base = self->base;
+    if (symbol == model->last_symbol)
+    {
+        const uint32_t x = model->distribution[symbol] * (self->length >> DM_LENGTH_SHIFT);
+        self->base += x;
+        self->length -= x;
+    }
+    else
+    {
+        self->length >>= DM_LENGTH_SHIFT;
+        const uint32_t x = model->distribution[symbol] * self->length;
+        self->base += x;
+        self->length = model->distribution[symbol + 1] * self->length - x;
+    }
+
+    if (init_base > self->base)
+    {
+        las_arithmetic_encoder_propagate_carry(self);
+    }
+    if (self->length < AC_MIN_LENGTH)
+    {
+        las_arithmetic_encoder_renorm(self);
+    }
+
+    ++model->symbol_count[symbol];
+    if (--model->symbols_until_update == 0)
+    {
+        las_arithmetic_model_update(model);
+    }
+}
+
+static void las_arithmetic_encoder_write_short(las_arithmetic_encoder_t *self, const uint32_t sym)
+{
+    LAS_DEBUG_ASSERT(sym < (1U << 16));
+
+    const uint32_t init_base = self->base;
+    self->length >>= 16;
+    self->base += sym * self->length;
+    if (init_base > self->base)
+    {
+        las_arithmetic_encoder_propagate_carry(self);
+    }
+    if (self->length < AC_MIN_LENGTH)
+    {
+        las_arithmetic_encoder_renorm(self);
+    }
+}
+
+void las_arithmetic_encoder_write_bits(las_arithmetic_encoder_t *self, uint32_t bits, uint32_t sym)
+{
+    LAS_DEBUG_ASSERT(bits > 0 && bits <= 32);
+
+    if (bits > 19)
+    {
+        las_arithmetic_encoder_write_short(self, sym & 0xFFFF);
+        sym >>= 16;
+        bits -= 16;
+    }
+
+    const uint32_t init_base = self->base;
+    self->length >>= bits;
+    self->base += sym * self->length;
+    if (init_base > self->base)
+    {
+        las_arithmetic_encoder_propagate_carry(self);
+    }
+    if (self->length < AC_MIN_LENGTH)
+    {
+        las_arithmetic_encoder_renorm(self);
+    }
+}
+
+void las_arithmetic_encoder_done(las_arithmetic_encoder_t *self)
+{
+    const uint32_t init_base = self->base;
+    bool another_byte = true;
+
+    if (self->length > 2 * AC_MIN_LENGTH)
+    {
+        self->base += AC_MIN_LENGTH;
+        self->length = AC_MIN_LENGTH >> 1;
+    }
+    else
+    {
+        self->base += AC_MIN_LENGTH >> 1;
+        self->length = AC_MIN_LENGTH >> 9;
+        another_byte = false;
+    }
+
+    if (init_base > self->base)
+    {
+        las_arithmetic_encoder_propagate_carry(self);
+    }
+    las_arithmetic_encoder_renorm(self);
+
+    // Same as LASzip: extra zero bytes so that the decoder,
+    // which reads 4 bytes ahead, stays in sync
+    las_arithmetic_encoder_put_byte(self, 0);
+    las_arithmetic_encoder_put_byte(self, 0);
+    if (another_byte)
+    {
+        las_arithmetic_encoder_put_byte(self, 0);
+    }
+}
+
+//=============================================================================
+// Decoder
+//=============================================================================
+
+static uint8_t las_arithmetic_decoder_get_byte(las_arithmetic_decoder_t *self)
+{
+    if (self->pos >= self->size)
+    {
+        self->is_past_end = true;
+        return 0;
+    }
+    return self->data[self->pos++];
+}
+
+void las_arithmetic_decoder_init(las_arithmetic_decoder_t *self,
+                                 const uint8_t *data,
+                                 const uint64_t size)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    self->data = data;
+    self->size = size;
+    self->pos = 0;
+    self->is_past_end = false;
+    self->length = AC_MAX_LENGTH;
+    self->value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        self->value = (self->value << 8) | las_arithmetic_decoder_get_byte(self);
+    }
+}
+
+static void las_arithmetic_decoder_renorm(las_arithmetic_decoder_t *self)
+{
+    do
+    {
+        self->value = (self->value << 8) | las_arithmetic_decoder_get_byte(self);
+        self->length <<= 8;
+    } while (self->length < AC_MIN_LENGTH);
+}
+
+uint32_t las_arithmetic_decoder_decode_bit(las_arithmetic_decoder_t *self,
+                                           las_arithmetic_bit_model_t *model)
+{
+    const uint32_t x = model->bit_0_prob * (self->length >> BM_LENGTH_SHIFT);
+    const uint32_t bit = (self->value >= x);
+
+    if (bit == 0)
+    {
+        self->length = x;
+        ++model->bit_0_count;
+    }
+    else
+    {
+        self->value -= x;
+        self->length -= x;
+    }
+
+    if (self->length < AC_MIN_LENGTH)
+    {
+        las_arithmetic_decoder_renorm(self);
+    }
+    if (--model->bits_until_update == 0)
+    {
+        las_arithmetic_bit_model_update(model);
+    }
+
+    return bit;
+}
+
+uint32_t las_arithmetic_decoder_decode_symbol(las_arithmetic_decoder_t *self,
+                                              las_arithmetic_model_t *model)
+{
+    uint32_t symbol = 0;
+    uint32_t x = 0;
+    uint32_t y = self->length;
+    uint32_t n = model->num_symbols;
+
+    // bisection search of the interval that contains the value
+    self->length >>= DM_LENGTH_SHIFT;
+    uint32_t k = n >> 1;
+    do
+    {
+        const uint32_t z = self->length * model->distribution[k];
+        if (z > self->value)
+        {
+            n = k;
+            y = z;
+        }
+        else
+        {
+            symbol = k;
+            x = z;
+        }
+    } while ((k = (symbol + n) >> 1) != symbol);
+
+    self->value -= x;
+    self->length = y - x;
+
+    if (self->length < AC_MIN_LENGTH)
+    {
+        las_arithmetic_decoder_renorm(self);
+    }
+
+    ++model->symbol_count[symbol];
+    if (--model->symbols_until_update == 0)
+    {
+        las_arithmetic_model_update(model);
+    }
+
+    return symbol;
+}
+
+static uint32_t las_arithmetic_decoder_read_short(las_arithmetic_decoder_t *self)
+{
+    self->length >>= 16;
+    const uint32_t sym = self->value / self->length;
+    self->value -= self->length * sym;
+    if (self->length < AC_MIN_LENGTH)
+    {
+        las_arithmetic_decoder_renorm(self);
+    }
+    return sym;
+}
+
+uint32_t las_arithmetic_decoder_read_bits(las_arithmetic_decoder_t *self, uint32_t bits)
+{
+    LAS_DEBUG_ASSERT(bits > 0 && bits <= 32);
+
+    if (bits > 19)
+    {
+        const uint32_t low = las_arithmetic_decoder_read_short(self);
+        bits -= 16;
+        const uint32_t high = las_arithmetic_decoder_read_bits(self, bits) << 16;
+        return high | low;
+    }
+
+    self->length >>= bits;
+    const uint32_t sym = self->value / self->length;
+    self->value -= self->length * sym;
+    if (self->length < AC_MIN_LENGTH)
+    {
+        las_arithmetic_decoder_renorm(self);
+    }
+    return sym;
+}
+
+//=============================================================================
+// Integer compressor
+//=============================================================================
+
+bool las_integer_compressor_init(las_integer_compressor_t *self, const uint32_t num_contexts)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    memset(self, 0, sizeof(las_integer_compressor_t));
+
+    self->m_bits = calloc(num_contexts, sizeof(las_arithmetic_model_t));
+    if (self->m_bits == NULL)
+    {
+        return false;
+    }
+    self->num_contexts = num_contexts;
+
+    for (uint32_t i = 0; i < num_contexts; ++i)
+    {
+        if (!las_arithmetic_model_init(&self->m_bits[i], IC_CORR_BITS + 1))
+        {
+            las_integer_compressor_deinit(self);
+            return false;
+        }
+    }
+
+    las_arithmetic_bit_model_init(&self->corrector_0);
+    for (uint32_t i = 1; i < IC_CORR_BITS; ++i)
+    {
+        const uint32_t num_symbols = (i <= IC_BITS_HIGH) ? (1U << i) : (1U << IC_BITS_HIGH);
+        if (!las_arithmetic_model_init(&self->correctors[i], num_symbols))
+        {
+            las_integer_compressor_deinit(self);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void las_integer_compressor_deinit(las_integer_compressor_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    if (self->m_bits != NULL)
+    {
+        for (uint32_t i = 0; i < self->num_contexts; ++i)
+        {
+            las_arithmetic_model_deinit(&self->m_bits[i]);
+        }
+        free(self->m_bits);
+        self->m_bits = NULL;
+    }
+
+    for (uint32_t i = 1; i < IC_CORR_BITS; ++i)
+    {
+        las_arithmetic_model_deinit(&self->correctors[i]);
+    }
+}
+
+void las_integer_compressor_compress(las_integer_compressor_t *self,
+                                     las_arithmetic_encoder_t *encoder,
+                                     const int32_t pred,
+                                     const int32_t real,
+                                     const uint32_t context)
+{
+    LAS_DEBUG_ASSERT(context < self->num_contexts);
+
+    // With 32 bits there is no range to wrap around, the subtraction wraps
+    const int32_t c = (int32_t)((uint32_t)real - (uint32_t)pred);
+
+    // find the tightest interval [ - (2^k - 1) ... + (2^k) ] that contains c
+    uint32_t k = 0;
+    uint32_t c1 = (c <= 0) ? (0U - (uint32_t)c) : ((uint32_t)c - 1);
+    while (c1 != 0)
+    {
+        c1 >>= 1;
+        ++k;
+    }
+
+    las_arithmetic_encoder_encode_symbol(encoder, &self->m_bits[context], k);
+
+    if (k == 0)
+    {
+        las_arithmetic_encoder_encode_bit(encoder, &self->corrector_0, (uint32_t)c);
+    }
+    else if (k < IC_CORR_BITS)
+    {
+        // translate c into [0, 2^k - 1]
+        uint32_t corr;
+        if (c < 0)
+        {
+            corr = (uint32_t)(c + (int32_t)((1U << k) - 1));
+        }
+        else
+        {
+            corr = (uint32_t)c - 1;
+        }
+
+        if (k <= IC_BITS_HIGH)
+        {
+            las_arithmetic_encoder_encode_symbol(encoder, &self->correctors[k], corr);
+        }
+        else
+        {
+            const uint32_t k1 = k - IC_BITS_HIGH;
+            const uint32_t low = corr & ((1U << k1) - 1);
+            las_arithmetic_encoder_encode_symbol(encoder, &self->correctors[k], corr >> k1);
+            las_arithmetic_encoder_write_bits(encoder, k1, low);
+        }
+    }
+}
+
+int32_t las_integer_compressor_decompress(las_integer_compressor_t *self,
+                                          las_arithmetic_decoder_t *decoder,
+                                          const int32_t pred,
+                                          const uint32_t context)
+{
+    LAS_DEBUG_ASSERT(context < self->num_contexts);
+
+    int32_t c;
+    const uint32_t k = las_arithmetic_decoder_decode_symbol(decoder, &self->m_bits[context]);
+
+    if (k == 0)
+    {
+        c = (int32_t)las_arithmetic_decoder_decode_bit(decoder, &self->corrector_0);
+    }
+    else if (k < IC_CORR_BITS)
+    {
+        uint32_t corr;
+        if (k <= IC_BITS_HIGH)
+        {
+            corr = las_arithmetic_decoder_decode_symbol(decoder, &self->correctors[k]);
+        }
+        else
+        {
+            const uint32_t k1 = k - IC_BITS_HIGH;
+            corr = las_arithmetic_decoder_decode_symbol(decoder, &self->correctors[k]);
+            corr = (corr << k1) | las_arithmetic_decoder_read_bits(decoder, k1);
+        }
+
+        // translate the corrector back into its interval
+        if (corr >= (1U << (k - 1)))
+        {
+            c = (int32_t)(corr + 1);
+        }
+        else
+        {
+            c = (int32_t)corr - (int32_t)((1U << k) - 1);
+        }
+    }
+    else
+    {
+        c = INT32_MIN;
+    }
+
+    return (int32_t)((uint32_t)pred + (uint32_t)c);
+}
@@ -0,0 +1,223 @@
+#include "private/laz_chunk_table.h"
+#include "private/laz_arithmetic.h"
+#include "private/macro.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// Version of the chunk table format, LASzip only knows 0
+#define LAS_LAZ_CHUNK_TABLE_VERSION 0
+
+/// Upper bound of the number of bytes one value takes in the encoded table
+///
+/// A 32 bits correction takes at most its 32 raw bits plus the symbol of its bit count.
+#define LAS_LAZ_CHUNK_TABLE_MAX_VALUE_SIZE 8
+
+las_error_t las_laz_chunk_table_write_to(const las_laz_chunk_entry_t *entries,
+                                         const uint64_t num_entries,
+                                         const bool is_variable_size,
+                                         las_dest_t *dest)
+{
+    LAS_DEBUG_ASSERT(entries != NULL || num_entries == 0);
+    LAS_DEBUG_ASSERT_NOT_NULL(dest);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    if (num_entries > UINT32_MAX)
+    {
+        las_err.kind = LAS_ERROR_POINT_COUNT_TOO_HIGH;
+        las_err.point_count = num_entries;
+        return las_err;
+    }
+
+    uint8_t prefix[8];
+    const uint32_t version = LAS_LAZ_CHUNK_TABLE_VERSION;
+    const uint32_t count = (uint32_t)num_entries;
+    memcpy(prefix, &version, sizeof(uint32_t));
+    memcpy(prefix + 4, &count, sizeof(uint32_t));
+    if (las_dest_write(dest, prefix, sizeof(prefix)) != sizeof(prefix))
+    {
+        return las_dest_err(dest);
+    }
+
+    if (num_entries == 0)
+    {
+        return las_err;
+    }
+
+    las_arithmetic_encoder_t encoder;
+    las_arithmetic_encoder_init(&encoder);
+    las_integer_compressor_t ic;
+    if (!las_integer_compressor_init(&ic, 2))
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    // Each value is predicted by the same value of the previous chunk,
+    // the (32 bits) values are stored as is in the encoded stream
+    for (uint64_t i = 0; i < num_entries; ++i)
+    {
+        if (is_variable_size)
+        {
+            const uint32_t prev_count = (i == 0) ? 0 : (uint32_t)entries[i - 1].point_count;
+            las_integer_compressor_compress(
+                &ic, &encoder, (int32_t)prev_count, (int32_t)(uint32_t)entries[i].point_count, 0);
+        }
+        const uint32_t prev_bytes = (i == 0) ? 0 : (uint32_t)entries[i - 1].byte_count;
+        las_integer_compressor_compress(
+            &ic, &encoder, (int32_t)prev_bytes, (int32_t)(uint32_t)entries[i].byte_count, 1);
+    }
+    las_arithmetic_encoder_done(&encoder);
+    las_integer_compressor_deinit(&ic);
+
+    if (encoder.has_failed)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+    }
+    else if (las_dest_write(dest, encoder.data, encoder.size) != encoder.size)
+    {
+        las_err = las_dest_err(dest);
+    }
+
+    las_arithmetic_encoder_deinit(&encoder);
+    return las_err;
+}
+
+/// Returns the error of a source that could not read or seek
+static las_error_t las_laz_chunk_table_source_error(las_source_t *source)
+{
+    las_error_t las_err;
+    las_err.kind = las_source_eof(source) ? LAS_ERROR_UNEXPECTED_EOF : LAS_ERROR_ERRNO;
+    return las_err;
+}
+
+las_error_t las_laz_chunk_table_read_from(las_source_t *source,
+                                          const uint64_t offset_to_point_data,
+                                          const uint32_t chunk_size,
+                                          const uint64_t point_count,
+                                          las_laz_chunk_entry_t **out_entries,
+                                          uint64_t *out_num_entries)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(source);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_entries);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_num_entries);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    *out_entries = NULL;
+    *out_num_entries = 0;
+
+    const bool is_variable_size = chunk_size == LAS_LAZ_VARIABLE_CHUNK_SIZE;
+    if (chunk_size == 0)
+    {
+        las_err.kind = LAS_ERROR_INVALID_LAZ_CHUNK_TABLE;
+        return las_err;
+    }
+
+    int64_t chunk_table_offset;
+    if (las_source_seek(source, (int64_t)offset_to_point_data, LAS_SEEK_FROM_START) != 0 ||
+        las_source_read(source, sizeof(int64_t), (uint8_t *)&chunk_table_offset) !=
+            sizeof(int64_t))
+    {
+        return las_laz_chunk_table_source_error(source);
+    }
+
+    // Writers that could not seek back store the offset in the last 8 bytes of the file
+    if (chunk_table_offset == -1)
+    {
+        if (las_source_seek(source, -(int64_t)sizeof(int64_t), LAS_SEEK_FROM_END) != 0 ||
+            las_source_read(source, sizeof(int64_t), (uint8_t *)&chunk_table_offset) !=
+                sizeof(int64_t))
+        {
+            return las_laz_chunk_table_source_error(source);
+        }
+    }
+
+    const uint64_t first_chunk_offset = offset_to_point_data + sizeof(int64_t);
+    if (chunk_table_offset < (int64_t)first_chunk_offset)
+    {
+        las_err.kind = LAS_ERROR_INVALID_LAZ_CHUNK_TABLE;
+        return las_err;
+    }
+
+    uint8_t prefix[8];
+    if (las_source_seek(source, chunk_table_offset, LAS_SEEK_FROM_START) != 0 ||
+        las_source_read(source, sizeof(prefix), prefix) != sizeof(prefix))
+    {
+        return las_laz_chunk_table_source_error(source);
+    }
+    uint32_t version, count;
+    memcpy(&version, prefix, sizeof(uint32_t));
+    memcpy(&count, prefix + 4, sizeof(uint32_t));
+    if (version != LAS_LAZ_CHUNK_TABLE_VERSION)
+    {
+        las_err.kind = LAS_ERROR_INVALID_LAZ_CHUNK_TABLE;
+        return las_err;
+    }
+    if (count == 0)
+    {
+        return las_err;
+    }
+
+    // The encoded table has no stored size, the bytes after it (e.g. EVLRs, or nothing)
+    // are read too, the decoder gives zeros if the file ends before.
+    const uint64_t max_encoded_size = 2 * (uint64_t)count * LAS_LAZ_CHUNK_TABLE_MAX_VALUE_SIZE;
+    uint8_t *encoded = malloc(max_encoded_size);
+    las_laz_chunk_entry_t *entries = malloc(sizeof(las_laz_chunk_entry_t) * count);
+    las_integer_compressor_t ic;
+    memset(&ic, 0, sizeof(las_integer_compressor_t));
+    if (encoded == NULL || entries == NULL || !las_integer_compressor_init(&ic, 2))
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    const uint64_t encoded_size = las_source_read(source, max_encoded_size, encoded);
+    if (encoded_size < max_encoded_size && !las_source_eof(source))
+    {
+        las_err.kind = LAS_ERROR_ERRNO;
+        goto out;
+    }
+
+    las_arithmetic_decoder_t decoder;
+    las_arithmetic_decoder_init(&decoder, encoded, encoded_size);
+
+    uint64_t points_left = point_count;
+    uint64_t end_of_chunks = first_chunk_offset;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        las_laz_chunk_entry_t *entry = &entries[i];
+        if (is_variable_size)
+        {
+            const uint32_t prev_count = (i == 0) ? 0 : (uint32_t)entries[i - 1].point_count;
+            entry->point_count =
+                (uint32_t)las_integer_compressor_decompress(&ic, &decoder, (int32_t)prev_count, 0);
+        }
+        else
+        {
+            entry->point_count = (points_left < chunk_size) ? points_left : chunk_size;
+            points_left -= entry->point_count;
+        }
+        const uint32_t prev_bytes = (i == 0) ? 0 : (uint32_t)entries[i - 1].byte_count;
+        entry->byte_count =
+            (uint32_t)las_integer_compressor_decompress(&ic, &decoder, (int32_t)prev_bytes, 1);
+        end_of_chunks += entry->byte_count;
+    }
+
+    // The chunks are between the chunk table offset and the table
+    if (end_of_chunks > (uint64_t)chunk_table_offset)
+    {
+        las_err.kind = LAS_ERROR_INVALID_LAZ_CHUNK_TABLE;
+        goto out;
+    }
+
+    *out_entries = entries;
+    *out_num_entries = count;
+    entries = NULL;
+
+out:
+    las_integer_compressor_deinit(&ic);
+    free(encoded);
+    free(entries);
+    return las_err;
+}
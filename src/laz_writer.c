@@ -0,0 +1,605 @@
+#ifdef WITH_LAZRS
+
+#include "private/laz_writer.h"
+#include "private/laz_chunk_table.h"
+#include "private/macro.h"
+#include "private/thread_pool.h"
+
+#include <lazrs/lazrs.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/// A chunk of points, and once compressed, its bytes
+typedef struct las_laz_chunk_job
+{
+    las_task_t task;
+
+    las_point_format_t point_format;
+    uint8_t *points;
+    uint64_t num_points;
+
+    /// Buffer that holds the compressed chunk, starting at `chunk_start`
+    uint8_t *compressed;
+    uint64_t chunk_start;
+    uint64_t chunk_size;
+    las_error_t err;
+} las_laz_chunk_job_t;
+
+struct las_laz_writer
+{
+    las_dest_t *dest;
+    /// Not NULL for writers created with `las_laz_writer_new_single`,
+    /// the chunk fields below are then unused
+    Lazrs_LasZipCompressor *compressor;
+    /// Position where the offset to the chunk table is written
+    uint64_t start_position;
+
+    las_point_format_t point_format;
+    uint16_t point_size;
+    /// Maximum number of points per chunk
+    uint32_t chunk_size;
+    /// Set once a chunk was closed before being full
+    bool is_variable_size;
+
+    /// NULL when chunks are compressed by the caller's thread
+    las_thread_pool_t *pool;
+
+    /// Ring of chunks, the `num_pending` ones starting at `first_pending` are
+    /// being compressed, the one after is being filled with points.
+    las_laz_chunk_job_t *jobs;
+    uint32_t num_jobs;
+    uint32_t first_pending;
+    uint32_t num_pending;
+
+    las_laz_chunk_entry_t *entries;
+    uint64_t num_entries;
+    uint64_t entries_capacity;
+};
+
+static inline las_error_t las_lazrs_error(const Lazrs_Result r)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+    if (r != LAZRS_OK)
+    {
+        las_err.kind = LAS_ERROR_LAZRS;
+        las_err.lazrs = r;
+    }
+    return las_err;
+}
+
+/// Creates a compressor that writes into the `dest`
+///
+/// `prefer_parallel` lets lazrs compress its chunks on several threads
+static las_error_t las_laz_compressor_new(las_dest_t *dest,
+                                          const las_point_format_t point_format,
+                                          const bool prefer_parallel,
+                                          Lazrs_LasZipCompressor **out_compressor)
+{
+    Lazrs_CompressorParams params;
+    params.dest_type = LAZRS_DEST_CUSTOM;
+    params.dest.custom.user_data = (void *)dest;
+    params.dest.custom.write_fn = (uint64_t(*)(void *, const uint8_t *, uint64_t))las_dest_write;
+    params.dest.custom.flush_fn = (int (*)(void *))las_dest_flush;
+    params.dest.custom.seek_fn = (int (*)(void *, int64_t, int))las_dest_seek;
+    params.dest.custom.tell_fn = (uint64_t(*)(void *))las_dest_tell;
+    params.point_format_id = point_format.id;
+    params.num_extra_bytes = point_format.num_extra_bytes;
+
+    return las_lazrs_error(
+        lazrs_compressor_new_for_point_format(params, prefer_parallel, out_compressor));
+}
+
+las_error_t las_laz_vlr_data_new(const las_point_format_t point_format,
+                                 uint32_t *chunk_size,
+                                 uint8_t **out_data,
+                                 uint16_t *out_size)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(chunk_size);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_data);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_size);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+    las_dest_t dest = {0};
+    Lazrs_LasZipCompressor *compressor = NULL;
+    uint8_t *data = NULL;
+
+    if (las_dest_new_memory(&dest) != 0)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    // The compressor is only created to get its VLR, nothing is compressed
+    las_err = las_laz_compressor_new(&dest, point_format, false, &compressor);
+    if (las_error_is_failure(&las_err))
+    {
+        goto out;
+    }
+
+    const uint16_t len = lazrs_compressor_laszip_vlr_size(compressor);
+    LAS_ASSERT(len >= LAS_LAZ_VLR_CHUNK_SIZE_OFFSET + sizeof(uint32_t));
+    data = calloc(len, sizeof(uint8_t));
+    if (data == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    las_err = las_lazrs_error(lazrs_compressor_laszip_vlr_data(compressor, data, len));
+    if (las_error_is_failure(&las_err))
+    {
+        goto out;
+    }
+
+    // A compressor given more points than its own chunk size would split
+    // them in several chunks, so that's the biggest size we can use
+    uint32_t max_chunk_size;
+    memcpy(&max_chunk_size, data + LAS_LAZ_VLR_CHUNK_SIZE_OFFSET, sizeof(uint32_t));
+    if (*chunk_size == 0 || *chunk_size > max_chunk_size)
+    {
+        *chunk_size = max_chunk_size;
+    }
+    memcpy(data + LAS_LAZ_VLR_CHUNK_SIZE_OFFSET, chunk_size, sizeof(uint32_t));
+
+    *out_data = data;
+    *out_size = len;
+    data = NULL;
+
+out:
+    free(data);
+    if (compressor != NULL)
+    {
+        lazrs_compressor_delete(compressor);
+    }
+    if (dest.inner != NULL)
+    {
+        las_dest_close(&dest);
+        las_dest_deinit(&dest);
+    }
+    return las_err;
+}
+
+/// Compresses the points of the job as one chunk
+static void las_laz_chunk_job_run(void *arg)
+{
+    las_laz_chunk_job_t *job = arg;
+    las_dest_t dest = {0};
+    Lazrs_LasZipCompressor *compressor = NULL;
+
+    job->err.kind = LAS_ERROR_OK;
+
+    if (las_dest_new_memory(&dest) != 0)
+    {
+        job->err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    // Chunks are already compressed in parallel, one chunk per compressor
+    job->err = las_laz_compressor_new(&dest, job->point_format, false, &compressor);
+    if (las_error_is_failure(&job->err))
+    {
+        goto out;
+    }
+
+    const uint64_t num_bytes = las_point_format_point_size(job->point_format) * job->num_points;
+    job->err = las_lazrs_error(lazrs_compressor_compress_many(compressor, job->points, num_bytes));
+    if (las_error_is_failure(&job->err))
+    {
+        goto out;
+    }
+
+    job->err = las_lazrs_error(lazrs_compressor_done(compressor));
+    if (las_error_is_failure(&job->err))
+    {
+        goto out;
+    }
+
+    las_memory_dest_t *memory = dest.inner;
+    if (memory->has_failed)
+    {
+        job->err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    // The compressor wrote: [offset to its chunk table][the chunk][its chunk table],
+    // we only keep the chunk
+    int64_t chunk_table_offset = 0;
+    LAS_ASSERT(memory->size >= sizeof(int64_t));
+    memcpy(&chunk_table_offset, memory->data, sizeof(int64_t));
+    LAS_ASSERT(chunk_table_offset >= (int64_t)sizeof(int64_t) &&
+               (uint64_t)chunk_table_offset <= memory->size);
+
+    job->compressed = memory->data;
+    job->chunk_start = sizeof(int64_t);
+    job->chunk_size = (uint64_t)chunk_table_offset - sizeof(int64_t);
+    memory->data = NULL;
+
+out:
+    if (compressor != NULL)
+    {
+        lazrs_compressor_delete(compressor);
+    }
+    if (dest.inner != NULL)
+    {
+        las_dest_close(&dest);
+        las_dest_deinit(&dest);
+    }
+}
+
+#ifdef WITH_LAZ_CHUNKED_WRITER
+las_error_t las_laz_writer_new(las_dest_t *dest,
+                               const las_point_format_t point_format,
+                               const uint32_t chunk_size,
+                               const uint32_t num_workers,
+                               las_laz_writer_t **out_writer)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(dest);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_writer);
+    LAS_DEBUG_ASSERT(chunk_size > 0);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    las_laz_writer_t *self = calloc(1, sizeof(las_laz_writer_t));
+    if (self == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    self->dest = dest;
+    self->point_format = point_format;
+    self->point_size = las_point_format_point_size(point_format);
+    self->chunk_size = chunk_size;
+
+    // Workers can all be busy while the caller fills the next chunks,
+    // more would only use memory
+    self->num_jobs = (num_workers == 0) ? 1 : 2 * num_workers;
+    self->jobs = calloc(self->num_jobs, sizeof(las_laz_chunk_job_t));
+    if (self->jobs == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    if (num_workers != 0)
+    {
+        self->pool = las_thread_pool_new(num_workers);
+        if (self->pool == NULL)
+        {
+            las_err.kind = LAS_ERROR_MEMORY;
+            goto out;
+        }
+    }
+
+    // Placeholder for the offset to the chunk table
+    self->start_position = las_dest_tell(dest);
+    const int64_t chunk_table_offset = -1;
+    if (las_dest_write(dest, (const uint8_t *)&chunk_table_offset, sizeof(int64_t)) !=
+        sizeof(int64_t))
+    {
+        las_err = las_dest_err(dest);
+        goto out;
+    }
+
+out:
+    if (las_error_is_failure(&las_err))
+    {
+        las_laz_writer_delete(self);
+    }
+    else
+    {
+        *out_writer = self;
+    }
+    return las_err;
+}
+#endif
+
+las_error_t las_laz_writer_new_single(las_dest_t *dest,
+                                      const las_point_format_t point_format,
+                                      las_laz_writer_t **out_writer)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(dest);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_writer);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    las_laz_writer_t *self = calloc(1, sizeof(las_laz_writer_t));
+    if (self == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    self->dest = dest;
+    self->point_format = point_format;
+    self->point_size = las_point_format_point_size(point_format);
+
+    las_err = las_laz_compressor_new(dest, point_format, true, &self->compressor);
+    if (las_error_is_failure(&las_err))
+    {
+        las_laz_writer_delete(self);
+    }
+    else
+    {
+        *out_writer = self;
+    }
+    return las_err;
+}
+
+static las_error_t las_laz_writer_push_entry(las_laz_writer_t *self,
+                                             const las_laz_chunk_entry_t entry)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    if (self->num_entries == self->entries_capacity)
+    {
+        const uint64_t new_capacity =
+            (self->entries_capacity == 0) ? 64 : self->entries_capacity * 2;
+        las_laz_chunk_entry_t *entries =
+            realloc(self->entries, sizeof(las_laz_chunk_entry_t) * new_capacity);
+        if (entries == NULL)
+        {
+            las_err.kind = LAS_ERROR_MEMORY;
+            return las_err;
+        }
+        self->entries = entries;
+        self->entries_capacity = new_capacity;
+    }
+
+    self->entries[self->num_entries++] = entry;
+    return las_err;
+}
+
+/// Waits for the oldest pending chunk, and writes it to the dest
+static las_error_t las_laz_writer_write_oldest(las_laz_writer_t *self)
+{
+    LAS_DEBUG_ASSERT(self->num_pending > 0);
+
+    las_laz_chunk_job_t *job = &self->jobs[self->first_pending];
+    if (self->pool != NULL)
+    {
+        las_thread_pool_wait(self->pool, &job->task);
+    }
+
+    self->first_pending = (self->first_pending + 1) % self->num_jobs;
+    self->num_pending--;
+
+    las_error_t las_err = job->err;
+    if (las_error_is_ok(&las_err))
+    {
+        const las_laz_chunk_entry_t entry = {job->num_points, job->chunk_size};
+        if (las_dest_write(self->dest, job->compressed + job->chunk_start, job->chunk_size) !=
+            job->chunk_size)
+        {
+            las_err = las_dest_err(self->dest);
+        }
+        else
+        {
+            las_err = las_laz_writer_push_entry(self, entry);
+        }
+    }
+
+    free(job->compressed);
+    job->compressed = NULL;
+    job->num_points = 0;
+
+    return las_err;
+}
+
+/// Returns the job that is being filled with points
+static inline las_laz_chunk_job_t *las_laz_writer_filling_job(las_laz_writer_t *self)
+{
+    LAS_DEBUG_ASSERT(self->num_pending < self->num_jobs);
+    return &self->jobs[(self->first_pending + self->num_pending) % self->num_jobs];
+}
+
+/// Starts the compression of the job being filled
+static las_error_t las_laz_writer_submit_filling_job(las_laz_writer_t *self)
+{
+    las_laz_chunk_job_t *job = las_laz_writer_filling_job(self);
+    LAS_DEBUG_ASSERT(job->num_points > 0);
+
+    job->point_format = self->point_format;
+    self->num_pending++;
+
+    if (self->pool != NULL)
+    {
+        job->task.fn = las_laz_chunk_job_run;
+        job->task.arg = job;
+        las_thread_pool_submit(self->pool, &job->task);
+        return (las_error_t){LAS_ERROR_OK};
+    }
+
+    las_laz_chunk_job_run(job);
+    return las_laz_writer_write_oldest(self);
+}
+
+las_error_t
+las_laz_writer_write(las_laz_writer_t *self, const uint8_t *records, uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT(records != NULL || num_points == 0);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    if (self->compressor != NULL)
+    {
+        const uint64_t num_bytes = self->point_size * num_points;
+        return las_lazrs_error(
+            lazrs_compressor_compress_many(self->compressor, records, num_bytes));
+    }
+
+    while (num_points > 0)
+    {
+        if (self->num_pending == self->num_jobs)
+        {
+            las_err = las_laz_writer_write_oldest(self);
+            if (las_error_is_failure(&las_err))
+            {
+                return las_err;
+            }
+        }
+
+        las_laz_chunk_job_t *job = las_laz_writer_filling_job(self);
+        if (job->points == NULL)
+        {
+            job->points = malloc(sizeof(uint8_t) * self->point_size * self->chunk_size);
+            if (job->points == NULL)
+            {
+                las_err.kind = LAS_ERROR_MEMORY;
+                return las_err;
+            }
+        }
+
+        const uint64_t space_left = self->chunk_size - job->num_points;
+        const uint64_t n = (num_points < space_left) ? num_points : space_left;
+        memcpy(job->points + job->num_points * self->point_size, records, n * self->point_size);
+        job->num_points += n;
+        records += n * self->point_size;
+        num_points -= n;
+
+        if (job->num_points == self->chunk_size)
+        {
+            las_err = las_laz_writer_submit_filling_job(self);
+            if (las_error_is_failure(&las_err))
+            {
+                return las_err;
+            }
+        }
+    }
+
+    return las_err;
+}
+
+las_error_t las_laz_writer_finish_chunk(las_laz_writer_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    // lazrs closes its chunks when they are full, and only then
+    if (self->compressor != NULL)
+    {
+        las_err.kind = LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA;
+        return las_err;
+    }
+
+    // When all jobs are pending, none is being filled
+    if (self->num_pending == self->num_jobs)
+    {
+        return las_err;
+    }
+
+    const las_laz_chunk_job_t *job = las_laz_writer_filling_job(self);
+    if (job->num_points == 0)
+    {
+        return las_err;
+    }
+
+    // Full chunks are submitted as soon as they are filled
+    LAS_DEBUG_ASSERT(job->num_points < self->chunk_size);
+    self->is_variable_size = true;
+    return las_laz_writer_submit_filling_job(self);
+}
+
+bool las_laz_writer_is_variable_size(const las_laz_writer_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    return self->is_variable_size;
+}
+
+las_error_t las_laz_writer_done(las_laz_writer_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    if (self->compressor != NULL)
+    {
+        // lazrs writes the last chunk and the chunk table,
+        // the position it leaves the dest at is not documented
+        las_err = las_lazrs_error(lazrs_compressor_done(self->compressor));
+        if (las_error_is_ok(&las_err) && las_dest_seek(self->dest, 0, LAS_SEEK_FROM_END) != 0)
+        {
+            las_err = las_dest_err(self->dest);
+        }
+        return las_err;
+    }
+
+    if (self->num_pending == self->num_jobs)
+    {
+        las_err = las_laz_writer_write_oldest(self);
+        if (las_error_is_failure(&las_err))
+        {
+            return las_err;
+        }
+    }
+
+    // The last chunk may not be full
+    if (las_laz_writer_filling_job(self)->num_points > 0)
+    {
+        las_err = las_laz_writer_submit_filling_job(self);
+        if (las_error_is_failure(&las_err))
+        {
+            return las_err;
+        }
+    }
+
+    while (self->num_pending > 0)
+    {
+        las_err = las_laz_writer_write_oldest(self);
+        if (las_error_is_failure(&las_err))
+        {
+            return las_err;
+        }
+    }
+
+    const int64_t chunk_table_offset = (int64_t)las_dest_tell(self->dest);
+    las_err = las_laz_chunk_table_write_to(
+        self->entries, self->num_entries, self->is_variable_size, self->dest);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    if (las_dest_seek(self->dest, (int64_t)self->start_position, LAS_SEEK_FROM_START) != 0 ||
+        las_dest_write(self->dest, (const uint8_t *)&chunk_table_offset, sizeof(int64_t)) !=
+            sizeof(int64_t) ||
+        las_dest_seek(self->dest, 0, LAS_SEEK_FROM_END) != 0)
+    {
+        return las_dest_err(self->dest);
+    }
+
+    return las_err;
+}
+
+void las_laz_writer_delete(las_laz_writer_t *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    if (self->compressor != NULL)
+    {
+        lazrs_compressor_delete(self->compressor);
+    }
+
+    // Waits for the chunks still being compressed
+    las_thread_pool_delete(self->pool);
+
+    if (self->jobs != NULL)
+    {
+        for (uint32_t i = 0; i < self->num_jobs; ++i)
+        {
+            free(self->jobs[i].points);
+            free(self->jobs[i].compressed);
+        }
+        free(self->jobs);
+    }
+    free(self->entries);
+    free(self);
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "private/point.h"
 #include "private/macro.h"
+#include "private/quantize.h"
 #include "private/source.h"
 #include "private/utils.h"
 
@@ -9,28 +10,29 @@
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define BASE_POINT10_SIZE 20
 // remove the gps for `las_point_standard_size` to work
 #define BASE_POINT14_SIZE (30 - sizeof(double))
 
-static int has_gps_time(const uint8_t point_format_id)
+static inline int has_gps_time(const uint8_t point_format_id)
 {
     return point_format_id == 3 || point_format_id == 1 || point_format_id >= 6;
 }
 
-static int has_rgb(const uint8_t point_format_id)
+static inline int has_rgb(const uint8_t point_format_id)
 {
     return point_format_id == 3 || point_format_id == 2 || point_format_id == 5 ||
            point_format_id == 7 || point_format_id == 8 || point_format_id == 10;
 }
 
-static int has_nir(const uint8_t point_format_id)
+static inline int has_nir(const uint8_t point_format_id)
 {
     return point_format_id == 8 || point_format_id == 10;
 }
 
-static int has_waveform(const uint8_t point_format_id)
+static inline int has_waveform(const uint8_t point_format_id)
 {
     return point_format_id == 4 || point_format_id == 5 || point_format_id == 9 ||
            point_format_id == 10;
@@ -150,6 +152,231 @@ void las_raw_point_deinit(las_raw_point_t *point)
     }
 }
 
+/// Sets where the extra bytes of the point are, whatever its format
+static inline void las_raw_point_set_extra_bytes(las_raw_point_t *point,
+                                                 const uint16_t num_extra_bytes,
+                                                 uint8_t *extra_bytes)
+{
+    if (point->point_format_id <= 5)
+    {
+        point->point10.num_extra_bytes = num_extra_bytes;
+        point->point10.extra_bytes = extra_bytes;
+    }
+    else
+    {
+        point->point14.num_extra_bytes = num_extra_bytes;
+        point->point14.extra_bytes = extra_bytes;
+    }
+}
+
+void las_raw_point_prepare_slab(las_raw_point_t *points,
+                                const uint64_t num_points,
+                                const las_point_format_t point_format)
+{
+    LAS_DEBUG_ASSERT(points != NULL || num_points == 0);
+
+    const uint16_t num_extra_bytes = point_format.num_extra_bytes;
+    uint8_t *slab = NULL;
+    if (num_extra_bytes != 0 && num_points != 0)
+    {
+        slab = calloc(num_points, num_extra_bytes);
+        LAS_ASSERT_M(slab != NULL, "out of memory");
+    }
+
+    memset(points, 0, sizeof(las_raw_point_t) * num_points);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        points[i].point_format_id = point_format.id;
+        las_raw_point_set_extra_bytes(
+            &points[i], num_extra_bytes, slab == NULL ? NULL : slab + i * num_extra_bytes);
+    }
+}
+
+void las_raw_point_deinit_slab(las_raw_point_t *points, const uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT(points != NULL || num_points == 0);
+
+    if (num_points == 0)
+    {
+        return;
+    }
+
+    // The slab starts at the extra bytes of the first point
+    const las_raw_point_t *first = &points[0];
+    uint8_t *slab =
+        first->point_format_id <= 5 ? first->point10.extra_bytes : first->point14.extra_bytes;
+    free(slab);
+
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        las_raw_point_set_extra_bytes(&points[i], 0, NULL);
+    }
+}
+
+_Static_assert(sizeof(las_packed_point_t) == 48, "packed points must stay compact");
+
+void las_packed_point_from_raw_many(const las_raw_point_t *points,
+                                    const uint64_t num_points,
+                                    las_packed_point_t *packed_points,
+                                    uint8_t *extra_bytes)
+{
+    LAS_DEBUG_ASSERT(points != NULL || num_points == 0);
+    LAS_DEBUG_ASSERT(packed_points != NULL || num_points == 0);
+
+    uint64_t extra_bytes_offset = 0;
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        const las_raw_point_t *point = &points[i];
+        las_packed_point_t *packed = &packed_points[i];
+        memset(packed, 0, sizeof(las_packed_point_t));
+
+        uint16_t num_extra_bytes;
+        const uint8_t *point_extra_bytes;
+        if (point->point_format_id <= 5)
+        {
+            const las_raw_point_10_t *p = &point->point10;
+            packed->x = p->x;
+            packed->y = p->y;
+            packed->z = p->z;
+            packed->intensity = p->intensity;
+            packed->return_number = p->return_number;
+            packed->number_of_returns = p->number_of_returns;
+            packed->classification = p->classification;
+            packed->flags =
+                (uint8_t)((p->synthetic ? LAS_PACKED_POINT_SYNTHETIC : 0) |
+                          (p->key_point ? LAS_PACKED_POINT_KEY_POINT : 0) |
+                          (p->withheld ? LAS_PACKED_POINT_WITHHELD : 0) |
+                          (p->scan_direction_flag ? LAS_PACKED_POINT_SCAN_DIRECTION : 0) |
+                          (p->edge_of_flight_line ? LAS_PACKED_POINT_EDGE_OF_FLIGHT_LINE : 0));
+            packed->user_data = p->user_data;
+            packed->scan_angle = p->scan_angle_rank;
+            packed->point_source_id = p->point_source_id;
+            packed->gps_time = p->gps_time;
+            packed->red = p->red;
+            packed->green = p->green;
+            packed->blue = p->blue;
+            num_extra_bytes = p->num_extra_bytes;
+            point_extra_bytes = p->extra_bytes;
+        }
+        else
+        {
+            const las_raw_point_14_t *p = &point->point14;
+            packed->x = p->x;
+            packed->y = p->y;
+            packed->z = p->z;
+            packed->intensity = p->intensity;
+            packed->return_number = p->return_number;
+            packed->number_of_returns = p->number_of_returns;
+            packed->classification = p->classification;
+            packed->flags =
+                (uint8_t)((p->synthetic ? LAS_PACKED_POINT_SYNTHETIC : 0) |
+                          (p->key_point ? LAS_PACKED_POINT_KEY_POINT : 0) |
+                          (p->withheld ? LAS_PACKED_POINT_WITHHELD : 0) |
+                          (p->overlap ? LAS_PACKED_POINT_OVERLAP : 0) |
+                          (p->scan_direction_flag ? LAS_PACKED_POINT_SCAN_DIRECTION : 0) |
+                          (p->edge_of_flight_line ? LAS_PACKED_POINT_EDGE_OF_FLIGHT_LINE : 0));
+            packed->user_data = p->user_data;
+            packed->scanner_channel = p->scanner_channel;
+            packed->scan_angle = p->scan_angle;
+            packed->point_source_id = p->point_source_id;
+            packed->gps_time = p->gps_time;
+            packed->red = p->red;
+            packed->green = p->green;
+            packed->blue = p->blue;
+            packed->nir = p->nir;
+            num_extra_bytes = p->num_extra_bytes;
+            point_extra_bytes = p->extra_bytes;
+        }
+
+        LAS_DEBUG_ASSERT(extra_bytes_offset <= UINT32_MAX);
+        packed->extra_bytes_offset = (uint32_t)extra_bytes_offset;
+        if (num_extra_bytes != 0 && point_extra_bytes != NULL)
+        {
+            LAS_DEBUG_ASSERT_NOT_NULL(extra_bytes);
+            memcpy(extra_bytes + extra_bytes_offset, point_extra_bytes, num_extra_bytes);
+        }
+        extra_bytes_offset += num_extra_bytes;
+    }
+}
+
+void las_packed_point_to_raw_many(const las_packed_point_t *packed_points,
+                                  const uint64_t num_points,
+                                  const uint8_t *extra_bytes,
+                                  las_raw_point_t *points)
+{
+    LAS_DEBUG_ASSERT(points != NULL || num_points == 0);
+    LAS_DEBUG_ASSERT(packed_points != NULL || num_points == 0);
+
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        const las_packed_point_t *packed = &packed_points[i];
+        las_raw_point_t *point = &points[i];
+        const uint8_t flags = packed->flags;
+
+        uint16_t num_extra_bytes;
+        uint8_t *point_extra_bytes;
+        if (point->point_format_id <= 5)
+        {
+            las_raw_point_10_t *p = &point->point10;
+            p->x = packed->x;
+            p->y = packed->y;
+            p->z = packed->z;
+            p->intensity = packed->intensity;
+            p->return_number = packed->return_number & 0b111;
+            p->number_of_returns = packed->number_of_returns & 0b111;
+            p->scan_direction_flag = (flags & LAS_PACKED_POINT_SCAN_DIRECTION) != 0;
+            p->edge_of_flight_line = (flags & LAS_PACKED_POINT_EDGE_OF_FLIGHT_LINE) != 0;
+            p->classification = packed->classification & 0b11111;
+            p->synthetic = (flags & LAS_PACKED_POINT_SYNTHETIC) != 0;
+            p->key_point = (flags & LAS_PACKED_POINT_KEY_POINT) != 0;
+            p->withheld = (flags & LAS_PACKED_POINT_WITHHELD) != 0;
+            p->scan_angle_rank = (uint8_t)(packed->scan_angle & 0xFF);
+            p->user_data = packed->user_data;
+            p->point_source_id = packed->point_source_id;
+            p->gps_time = packed->gps_time;
+            p->red = packed->red;
+            p->green = packed->green;
+            p->blue = packed->blue;
+            num_extra_bytes = p->num_extra_bytes;
+            point_extra_bytes = p->extra_bytes;
+        }
+        else
+        {
+            las_raw_point_14_t *p = &point->point14;
+            p->x = packed->x;
+            p->y = packed->y;
+            p->z = packed->z;
+            p->intensity = packed->intensity;
+            p->return_number = packed->return_number & 0b1111;
+            p->number_of_returns = packed->number_of_returns & 0b1111;
+            p->synthetic = (flags & LAS_PACKED_POINT_SYNTHETIC) != 0;
+            p->key_point = (flags & LAS_PACKED_POINT_KEY_POINT) != 0;
+            p->withheld = (flags & LAS_PACKED_POINT_WITHHELD) != 0;
+            p->overlap = (flags & LAS_PACKED_POINT_OVERLAP) != 0;
+            p->scanner_channel = packed->scanner_channel & 0b11;
+            p->scan_direction_flag = (flags & LAS_PACKED_POINT_SCAN_DIRECTION) != 0;
+            p->edge_of_flight_line = (flags & LAS_PACKED_POINT_EDGE_OF_FLIGHT_LINE) != 0;
+            p->classification = packed->classification;
+            p->user_data = packed->user_data;
+            p->scan_angle = packed->scan_angle;
+            p->point_source_id = packed->point_source_id;
+            p->gps_time = packed->gps_time;
+            p->red = packed->red;
+            p->green = packed->green;
+            p->blue = packed->blue;
+            p->nir = packed->nir;
+            num_extra_bytes = p->num_extra_bytes;
+            point_extra_bytes = p->extra_bytes;
+        }
+
+        if (num_extra_bytes != 0 && point_extra_bytes != NULL)
+        {
+            LAS_DEBUG_ASSERT_NOT_NULL(extra_bytes);
+            memcpy(point_extra_bytes, extra_bytes + packed->extra_bytes_offset, num_extra_bytes);
+        }
+    }
+}
+
 void las_wave_packet_from_buffer(const uint8_t *buffer, las_wave_packet_t *wave_packet)
 {
     LAS_DEBUG_ASSERT(buffer != NULL);
@@ -182,9 +409,9 @@ void las_wave_packet_to_buffer(const las_wave_packet_t *wave_packet, uint8_t *bu
     write_intog(&wtr, &wave_packet->zt);
 }
 
-void las_raw_point_10_from_buffer(const uint8_t *buffer,
-                                  const las_point_format_t point_format,
-                                  las_raw_point_10_t *point10)
+static LAS_ALWAYS_INLINE void las_raw_point_10_decode(const uint8_t *buffer,
+                                                      const las_point_format_t point_format,
+                                                      las_raw_point_10_t *point10)
 {
     LAS_DEBUG_ASSERT(buffer != NULL);
     LAS_DEBUG_ASSERT(point10 != NULL);
@@ -203,7 +430,7 @@ void las_raw_point_10_from_buffer(const uint8_t *buffer,
     read_intog(&rdr, &packed);
     point10->return_number       = packed  & 0b00000111;
     point10->number_of_returns   = (packed & 0b00111000) >> 3;
-    point10->scan_angle_rank     = (packed & 0b01000000) >> 6;
+    point10->scan_direction_flag = (packed & 0b01000000) >> 6;
     point10->edge_of_flight_line = (packed & 0b10000000) >> 7;
 
     read_intog(&rdr, &packed);
@@ -245,9 +472,9 @@ void las_raw_point_10_from_buffer(const uint8_t *buffer,
     // LAS_DEBUG_ASSERT((rdr.ptr - buffer) == (uint64_t)header->point_size);
 }
 
-void las_raw_point_10_to_buffer(const las_raw_point_10_t *point10,
-                                const las_point_format_t point_format,
-                                uint8_t *buffer)
+static LAS_ALWAYS_INLINE void las_raw_point_10_encode(const las_raw_point_10_t *point10,
+                                                      const las_point_format_t point_format,
+                                                      uint8_t *buffer)
 {
     LAS_DEBUG_ASSERT_NOT_NULL(point10);
     LAS_DEBUG_ASSERT_NOT_NULL(buffer);
@@ -265,7 +492,7 @@ void las_raw_point_10_to_buffer(const las_raw_point_10_t *point10,
     uint8_t packed = 0;
     packed |= point10->return_number;
     packed |= point10->number_of_returns << 3;
-    packed |= point10->scan_angle_rank << 6;
+    packed |= point10->scan_direction_flag << 6;
     packed |= point10->edge_of_flight_line << 7;
     write_intog(wtr, (const uint8_t*)&packed);
 
@@ -309,9 +536,9 @@ void las_raw_point_10_to_buffer(const las_raw_point_10_t *point10,
     LAS_DEBUG_ASSERT((wtr->ptr - buffer) == (uint64_t)las_point_format_point_size(point_format));
 }
 
-void las_raw_point_14_from_buffer(const uint8_t *buffer,
-                                  const las_point_format_t point_format,
-                                  las_raw_point_14_t *point14)
+static LAS_ALWAYS_INLINE void las_raw_point_14_decode(const uint8_t *buffer,
+                                                      const las_point_format_t point_format,
+                                                      las_raw_point_14_t *point14)
 {
     LAS_DEBUG_ASSERT(buffer != NULL);
     LAS_DEBUG_ASSERT(point14 != NULL);
@@ -383,10 +610,9 @@ void las_raw_point_14_from_buffer(const uint8_t *buffer,
     LAS_DEBUG_ASSERT((rdr.ptr - buffer) == (uint64_t)las_point_format_point_size(point_format));
 }
 
-void las_raw_point_14_to_buffer(const las_raw_point_14_t *point14,
-                                const las_point_format_t point_format,
-                                uint8_t *buffer)
-
+static LAS_ALWAYS_INLINE void las_raw_point_14_encode(const las_raw_point_14_t *point14,
+                                                      const las_point_format_t point_format,
+                                                      uint8_t *buffer)
 {
     LAS_DEBUG_ASSERT(buffer != NULL);
     LAS_DEBUG_ASSERT(point14 != NULL);
@@ -456,97 +682,402 @@ void las_raw_point_14_to_buffer(const las_raw_point_14_t *point14,
     LAS_DEBUG_ASSERT((wtr->ptr - buffer) == (uint64_t)las_point_format_point_size(point_format));
 }
 
-void las_raw_point_copy_from_point(las_raw_point_t *self,
-                                   const las_point_t *point,
-                                   const las_scaling_t scaling)
+void las_raw_point_10_from_buffer(const uint8_t *buffer,
+                                  const las_point_format_t point_format,
+                                  las_raw_point_10_t *point10)
+{
+    las_raw_point_10_decode(buffer, point_format, point10);
+}
+
+void las_raw_point_10_to_buffer(const las_raw_point_10_t *point10,
+                                const las_point_format_t point_format,
+                                uint8_t *buffer)
+{
+    las_raw_point_10_encode(point10, point_format, buffer);
+}
+
+void las_raw_point_14_from_buffer(const uint8_t *buffer,
+                                  const las_point_format_t point_format,
+                                  las_raw_point_14_t *point14)
+{
+    las_raw_point_14_decode(buffer, point_format, point14);
+}
+
+void las_raw_point_14_to_buffer(const las_raw_point_14_t *point14,
+                                const las_point_format_t point_format,
+                                uint8_t *buffer)
+{
+    las_raw_point_14_encode(point14, point_format, buffer);
+}
+
+/// Defines the decoder and encoder of point format `id`
+///
+/// The format id is a constant in their body, so once the generic
+/// decode / encode functions are inlined, the checks for optional
+/// fields (gps time, rgb, ...) are resolved at compile time.
+/// `kind` is 10 or 14, the raw point struct the format uses.
+#define LAS_DEFINE_POINT_CODECS(id, kind)                                                          \
+    static void las_raw_point_decode_many_##id(const uint8_t *records,                             \
+                                               const las_point_format_t point_format,              \
+                                               las_raw_point_t *points,                            \
+                                               const uint64_t num_points)                          \
+    {                                                                                              \
+        const las_point_format_t format = {id, point_format.num_extra_bytes};                     \
+        const uint16_t point_size = las_point_format_point_size(format);                          \
+        for (uint64_t i = 0; i < num_points; ++i)                                                  \
+        {                                                                                          \
+            las_raw_point_##kind##_decode(records, format, &points[i].point##kind);                \
+            records += point_size;                                                                 \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static void las_raw_point_encode_many_##id(const las_raw_point_t *points,                      \
+                                               const uint64_t num_points,                          \
+                                               const las_point_format_t point_format,              \
+                                               uint8_t *records)                                   \
+    {                                                                                              \
+        const las_point_format_t format = {id, point_format.num_extra_bytes};                     \
+        const uint16_t point_size = las_point_format_point_size(format);                          \
+        for (uint64_t i = 0; i < num_points; ++i)                                                  \
+        {                                                                                          \
+            las_raw_point_##kind##_encode(&points[i].point##kind, format, records);                \
+            records += point_size;                                                                 \
+        }                                                                                          \
+    }
+
+LAS_DEFINE_POINT_CODECS(0, 10)
+LAS_DEFINE_POINT_CODECS(1, 10)
+LAS_DEFINE_POINT_CODECS(2, 10)
+LAS_DEFINE_POINT_CODECS(3, 10)
+LAS_DEFINE_POINT_CODECS(4, 10)
+LAS_DEFINE_POINT_CODECS(5, 10)
+LAS_DEFINE_POINT_CODECS(6, 14)
+LAS_DEFINE_POINT_CODECS(7, 14)
+LAS_DEFINE_POINT_CODECS(8, 14)
+LAS_DEFINE_POINT_CODECS(9, 14)
+LAS_DEFINE_POINT_CODECS(10, 14)
+
+las_raw_point_decode_many_fn las_raw_point_select_decode_many_fn(const uint8_t point_format_id)
+{
+    static const las_raw_point_decode_many_fn decoders[11] = {
+        las_raw_point_decode_many_0,
+        las_raw_point_decode_many_1,
+        las_raw_point_decode_many_2,
+        las_raw_point_decode_many_3,
+        las_raw_point_decode_many_4,
+        las_raw_point_decode_many_5,
+        las_raw_point_decode_many_6,
+        las_raw_point_decode_many_7,
+        las_raw_point_decode_many_8,
+        las_raw_point_decode_many_9,
+        las_raw_point_decode_many_10,
+    };
+    LAS_ASSERT(point_format_id <= 10);
+    return decoders[point_format_id];
+}
+
+las_raw_point_encode_many_fn las_raw_point_select_encode_many_fn(const uint8_t point_format_id)
+{
+    static const las_raw_point_encode_many_fn encoders[11] = {
+        las_raw_point_encode_many_0,
+        las_raw_point_encode_many_1,
+        las_raw_point_encode_many_2,
+        las_raw_point_encode_many_3,
+        las_raw_point_encode_many_4,
+        las_raw_point_encode_many_5,
+        las_raw_point_encode_many_6,
+        las_raw_point_encode_many_7,
+        las_raw_point_encode_many_8,
+        las_raw_point_encode_many_9,
+        las_raw_point_encode_many_10,
+    };
+    LAS_ASSERT(point_format_id <= 10);
+    return encoders[point_format_id];
+}
+
+void las_point_to_buffer_without_xyz(const las_point_t *point,
+                                     const las_point_format_t point_format,
+                                     uint8_t *buffer)
 {
-    LAS_DEBUG_ASSERT_NOT_NULL(self);
     LAS_DEBUG_ASSERT_NOT_NULL(point);
+    LAS_DEBUG_ASSERT_NOT_NULL(buffer);
 
-    if (self->point_format_id <= 5)
+    buffer_writer_t wtr_s = {buffer + 3 * sizeof(int32_t)};
+    buffer_writer_t *wtr = &wtr_s;
+
+    write_intog(wtr, &point->intensity);
+
+    // clang-format off
+    uint8_t packed = 0;
+    if (point_format.id <= 5)
     {
-        las_raw_point_10_t *rp = &self->point10;
-        LAS_DEBUG_ASSERT(rp->num_extra_bytes == rp->num_extra_bytes);
+        packed |= point->return_number & 0b00000111;
+        packed |= (point->number_of_returns & 0b00000111) << 3;
+        packed |= point->scan_direction_flag << 6;
+        packed |= point->edge_of_flight_line << 7;
+        write_intog(wtr, (const uint8_t*)&packed);
+
+        packed = 0;
+        packed |= point->classification & 0b00011111;
+        packed |= point->synthetic << 5;
+        packed |= point->key_point << 6;
+        packed |= point->withheld << 7;
+        write_intog(wtr, (const uint8_t*)&packed);
+
+        packed = (uint8_t)(point->scan_angle & 0b11111111);
+        write_intog(wtr, (const uint8_t*)&packed);
+        write_intog(wtr, &point->user_data);
+    }
+    else
+    {
+        packed |= point->return_number;
+        packed |= point->number_of_returns << 4;
+        write_intog(wtr, (const uint8_t*)&packed);
+
+        packed = 0;
+        packed |= point->synthetic;
+        packed |= point->key_point << 1;
+        packed |= point->withheld << 2;
+        packed |= point->overlap << 3;
+        packed |= point->scanner_channel << 4;
+        packed |= point->scan_direction_flag << 6;
+        packed |= point->edge_of_flight_line << 7;
+        write_intog(wtr, (const uint8_t*)&packed);
+
+        write_intog(wtr, &point->classification);
+        write_intog(wtr, &point->user_data);
+        write_intog(wtr, &point->scan_angle);
+    }
+    // clang-format on
 
-        rp->x = las_scaling_unapply_x(scaling, point->x);
-        rp->y = las_scaling_unapply_y(scaling, point->x);
-        rp->z = las_scaling_unapply_z(scaling, point->z);
+    write_intog(wtr, &point->point_source_id);
 
-        rp->intensity = point->intensity;
+    if (has_gps_time(point_format.id))
+    {
+        write_intog(wtr, &point->gps_time);
+    }
 
-        rp->return_number = point->return_number & 0b00000111;
-        rp->number_of_returns = point->number_of_returns & 0b00000111;
+    if (has_rgb(point_format.id))
+    {
+        write_intog(wtr, &point->red);
+        write_intog(wtr, &point->green);
+        write_intog(wtr, &point->blue);
+    }
 
-        rp->scan_direction_flag = point->scan_direction_flag;
-        rp->edge_of_flight_line = point->edge_of_flight_line;
+    if (has_nir(point_format.id))
+    {
+        write_intog(wtr, &point->nir);
+    }
 
-        rp->classification = point->classification & UINT8_C(0b00011111);
-        rp->synthetic = point->synthetic;
-        rp->key_point = point->key_point;
-        rp->withheld = point->withheld;
+    if (has_waveform(point_format.id))
+    {
+        las_wave_packet_to_buffer(&point->wave_packet, wtr->ptr);
+        wtr->ptr += LAS_WAVE_PACKET_SIZE;
+    }
+
+    LAS_DEBUG_ASSERT((wtr->ptr - buffer) == las_point_standard_size(point_format.id));
+    if (point->extra_bytes != NULL)
+    {
+        LAS_DEBUG_ASSERT(point->num_extra_bytes == point_format.num_extra_bytes);
+        write_into(wtr, point->extra_bytes, point_format.num_extra_bytes);
+    }
+    else
+    {
+        memset(wtr->ptr, 0, point_format.num_extra_bytes);
+    }
+}
 
-        rp->scan_angle_rank = (uint8_t)(point->scan_angle & 0b11111111);
-        rp->user_data = point->user_data;
-        rp->point_source_id = point->point_source_id;
+/// Copies all the fields but the coordinates of `point` into a point of format 0-5
+static LAS_ALWAYS_INLINE void las_raw_point_10_copy_fields_from_point(las_raw_point_10_t *rp,
+                                                                      const las_point_t *point)
+{
+    rp->intensity = point->intensity;
 
-        rp->gps_time = point->gps_time;
+    rp->return_number = point->return_number & 0b00000111;
+    rp->number_of_returns = point->number_of_returns & 0b00000111;
 
-        rp->red = point->red;
-        rp->green = point->green;
-        rp->blue = point->blue;
+    rp->scan_direction_flag = point->scan_direction_flag;
+    rp->edge_of_flight_line = point->edge_of_flight_line;
 
-        rp->wave_packet = point->wave_packet;
+    rp->classification = point->classification & UINT8_C(0b00011111);
+    rp->synthetic = point->synthetic;
+    rp->key_point = point->key_point;
+    rp->withheld = point->withheld;
 
-        if (rp->extra_bytes != NULL)
-        {
-            LAS_DEBUG_ASSERT(rp->extra_bytes != NULL)
-            memcpy(rp->extra_bytes, point->extra_bytes, point->num_extra_bytes);
-        }
+    rp->scan_angle_rank = (uint8_t)(point->scan_angle & 0b11111111);
+    rp->user_data = point->user_data;
+    rp->point_source_id = point->point_source_id;
+
+    rp->gps_time = point->gps_time;
+
+    rp->red = point->red;
+    rp->green = point->green;
+    rp->blue = point->blue;
+
+    rp->wave_packet = point->wave_packet;
+
+    if (rp->extra_bytes != NULL)
+    {
+        LAS_DEBUG_ASSERT(rp->extra_bytes != NULL)
+        memcpy(rp->extra_bytes, point->extra_bytes, point->num_extra_bytes);
     }
-    else
+}
+
+/// Copies all the fields but the coordinates of `point` into a point of format 6-10
+static LAS_ALWAYS_INLINE void las_raw_point_14_copy_fields_from_point(las_raw_point_14_t *rp,
+                                                                      const las_point_t *point)
+{
+    LAS_DEBUG_ASSERT(rp->num_extra_bytes == point->num_extra_bytes);
+
+    rp->intensity = point->intensity;
+
+    rp->return_number = point->return_number & 0b00001111;
+    rp->number_of_returns = point->number_of_returns & 0b00001111;
+
+    rp->synthetic = point->synthetic;
+    rp->key_point = point->key_point;
+    rp->withheld = point->withheld;
+    rp->overlap = point->overlap;
+    rp->scanner_channel = point->scanner_channel;
+    rp->scan_direction_flag = point->scan_direction_flag;
+    rp->edge_of_flight_line = point->edge_of_flight_line;
+
+    rp->classification = point->classification;
+    rp->user_data = point->user_data;
+    rp->scan_angle = point->scan_angle;
+    rp->point_source_id = point->point_source_id;
+
+    rp->gps_time = point->gps_time;
+
+    rp->red = point->red;
+    rp->green = point->green;
+    rp->blue = point->blue;
+
+    rp->nir = point->nir;
+
+    rp->wave_packet = point->wave_packet;
+
+    if (rp->extra_bytes != NULL)
     {
-        las_raw_point_14_t *rp = &self->point14;
-        LAS_DEBUG_ASSERT(rp->num_extra_bytes == point->num_extra_bytes);
+        LAS_DEBUG_ASSERT(rp->extra_bytes != NULL)
+        memcpy(rp->extra_bytes, point->extra_bytes, point->num_extra_bytes);
+    }
+}
+
+void las_raw_point_copy_from_point(las_raw_point_t *self,
+                                   const las_point_t *point,
+                                   const las_scaling_t scaling)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(point);
+
+    if (self->point_format_id <= 5)
+    {
+        las_raw_point_10_t *rp = &self->point10;
 
         rp->x = las_scaling_unapply_x(scaling, point->x);
-        rp->y = las_scaling_unapply_y(scaling, point->x);
+        rp->y = las_scaling_unapply_y(scaling, point->y);
         rp->z = las_scaling_unapply_z(scaling, point->z);
 
-        rp->intensity = point->intensity;
+        las_raw_point_10_copy_fields_from_point(rp, point);
+    }
+    else
+    {
+        las_raw_point_14_t *rp = &self->point14;
 
-        rp->return_number = point->return_number & 0b00001111;
-        rp->number_of_returns = point->number_of_returns & 0b00001111;
+        rp->x = las_scaling_unapply_x(scaling, point->x);
+        rp->y = las_scaling_unapply_y(scaling, point->y);
+        rp->z = las_scaling_unapply_z(scaling, point->z);
 
-        rp->synthetic = point->synthetic;
-        rp->key_point = point->key_point;
-        rp->withheld = point->withheld;
-        rp->overlap = point->overlap;
-        rp->scanner_channel = point->scanner_channel;
-        rp->scan_direction_flag = point->scan_direction_flag;
-        rp->edge_of_flight_line = point->edge_of_flight_line;
+        las_raw_point_14_copy_fields_from_point(rp, point);
+    }
+}
 
-        rp->classification = point->classification;
-        rp->user_data = point->user_data;
-        rp->classification = point->classification;
-        rp->scan_angle = point->scan_angle;
-        rp->point_source_id = point->point_source_id;
+void las_raw_point_copy_many_from_point(las_raw_point_t *raw_points,
+                                        const las_point_t *points,
+                                        const uint64_t num_points,
+                                        const las_scaling_t scaling)
+{
+    if (num_points == 0)
+    {
+        return;
+    }
+    LAS_DEBUG_ASSERT_NOT_NULL(raw_points);
+    LAS_DEBUG_ASSERT_NOT_NULL(points);
 
-        rp->gps_time = point->gps_time;
+    int32_t *x, *y, *z;
+    if (raw_points[0].point_format_id <= 5)
+    {
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            LAS_DEBUG_ASSERT(raw_points[i].point_format_id <= 5);
+            las_raw_point_10_copy_fields_from_point(&raw_points[i].point10, &points[i]);
+        }
+        x = &raw_points[0].point10.x;
+        y = &raw_points[0].point10.y;
+        z = &raw_points[0].point10.z;
+    }
+    else
+    {
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            LAS_DEBUG_ASSERT(raw_points[i].point_format_id > 5);
+            las_raw_point_14_copy_fields_from_point(&raw_points[i].point14, &points[i]);
+        }
+        x = &raw_points[0].point14.x;
+        y = &raw_points[0].point14.y;
+        z = &raw_points[0].point14.z;
+    }
 
-        rp->red = point->red;
-        rp->green = point->green;
-        rp->blue = point->blue;
+    const las_quantize_fn quantize = las_quantize_select_fn();
+    const size_t point_stride = sizeof(las_point_t) / sizeof(double);
+    quantize(&points[0].x,
+             point_stride,
+             num_points,
+             scaling.scales.x,
+             scaling.offsets.x,
+             (uint8_t *)x,
+             sizeof(las_raw_point_t));
+    quantize(&points[0].y,
+             point_stride,
+             num_points,
+             scaling.scales.y,
+             scaling.offsets.y,
+             (uint8_t *)y,
+             sizeof(las_raw_point_t));
+    quantize(&points[0].z,
+             point_stride,
+             num_points,
+             scaling.scales.z,
+             scaling.offsets.z,
+             (uint8_t *)z,
+             sizeof(las_raw_point_t));
+}
 
-        rp->nir = point->nir;
+/// Size of a step of the scan angle of formats 6 to 10, in degrees
+#define LAS_SCAN_ANGLE_STEP 0.006
 
-        rp->wave_packet = point->wave_packet;
+uint16_t las_scan_angle_from_rank(const uint8_t scan_angle_rank)
+{
+    const double steps = (int8_t)scan_angle_rank / LAS_SCAN_ANGLE_STEP;
+    // |steps| <= 128 / 0.006 which fits in 16 bits
+    const int16_t scan_angle = (int16_t)((steps >= 0.0) ? steps + 0.5 : steps - 0.5);
+    return (uint16_t)scan_angle;
+}
 
-        if (rp->extra_bytes != NULL)
-        {
-            LAS_DEBUG_ASSERT(rp->extra_bytes != NULL)
-            memcpy(rp->extra_bytes, point->extra_bytes, point->num_extra_bytes);
-        }
+uint8_t las_scan_angle_to_rank(const uint16_t scan_angle)
+{
+    double degrees = (int16_t)scan_angle * LAS_SCAN_ANGLE_STEP;
+    if (degrees > 90.0)
+    {
+        degrees = 90.0;
+    }
+    else if (degrees < -90.0)
+    {
+        degrees = -90.0;
     }
+    const int8_t rank = (int8_t)((degrees >= 0.0) ? degrees + 0.5 : degrees - 0.5);
+    return (uint8_t)rank;
 }
 
 void las_raw_point_copy_from_raw(las_raw_point_t *restrict dest,
@@ -562,15 +1093,16 @@ void las_raw_point_copy_from_raw(las_raw_point_t *restrict dest,
         const las_raw_point_10_t *s = &source->point10;
         LAS_DEBUG_ASSERT(d->num_extra_bytes == s->num_extra_bytes);
 
+        // The struct copy would make dest point to the source's extra bytes
+        uint8_t *extra_bytes = d->extra_bytes;
         *d = *s;
+        d->extra_bytes = extra_bytes;
 
         if (s->num_extra_bytes)
         {
             LAS_DEBUG_ASSERT_NOT_NULL(d->extra_bytes);
             LAS_DEBUG_ASSERT_NOT_NULL(s->extra_bytes);
             memcpy(d->extra_bytes, s->extra_bytes, sizeof(uint8_t) * s->num_extra_bytes);
-            uint8_t *eb = d->extra_bytes;
-            d->extra_bytes = eb;
         }
     }
     else if (dest->point_format_id >= 6 && source->point_format_id >= 6)
@@ -580,15 +1112,16 @@ void las_raw_point_copy_from_raw(las_raw_point_t *restrict dest,
         const las_raw_point_14_t *s = &source->point14;
         LAS_DEBUG_ASSERT(d->num_extra_bytes == s->num_extra_bytes);
 
+        // The struct copy would make dest point to the source's extra bytes
+        uint8_t *extra_bytes = d->extra_bytes;
         *d = *s;
+        d->extra_bytes = extra_bytes;
 
         if (s->num_extra_bytes)
         {
             LAS_DEBUG_ASSERT_NOT_NULL(d->extra_bytes);
             LAS_DEBUG_ASSERT_NOT_NULL(s->extra_bytes);
             memcpy(d->extra_bytes, s->extra_bytes, sizeof(uint8_t) * s->num_extra_bytes);
-            uint8_t *eb = d->extra_bytes;
-            d->extra_bytes = eb;
         }
     }
     else if (dest->point_format_id <= 5 && source->point_format_id >= 6)
@@ -614,7 +1147,7 @@ void las_raw_point_copy_from_raw(las_raw_point_t *restrict dest,
         d->key_point = s->key_point;
         d->withheld = s->withheld;
 
-        d->scan_angle_rank = (uint8_t)s->scan_angle;
+        d->scan_angle_rank = las_scan_angle_to_rank(s->scan_angle);
         d->user_data = s->user_data;
         d->point_source_id = s->point_source_id;
 
@@ -659,7 +1192,7 @@ void las_raw_point_copy_from_raw(las_raw_point_t *restrict dest,
 
         d->classification = s->classification;
         d->user_data = s->user_data;
-        d->scan_angle = (uint16_t)s->scan_angle_rank;
+        d->scan_angle = las_scan_angle_from_rank(s->scan_angle_rank);
         d->point_source_id = s->point_source_id;
 
         d->gps_time = s->gps_time;
@@ -679,6 +1212,85 @@ void las_raw_point_copy_from_raw(las_raw_point_t *restrict dest,
     }
 }
 
+/// Copies all the fields but the coordinates of a point of format 0-5 into `self`
+static LAS_ALWAYS_INLINE void las_point_copy_fields_from_raw_10(las_point_t *self,
+                                                                const las_raw_point_10_t *rp)
+{
+    LAS_DEBUG_ASSERT(self->num_extra_bytes == rp->num_extra_bytes);
+
+    self->intensity = rp->intensity;
+
+    self->return_number = rp->return_number;
+    self->number_of_returns = rp->number_of_returns;
+
+    self->scan_direction_flag = rp->scan_direction_flag;
+    self->edge_of_flight_line = rp->edge_of_flight_line;
+
+    self->classification = rp->classification;
+    self->synthetic = rp->synthetic;
+    self->key_point = rp->key_point;
+    self->withheld = rp->withheld;
+
+    self->scan_angle = rp->scan_angle_rank;
+    self->user_data = rp->user_data;
+    self->point_source_id = rp->point_source_id;
+
+    self->gps_time = rp->gps_time;
+
+    self->red = rp->red;
+    self->green = rp->green;
+    self->blue = rp->blue;
+
+    self->wave_packet = rp->wave_packet;
+
+    if (rp->extra_bytes != NULL)
+    {
+        LAS_DEBUG_ASSERT(self->extra_bytes != NULL);
+        memcpy(self->extra_bytes, rp->extra_bytes, rp->num_extra_bytes);
+    }
+}
+
+/// Copies all the fields but the coordinates of a point of format 6-10 into `self`
+static LAS_ALWAYS_INLINE void las_point_copy_fields_from_raw_14(las_point_t *self,
+                                                                const las_raw_point_14_t *rp)
+{
+    LAS_DEBUG_ASSERT(self->num_extra_bytes == rp->num_extra_bytes);
+
+    self->intensity = rp->intensity;
+
+    self->return_number = rp->return_number;
+    self->number_of_returns = rp->number_of_returns;
+
+    self->synthetic = rp->synthetic;
+    self->key_point = rp->key_point;
+    self->withheld = rp->withheld;
+    self->overlap = rp->overlap;
+    self->scanner_channel = rp->scanner_channel;
+    self->scan_direction_flag = rp->scan_direction_flag;
+    self->edge_of_flight_line = rp->edge_of_flight_line;
+
+    self->classification = rp->classification;
+    self->user_data = rp->user_data;
+    self->scan_angle = rp->scan_angle;
+    self->point_source_id = rp->point_source_id;
+
+    self->gps_time = rp->gps_time;
+
+    self->red = rp->red;
+    self->green = rp->green;
+    self->blue = rp->blue;
+
+    self->nir = rp->nir;
+
+    self->wave_packet = rp->wave_packet;
+
+    if (rp->extra_bytes != NULL)
+    {
+        LAS_DEBUG_ASSERT(self->extra_bytes != NULL);
+        memcpy(self->extra_bytes, rp->extra_bytes, rp->num_extra_bytes);
+    }
+}
+
 void las_point_copy_from_raw(las_point_t *self,
                              const las_raw_point_t *raw_point,
                              const las_scaling_t scaling)
@@ -689,87 +1301,84 @@ void las_point_copy_from_raw(las_point_t *self,
     if (raw_point->point_format_id <= 5)
     {
         const las_raw_point_10_t *rp = &raw_point->point10;
-        LAS_DEBUG_ASSERT(self->num_extra_bytes == rp->num_extra_bytes);
 
         self->x = las_scaling_apply_x(scaling, rp->x);
         self->y = las_scaling_apply_y(scaling, rp->y);
         self->z = las_scaling_apply_z(scaling, rp->z);
 
-        self->intensity = rp->intensity;
-
-        self->return_number = rp->return_number;
-        self->number_of_returns = rp->number_of_returns;
-
-        self->scan_direction_flag = rp->scan_direction_flag;
-        self->edge_of_flight_line = rp->edge_of_flight_line;
-
-        self->classification = rp->classification;
-        self->synthetic = rp->synthetic;
-        self->key_point = rp->key_point;
-        self->withheld = rp->withheld;
-
-        self->scan_angle = rp->scan_angle_rank;
-        self->user_data = rp->user_data;
-        self->point_source_id = rp->point_source_id;
-
-        self->gps_time = rp->gps_time;
-
-        self->red = rp->red;
-        self->green = rp->green;
-        self->blue = rp->blue;
-
-        self->wave_packet = rp->wave_packet;
-
-        if (rp->extra_bytes != NULL)
-        {
-            LAS_DEBUG_ASSERT(self->extra_bytes != NULL);
-            memcpy(self->extra_bytes, rp->extra_bytes, rp->num_extra_bytes);
-        }
+        las_point_copy_fields_from_raw_10(self, rp);
     }
     else
     {
         const las_raw_point_14_t *rp = &raw_point->point14;
-        LAS_DEBUG_ASSERT(self->num_extra_bytes == raw_point->point14.num_extra_bytes);
 
         self->x = las_scaling_apply_x(scaling, rp->x);
         self->y = las_scaling_apply_y(scaling, rp->y);
         self->z = las_scaling_apply_z(scaling, rp->z);
 
-        self->intensity = rp->intensity;
-
-        self->return_number = rp->return_number;
-        self->number_of_returns = rp->number_of_returns;
-
-        self->synthetic = rp->synthetic;
-        self->key_point = rp->key_point;
-        self->withheld = rp->withheld;
-        self->overlap = rp->overlap;
-        self->scanner_channel = rp->scanner_channel;
-        self->scan_direction_flag = rp->scan_direction_flag;
-        self->edge_of_flight_line = rp->edge_of_flight_line;
-
-        self->classification = rp->classification;
-        self->user_data = rp->user_data;
-        self->classification = rp->classification;
-        self->scan_angle = rp->scan_angle;
-        self->point_source_id = rp->point_source_id;
-
-        self->gps_time = rp->gps_time;
-
-        self->red = rp->red;
-        self->green = rp->green;
-        self->blue = rp->blue;
-
-        self->nir = rp->nir;
+        las_point_copy_fields_from_raw_14(self, rp);
+    }
+}
 
-        self->wave_packet = rp->wave_packet;
+void las_point_copy_many_from_raw(las_point_t *points,
+                                  const las_raw_point_t *raw_points,
+                                  const uint64_t num_points,
+                                  const las_scaling_t scaling)
+{
+    if (num_points == 0)
+    {
+        return;
+    }
+    LAS_DEBUG_ASSERT_NOT_NULL(points);
+    LAS_DEBUG_ASSERT_NOT_NULL(raw_points);
 
-        if (rp->extra_bytes != NULL)
+    const int32_t *x, *y, *z;
+    if (raw_points[0].point_format_id <= 5)
+    {
+        for (uint64_t i = 0; i < num_points; ++i)
         {
-            LAS_DEBUG_ASSERT(self->extra_bytes != NULL);
-            memcpy(self->extra_bytes, rp->extra_bytes, rp->num_extra_bytes);
+            LAS_DEBUG_ASSERT(raw_points[i].point_format_id <= 5);
+            las_point_copy_fields_from_raw_10(&points[i], &raw_points[i].point10);
         }
+        x = &raw_points[0].point10.x;
+        y = &raw_points[0].point10.y;
+        z = &raw_points[0].point10.z;
     }
+    else
+    {
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            LAS_DEBUG_ASSERT(raw_points[i].point_format_id > 5);
+            las_point_copy_fields_from_raw_14(&points[i], &raw_points[i].point14);
+        }
+        x = &raw_points[0].point14.x;
+        y = &raw_points[0].point14.y;
+        z = &raw_points[0].point14.z;
+    }
+
+    const las_dequantize_fn dequantize = las_dequantize_select_fn();
+    const size_t point_stride = sizeof(las_point_t) / sizeof(double);
+    dequantize((const uint8_t *)x,
+               sizeof(las_raw_point_t),
+               num_points,
+               scaling.scales.x,
+               scaling.offsets.x,
+               &points[0].x,
+               point_stride);
+    dequantize((const uint8_t *)y,
+               sizeof(las_raw_point_t),
+               num_points,
+               scaling.scales.y,
+               scaling.offsets.y,
+               &points[0].y,
+               point_stride);
+    dequantize((const uint8_t *)z,
+               sizeof(las_raw_point_t),
+               num_points,
+               scaling.scales.z,
+               scaling.offsets.z,
+               &points[0].z,
+               point_stride);
 }
 
 int las_raw_point_eq(const las_raw_point_t *lhs, const las_raw_point_t *rhs)
@@ -784,7 +1393,7 @@ int las_raw_point_eq(const las_raw_point_t *lhs, const las_raw_point_t *rhs)
 
     if (lhs->point_format_id <= 5)
     {
-        const las_raw_point_10_t *rpl = &rhs->point10;
+        const las_raw_point_10_t *rpl = &lhs->point10;
         const las_raw_point_10_t *rph = &rhs->point10;
 
         return rpl->x == rph->x && rpl->y == rph->y && rpl->z == rph->z &&
@@ -799,11 +1408,30 @@ int las_raw_point_eq(const las_raw_point_t *lhs, const las_raw_point_t *rhs)
                rpl->red == rph->red && rpl->green == rph->green && rpl->blue == rph->blue &&
                las_wave_packet_eq(&rpl->wave_packet, &rph->wave_packet) &&
                rpl->num_extra_bytes == rph->num_extra_bytes &&
-               (memcmp(rpl->extra_bytes, rph->extra_bytes, rpl->num_extra_bytes) == 0);
+               (rpl->num_extra_bytes == 0 ||
+                memcmp(rpl->extra_bytes, rph->extra_bytes, rpl->num_extra_bytes) == 0);
     }
     else
     {
-        LAS_ASSERT_M(false, "todo");
+        const las_raw_point_14_t *rpl = &lhs->point14;
+        const las_raw_point_14_t *rph = &rhs->point14;
+
+        return rpl->x == rph->x && rpl->y == rph->y && rpl->z == rph->z &&
+               rpl->intensity == rph->intensity && rpl->return_number == rph->return_number &&
+               rpl->number_of_returns == rph->number_of_returns &&
+               rpl->synthetic == rph->synthetic && rpl->key_point == rph->key_point &&
+               rpl->withheld == rph->withheld && rpl->overlap == rph->overlap &&
+               rpl->scanner_channel == rph->scanner_channel &&
+               rpl->scan_direction_flag == rph->scan_direction_flag &&
+               rpl->edge_of_flight_line == rph->edge_of_flight_line &&
+               rpl->classification == rph->classification && rpl->user_data == rph->user_data &&
+               rpl->scan_angle == rph->scan_angle && rpl->point_source_id == rph->point_source_id &&
+               rpl->gps_time == rph->gps_time && rpl->red == rph->red &&
+               rpl->green == rph->green && rpl->blue == rph->blue && rpl->nir == rph->nir &&
+               las_wave_packet_eq(&rpl->wave_packet, &rph->wave_packet) &&
+               rpl->num_extra_bytes == rph->num_extra_bytes &&
+               (rpl->num_extra_bytes == 0 ||
+                memcmp(rpl->extra_bytes, rph->extra_bytes, rpl->num_extra_bytes) == 0);
     }
 }
 
@@ -833,3 +1461,60 @@ void las_point_deinit(las_point_t *self)
         self->num_extra_bytes = 0;
     }
 }
+
+las_point_layout_t las_point_layout_from_format(const las_point_format_t point_format)
+{
+    las_point_layout_t layout;
+    layout.is_legacy = point_format.id <= 5;
+
+    uint16_t offset;
+    if (layout.is_legacy)
+    {
+        layout.classification = 15;
+        layout.classification_flags = 15;
+        layout.scan_angle = 16;
+        layout.user_data = 17;
+        layout.point_source_id = 18;
+        offset = BASE_POINT10_SIZE;
+    }
+    else
+    {
+        layout.classification_flags = 15;
+        layout.classification = 16;
+        layout.user_data = 17;
+        layout.scan_angle = 18;
+        layout.point_source_id = 20;
+        offset = BASE_POINT14_SIZE;
+    }
+
+    // Optional fields come in this order in all formats
+    layout.gps_time = LAS_POINT_LAYOUT_ABSENT;
+    if (has_gps_time(point_format.id))
+    {
+        layout.gps_time = offset;
+        offset += sizeof(double);
+    }
+    layout.rgb = LAS_POINT_LAYOUT_ABSENT;
+    if (has_rgb(point_format.id))
+    {
+        layout.rgb = offset;
+        offset += sizeof(uint16_t) * 3;
+    }
+    layout.nir = LAS_POINT_LAYOUT_ABSENT;
+    if (has_nir(point_format.id))
+    {
+        layout.nir = offset;
+        offset += sizeof(uint16_t);
+    }
+    layout.wave_packet = LAS_POINT_LAYOUT_ABSENT;
+    if (has_waveform(point_format.id))
+    {
+        layout.wave_packet = offset;
+        offset += LAS_WAVE_PACKET_SIZE;
+    }
+
+    LAS_DEBUG_ASSERT(offset == las_point_standard_size(point_format.id));
+    layout.extra_bytes = offset;
+    layout.point_size = las_point_format_point_size(point_format);
+    return layout;
+}
@@ -0,0 +1,1264 @@
+#include "private/point_columns.h"
+
+#include <string.h>
+
+#include "private/cpu.h"
+
+#if LAS_WITH_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/// Copies the field of `type` at `offset` of each record into the column
+///
+/// Uses the `records`, `first`, `count` and `point_size` of the current range.
+#define LAS_UNPACK_COLUMN(column, type, offset)                                                    \
+    do                                                                                             \
+    {                                                                                              \
+        const uint8_t *record_ = records + (offset);                                               \
+        for (uint64_t i_ = 0; i_ < count; ++i_)                                                    \
+        {                                                                                          \
+            memcpy(&(column)[first + i_], record_, sizeof(type));                                  \
+            record_ += point_size;                                                                 \
+        }                                                                                          \
+    } while (0)
+
+/// Extracts `(byte >> shift) & mask` of the byte at the same offset in each record
+static inline void las_unpack_bits(const uint8_t *bytes,
+                                   const uint16_t point_size,
+                                   const uint8_t shift,
+                                   const uint8_t mask,
+                                   uint8_t *column,
+                                   const uint64_t count)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        column[i] = (uint8_t)((*bytes >> shift) & mask);
+        bytes += point_size;
+    }
+}
+
+/// Decodes the `count` records starting at `records`
+/// into the columns, starting at index `first`
+static void las_decode_columns_scalar_range(const uint8_t *records,
+                                            const las_point_layout_t *layout,
+                                            const uint64_t first,
+                                            const uint64_t count,
+                                            const las_raw_point_columns_t *c)
+{
+    const uint16_t point_size = layout->point_size;
+    const bool is_legacy = layout->is_legacy;
+
+    if (c->x != NULL)
+    {
+        LAS_UNPACK_COLUMN(c->x, int32_t, 0);
+    }
+    if (c->y != NULL)
+    {
+        LAS_UNPACK_COLUMN(c->y, int32_t, 4);
+    }
+    if (c->z != NULL)
+    {
+        LAS_UNPACK_COLUMN(c->z, int32_t, 8);
+    }
+    if (c->intensity != NULL)
+    {
+        LAS_UNPACK_COLUMN(c->intensity, uint16_t, 12);
+    }
+
+    // clang-format off
+    const uint8_t *return_byte = records + LAS_POINT_RETURN_BYTE_OFFSET;
+    const uint8_t *flags_byte = records + layout->classification_flags;
+    const uint8_t return_mask = is_legacy ? 0b111 : 0b1111;
+    if (c->return_number != NULL)
+    {
+        las_unpack_bits(return_byte, point_size, 0, return_mask, c->return_number + first, count);
+    }
+    if (c->number_of_returns != NULL)
+    {
+        las_unpack_bits(return_byte, point_size, is_legacy ? 3 : 4, return_mask,
+                        c->number_of_returns + first, count);
+    }
+
+    // Legacy formats have the direction and edge flags in the return byte,
+    // and the classification flags packed with the classification
+    const uint8_t *direction_byte = is_legacy ? return_byte : flags_byte;
+    const uint8_t flags_shift = is_legacy ? 5 : 0;
+    if (c->scan_direction_flag != NULL)
+    {
+        las_unpack_bits(direction_byte, point_size, 6, 1, c->scan_direction_flag + first, count);
+    }
+    if (c->edge_of_flight_line != NULL)
+    {
+        las_unpack_bits(direction_byte, point_size, 7, 1, c->edge_of_flight_line + first, count);
+    }
+    if (c->synthetic != NULL)
+    {
+        las_unpack_bits(flags_byte, point_size, flags_shift, 1, c->synthetic + first, count);
+    }
+    if (c->key_point != NULL)
+    {
+        las_unpack_bits(flags_byte, point_size, (uint8_t)(flags_shift + 1), 1,
+                        c->key_point + first, count);
+    }
+    if (c->withheld != NULL)
+    {
+        las_unpack_bits(flags_byte, point_size, (uint8_t)(flags_shift + 2), 1,
+                        c->withheld + first, count);
+    }
+    if (!is_legacy && c->overlap != NULL)
+    {
+        las_unpack_bits(flags_byte, point_size, 3, 1, c->overlap + first, count);
+    }
+    if (!is_legacy && c->scanner_channel != NULL)
+    {
+        las_unpack_bits(flags_byte, point_size, 4, 0b11, c->scanner_channel + first, count);
+    }
+    if (c->classification != NULL)
+    {
+        las_unpack_bits(records + layout->classification, point_size, 0,
+                        is_legacy ? 0b11111 : 0xFF, c->classification + first, count);
+    }
+    // clang-format on
+
+    if (c->user_data != NULL)
+    {
+        LAS_UNPACK_COLUMN(c->user_data, uint8_t, layout->user_data);
+    }
+    if (c->scan_angle != NULL)
+    {
+        if (is_legacy)
+        {
+            const uint8_t *record = records + layout->scan_angle;
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                c->scan_angle[first + i] = *record;
+                record += point_size;
+            }
+        }
+        else
+        {
+            LAS_UNPACK_COLUMN(c->scan_angle, uint16_t, layout->scan_angle);
+        }
+    }
+    if (c->point_source_id != NULL)
+    {
+        LAS_UNPACK_COLUMN(c->point_source_id, uint16_t, layout->point_source_id);
+    }
+    if (layout->gps_time != LAS_POINT_LAYOUT_ABSENT && c->gps_time != NULL)
+    {
+        LAS_UNPACK_COLUMN(c->gps_time, double, layout->gps_time);
+    }
+    if (layout->rgb != LAS_POINT_LAYOUT_ABSENT)
+    {
+        if (c->red != NULL)
+        {
+            LAS_UNPACK_COLUMN(c->red, uint16_t, layout->rgb);
+        }
+        if (c->green != NULL)
+        {
+            LAS_UNPACK_COLUMN(c->green, uint16_t, layout->rgb + 2);
+        }
+        if (c->blue != NULL)
+        {
+            LAS_UNPACK_COLUMN(c->blue, uint16_t, layout->rgb + 4);
+        }
+    }
+    if (layout->nir != LAS_POINT_LAYOUT_ABSENT && c->nir != NULL)
+    {
+        LAS_UNPACK_COLUMN(c->nir, uint16_t, layout->nir);
+    }
+}
+
+/// Decodes the dimensions that are not fixed size numbers,
+/// wave packets and extra bytes, they are not worth vectorizing
+static void las_decode_columns_variable(const uint8_t *records,
+                                        const las_point_layout_t *layout,
+                                        const uint64_t num_points,
+                                        const las_raw_point_columns_t *c)
+{
+    const uint16_t point_size = layout->point_size;
+    if (layout->wave_packet != LAS_POINT_LAYOUT_ABSENT && c->wave_packet != NULL)
+    {
+        const uint8_t *record = records + layout->wave_packet;
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            las_wave_packet_from_buffer(record, &c->wave_packet[i]);
+            record += point_size;
+        }
+    }
+
+    const uint16_t num_extra_bytes = (uint16_t)(point_size - layout->extra_bytes);
+    if (num_extra_bytes != 0 && c->extra_bytes != NULL)
+    {
+        const uint8_t *record = records + layout->extra_bytes;
+        uint8_t *extra_bytes = c->extra_bytes;
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            memcpy(extra_bytes, record, num_extra_bytes);
+            record += point_size;
+            extra_bytes += num_extra_bytes;
+        }
+    }
+}
+
+static void las_decode_columns_scalar(const uint8_t *records,
+                                      const las_point_layout_t *layout,
+                                      const uint64_t num_points,
+                                      const las_raw_point_columns_t *columns)
+{
+    las_decode_columns_scalar_range(records, layout, 0, num_points, columns);
+    las_decode_columns_variable(records, layout, num_points, columns);
+}
+
+#if LAS_WITH_X86_SIMD
+
+// The kernels load 4 bytes for 2-byte fields, which reads past the end of
+// the field, up to 2 bytes past the end of the record for the last fields.
+// Blocks are only decoded with SIMD when at least one record follows them,
+// so these reads never go past the end of the records.
+
+/// Stores the low byte of the 4 lanes
+__attribute__((target("sse4.1"))) static inline void las_sse41_store_u8(uint8_t *dst,
+                                                                         const __m128i v)
+{
+    const __m128i low_bytes =
+        _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i bytes = _mm_shuffle_epi8(v, low_bytes);
+    const int32_t packed = _mm_cvtsi128_si32(bytes);
+    memcpy(dst, &packed, sizeof(int32_t));
+}
+
+/// Stores the low 2 bytes of the 4 lanes
+__attribute__((target("sse4.1"))) static inline void las_sse41_store_u16(uint16_t *dst,
+                                                                          const __m128i v)
+{
+    const __m128i low_words =
+        _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i words = _mm_shuffle_epi8(v, low_words);
+    _mm_storel_epi64((__m128i *)dst, words);
+}
+
+/// Loads the 4 bytes at `offset` of 4 consecutive records
+__attribute__((target("sse4.1"))) static inline __m128i
+las_sse41_load_u32(const uint8_t *records, const uint16_t point_size, const uint16_t offset)
+{
+    int32_t lanes[4];
+    for (int k = 0; k < 4; ++k)
+    {
+        memcpy(&lanes[k], records + (size_t)k * point_size + offset, sizeof(int32_t));
+    }
+    return _mm_loadu_si128((const __m128i *)lanes);
+}
+
+/// Decodes 4 records per iteration
+///
+/// SSE4.1 has no gather, the fields are loaded one record at a time,
+/// but the bit fields are unpacked for the 4 records at once.
+__attribute__((target("sse4.1"))) static void
+las_decode_columns_sse41(const uint8_t *records,
+                         const las_point_layout_t *layout,
+                         const uint64_t num_points,
+                         const las_raw_point_columns_t *c)
+{
+    const uint16_t ps = layout->point_size;
+    const bool is_legacy = layout->is_legacy;
+    const __m128i bit = _mm_set1_epi32(1);
+    const __m128i byte = _mm_set1_epi32(0xFF);
+    const __m128i return_mask = _mm_set1_epi32(is_legacy ? 0b111 : 0b1111);
+    const int number_of_returns_shift = is_legacy ? 3 : 4;
+
+    uint64_t i = 0;
+    for (; i + 4 < num_points; i += 4)
+    {
+        const uint8_t *block = records + i * ps;
+
+        if (c->x != NULL)
+        {
+            _mm_storeu_si128((__m128i *)&c->x[i], las_sse41_load_u32(block, ps, 0));
+        }
+        if (c->y != NULL)
+        {
+            _mm_storeu_si128((__m128i *)&c->y[i], las_sse41_load_u32(block, ps, 4));
+        }
+        if (c->z != NULL)
+        {
+            _mm_storeu_si128((__m128i *)&c->z[i], las_sse41_load_u32(block, ps, 8));
+        }
+
+        // intensity | return byte << 16 | classification (or flags) byte << 24
+        const __m128i w = las_sse41_load_u32(block, ps, 12);
+        const __m128i returns = _mm_and_si128(_mm_srli_epi32(w, 16), byte);
+        const __m128i flags = _mm_srli_epi32(w, 24);
+
+        if (c->intensity != NULL)
+        {
+            las_sse41_store_u16(&c->intensity[i], w);
+        }
+        if (c->return_number != NULL)
+        {
+            las_sse41_store_u8(&c->return_number[i], _mm_and_si128(returns, return_mask));
+        }
+        if (c->number_of_returns != NULL)
+        {
+            las_sse41_store_u8(
+                &c->number_of_returns[i],
+                _mm_and_si128(_mm_srl_epi32(returns, _mm_cvtsi32_si128(number_of_returns_shift)),
+                              return_mask));
+        }
+
+        const __m128i direction = is_legacy ? returns : flags;
+        if (c->scan_direction_flag != NULL)
+        {
+            las_sse41_store_u8(&c->scan_direction_flag[i],
+                               _mm_and_si128(_mm_srli_epi32(direction, 6), bit));
+        }
+        if (c->edge_of_flight_line != NULL)
+        {
+            las_sse41_store_u8(&c->edge_of_flight_line[i], _mm_srli_epi32(direction, 7));
+        }
+
+        const __m128i class_flags = is_legacy ? _mm_srli_epi32(flags, 5) : flags;
+        if (c->synthetic != NULL)
+        {
+            las_sse41_store_u8(&c->synthetic[i], _mm_and_si128(class_flags, bit));
+        }
+        if (c->key_point != NULL)
+        {
+            las_sse41_store_u8(&c->key_point[i],
+                               _mm_and_si128(_mm_srli_epi32(class_flags, 1), bit));
+        }
+        if (c->withheld != NULL)
+        {
+            las_sse41_store_u8(&c->withheld[i],
+                               _mm_and_si128(_mm_srli_epi32(class_flags, 2), bit));
+        }
+
+        const __m128i w16 = las_sse41_load_u32(block, ps, 16);
+        if (is_legacy)
+        {
+            // scan angle rank | user data << 8 | point source id << 16
+            if (c->classification != NULL)
+            {
+                las_sse41_store_u8(&c->classification[i],
+                                   _mm_and_si128(flags, _mm_set1_epi32(0b11111)));
+            }
+            if (c->scan_angle != NULL)
+            {
+                las_sse41_store_u16(&c->scan_angle[i], _mm_and_si128(w16, byte));
+            }
+            if (c->point_source_id != NULL)
+            {
+                las_sse41_store_u16(&c->point_source_id[i], _mm_srli_epi32(w16, 16));
+            }
+        }
+        else
+        {
+            // classification | user data << 8 | scan angle << 16
+            if (c->overlap != NULL)
+            {
+                las_sse41_store_u8(&c->overlap[i], _mm_and_si128(_mm_srli_epi32(flags, 3), bit));
+            }
+            if (c->scanner_channel != NULL)
+            {
+                las_sse41_store_u8(&c->scanner_channel[i],
+                                   _mm_and_si128(_mm_srli_epi32(flags, 4), _mm_set1_epi32(0b11)));
+            }
+            if (c->classification != NULL)
+            {
+                las_sse41_store_u8(&c->classification[i], w16);
+            }
+            if (c->scan_angle != NULL)
+            {
+                las_sse41_store_u16(&c->scan_angle[i], _mm_srli_epi32(w16, 16));
+            }
+            if (c->point_source_id != NULL)
+            {
+                las_sse41_store_u16(&c->point_source_id[i], las_sse41_load_u32(block, ps, 20));
+            }
+        }
+        if (c->user_data != NULL)
+        {
+            las_sse41_store_u8(&c->user_data[i], _mm_srli_epi32(w16, 8));
+        }
+
+        if (layout->gps_time != LAS_POINT_LAYOUT_ABSENT && c->gps_time != NULL)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                memcpy(&c->gps_time[i + (uint64_t)k],
+                       block + (size_t)k * ps + layout->gps_time,
+                       sizeof(double));
+            }
+        }
+        if (layout->rgb != LAS_POINT_LAYOUT_ABSENT)
+        {
+            const __m128i rg = las_sse41_load_u32(block, ps, layout->rgb);
+            if (c->red != NULL)
+            {
+                las_sse41_store_u16(&c->red[i], rg);
+            }
+            if (c->green != NULL)
+            {
+                las_sse41_store_u16(&c->green[i], _mm_srli_epi32(rg, 16));
+            }
+            if (c->blue != NULL)
+            {
+                las_sse41_store_u16(&c->blue[i],
+                                    las_sse41_load_u32(block, ps, (uint16_t)(layout->rgb + 4)));
+            }
+        }
+        if (layout->nir != LAS_POINT_LAYOUT_ABSENT && c->nir != NULL)
+        {
+            las_sse41_store_u16(&c->nir[i], las_sse41_load_u32(block, ps, layout->nir));
+        }
+    }
+
+    las_decode_columns_scalar_range(records + i * ps, layout, i, num_points - i, c);
+    las_decode_columns_variable(records, layout, num_points, c);
+}
+
+/// Stores the low byte of the 8 lanes
+__attribute__((target("avx2"))) static inline void las_avx2_store_u8(uint8_t *dst,
+                                                                      const __m256i v)
+{
+    // The shuffle works within each 128-bit half: each half gives 4 bytes
+    const __m256i bytes = _mm256_shuffle_epi8(v,
+                                              _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1,
+                                                               -1, -1, -1, -1, -1, -1, -1, -1,
+                                                               0, 4, 8, 12, -1, -1, -1, -1,
+                                                               -1, -1, -1, -1, -1, -1, -1, -1));
+    const __m128i packed = _mm_unpacklo_epi32(_mm256_castsi256_si128(bytes),
+                                              _mm256_extracti128_si256(bytes, 1));
+    _mm_storel_epi64((__m128i *)dst, packed);
+}
+
+/// Stores the low 2 bytes of the 8 lanes
+__attribute__((target("avx2"))) static inline void las_avx2_store_u16(uint16_t *dst,
+                                                                       const __m256i v)
+{
+    const __m256i words = _mm256_shuffle_epi8(v,
+                                              _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13,
+                                                               -1, -1, -1, -1, -1, -1, -1, -1,
+                                                               0, 1, 4, 5, 8, 9, 12, 13,
+                                                               -1, -1, -1, -1, -1, -1, -1, -1));
+    const __m128i packed = _mm_unpacklo_epi64(_mm256_castsi256_si128(words),
+                                              _mm256_extracti128_si256(words, 1));
+    _mm_storeu_si128((__m128i *)dst, packed);
+}
+
+/// Gathers the 4 bytes at `offset` of 8 consecutive records
+__attribute__((target("avx2"))) static inline __m256i
+las_avx2_gather_u32(const uint8_t *block, const __m256i offsets, const uint16_t offset)
+{
+    return _mm256_i32gather_epi32((const int *)(block + offset), offsets, 1);
+}
+
+/// Decodes 8 records per iteration, each field of the 8 records
+/// is gathered into one register.
+__attribute__((target("avx2"))) static void
+las_decode_columns_avx2(const uint8_t *records,
+                        const las_point_layout_t *layout,
+                        const uint64_t num_points,
+                        const las_raw_point_columns_t *c)
+{
+    const uint16_t ps = layout->point_size;
+    const int32_t p = (int32_t)ps;
+    const __m256i offsets = _mm256_setr_epi32(0, p, 2 * p, 3 * p, 4 * p, 5 * p, 6 * p, 7 * p);
+    const __m128i offsets_lo = _mm_setr_epi32(0, p, 2 * p, 3 * p);
+    const __m128i offsets_hi = _mm_setr_epi32(4 * p, 5 * p, 6 * p, 7 * p);
+
+    const bool is_legacy = layout->is_legacy;
+    const __m256i bit = _mm256_set1_epi32(1);
+    const __m256i byte = _mm256_set1_epi32(0xFF);
+    const __m256i return_mask = _mm256_set1_epi32(is_legacy ? 0b111 : 0b1111);
+    const __m128i number_of_returns_shift = _mm_cvtsi32_si128(is_legacy ? 3 : 4);
+
+    uint64_t i = 0;
+    for (; i + 8 < num_points; i += 8)
+    {
+        const uint8_t *block = records + i * ps;
+
+        if (c->x != NULL)
+        {
+            _mm256_storeu_si256((__m256i *)&c->x[i], las_avx2_gather_u32(block, offsets, 0));
+        }
+        if (c->y != NULL)
+        {
+            _mm256_storeu_si256((__m256i *)&c->y[i], las_avx2_gather_u32(block, offsets, 4));
+        }
+        if (c->z != NULL)
+        {
+            _mm256_storeu_si256((__m256i *)&c->z[i], las_avx2_gather_u32(block, offsets, 8));
+        }
+
+        // intensity | return byte << 16 | classification (or flags) byte << 24
+        const __m256i w = las_avx2_gather_u32(block, offsets, 12);
+        const __m256i returns = _mm256_and_si256(_mm256_srli_epi32(w, 16), byte);
+        const __m256i flags = _mm256_srli_epi32(w, 24);
+
+        if (c->intensity != NULL)
+        {
+            las_avx2_store_u16(&c->intensity[i], w);
+        }
+        if (c->return_number != NULL)
+        {
+            las_avx2_store_u8(&c->return_number[i], _mm256_and_si256(returns, return_mask));
+        }
+        if (c->number_of_returns != NULL)
+        {
+            las_avx2_store_u8(
+                &c->number_of_returns[i],
+                _mm256_and_si256(_mm256_srl_epi32(returns, number_of_returns_shift), return_mask));
+        }
+
+        const __m256i direction = is_legacy ? returns : flags;
+        if (c->scan_direction_flag != NULL)
+        {
+            las_avx2_store_u8(&c->scan_direction_flag[i],
+                              _mm256_and_si256(_mm256_srli_epi32(direction, 6), bit));
+        }
+        if (c->edge_of_flight_line != NULL)
+        {
+            las_avx2_store_u8(&c->edge_of_flight_line[i], _mm256_srli_epi32(direction, 7));
+        }
+
+        const __m256i class_flags = is_legacy ? _mm256_srli_epi32(flags, 5) : flags;
+        if (c->synthetic != NULL)
+        {
+            las_avx2_store_u8(&c->synthetic[i], _mm256_and_si256(class_flags, bit));
+        }
+        if (c->key_point != NULL)
+        {
+            las_avx2_store_u8(&c->key_point[i],
+                              _mm256_and_si256(_mm256_srli_epi32(class_flags, 1), bit));
+        }
+        if (c->withheld != NULL)
+        {
+            las_avx2_store_u8(&c->withheld[i],
+                              _mm256_and_si256(_mm256_srli_epi32(class_flags, 2), bit));
+        }
+
+        const __m256i w16 = las_avx2_gather_u32(block, offsets, 16);
+        if (is_legacy)
+        {
+            // scan angle rank | user data << 8 | point source id << 16
+            if (c->classification != NULL)
+            {
+                las_avx2_store_u8(&c->classification[i],
+                                  _mm256_and_si256(flags, _mm256_set1_epi32(0b11111)));
+            }
+            if (c->scan_angle != NULL)
+            {
+                las_avx2_store_u16(&c->scan_angle[i], _mm256_and_si256(w16, byte));
+            }
+            if (c->point_source_id != NULL)
+            {
+                las_avx2_store_u16(&c->point_source_id[i], _mm256_srli_epi32(w16, 16));
+            }
+        }
+        else
+        {
+            // classification | user data << 8 | scan angle << 16
+            if (c->overlap != NULL)
+            {
+                las_avx2_store_u8(&c->overlap[i],
+                                  _mm256_and_si256(_mm256_srli_epi32(flags, 3), bit));
+            }
+            if (c->scanner_channel != NULL)
+            {
+                las_avx2_store_u8(
+                    &c->scanner_channel[i],
+                    _mm256_and_si256(_mm256_srli_epi32(flags, 4), _mm256_set1_epi32(0b11)));
+            }
+            if (c->classification != NULL)
+            {
+                las_avx2_store_u8(&c->classification[i], w16);
+            }
+            if (c->scan_angle != NULL)
+            {
+                las_avx2_store_u16(&c->scan_angle[i], _mm256_srli_epi32(w16, 16));
+            }
+            if (c->point_source_id != NULL)
+            {
+                las_avx2_store_u16(&c->point_source_id[i], las_avx2_gather_u32(block, offsets, 20));
+            }
+        }
+        if (c->user_data != NULL)
+        {
+            las_avx2_store_u8(&c->user_data[i], _mm256_srli_epi32(w16, 8));
+        }
+
+        if (layout->gps_time != LAS_POINT_LAYOUT_ABSENT && c->gps_time != NULL)
+        {
+            const double *gps_times = (const double *)(block + layout->gps_time);
+            _mm256_storeu_pd(&c->gps_time[i], _mm256_i32gather_pd(gps_times, offsets_lo, 1));
+            _mm256_storeu_pd(&c->gps_time[i + 4], _mm256_i32gather_pd(gps_times, offsets_hi, 1));
+        }
+        if (layout->rgb != LAS_POINT_LAYOUT_ABSENT)
+        {
+            const __m256i rg = las_avx2_gather_u32(block, offsets, layout->rgb);
+            if (c->red != NULL)
+            {
+                las_avx2_store_u16(&c->red[i], rg);
+            }
+            if (c->green != NULL)
+            {
+                las_avx2_store_u16(&c->green[i], _mm256_srli_epi32(rg, 16));
+            }
+            if (c->blue != NULL)
+            {
+                const uint16_t blue_offset = (uint16_t)(layout->rgb + 4);
+                las_avx2_store_u16(&c->blue[i], las_avx2_gather_u32(block, offsets, blue_offset));
+            }
+        }
+        if (layout->nir != LAS_POINT_LAYOUT_ABSENT && c->nir != NULL)
+        {
+            las_avx2_store_u16(&c->nir[i], las_avx2_gather_u32(block, offsets, layout->nir));
+        }
+    }
+
+    las_decode_columns_scalar_range(records + i * ps, layout, i, num_points - i, c);
+    las_decode_columns_variable(records, layout, num_points, c);
+}
+#endif
+
+las_raw_point_columns_decode_fn las_raw_point_columns_select_decode_fn(void)
+{
+#if LAS_WITH_X86_SIMD
+    const las_simd_level_t level = las_cpu_simd_level();
+    if (level >= LAS_SIMD_AVX2)
+    {
+        return las_decode_columns_avx2;
+    }
+    if (level >= LAS_SIMD_SSE41)
+    {
+        return las_decode_columns_sse41;
+    }
+#endif
+    return las_decode_columns_scalar;
+}
+
+/// Number of points packed per pass, so that the records of a block
+/// stay in the cache while each column is copied into them
+#define LAS_COLUMNS_BLOCK_SIZE 1024
+
+/// Copies a column of `type` into the field at `offset` of each record
+///
+/// Uses the `records`, `first`, `count` and `point_size` of the current range.
+#define LAS_PACK_COLUMN(column, type, offset)                                                      \
+    do                                                                                             \
+    {                                                                                              \
+        uint8_t *record_ = records + (offset);                                                     \
+        for (uint64_t i_ = 0; i_ < count; ++i_)                                                    \
+        {                                                                                          \
+            memcpy(record_, &(column)[first + i_], sizeof(type));                                  \
+            record_ += point_size;                                                                 \
+        }                                                                                          \
+    } while (0)
+
+/// ORs the bits of a column into the byte at the same offset of each record
+static inline void las_pack_bits(const uint8_t *column,
+                                 const uint8_t mask,
+                                 const uint8_t shift,
+                                 uint8_t *bytes,
+                                 const uint16_t point_size,
+                                 const uint64_t count)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        *bytes |= (uint8_t)((column[i] << shift) & mask);
+        bytes += point_size;
+    }
+}
+
+/// Writes the wave packets and extra bytes of `count` points,
+/// zeroes are written for missing columns
+static void las_encode_columns_variable(const las_raw_point_columns_t *c,
+                                        const las_point_layout_t *layout,
+                                        const uint64_t first,
+                                        const uint64_t count,
+                                        uint8_t *records)
+{
+    const uint16_t point_size = layout->point_size;
+    if (layout->wave_packet != LAS_POINT_LAYOUT_ABSENT)
+    {
+        uint8_t *record = records + layout->wave_packet;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (c->wave_packet != NULL)
+            {
+                las_wave_packet_to_buffer(&c->wave_packet[first + i], record);
+            }
+            else
+            {
+                memset(record, 0, LAS_WAVE_PACKET_SIZE);
+            }
+            record += point_size;
+        }
+    }
+
+    const uint16_t num_extra_bytes = (uint16_t)(point_size - layout->extra_bytes);
+    if (num_extra_bytes != 0)
+    {
+        uint8_t *record = records + layout->extra_bytes;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (c->extra_bytes != NULL)
+            {
+                memcpy(record, c->extra_bytes + (first + i) * num_extra_bytes, num_extra_bytes);
+            }
+            else
+            {
+                memset(record, 0, num_extra_bytes);
+            }
+            record += point_size;
+        }
+    }
+}
+
+/// Packs the points in [`first`, `first` + `count`) of the columns
+/// into the records starting at `records`
+static void las_encode_columns_scalar_range(const las_raw_point_columns_t *c,
+                                            const las_point_layout_t *layout,
+                                            const uint64_t first,
+                                            const uint64_t count,
+                                            uint8_t *records)
+{
+    const uint16_t point_size = layout->point_size;
+    memset(records, 0, (size_t)point_size * count);
+
+    if (c->x != NULL)
+    {
+        LAS_PACK_COLUMN(c->x, int32_t, 0);
+    }
+    if (c->y != NULL)
+    {
+        LAS_PACK_COLUMN(c->y, int32_t, 4);
+    }
+    if (c->z != NULL)
+    {
+        LAS_PACK_COLUMN(c->z, int32_t, 8);
+    }
+    if (c->intensity != NULL)
+    {
+        LAS_PACK_COLUMN(c->intensity, uint16_t, 12);
+    }
+
+    // Legacy formats have 3 bits for return numbers and 5 for the classification
+    const bool is_legacy = layout->is_legacy;
+    const uint8_t return_mask = is_legacy ? 0b00000111 : 0b00001111;
+    const uint8_t number_of_returns_shift = is_legacy ? 3 : 4;
+    const uint8_t classification_mask = is_legacy ? 0b00011111 : 0b11111111;
+    const uint8_t flags_shift = is_legacy ? 5 : 0;
+    uint8_t *return_byte = records + LAS_POINT_RETURN_BYTE_OFFSET;
+    uint8_t *flags_byte = records + layout->classification_flags;
+
+    // clang-format off
+    if (c->return_number != NULL)
+    {
+        las_pack_bits(c->return_number + first, return_mask, 0, return_byte, point_size, count);
+    }
+    if (c->number_of_returns != NULL)
+    {
+        las_pack_bits(c->number_of_returns + first,
+                      (uint8_t)(return_mask << number_of_returns_shift), number_of_returns_shift,
+                      return_byte, point_size, count);
+    }
+    if (c->classification != NULL)
+    {
+        las_pack_bits(c->classification + first, classification_mask, 0,
+                      records + layout->classification, point_size, count);
+    }
+    if (c->synthetic != NULL)
+    {
+        las_pack_bits(c->synthetic + first, (uint8_t)(1 << flags_shift), flags_shift,
+                      flags_byte, point_size, count);
+    }
+    if (c->key_point != NULL)
+    {
+        las_pack_bits(c->key_point + first, (uint8_t)(1 << (flags_shift + 1)),
+                      (uint8_t)(flags_shift + 1), flags_byte, point_size, count);
+    }
+    if (c->withheld != NULL)
+    {
+        las_pack_bits(c->withheld + first, (uint8_t)(1 << (flags_shift + 2)),
+                      (uint8_t)(flags_shift + 2), flags_byte, point_size, count);
+    }
+    if (!is_legacy && c->overlap != NULL)
+    {
+        las_pack_bits(c->overlap + first, 0b00001000, 3, flags_byte, point_size, count);
+    }
+    if (!is_legacy && c->scanner_channel != NULL)
+    {
+        las_pack_bits(c->scanner_channel + first, 0b00110000, 4, flags_byte, point_size, count);
+    }
+
+    // In legacy formats, the scan direction and edge of flight line
+    // flags are in the return byte
+    uint8_t *direction_byte = is_legacy ? return_byte : flags_byte;
+    if (c->scan_direction_flag != NULL)
+    {
+        las_pack_bits(c->scan_direction_flag + first, 0b01000000, 6,
+                      direction_byte, point_size, count);
+    }
+    if (c->edge_of_flight_line != NULL)
+    {
+        las_pack_bits(c->edge_of_flight_line + first, 0b10000000, 7,
+                      direction_byte, point_size, count);
+    }
+    // clang-format on
+
+    if (c->user_data != NULL)
+    {
+        LAS_PACK_COLUMN(c->user_data, uint8_t, layout->user_data);
+    }
+    if (c->scan_angle != NULL)
+    {
+        if (is_legacy)
+        {
+            uint8_t *record = records + layout->scan_angle;
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                *record = (uint8_t)(c->scan_angle[first + i] & 0xFF);
+                record += point_size;
+            }
+        }
+        else
+        {
+            LAS_PACK_COLUMN(c->scan_angle, uint16_t, layout->scan_angle);
+        }
+    }
+    if (c->point_source_id != NULL)
+    {
+        LAS_PACK_COLUMN(c->point_source_id, uint16_t, layout->point_source_id);
+    }
+    if (layout->gps_time != LAS_POINT_LAYOUT_ABSENT && c->gps_time != NULL)
+    {
+        LAS_PACK_COLUMN(c->gps_time, double, layout->gps_time);
+    }
+    if (layout->rgb != LAS_POINT_LAYOUT_ABSENT)
+    {
+        if (c->red != NULL)
+        {
+            LAS_PACK_COLUMN(c->red, uint16_t, layout->rgb);
+        }
+        if (c->green != NULL)
+        {
+            LAS_PACK_COLUMN(c->green, uint16_t, layout->rgb + 2);
+        }
+        if (c->blue != NULL)
+        {
+            LAS_PACK_COLUMN(c->blue, uint16_t, layout->rgb + 4);
+        }
+    }
+    if (layout->nir != LAS_POINT_LAYOUT_ABSENT && c->nir != NULL)
+    {
+        LAS_PACK_COLUMN(c->nir, uint16_t, layout->nir);
+    }
+
+    las_encode_columns_variable(c, layout, first, count, records);
+}
+
+static void las_encode_columns_scalar(const las_raw_point_columns_t *columns,
+                                      const las_point_layout_t *layout,
+                                      const uint64_t num_points,
+                                      uint8_t *records)
+{
+    const uint16_t point_size = layout->point_size;
+    for (uint64_t first = 0; first < num_points; first += LAS_COLUMNS_BLOCK_SIZE)
+    {
+        const uint64_t left = num_points - first;
+        const uint64_t count = (left < LAS_COLUMNS_BLOCK_SIZE) ? left : LAS_COLUMNS_BLOCK_SIZE;
+        las_encode_columns_scalar_range(
+            columns, layout, first, count, records + first * point_size);
+    }
+}
+
+/// Copies the `num_lanes` 32-bit lanes stored in `lanes`
+/// into the `size` bytes at `offset` of consecutive records
+static inline void las_scatter_lanes(const int32_t *lanes,
+                                     const int num_lanes,
+                                     uint8_t *records,
+                                     const uint16_t point_size,
+                                     const uint16_t offset,
+                                     const size_t size)
+{
+    for (int k = 0; k < num_lanes; ++k)
+    {
+        memcpy(records + (size_t)k * point_size + offset, &lanes[k], size);
+    }
+}
+
+/// Copies the values of `column` (or zeroes if it is NULL)
+/// into the field at `offset` of consecutive records
+static inline void las_scatter_column(const void *column,
+                                      const size_t size,
+                                      const uint64_t first,
+                                      const int num_values,
+                                      uint8_t *records,
+                                      const uint16_t point_size,
+                                      const uint16_t offset)
+{
+    for (int k = 0; k < num_values; ++k)
+    {
+        uint8_t *field = records + (size_t)k * point_size + offset;
+        if (column != NULL)
+        {
+            memcpy(field, (const uint8_t *)column + (first + (uint64_t)k) * size, size);
+        }
+        else
+        {
+            memset(field, 0, size);
+        }
+    }
+}
+
+/// Writes the fields that follow the first 20 bytes and are copied as is,
+/// for the `num_values` points starting at `first`
+static inline void las_scatter_trailing_fields(const las_raw_point_columns_t *c,
+                                               const las_point_layout_t *layout,
+                                               const uint64_t first,
+                                               const int num_values,
+                                               uint8_t *records)
+{
+    const uint16_t ps = layout->point_size;
+    if (!layout->is_legacy)
+    {
+        las_scatter_column(
+            c->point_source_id, sizeof(uint16_t), first, num_values, records, ps, 20);
+    }
+    if (layout->gps_time != LAS_POINT_LAYOUT_ABSENT)
+    {
+        las_scatter_column(
+            c->gps_time, sizeof(double), first, num_values, records, ps, layout->gps_time);
+    }
+    if (layout->rgb != LAS_POINT_LAYOUT_ABSENT)
+    {
+        const uint16_t rgb = layout->rgb;
+        las_scatter_column(c->red, sizeof(uint16_t), first, num_values, records, ps, rgb);
+        las_scatter_column(
+            c->green, sizeof(uint16_t), first, num_values, records, ps, (uint16_t)(rgb + 2));
+        las_scatter_column(
+            c->blue, sizeof(uint16_t), first, num_values, records, ps, (uint16_t)(rgb + 4));
+    }
+    if (layout->nir != LAS_POINT_LAYOUT_ABSENT)
+    {
+        las_scatter_column(c->nir, sizeof(uint16_t), first, num_values, records, ps, layout->nir);
+    }
+}
+
+#if LAS_WITH_X86_SIMD
+
+// The SIMD encoders write the records field by field, without zeroing them first:
+// bytes [0, 16) with one store per record, then [16, 20) as one 32-bit word,
+// then the fields that are copied as is.
+
+/// Loads 4 bytes of a column into the 4 lanes, zeroes if the column is NULL
+__attribute__((target("sse4.1"))) static inline __m128i las_sse41_load_column_u8(
+    const uint8_t *column, const uint64_t first)
+{
+    if (column == NULL)
+    {
+        return _mm_setzero_si128();
+    }
+    int32_t bytes;
+    memcpy(&bytes, column + first, sizeof(int32_t));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes));
+}
+
+/// Loads 4 values of a 16-bit column into the 4 lanes, zeroes if the column is NULL
+__attribute__((target("sse4.1"))) static inline __m128i las_sse41_load_column_u16(
+    const uint16_t *column, const uint64_t first)
+{
+    if (column == NULL)
+    {
+        return _mm_setzero_si128();
+    }
+    return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(column + first)));
+}
+
+/// Loads 4 values of a 32-bit column, zeroes if the column is NULL
+__attribute__((target("sse4.1"))) static inline __m128i las_sse41_load_column_i32(
+    const int32_t *column, const uint64_t first)
+{
+    if (column == NULL)
+    {
+        return _mm_setzero_si128();
+    }
+    return _mm_loadu_si128((const __m128i *)(column + first));
+}
+
+/// Returns `(column & mask) << shift` for 4 points
+__attribute__((target("sse4.1"))) static inline __m128i las_sse41_bits(const uint8_t *column,
+                                                                        const uint64_t first,
+                                                                        const int mask,
+                                                                        const int shift)
+{
+    const __m128i v = _mm_and_si128(las_sse41_load_column_u8(column, first), _mm_set1_epi32(mask));
+    return _mm_sll_epi32(v, _mm_cvtsi32_si128(shift));
+}
+
+/// Packs 4 points per iteration
+__attribute__((target("sse4.1"))) static void
+las_encode_columns_sse41(const las_raw_point_columns_t *c,
+                         const las_point_layout_t *layout,
+                         const uint64_t num_points,
+                         uint8_t *records)
+{
+    const uint16_t ps = layout->point_size;
+    const bool is_legacy = layout->is_legacy;
+    const __m128i byte = _mm_set1_epi32(0xFF);
+
+    uint64_t i = 0;
+    for (; i + 4 <= num_points; i += 4)
+    {
+        uint8_t *block = records + i * ps;
+
+        __m128i returns, flags, w16;
+        if (is_legacy)
+        {
+            returns = _mm_or_si128(
+                _mm_or_si128(las_sse41_bits(c->return_number, i, 0b111, 0),
+                             las_sse41_bits(c->number_of_returns, i, 0b111, 3)),
+                _mm_or_si128(las_sse41_bits(c->scan_direction_flag, i, 1, 6),
+                             las_sse41_bits(c->edge_of_flight_line, i, 1, 7)));
+            flags = _mm_or_si128(
+                _mm_or_si128(las_sse41_bits(c->classification, i, 0b11111, 0),
+                             las_sse41_bits(c->synthetic, i, 1, 5)),
+                _mm_or_si128(las_sse41_bits(c->key_point, i, 1, 6),
+                             las_sse41_bits(c->withheld, i, 1, 7)));
+            // scan angle rank | user data << 8 | point source id << 16
+            w16 = _mm_or_si128(
+                _mm_or_si128(_mm_and_si128(las_sse41_load_column_u16(c->scan_angle, i), byte),
+                             las_sse41_bits(c->user_data, i, 0xFF, 8)),
+                _mm_slli_epi32(las_sse41_load_column_u16(c->point_source_id, i), 16));
+        }
+        else
+        {
+            returns = _mm_or_si128(las_sse41_bits(c->return_number, i, 0b1111, 0),
+                                   las_sse41_bits(c->number_of_returns, i, 0b1111, 4));
+            flags = _mm_or_si128(
+                _mm_or_si128(_mm_or_si128(las_sse41_bits(c->synthetic, i, 1, 0),
+                                          las_sse41_bits(c->key_point, i, 1, 1)),
+                             _mm_or_si128(las_sse41_bits(c->withheld, i, 1, 2),
+                                          las_sse41_bits(c->overlap, i, 1, 3))),
+                _mm_or_si128(_mm_or_si128(las_sse41_bits(c->scanner_channel, i, 0b11, 4),
+                                          las_sse41_bits(c->scan_direction_flag, i, 1, 6)),
+                             las_sse41_bits(c->edge_of_flight_line, i, 1, 7)));
+            // classification | user data << 8 | scan angle << 16
+            w16 = _mm_or_si128(
+                _mm_or_si128(las_sse41_bits(c->classification, i, 0xFF, 0),
+                             las_sse41_bits(c->user_data, i, 0xFF, 8)),
+                _mm_slli_epi32(las_sse41_load_column_u16(c->scan_angle, i), 16));
+        }
+
+        // intensity | return byte << 16 | classification (or flags) byte << 24
+        const __m128i w12 = _mm_or_si128(
+            _mm_or_si128(las_sse41_load_column_u16(c->intensity, i), _mm_slli_epi32(returns, 16)),
+            _mm_slli_epi32(flags, 24));
+
+        // Transposes the x, y, z, w12 rows into one 16-byte row per record
+        const __m128i x = las_sse41_load_column_i32(c->x, i);
+        const __m128i y = las_sse41_load_column_i32(c->y, i);
+        const __m128i z = las_sse41_load_column_i32(c->z, i);
+        const __m128i xy_lo = _mm_unpacklo_epi32(x, y);
+        const __m128i xy_hi = _mm_unpackhi_epi32(x, y);
+        const __m128i zw_lo = _mm_unpacklo_epi32(z, w12);
+        const __m128i zw_hi = _mm_unpackhi_epi32(z, w12);
+        _mm_storeu_si128((__m128i *)block, _mm_unpacklo_epi64(xy_lo, zw_lo));
+        _mm_storeu_si128((__m128i *)(block + ps), _mm_unpackhi_epi64(xy_lo, zw_lo));
+        _mm_storeu_si128((__m128i *)(block + 2 * ps), _mm_unpacklo_epi64(xy_hi, zw_hi));
+        _mm_storeu_si128((__m128i *)(block + 3 * ps), _mm_unpackhi_epi64(xy_hi, zw_hi));
+
+        int32_t lanes[4];
+        _mm_storeu_si128((__m128i *)lanes, w16);
+        las_scatter_lanes(lanes, 4, block, ps, 16, sizeof(int32_t));
+        las_scatter_trailing_fields(c, layout, i, 4, block);
+    }
+
+    las_encode_columns_variable(c, layout, 0, i, records);
+    las_encode_columns_scalar_range(c, layout, i, num_points - i, records + i * ps);
+}
+
+/// Loads 8 bytes of a column into the 8 lanes, zeroes if the column is NULL
+__attribute__((target("avx2"))) static inline __m256i las_avx2_load_column_u8(
+    const uint8_t *column, const uint64_t first)
+{
+    if (column == NULL)
+    {
+        return _mm256_setzero_si256();
+    }
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(column + first)));
+}
+
+/// Loads 8 values of a 16-bit column into the 8 lanes, zeroes if the column is NULL
+__attribute__((target("avx2"))) static inline __m256i las_avx2_load_column_u16(
+    const uint16_t *column, const uint64_t first)
+{
+    if (column == NULL)
+    {
+        return _mm256_setzero_si256();
+    }
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(column + first)));
+}
+
+/// Loads 8 values of a 32-bit column, zeroes if the column is NULL
+__attribute__((target("avx2"))) static inline __m256i las_avx2_load_column_i32(
+    const int32_t *column, const uint64_t first)
+{
+    if (column == NULL)
+    {
+        return _mm256_setzero_si256();
+    }
+    return _mm256_loadu_si256((const __m256i *)(column + first));
+}
+
+/// Returns `(column & mask) << shift` for 8 points
+__attribute__((target("avx2"))) static inline __m256i las_avx2_bits(const uint8_t *column,
+                                                                     const uint64_t first,
+                                                                     const int mask,
+                                                                     const int shift)
+{
+    const __m256i v =
+        _mm256_and_si256(las_avx2_load_column_u8(column, first), _mm256_set1_epi32(mask));
+    return _mm256_sll_epi32(v, _mm_cvtsi32_si128(shift));
+}
+
+/// Packs 8 points per iteration
+__attribute__((target("avx2"))) static void
+las_encode_columns_avx2(const las_raw_point_columns_t *c,
+                        const las_point_layout_t *layout,
+                        const uint64_t num_points,
+                        uint8_t *records)
+{
+    const uint16_t ps = layout->point_size;
+    const bool is_legacy = layout->is_legacy;
+    const __m256i byte = _mm256_set1_epi32(0xFF);
+
+    uint64_t i = 0;
+    for (; i + 8 <= num_points; i += 8)
+    {
+        uint8_t *block = records + i * ps;
+
+        __m256i returns, flags, w16;
+        if (is_legacy)
+        {
+            returns = _mm256_or_si256(
+                _mm256_or_si256(las_avx2_bits(c->return_number, i, 0b111, 0),
+                                las_avx2_bits(c->number_of_returns, i, 0b111, 3)),
+                _mm256_or_si256(las_avx2_bits(c->scan_direction_flag, i, 1, 6),
+                                las_avx2_bits(c->edge_of_flight_line, i, 1, 7)));
+            flags = _mm256_or_si256(
+                _mm256_or_si256(las_avx2_bits(c->classification, i, 0b11111, 0),
+                                las_avx2_bits(c->synthetic, i, 1, 5)),
+                _mm256_or_si256(las_avx2_bits(c->key_point, i, 1, 6),
+                                las_avx2_bits(c->withheld, i, 1, 7)));
+            // scan angle rank | user data << 8 | point source id << 16
+            w16 = _mm256_or_si256(
+                _mm256_or_si256(
+                    _mm256_and_si256(las_avx2_load_column_u16(c->scan_angle, i), byte),
+                    las_avx2_bits(c->user_data, i, 0xFF, 8)),
+                _mm256_slli_epi32(las_avx2_load_column_u16(c->point_source_id, i), 16));
+        }
+        else
+        {
+            returns = _mm256_or_si256(las_avx2_bits(c->return_number, i, 0b1111, 0),
+                                      las_avx2_bits(c->number_of_returns, i, 0b1111, 4));
+            flags = _mm256_or_si256(
+                _mm256_or_si256(_mm256_or_si256(las_avx2_bits(c->synthetic, i, 1, 0),
+                                                las_avx2_bits(c->key_point, i, 1, 1)),
+                                _mm256_or_si256(las_avx2_bits(c->withheld, i, 1, 2),
+                                                las_avx2_bits(c->overlap, i, 1, 3))),
+                _mm256_or_si256(_mm256_or_si256(las_avx2_bits(c->scanner_channel, i, 0b11, 4),
+                                                las_avx2_bits(c->scan_direction_flag, i, 1, 6)),
+                                las_avx2_bits(c->edge_of_flight_line, i, 1, 7)));
+            // classification | user data << 8 | scan angle << 16
+            w16 = _mm256_or_si256(
+                _mm256_or_si256(las_avx2_bits(c->classification, i, 0xFF, 0),
+                                las_avx2_bits(c->user_data, i, 0xFF, 8)),
+                _mm256_slli_epi32(las_avx2_load_column_u16(c->scan_angle, i), 16));
+        }
+
+        // intensity | return byte << 16 | classification (or flags) byte << 24
+        const __m256i intensities = las_avx2_load_column_u16(c->intensity, i);
+        const __m256i w12 = _mm256_or_si256(
+            _mm256_or_si256(intensities, _mm256_slli_epi32(returns, 16)),
+            _mm256_slli_epi32(flags, 24));
+
+        // Transposes the x, y, z, w12 rows into one 16-byte row per record,
+        // the unpacks work within 128-bit halves: the low half holds records 0 to 3,
+        // the high half records 4 to 7
+        const __m256i x = las_avx2_load_column_i32(c->x, i);
+        const __m256i y = las_avx2_load_column_i32(c->y, i);
+        const __m256i z = las_avx2_load_column_i32(c->z, i);
+        const __m256i xy_lo = _mm256_unpacklo_epi32(x, y);
+        const __m256i xy_hi = _mm256_unpackhi_epi32(x, y);
+        const __m256i zw_lo = _mm256_unpacklo_epi32(z, w12);
+        const __m256i zw_hi = _mm256_unpackhi_epi32(z, w12);
+        const __m256i rows[4] = {
+            _mm256_unpacklo_epi64(xy_lo, zw_lo), // records 0 and 4
+            _mm256_unpackhi_epi64(xy_lo, zw_lo), // records 1 and 5
+            _mm256_unpacklo_epi64(xy_hi, zw_hi), // records 2 and 6
+            _mm256_unpackhi_epi64(xy_hi, zw_hi), // records 3 and 7
+        };
+        for (int k = 0; k < 4; ++k)
+        {
+            _mm_storeu_si128((__m128i *)(block + (size_t)k * ps), _mm256_castsi256_si128(rows[k]));
+            _mm_storeu_si128((__m128i *)(block + (size_t)(k + 4) * ps),
+                             _mm256_extracti128_si256(rows[k], 1));
+        }
+
+        int32_t lanes[8];
+        _mm256_storeu_si256((__m256i *)lanes, w16);
+        las_scatter_lanes(lanes, 8, block, ps, 16, sizeof(int32_t));
+        las_scatter_trailing_fields(c, layout, i, 8, block);
+    }
+
+    las_encode_columns_variable(c, layout, 0, i, records);
+    las_encode_columns_scalar_range(c, layout, i, num_points - i, records + i * ps);
+}
+#endif
+
+las_raw_point_columns_encode_fn las_raw_point_columns_select_encode_fn(void)
+{
+#if LAS_WITH_X86_SIMD
+    const las_simd_level_t level = las_cpu_simd_level();
+    if (level >= LAS_SIMD_AVX2)
+    {
+        return las_encode_columns_avx2;
+    }
+    if (level >= LAS_SIMD_SSE41)
+    {
+        return las_encode_columns_sse41;
+    }
+#endif
+    return las_encode_columns_scalar;
+}
+
+las_raw_point_columns_t las_raw_point_columns_from_columns(const las_point_columns_t *columns)
+{
+    las_raw_point_columns_t view;
+    memset(&view, 0, sizeof(las_raw_point_columns_t));
+    view.intensity = (uint16_t *)columns->intensity;
+    view.return_number = (uint8_t *)columns->return_number;
+    view.number_of_returns = (uint8_t *)columns->number_of_returns;
+    view.synthetic = (uint8_t *)columns->synthetic;
+    view.key_point = (uint8_t *)columns->key_point;
+    view.withheld = (uint8_t *)columns->withheld;
+    view.overlap = (uint8_t *)columns->overlap;
+    view.scanner_channel = (uint8_t *)columns->scanner_channel;
+    view.scan_direction_flag = (uint8_t *)columns->scan_direction_flag;
+    view.edge_of_flight_line = (uint8_t *)columns->edge_of_flight_line;
+    view.classification = (uint8_t *)columns->classification;
+    view.user_data = (uint8_t *)columns->user_data;
+    view.scan_angle = (uint16_t *)columns->scan_angle;
+    view.point_source_id = (uint16_t *)columns->point_source_id;
+    view.gps_time = (double *)columns->gps_time;
+    view.red = (uint16_t *)columns->red;
+    view.green = (uint16_t *)columns->green;
+    view.blue = (uint16_t *)columns->blue;
+    view.nir = (uint16_t *)columns->nir;
+    view.wave_packet = (las_wave_packet_t *)columns->wave_packet;
+    view.extra_bytes = (uint8_t *)columns->extra_bytes;
+    return view;
+}
@@ -0,0 +1,254 @@
+#include "private/point_stats.h"
+
+#include <string.h>
+
+#include "private/cpu.h"
+#include "private/macro.h"
+#include "private/point.h"
+
+#if LAS_WITH_X86_SIMD
+#include <immintrin.h>
+#endif
+
+void las_point_stats_init(las_point_stats_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        self->mins[i] = INT32_MAX;
+        self->maxs[i] = INT32_MIN;
+    }
+    memset(self->return_counts, 0, sizeof(uint64_t) * LAS_POINT_STATS_RETURN_COUNTS_SIZE);
+}
+
+/// Converts a bound back to the integer stored in records
+static inline int32_t
+las_point_stats_unscale(const double value, const double scale, const double offset)
+{
+    const double unscaled = (value - offset) / scale;
+    // rounded to the nearest, the cast truncates
+    const double v = (unscaled >= 0.0) ? unscaled + 0.5 : unscaled - 0.5;
+    if (v <= (double)INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+    if (v >= (double)INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    return (int32_t)v;
+}
+
+void las_point_stats_from_header(las_point_stats_t *self, const las_header_t *header)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(header);
+
+    las_point_stats_init(self);
+
+    if (header->point_count != 0)
+    {
+        const double mins[3] = {header->mins.x, header->mins.y, header->mins.z};
+        const double maxs[3] = {header->maxs.x, header->maxs.y, header->maxs.z};
+        const double scales[3] = {
+            header->scaling.scales.x, header->scaling.scales.y, header->scaling.scales.z};
+        const double offsets[3] = {
+            header->scaling.offsets.x, header->scaling.offsets.y, header->scaling.offsets.z};
+
+        for (int i = 0; i < 3; ++i)
+        {
+            // with a negative scale, the min bound comes from the max integer
+            const int32_t a = las_point_stats_unscale(mins[i], scales[i], offsets[i]);
+            const int32_t b = las_point_stats_unscale(maxs[i], scales[i], offsets[i]);
+            self->mins[i] = (a < b) ? a : b;
+            self->maxs[i] = (a < b) ? b : a;
+        }
+    }
+
+    for (int i = 0; i < LAS_NUMBER_OF_POINTS_BY_RETURN_SIZE; ++i)
+    {
+        self->return_counts[i + 1] = header->number_of_points_by_return[i];
+    }
+}
+
+void las_point_stats_merge(las_point_stats_t *self, const las_point_stats_t *other)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(other);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        self->mins[i] = (other->mins[i] < self->mins[i]) ? other->mins[i] : self->mins[i];
+        self->maxs[i] = (other->maxs[i] > self->maxs[i]) ? other->maxs[i] : self->maxs[i];
+    }
+    for (int i = 0; i < LAS_POINT_STATS_RETURN_COUNTS_SIZE; ++i)
+    {
+        self->return_counts[i] += other->return_counts[i];
+    }
+}
+
+static void las_point_stats_update_scalar(las_point_stats_t *stats,
+                                          const uint8_t *records,
+                                          const uint64_t num_points,
+                                          const uint16_t point_size,
+                                          const uint8_t return_mask)
+{
+    int32_t mins[3] = {stats->mins[0], stats->mins[1], stats->mins[2]};
+    int32_t maxs[3] = {stats->maxs[0], stats->maxs[1], stats->maxs[2]};
+
+    const uint8_t *record = records;
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        int32_t xyz[3];
+        // x, y, z are the first fields of all point formats
+        memcpy(xyz, record, sizeof(int32_t) * 3);
+        for (int j = 0; j < 3; ++j)
+        {
+            mins[j] = (xyz[j] < mins[j]) ? xyz[j] : mins[j];
+            maxs[j] = (xyz[j] > maxs[j]) ? xyz[j] : maxs[j];
+        }
+        stats->return_counts[record[LAS_POINT_RETURN_BYTE_OFFSET] & return_mask]++;
+        record += point_size;
+    }
+
+    memcpy(stats->mins, mins, sizeof(int32_t) * 3);
+    memcpy(stats->maxs, maxs, sizeof(int32_t) * 3);
+}
+
+#if LAS_WITH_X86_SIMD
+/// Processes 8 records per iteration: x, y and z of the 8 records are
+/// gathered into one register each, reduced with vector min/max,
+/// while the return numbers of those same records are counted.
+__attribute__((target("avx2"))) static void
+las_point_stats_update_avx2(las_point_stats_t *stats,
+                            const uint8_t *records,
+                            const uint64_t num_points,
+                            const uint16_t point_size,
+                            const uint8_t return_mask)
+{
+    const int32_t ps = (int32_t)point_size;
+    const __m256i offsets =
+        _mm256_setr_epi32(0, ps, 2 * ps, 3 * ps, 4 * ps, 5 * ps, 6 * ps, 7 * ps);
+
+    __m256i mins[3];
+    __m256i maxs[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        mins[j] = _mm256_set1_epi32(stats->mins[j]);
+        maxs[j] = _mm256_set1_epi32(stats->maxs[j]);
+    }
+
+    const uint64_t num_blocks = num_points / 8;
+    const uint64_t block_size = (uint64_t)point_size * 8;
+    const uint8_t *block = records;
+    for (uint64_t i = 0; i < num_blocks; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            const int *coordinates =
+                (const int *)(block + sizeof(int32_t) * (size_t)j);
+            const __m256i v = _mm256_i32gather_epi32(coordinates, offsets, 1);
+            mins[j] = _mm256_min_epi32(mins[j], v);
+            maxs[j] = _mm256_max_epi32(maxs[j], v);
+        }
+
+        const uint8_t *return_byte = block + LAS_POINT_RETURN_BYTE_OFFSET;
+        for (int k = 0; k < 8; ++k)
+        {
+            stats->return_counts[*return_byte & return_mask]++;
+            return_byte += point_size;
+        }
+
+        block += block_size;
+    }
+
+    for (int j = 0; j < 3; ++j)
+    {
+        int32_t lanes_min[8];
+        int32_t lanes_max[8];
+        _mm256_storeu_si256((__m256i *)lanes_min, mins[j]);
+        _mm256_storeu_si256((__m256i *)lanes_max, maxs[j]);
+        for (int k = 0; k < 8; ++k)
+        {
+            stats->mins[j] = (lanes_min[k] < stats->mins[j]) ? lanes_min[k] : stats->mins[j];
+            stats->maxs[j] = (lanes_max[k] > stats->maxs[j]) ? lanes_max[k] : stats->maxs[j];
+        }
+    }
+
+    las_point_stats_update_scalar(
+        stats, block, num_points - num_blocks * 8, point_size, return_mask);
+}
+#endif
+
+las_point_stats_update_fn las_point_stats_select_update_fn(void)
+{
+#if LAS_WITH_X86_SIMD
+    if (las_cpu_simd_level() >= LAS_SIMD_AVX2)
+    {
+        return las_point_stats_update_avx2;
+    }
+#endif
+    return las_point_stats_update_scalar;
+}
+
+/// Scales the integer bounds, taking care of negative scales
+/// which swap which one is the minimum
+static inline void las_point_stats_scale_bounds(const int32_t min,
+                                                const int32_t max,
+                                                const double scale,
+                                                const double offset,
+                                                double *out_min,
+                                                double *out_max)
+{
+    const double a = scaling_apply(scale, offset, min);
+    const double b = scaling_apply(scale, offset, max);
+    *out_min = (a < b) ? a : b;
+    *out_max = (a < b) ? b : a;
+}
+
+void las_point_stats_to_header(const las_point_stats_t *self, las_header_t *header)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(header);
+
+    if (header->point_count == 0)
+    {
+        memset(&header->mins, 0, sizeof(las_vector_3_t));
+        memset(&header->maxs, 0, sizeof(las_vector_3_t));
+    }
+    else
+    {
+        const las_scaling_t scaling = header->scaling;
+        las_point_stats_scale_bounds(self->mins[0],
+                                     self->maxs[0],
+                                     scaling.scales.x,
+                                     scaling.offsets.x,
+                                     &header->mins.x,
+                                     &header->maxs.x);
+        las_point_stats_scale_bounds(self->mins[1],
+                                     self->maxs[1],
+                                     scaling.scales.y,
+                                     scaling.offsets.y,
+                                     &header->mins.y,
+                                     &header->maxs.y);
+        las_point_stats_scale_bounds(self->mins[2],
+                                     self->maxs[2],
+                                     scaling.scales.z,
+                                     scaling.offsets.z,
+                                     &header->mins.z,
+                                     &header->maxs.z);
+    }
+
+    // Legacy formats can only hold return numbers up to 5
+    const uint8_t max_return_number = (header->point_format.id <= 5)
+                                          ? LAS_LEGACY_NUMBER_OF_POINTS_BY_RETURN_SIZE
+                                          : LAS_NUMBER_OF_POINTS_BY_RETURN_SIZE;
+    memset(header->number_of_points_by_return,
+           0,
+           sizeof(uint64_t) * LAS_NUMBER_OF_POINTS_BY_RETURN_SIZE);
+    for (uint8_t i = 1; i <= max_return_number; ++i)
+    {
+        header->number_of_points_by_return[i - 1] = self->return_counts[i];
+    }
+}
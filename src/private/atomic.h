@@ -0,0 +1,80 @@
+#ifndef LAS_C_PRIV_ATOMIC_H
+#define LAS_C_PRIV_ATOMIC_H
+
+#include <stdint.h>
+
+/// The few atomic operations the library needs
+///
+/// MSVC's C compiler has no usable <stdatomic.h>, the Interlocked functions
+/// are used there instead.
+#if defined(_MSC_VER) && !defined(__clang__)
+
+#include <windows.h>
+
+typedef volatile LONG las_atomic_u32_t;
+typedef volatile LONG64 las_atomic_u64_t;
+
+static inline void las_atomic_u32_init(las_atomic_u32_t *self, const uint32_t value)
+{
+    *self = (LONG)value;
+}
+
+static inline void las_atomic_u32_increment(las_atomic_u32_t *self)
+{
+    InterlockedIncrement(self);
+}
+
+/// Returns the new value
+static inline uint32_t las_atomic_u32_decrement(las_atomic_u32_t *self)
+{
+    return (uint32_t)InterlockedDecrement(self);
+}
+
+static inline void las_atomic_u64_init(las_atomic_u64_t *self, const uint64_t value)
+{
+    *self = (LONG64)value;
+}
+
+/// Returns the previous value
+static inline uint64_t las_atomic_u64_fetch_add(las_atomic_u64_t *self, const uint64_t value)
+{
+    return (uint64_t)InterlockedExchangeAdd64(self, (LONG64)value);
+}
+
+#else
+
+#include <stdatomic.h>
+
+typedef atomic_uint_least32_t las_atomic_u32_t;
+typedef atomic_uint_least64_t las_atomic_u64_t;
+
+static inline void las_atomic_u32_init(las_atomic_u32_t *self, const uint32_t value)
+{
+    atomic_init(self, value);
+}
+
+static inline void las_atomic_u32_increment(las_atomic_u32_t *self)
+{
+    atomic_fetch_add_explicit(self, 1, memory_order_relaxed);
+}
+
+/// Returns the new value
+static inline uint32_t las_atomic_u32_decrement(las_atomic_u32_t *self)
+{
+    return (uint32_t)(atomic_fetch_sub_explicit(self, 1, memory_order_acq_rel) - 1);
+}
+
+static inline void las_atomic_u64_init(las_atomic_u64_t *self, const uint64_t value)
+{
+    atomic_init(self, value);
+}
+
+/// Returns the previous value
+static inline uint64_t las_atomic_u64_fetch_add(las_atomic_u64_t *self, const uint64_t value)
+{
+    return atomic_fetch_add(self, value);
+}
+
+#endif
+
+#endif // LAS_C_PRIV_ATOMIC_H
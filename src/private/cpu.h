@@ -0,0 +1,33 @@
+#ifndef LAS_C_PRIV_CPU_H
+#define LAS_C_PRIV_CPU_H
+
+/// Whether the x86 SIMD kernels can be compiled
+///
+/// They use per function `target` attributes, so they are compiled
+/// even when the build does not target those instruction sets,
+/// and are only used when the CPU running the program supports them.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define LAS_WITH_X86_SIMD 1
+#else
+#define LAS_WITH_X86_SIMD 0
+#endif
+
+/// SIMD instruction sets that kernels may use, from least to most capable
+typedef enum las_simd_level
+{
+    LAS_SIMD_NONE = 0,
+    LAS_SIMD_SSE41,
+    LAS_SIMD_AVX2,
+} las_simd_level_t;
+
+/// Returns the most capable instruction set supported by the CPU
+///
+/// The `LAS_C_SIMD` environment variable (`none`, `sse4.1` or `avx2`)
+/// can lower the returned level, e.g. to compare kernels against the scalar code.
+///
+/// The level is detected once per process, so functions without state
+/// (e.g. batch conversions) can select their kernels on each call.
+/// Readers and writers still select theirs once, when opened.
+las_simd_level_t las_cpu_simd_level(void);
+
+#endif // LAS_C_PRIV_CPU_H
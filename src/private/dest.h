@@ -33,8 +33,28 @@ typedef struct las_dest_t las_dest_t;
 
 // TODO delete function for las_dest
 
+/// Dest that writes into a growable in memory buffer
+///
+/// The buffer is freed when the dest is closed,
+/// unless the `data` was taken (and set to NULL) before.
+typedef struct las_memory_dest_t
+{
+    uint8_t *data;
+    /// Number of bytes written (i.e. position of the end)
+    uint64_t size;
+    uint64_t capacity;
+    uint64_t pos;
+    int has_failed;
+} las_memory_dest_t;
+
 int las_dest_new_file(const char *filename, las_dest_t *dest);
 
+/// Opens an existing file for writing, without truncating it
+int las_dest_open_file(const char *filename, las_dest_t *dest);
+
+/// Creates a dest that writes in memory, its `inner` is a `las_memory_dest_t`
+int las_dest_new_memory(las_dest_t *dest);
+
 uint64_t las_dest_write(las_dest_t *self, const uint8_t *buffer, uint64_t n);
 
 int las_dest_seek(las_dest_t *self, int64_t n, las_seek_from_t from);
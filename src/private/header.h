@@ -10,11 +10,36 @@
 
 void las_vlr_deinit(las_vlr_t *self);
 
+/// Same as `las_vlr_deinit`, except that a payload stored in the `arena` is not freed
+void las_vlr_deinit_shared(las_vlr_t *self, const las_vlr_arena_t *arena);
+
 las_error_t
 las_header_read_from(las_source_t *source, las_header_t *header, bool *is_data_compressed);
 
 las_error_t las_header_write_to(const las_header_t *self, las_dest_t *dest);
 
+/// Returns the offset to point data `las_header_write_to` writes for this header
+/// (the size of the header, its extra bytes and VLRs)
+uint32_t las_header_written_offset_to_point_data(const las_header_t *self);
+
+/// Reads the EVLRs descriptions (but not their payload)
+/// located at `header->start_of_evlrs` and stores them in the header.
+las_error_t las_evlrs_read_from(las_source_t *source, las_header_t *header);
+
+/// Loads the payload of the EVLR, does nothing if it is already loaded.
+///
+/// The position of the `source` is __not__ restored.
+las_error_t las_evlr_read_data_from(las_evlr_t *self, las_source_t *source);
+
+/// Writes the EVLR and its payload
+///
+/// When the payload is not loaded, it is copied from the `data_source`
+/// at the EVLR's `offset_to_data`, in blocks of bounded size.
+/// `data_source` can be NULL if the payload is loaded,
+/// otherwise `LAS_ERROR_EVLR_DATA_NOT_LOADED` is returned.
+las_error_t
+las_evlr_write_to(const las_evlr_t *self, las_source_t *data_source, las_dest_t *dest);
+
 las_error_t las_header_validate(const las_header_t *self);
 
 /// When writing we are more strict than when reading a file.
@@ -0,0 +1,124 @@
+#ifndef LAS_C_PRIV_LAZ_ARITHMETIC_H
+#define LAS_C_PRIV_LAZ_ARITHMETIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Adaptive arithmetic coding, as used by LASzip
+///
+/// This is the small subset needed to encode and decode the LAZ chunk table
+/// (points are (de)compressed by lazrs), it must produce the exact same
+/// bytes as LASzip's ArithmeticEncoder/Decoder and IntegerCompressor.
+
+/// Adaptive model for binary symbols
+typedef struct las_arithmetic_bit_model
+{
+    uint32_t update_cycle;
+    uint32_t bits_until_update;
+    uint32_t bit_0_prob;
+    uint32_t bit_0_count;
+    uint32_t bit_count;
+} las_arithmetic_bit_model_t;
+
+/// Adaptive model for symbols in [0, num_symbols)
+typedef struct las_arithmetic_model
+{
+    uint32_t *distribution;
+    uint32_t *symbol_count;
+    uint32_t total_count;
+    uint32_t update_cycle;
+    uint32_t symbols_until_update;
+    uint32_t num_symbols;
+    uint32_t last_symbol;
+} las_arithmetic_model_t;
+
+/// Encodes into a growable in memory buffer
+typedef struct las_arithmetic_encoder
+{
+    uint8_t *data;
+    uint64_t size;
+    uint64_t capacity;
+    uint32_t base;
+    uint32_t length;
+    bool has_failed;
+} las_arithmetic_encoder_t;
+
+/// Decodes from an in memory buffer
+///
+/// Reading past the end of the buffer yields zeros, and sets `is_past_end`
+typedef struct las_arithmetic_decoder
+{
+    const uint8_t *data;
+    uint64_t size;
+    uint64_t pos;
+    uint32_t value;
+    uint32_t length;
+    bool is_past_end;
+} las_arithmetic_decoder_t;
+
+/// Compresses integers as corrections to a prediction
+///
+/// Only the configuration used by the chunk table
+/// (32 bits, `bits_high` of 8, no range) is supported.
+typedef struct las_integer_compressor
+{
+    las_arithmetic_model_t *m_bits;
+    uint32_t num_contexts;
+    /// corrector 0 is a bit model, the others are symbol models
+    las_arithmetic_bit_model_t corrector_0;
+    las_arithmetic_model_t correctors[32];
+} las_integer_compressor_t;
+
+void las_arithmetic_bit_model_init(las_arithmetic_bit_model_t *self);
+
+/// Returns false if memory could not be allocated
+bool las_arithmetic_model_init(las_arithmetic_model_t *self, uint32_t num_symbols);
+
+void las_arithmetic_model_deinit(las_arithmetic_model_t *self);
+
+void las_arithmetic_encoder_init(las_arithmetic_encoder_t *self);
+
+void las_arithmetic_encoder_deinit(las_arithmetic_encoder_t *self);
+
+void las_arithmetic_encoder_encode_bit(las_arithmetic_encoder_t *self,
+                                       las_arithmetic_bit_model_t *model,
+                                       uint32_t bit);
+
+void las_arithmetic_encoder_encode_symbol(las_arithmetic_encoder_t *self,
+                                          las_arithmetic_model_t *model,
+                                          uint32_t symbol);
+
+void las_arithmetic_encoder_write_bits(las_arithmetic_encoder_t *self, uint32_t bits, uint32_t sym);
+
+/// Flushes the encoder, no more symbols can be encoded after this
+void las_arithmetic_encoder_done(las_arithmetic_encoder_t *self);
+
+void las_arithmetic_decoder_init(las_arithmetic_decoder_t *self,
+                                 const uint8_t *data,
+                                 uint64_t size);
+
+uint32_t las_arithmetic_decoder_decode_bit(las_arithmetic_decoder_t *self,
+                                           las_arithmetic_bit_model_t *model);
+
+uint32_t las_arithmetic_decoder_decode_symbol(las_arithmetic_decoder_t *self,
+                                              las_arithmetic_model_t *model);
+
+uint32_t las_arithmetic_decoder_read_bits(las_arithmetic_decoder_t *self, uint32_t bits);
+
+/// Returns false if memory could not be allocated
+bool las_integer_compressor_init(las_integer_compressor_t *self, uint32_t num_contexts);
+
+void las_integer_compressor_deinit(las_integer_compressor_t *self);
+
+void las_integer_compressor_compress(las_integer_compressor_t *self,
+                                     las_arithmetic_encoder_t *encoder,
+                                     int32_t pred,
+                                     int32_t real,
+                                     uint32_t context);
+
+int32_t las_integer_compressor_decompress(las_integer_compressor_t *self,
+                                          las_arithmetic_decoder_t *decoder,
+                                          int32_t pred,
+                                          uint32_t context);
+
+#endif // LAS_C_PRIV_LAZ_ARITHMETIC_H
@@ -0,0 +1,49 @@
+#ifndef LAS_C_PRIV_LAZ_CHUNK_TABLE_H
+#define LAS_C_PRIV_LAZ_CHUNK_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dest.h"
+#include "source.h"
+
+/// Chunk size stored in the LASzip VLR when chunks have variable sizes
+#define LAS_LAZ_VARIABLE_CHUNK_SIZE UINT32_MAX
+
+/// Offset of the chunk size in the LASzip VLR's data
+#define LAS_LAZ_VLR_CHUNK_SIZE_OFFSET 12
+
+/// One entry of the chunk table of a LAZ file
+typedef struct las_laz_chunk_entry
+{
+    /// Number of points in the chunk
+    uint64_t point_count;
+    /// Size of the compressed chunk, in bytes
+    uint64_t byte_count;
+} las_laz_chunk_entry_t;
+
+/// Writes the chunk table, in LASzip's format, at the current position of the dest
+///
+/// Point counts are only stored when `is_variable_size` is true,
+/// otherwise all chunks (but the last) have the size stored in the LASzip VLR.
+las_error_t las_laz_chunk_table_write_to(const las_laz_chunk_entry_t *entries,
+                                         uint64_t num_entries,
+                                         bool is_variable_size,
+                                         las_dest_t *dest);
+
+/// Reads the chunk table of LAZ data whose points start at `offset_to_point_data`
+///
+/// `chunk_size` is the one of the LASzip VLR, when it is not `LAS_LAZ_VARIABLE_CHUNK_SIZE`
+/// the point counts are not stored: all chunks have `chunk_size` points,
+/// except the last one which has what remains of the `point_count`.
+///
+/// The `out_entries` are allocated and must be freed by the caller.
+/// The position of the source is __not__ restored.
+las_error_t las_laz_chunk_table_read_from(las_source_t *source,
+                                          uint64_t offset_to_point_data,
+                                          uint32_t chunk_size,
+                                          uint64_t point_count,
+                                          las_laz_chunk_entry_t **out_entries,
+                                          uint64_t *out_num_entries);
+
+#endif // LAS_C_PRIV_LAZ_CHUNK_TABLE_H
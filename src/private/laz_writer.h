@@ -0,0 +1,85 @@
+#ifndef LAS_C_PRIV_LAZ_WRITER_H
+#define LAS_C_PRIV_LAZ_WRITER_H
+
+#ifdef WITH_LAZRS
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dest.h"
+#include "las/header.h"
+
+/// Number of points per chunk when the user does not choose
+#define LAS_LAZ_DEFAULT_CHUNK_SIZE 50000
+
+/// Compresses point records into LAZ chunks
+///
+/// Each chunk is compressed independently (by a worker thread, or by the
+/// caller when there are no workers), then chunks are written in order
+/// followed by the chunk table. So the output does not depend on the
+/// number of workers.
+///
+/// A writer created with `las_laz_writer_new_single` instead gives all the
+/// points to one lazrs compressor, which writes the chunks and the chunk table.
+typedef struct las_laz_writer las_laz_writer_t;
+
+/// Creates the data of the LASzip VLR for the point format
+///
+/// `chunk_size` is the requested number of points per chunk, it is lowered
+/// if it is bigger than what the compressor supports, the value actually
+/// used is written back.
+las_error_t las_laz_vlr_data_new(las_point_format_t point_format,
+                                 uint32_t *chunk_size,
+                                 uint8_t **out_data,
+                                 uint16_t *out_size);
+
+#ifdef WITH_LAZ_CHUNKED_WRITER
+/// Creates the writer, the compressed data starts at the current position of the `dest`
+///
+/// The chunk table is encoded by `las_laz_chunk_table_write_to`, not by lazrs,
+/// which is why this writer is only built with `WITH_LAZ_CHUNKED_WRITER`.
+///
+/// The `dest` must outlive the writer.
+las_error_t las_laz_writer_new(las_dest_t *dest,
+                               las_point_format_t point_format,
+                               uint32_t chunk_size,
+                               uint32_t num_workers,
+                               las_laz_writer_t **out_writer);
+#endif
+
+/// Creates a writer that gives the points to a single lazrs compressor,
+/// the compressed data starts at the current position of the `dest`
+///
+/// The chunks have the compressor's own chunk size, and cannot be finished early.
+///
+/// The `dest` must outlive the writer.
+las_error_t las_laz_writer_new_single(las_dest_t *dest,
+                                      las_point_format_t point_format,
+                                      las_laz_writer_t **out_writer);
+
+/// Queues the `num_points` records for compression
+las_error_t
+las_laz_writer_write(las_laz_writer_t *self, const uint8_t *records, uint64_t num_points);
+
+/// Closes the chunk being filled (if it has points), the next points start a new chunk
+///
+/// Closing a chunk before it is full switches the writer to variable size chunks.
+/// Returns `LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA` for writers created with
+/// `las_laz_writer_new_single`.
+las_error_t las_laz_writer_finish_chunk(las_laz_writer_t *self);
+
+/// Returns whether chunks of different sizes were written,
+/// the LASzip VLR must then have `LAS_LAZ_VARIABLE_CHUNK_SIZE` as chunk size
+bool las_laz_writer_is_variable_size(const las_laz_writer_t *self);
+
+/// Compresses the remaining points, then writes the chunk table
+las_error_t las_laz_writer_done(las_laz_writer_t *self);
+
+/// Waits for the workers and frees the writer
+///
+/// `self` can be NULL
+void las_laz_writer_delete(las_laz_writer_t *self);
+
+#endif
+
+#endif // LAS_C_PRIV_LAZ_WRITER_H
@@ -55,4 +55,14 @@
 
 #define MEMBER_SIZE(type, member) sizeof(((type *)0)->member)
 
+/// Forces a function to be inlined, e.g. so that its branches on
+/// arguments that are constant at the call site are removed
+#if defined(__GNUC__)
+#define LAS_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define LAS_ALWAYS_INLINE __forceinline
+#else
+#define LAS_ALWAYS_INLINE inline
+#endif
+
 #endif // LAS_C_MACRO_H
@@ -3,11 +3,17 @@
 
 #include "las/point.h"
 
+#include <stdbool.h>
+
 #include "header.h"
 #include "source.h"
 
 #define LAS_WAVE_PACKET_SIZE 29
 
+/// Offset of the byte holding the return number, in a point record
+/// (it is the same for all point formats)
+#define LAS_POINT_RETURN_BYTE_OFFSET 14
+
 // TODO there is no reason for the to_ and from_ function to take
 // parameters with slight order change
 
@@ -50,4 +56,82 @@ void las_raw_point_14_to_buffer(const las_raw_point_14_t *point14,
                                 las_point_format_t point_format,
                                 uint8_t *buffer);
 
+/// Decodes `num_points` consecutive records into `points`
+///
+/// The `points` must have been prepared for the `point_format`.
+typedef void (*las_raw_point_decode_many_fn)(const uint8_t *records,
+                                             las_point_format_t point_format,
+                                             las_raw_point_t *points,
+                                             uint64_t num_points);
+
+/// Encodes `num_points` `points` into consecutive records
+typedef void (*las_raw_point_encode_many_fn)(const las_raw_point_t *points,
+                                             uint64_t num_points,
+                                             las_point_format_t point_format,
+                                             uint8_t *records);
+
+/// Returns the decoder specialized for the point format
+///
+/// It does not check which optional fields the format has for each point,
+/// readers select it once, when opened.
+las_raw_point_decode_many_fn las_raw_point_select_decode_many_fn(uint8_t point_format_id);
+
+/// Returns the encoder specialized for the point format
+///
+/// See `las_raw_point_select_decode_many_fn`.
+las_raw_point_encode_many_fn las_raw_point_select_encode_many_fn(uint8_t point_format_id);
+
+/// Writes the members of the `point` to the `buffer`, except its coordinates
+///
+/// The coordinates need the scaling to be converted, they are written
+/// separately, for many points at once (see `las_quantize_fn`).
+/// Fields the point format cannot hold are ignored, when the `point`
+/// has no extra bytes, the extra bytes of the record are zeroed.
+///
+/// \param point The point to write
+/// \param point_format The point format, to know which fields needs to be written
+/// \param buffer Output buffer, its size __must__ be >= header->point_size
+void las_point_to_buffer_without_xyz(const las_point_t *point,
+                                     las_point_format_t point_format,
+                                     uint8_t *buffer);
+
+/// Converts the scan angle rank of formats 0 to 5 (signed, in degrees)
+/// into the scan angle of formats 6 to 10 (signed, in 0.006 degree steps)
+uint16_t las_scan_angle_from_rank(uint8_t scan_angle_rank);
+
+/// Converts the scan angle of formats 6 to 10 into the scan angle rank
+/// of formats 0 to 5, rounded to the nearest degree and clamped to [-90, 90]
+uint8_t las_scan_angle_to_rank(uint16_t scan_angle);
+
+/// Marks an optional field that the point format does not have
+#define LAS_POINT_LAYOUT_ABSENT UINT16_MAX
+
+/// Offsets (in bytes) of the fields in a point record
+///
+/// x, y, z, intensity and the return byte have the same offsets
+/// in all formats, they are not listed.
+typedef struct las_point_layout
+{
+    /// True for formats 0 to 5, where the flags are packed with the
+    /// classification, and the scan angle is a single byte
+    bool is_legacy;
+    uint16_t classification;
+    /// Byte holding the synthetic, key point and withheld flags
+    /// (and overlap, scanner channel for formats 6 to 10)
+    uint16_t classification_flags;
+    uint16_t scan_angle;
+    uint16_t user_data;
+    uint16_t point_source_id;
+    /// Optional fields, `LAS_POINT_LAYOUT_ABSENT` when not in the format
+    uint16_t gps_time;
+    uint16_t rgb;
+    uint16_t nir;
+    uint16_t wave_packet;
+    uint16_t extra_bytes;
+    uint16_t point_size;
+} las_point_layout_t;
+
+/// Returns the offsets of the fields for the point format
+las_point_layout_t las_point_layout_from_format(las_point_format_t point_format);
+
 #endif // LAS_C_PRIV_POINT_H
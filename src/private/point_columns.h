@@ -0,0 +1,49 @@
+#ifndef LAS_C_PRIV_POINT_COLUMNS_H
+#define LAS_C_PRIV_POINT_COLUMNS_H
+
+#include <stdint.h>
+
+#include "las/point.h"
+
+#include "point.h"
+
+/// Decodes `num_points` consecutive records into the first `num_points`
+/// values of each non-NULL column
+///
+/// The results are the same whichever kernel is used.
+typedef void (*las_raw_point_columns_decode_fn)(const uint8_t *records,
+                                                const las_point_layout_t *layout,
+                                                uint64_t num_points,
+                                                const las_raw_point_columns_t *columns);
+
+/// Returns the column decoder best suited for the CPU
+///
+/// The SIMD kernels decode blocks of records at once: the fields are
+/// gathered from the records into vector registers, and the bit fields
+/// (return numbers, flags, classification) are unpacked with vector shifts and masks.
+las_raw_point_columns_decode_fn las_raw_point_columns_select_decode_fn(void);
+
+/// Packs `num_points` points given as `columns` into consecutive records
+///
+/// The records are fully written, dimensions left NULL are zeroed.
+/// The bytes are the same whichever kernel is used, and the same as
+/// `las_raw_point_10_to_buffer` / `las_raw_point_14_to_buffer` would write.
+typedef void (*las_raw_point_columns_encode_fn)(const las_raw_point_columns_t *columns,
+                                                const las_point_layout_t *layout,
+                                                uint64_t num_points,
+                                                uint8_t *records);
+
+/// Returns the column encoder best suited for the CPU
+///
+/// The SIMD kernels combine the bit fields of a block of points with vector
+/// shifts and ors, and transpose x, y, z and the intensity/return/flags word
+/// so that the first 16 bytes of each record are written with one store.
+las_raw_point_columns_encode_fn las_raw_point_columns_select_encode_fn(void);
+
+/// Returns a view of the `columns` of scaled points, without the coordinates
+///
+/// The encoders only read the columns, the view can be passed to them
+/// even though its members are not const.
+las_raw_point_columns_t las_raw_point_columns_from_columns(const las_point_columns_t *columns);
+
+#endif // LAS_C_PRIV_POINT_COLUMNS_H
@@ -0,0 +1,62 @@
+#ifndef LAS_C_PRIV_POINT_STATS_H
+#define LAS_C_PRIV_POINT_STATS_H
+
+#include <stdint.h>
+
+#include "las/header.h"
+
+/// Number of distinct values the return number bits can hold
+#define LAS_POINT_STATS_RETURN_COUNTS_SIZE 16
+
+/// Statistics of point records, as needed by the header
+///
+/// Coordinates are kept as the integers stored in the records,
+/// they are scaled only when written into the header.
+typedef struct las_point_stats
+{
+    int32_t mins[3];
+    int32_t maxs[3];
+    /// Indexed by return number, index 0 counts points without a return number
+    uint64_t return_counts[LAS_POINT_STATS_RETURN_COUNTS_SIZE];
+} las_point_stats_t;
+
+/// Updates the `stats` with the `num_points` records stored in `records`
+///
+/// - `point_size`: size in bytes of one record
+/// - `return_mask`: mask to extract the return number from its byte
+typedef void (*las_point_stats_update_fn)(las_point_stats_t *stats,
+                                          const uint8_t *records,
+                                          uint64_t num_points,
+                                          uint16_t point_size,
+                                          uint8_t return_mask);
+
+/// Resets the stats, so that they describe an empty set of points
+void las_point_stats_init(las_point_stats_t *self);
+
+/// Initializes the stats from the bounds and number of points by return of a header
+///
+/// Used to continue the stats of an existing file.
+void las_point_stats_from_header(las_point_stats_t *self, const las_header_t *header);
+
+/// Adds the stats of `other` (computed on other records) to `self`
+void las_point_stats_merge(las_point_stats_t *self, const las_point_stats_t *other);
+
+/// Returns the update function best suited for the CPU
+///
+/// x, y, z min/max and return counts are computed in a single pass
+/// over the records.
+las_point_stats_update_fn las_point_stats_select_update_fn(void);
+
+/// Returns the return number mask for the point format
+static inline uint8_t las_point_stats_return_mask(const uint8_t point_format_id)
+{
+    return (point_format_id <= 5) ? 0b00000111 : 0b00001111;
+}
+
+/// Writes the bounds (mins, maxs) and the number of points by return into the `header`
+///
+/// The header's point count is used to know if there were any points,
+/// when there were none, bounds are set to 0.
+void las_point_stats_to_header(const las_point_stats_t *self, las_header_t *header);
+
+#endif // LAS_C_PRIV_POINT_STATS_H
@@ -0,0 +1,63 @@
+#ifndef LAS_C_PRIV_QUANTIZE_H
+#define LAS_C_PRIV_QUANTIZE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Converts scaled coordinates to the integers stored in point records
+///
+/// Each value is computed as `scaling_unapply(scale, offset, value)` would
+/// (rounded to the nearest), the results are the same whichever kernel is used.
+/// The caller checks beforehand with `las_quantize_all_fit` that the results fit in 32 bits.
+///
+/// - `values`: first coordinate to convert
+/// - `value_stride`: distance, in number of doubles, between two coordinates
+///                   (1 for a column, more for e.g. the `x` of an array of `las_point_t`)
+/// - `num_values`: number of coordinates to convert
+/// - `out`: where the first integer is written (unaligned, little-endian)
+/// - `out_stride`: distance, in bytes, between two written integers
+///                 (typically the point size)
+typedef void (*las_quantize_fn)(const double *values,
+                                size_t value_stride,
+                                uint64_t num_values,
+                                double scale,
+                                double offset,
+                                uint8_t *out,
+                                size_t out_stride);
+
+/// Returns the quantize function best suited for the CPU
+las_quantize_fn las_quantize_select_fn(void);
+
+/// Returns whether all the `num_values` coordinates, `value_stride` doubles apart,
+/// fit in 32 bits once converted with `scale` and `offset`
+///
+/// NaN never fits.
+bool las_quantize_all_fit(const double *values,
+                          size_t value_stride,
+                          uint64_t num_values,
+                          double scale,
+                          double offset);
+
+/// Converts the integers stored in point records to scaled coordinates
+///
+/// Each value is computed as `scaling_apply(scale, offset, value)` would,
+/// the results are the same whichever kernel is used.
+///
+/// - `in`: where the first integer is read (unaligned, little-endian)
+/// - `in_stride`: distance, in bytes, between two integers
+/// - `num_values`: number of coordinates to convert
+/// - `out`: first coordinate to write
+/// - `out_stride`: distance, in number of doubles, between two coordinates
+typedef void (*las_dequantize_fn)(const uint8_t *in,
+                                  size_t in_stride,
+                                  uint64_t num_values,
+                                  double scale,
+                                  double offset,
+                                  double *out,
+                                  size_t out_stride);
+
+/// Returns the dequantize function best suited for the CPU
+las_dequantize_fn las_dequantize_select_fn(void);
+
+#endif // LAS_C_PRIV_QUANTIZE_H
@@ -39,6 +39,9 @@ las_source_t las_source_new_memory(const uint8_t *buffer, uint64_t size);
 
 int las_source_new_file(const char *filename, las_source_t *source);
 
+/// Creates a source that reads the already opened `file`, it is closed with the source
+void las_source_new_from_file(FILE *file, las_source_t *source);
+
 uint64_t las_source_read(las_source_t *self, uint64_t n, uint8_t *out_buffer);
 
 int las_source_seek(las_source_t *self, int64_t n, las_seek_from_t from);
@@ -0,0 +1,48 @@
+#ifndef LAS_C_PRIV_THREAD_POOL_H
+#define LAS_C_PRIV_THREAD_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Function executed by a worker thread
+typedef void (*las_task_fn)(void *arg);
+
+/// A unit of work given to a thread pool
+///
+/// The memory of the task is owned by the caller, it must stay valid
+/// until `las_thread_pool_wait` returned for this task.
+typedef struct las_task
+{
+    las_task_fn fn;
+    void *arg;
+
+    // Managed by the pool
+    bool is_done;
+    struct las_task *next;
+} las_task_t;
+
+/// Fixed number of worker threads executing tasks in submission order
+typedef struct las_thread_pool las_thread_pool_t;
+
+/// Creates a pool with `num_threads` workers (must be > 0)
+///
+/// Returns NULL if the threads or memory could not be allocated
+las_thread_pool_t *las_thread_pool_new(uint32_t num_threads);
+
+/// Returns the number of threads the machine can run in parallel
+uint32_t las_thread_pool_available_parallelism(void);
+
+/// Queues the task, it will be executed by one of the workers
+///
+/// `task->fn` and `task->arg` must be set, the rest is initialized by the pool.
+void las_thread_pool_submit(las_thread_pool_t *self, las_task_t *task);
+
+/// Blocks until the task has been executed
+void las_thread_pool_wait(las_thread_pool_t *self, las_task_t *task);
+
+/// Waits for all queued tasks to be executed, then stops the workers and frees the pool
+///
+/// `self` can be NULL
+void las_thread_pool_delete(las_thread_pool_t *self);
+
+#endif // LAS_C_PRIV_THREAD_POOL_H
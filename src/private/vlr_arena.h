@@ -0,0 +1,32 @@
+#ifndef LAS_C_PRIV_VLR_ARENA_H
+#define LAS_C_PRIV_VLR_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "las/header.h"
+
+/// Returns a new arena of `size` bytes with one reference, NULL if allocation failed
+///
+/// An arena is one allocation holding the VLR payloads of a header.
+/// It is reference counted: clones of a header share the arena
+/// (and so the payloads) of the header they were cloned from,
+/// it is freed when the last header using it is deinitialized.
+/// Retaining and releasing are thread safe, so clones can be handed to other threads.
+las_vlr_arena_t *las_vlr_arena_new(size_t size);
+
+/// Adds a reference to the arena, `self` can be NULL
+void las_vlr_arena_retain(las_vlr_arena_t *self);
+
+/// Removes a reference to the arena, frees it if it was the last one,
+/// `self` can be NULL
+void las_vlr_arena_release(las_vlr_arena_t *self);
+
+/// Returns the first byte of the arena
+uint8_t *las_vlr_arena_data(las_vlr_arena_t *self);
+
+/// Returns whether `ptr` points into the arena, `self` can be NULL
+bool las_vlr_arena_owns(const las_vlr_arena_t *self, const uint8_t *ptr);
+
+#endif // LAS_C_PRIV_VLR_ARENA_H
@@ -0,0 +1,269 @@
+#include "private/quantize.h"
+
+#include <string.h>
+
+#include "las/header.h"
+
+#include "private/cpu.h"
+
+#if LAS_WITH_X86_SIMD
+#include <immintrin.h>
+#endif
+
+static void las_quantize_scalar(const double *values,
+                                const size_t value_stride,
+                                const uint64_t num_values,
+                                const double scale,
+                                const double offset,
+                                uint8_t *out,
+                                const size_t out_stride)
+{
+    for (uint64_t i = 0; i < num_values; ++i)
+    {
+        const int32_t v = scaling_unapply(scale, offset, *values);
+        memcpy(out, &v, sizeof(int32_t));
+        values += value_stride;
+        out += out_stride;
+    }
+}
+
+#if LAS_WITH_X86_SIMD
+/// Processes 2 values per iteration
+///
+/// Rounding is done as in `scaling_unapply`: 0.5 with the sign of the value
+/// is added, then the conversion truncates.
+__attribute__((target("sse4.1"))) static void las_quantize_sse41(const double *values,
+                                                                 const size_t value_stride,
+                                                                 const uint64_t num_values,
+                                                                 const double scale,
+                                                                 const double offset,
+                                                                 uint8_t *out,
+                                                                 const size_t out_stride)
+{
+    const __m128d scales = _mm_set1_pd(scale);
+    const __m128d offsets = _mm_set1_pd(offset);
+    const __m128d halves = _mm_set1_pd(0.5);
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+
+    const uint64_t num_blocks = num_values / 2;
+    for (uint64_t i = 0; i < num_blocks; ++i)
+    {
+        const __m128d v = _mm_setr_pd(values[0], values[value_stride]);
+        const __m128d unscaled = _mm_div_pd(_mm_sub_pd(v, offsets), scales);
+        const __m128d half = _mm_or_pd(halves, _mm_and_pd(unscaled, sign_mask));
+        const __m128i r = _mm_cvttpd_epi32(_mm_add_pd(unscaled, half));
+
+        const int32_t lo = _mm_cvtsi128_si32(r);
+        const int32_t hi = _mm_extract_epi32(r, 1);
+        memcpy(out, &lo, sizeof(int32_t));
+        memcpy(out + out_stride, &hi, sizeof(int32_t));
+
+        values += 2 * value_stride;
+        out += 2 * out_stride;
+    }
+
+    las_quantize_scalar(
+        values, value_stride, num_values - num_blocks * 2, scale, offset, out, out_stride);
+}
+
+/// Processes 4 values per iteration, contiguous values are loaded
+/// directly, strided ones are gathered.
+__attribute__((target("avx2"))) static void las_quantize_avx2(const double *values,
+                                                              const size_t value_stride,
+                                                              const uint64_t num_values,
+                                                              const double scale,
+                                                              const double offset,
+                                                              uint8_t *out,
+                                                              const size_t out_stride)
+{
+    const __m256d scales = _mm256_set1_pd(scale);
+    const __m256d offsets = _mm256_set1_pd(offset);
+    const __m256d halves = _mm256_set1_pd(0.5);
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const long long s = (long long)value_stride;
+    const __m256i indices = _mm256_setr_epi64x(0, s, 2 * s, 3 * s);
+
+    const uint64_t num_blocks = num_values / 4;
+    for (uint64_t i = 0; i < num_blocks; ++i)
+    {
+        const __m256d v = (value_stride == 1) ? _mm256_loadu_pd(values)
+                                              : _mm256_i64gather_pd(values, indices, 8);
+        const __m256d unscaled = _mm256_div_pd(_mm256_sub_pd(v, offsets), scales);
+        const __m256d half = _mm256_or_pd(halves, _mm256_and_pd(unscaled, sign_mask));
+        const __m128i r = _mm256_cvttpd_epi32(_mm256_add_pd(unscaled, half));
+
+        if (out_stride == sizeof(int32_t))
+        {
+            _mm_storeu_si128((__m128i *)out, r);
+        }
+        else
+        {
+            int32_t lanes[4];
+            _mm_storeu_si128((__m128i *)lanes, r);
+            for (int k = 0; k < 4; ++k)
+            {
+                memcpy(out + (size_t)k * out_stride, &lanes[k], sizeof(int32_t));
+            }
+        }
+
+        values += 4 * value_stride;
+        out += 4 * out_stride;
+    }
+
+    las_quantize_scalar(
+        values, value_stride, num_values - num_blocks * 4, scale, offset, out, out_stride);
+}
+#endif
+
+las_quantize_fn las_quantize_select_fn(void)
+{
+#if LAS_WITH_X86_SIMD
+    const las_simd_level_t level = las_cpu_simd_level();
+    if (level >= LAS_SIMD_AVX2)
+    {
+        return las_quantize_avx2;
+    }
+    if (level >= LAS_SIMD_SSE41)
+    {
+        return las_quantize_sse41;
+    }
+#endif
+    return las_quantize_scalar;
+}
+
+bool las_quantize_all_fit(const double *values,
+                          const size_t value_stride,
+                          const uint64_t num_values,
+                          const double scale,
+                          const double offset)
+{
+    for (uint64_t i = 0; i < num_values; ++i)
+    {
+        const double unscaled = (*values - offset) / scale;
+        const double rounded = (unscaled >= 0.0) ? unscaled + 0.5 : unscaled - 0.5;
+        // Written so that NaN does not fit
+        if (!(rounded > -2147483649.0 && rounded < 2147483648.0))
+        {
+            return false;
+        }
+        values += value_stride;
+    }
+    return true;
+}
+
+static void las_dequantize_scalar(const uint8_t *in,
+                                  const size_t in_stride,
+                                  const uint64_t num_values,
+                                  const double scale,
+                                  const double offset,
+                                  double *out,
+                                  const size_t out_stride)
+{
+    for (uint64_t i = 0; i < num_values; ++i)
+    {
+        int32_t v;
+        memcpy(&v, in, sizeof(int32_t));
+        *out = scaling_apply(scale, offset, v);
+        in += in_stride;
+        out += out_stride;
+    }
+}
+
+#if LAS_WITH_X86_SIMD
+/// Processes 2 values per iteration
+///
+/// The product and the sum are separate instructions (no fused multiply-add)
+/// to round exactly as `scaling_apply`.
+__attribute__((target("sse4.1"))) static void las_dequantize_sse41(const uint8_t *in,
+                                                                   const size_t in_stride,
+                                                                   const uint64_t num_values,
+                                                                   const double scale,
+                                                                   const double offset,
+                                                                   double *out,
+                                                                   const size_t out_stride)
+{
+    const __m128d scales = _mm_set1_pd(scale);
+    const __m128d offsets = _mm_set1_pd(offset);
+
+    const uint64_t num_blocks = num_values / 2;
+    for (uint64_t i = 0; i < num_blocks; ++i)
+    {
+        int32_t lo, hi;
+        memcpy(&lo, in, sizeof(int32_t));
+        memcpy(&hi, in + in_stride, sizeof(int32_t));
+        const __m128d v = _mm_cvtepi32_pd(_mm_setr_epi32(lo, hi, 0, 0));
+        const __m128d scaled = _mm_add_pd(_mm_mul_pd(v, scales), offsets);
+
+        _mm_storel_pd(out, scaled);
+        _mm_storeh_pd(out + out_stride, scaled);
+
+        in += 2 * in_stride;
+        out += 2 * out_stride;
+    }
+
+    las_dequantize_scalar(
+        in, in_stride, num_values - num_blocks * 2, scale, offset, out, out_stride);
+}
+
+/// Processes 4 values per iteration, contiguous integers are loaded
+/// directly, strided ones are gathered.
+__attribute__((target("avx2"))) static void las_dequantize_avx2(const uint8_t *in,
+                                                                const size_t in_stride,
+                                                                const uint64_t num_values,
+                                                                const double scale,
+                                                                const double offset,
+                                                                double *out,
+                                                                const size_t out_stride)
+{
+    const __m256d scales = _mm256_set1_pd(scale);
+    const __m256d offsets = _mm256_set1_pd(offset);
+    const int s = (int)in_stride;
+    const __m128i indices = _mm_setr_epi32(0, s, 2 * s, 3 * s);
+
+    const uint64_t num_blocks = num_values / 4;
+    for (uint64_t i = 0; i < num_blocks; ++i)
+    {
+        const __m128i v = (in_stride == sizeof(int32_t))
+                              ? _mm_loadu_si128((const __m128i *)in)
+                              : _mm_i32gather_epi32((const int *)in, indices, 1);
+        const __m256d scaled =
+            _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(v), scales), offsets);
+
+        if (out_stride == 1)
+        {
+            _mm256_storeu_pd(out, scaled);
+        }
+        else
+        {
+            double lanes[4];
+            _mm256_storeu_pd(lanes, scaled);
+            for (int k = 0; k < 4; ++k)
+            {
+                out[(size_t)k * out_stride] = lanes[k];
+            }
+        }
+
+        in += 4 * in_stride;
+        out += 4 * out_stride;
+    }
+
+    las_dequantize_scalar(
+        in, in_stride, num_values - num_blocks * 4, scale, offset, out, out_stride);
+}
+#endif
+
+las_dequantize_fn las_dequantize_select_fn(void)
+{
+#if LAS_WITH_X86_SIMD
+    const las_simd_level_t level = las_cpu_simd_level();
+    if (level >= LAS_SIMD_AVX2)
+    {
+        return las_dequantize_avx2;
+    }
+    if (level >= LAS_SIMD_SSE41)
+    {
+        return las_dequantize_sse41;
+    }
+#endif
+    return las_dequantize_scalar;
+}
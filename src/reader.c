@@ -4,8 +4,10 @@
 #include <lazrs/lazrs.h>
 #endif
 
+#include "private/laz_chunk_table.h"
 #include "private/macro.h"
 #include "private/point.h"
+#include "private/point_columns.h"
 #include "private/source.h"
 
 typedef struct las_reader
@@ -22,6 +24,19 @@ typedef struct las_reader
 
     bool is_data_compressed;
 
+    /// Chunk size of the LASzip VLR (which is removed from the header)
+    uint32_t laz_chunk_size;
+    /// NULL until `las_reader_laz_chunks` reads the chunk table
+    las_laz_chunk_t *laz_chunks;
+    uint64_t num_laz_chunks;
+
+    /// Decoder specialized for the point format
+    las_raw_point_decode_many_fn decode;
+    /// Where the fields are in the records, for the column decoder
+    las_point_layout_t layout;
+    /// Column decoder best suited for the CPU
+    las_raw_point_columns_decode_fn decode_columns;
+
 #ifdef WITH_LAZRS
     /// Is not null when the input data is LAZ
     /// meaning we should get bytes from the
@@ -30,18 +45,20 @@ typedef struct las_reader
 #endif
 } las_reader_t;
 
-static inline las_error_t las_reader_fill_point_buffer_from_source(las_reader_t *self,
-                                                                   const uint64_t num_points)
+/// Reads the bytes of `num_points` points from the source into `buffer`
+static inline las_error_t las_reader_fill_buffer_from_source(las_reader_t *self,
+                                                             uint8_t *buffer,
+                                                             const uint64_t num_points)
 {
     LAS_DEBUG_ASSERT(self != NULL);
-    LAS_DEBUG_ASSERT(num_points <= self->points_in_buffer);
+    LAS_DEBUG_ASSERT(buffer != NULL);
 
     las_error_t las_err;
     las_err.kind = LAS_ERROR_OK;
 
-    const uint64_t n =
-        las_source_read(&self->source, self->point_size * num_points, self->point_buffer);
-    if (n < self->point_size)
+    const uint64_t num_bytes = self->point_size * num_points;
+    const uint64_t n = las_source_read(&self->source, num_bytes, buffer);
+    if (n < num_bytes)
     {
         if (las_source_eof(&self->source))
         {
@@ -58,19 +75,20 @@ static inline las_error_t las_reader_fill_point_buffer_from_source(las_reader_t
 }
 
 #ifdef WITH_LAZRS
-/// Fills the reader's point buffer with the bytes of a decompressed point
-static inline las_error_t las_reader_fill_point_buffer_from_decompressor(las_reader_t *self,
-                                                                         uint64_t const num_points)
+/// Fills the `buffer` with the bytes of `num_points` decompressed points
+static inline las_error_t las_reader_fill_buffer_from_decompressor(las_reader_t *self,
+                                                                   uint8_t *buffer,
+                                                                   uint64_t const num_points)
 {
     LAS_DEBUG_ASSERT(self != NULL);
     LAS_DEBUG_ASSERT(self->decompressor != NULL);
-    LAS_DEBUG_ASSERT(num_points <= self->points_in_buffer);
+    LAS_DEBUG_ASSERT(buffer != NULL);
 
     las_error_t las_err;
     las_err.kind = LAS_ERROR_OK;
 
     const Lazrs_Result laz_err = lazrs_decompressor_decompress_many(
-        self->decompressor, self->point_buffer, self->point_size * num_points);
+        self->decompressor, buffer, self->point_size * num_points);
 
     if (laz_err != LAZRS_OK)
     {
@@ -121,6 +139,13 @@ static inline las_error_t las_reader_create_decompressor(las_reader_t *self)
         return las_err;
     }
 
+    if (laszip_vlr->data_size >= LAS_LAZ_VLR_CHUNK_SIZE_OFFSET + sizeof(uint32_t))
+    {
+        memcpy(&self->laz_chunk_size,
+               laszip_vlr->data + LAS_LAZ_VLR_CHUNK_SIZE_OFFSET,
+               sizeof(uint32_t));
+    }
+
     // We are removing the laszip vlr
     // as it is an implementation detail,
     las_vlr_t *new_vlrs = malloc(sizeof(las_vlr_t) * (self->header.number_of_vlrs - 1));
@@ -144,7 +169,8 @@ static inline las_error_t las_reader_create_decompressor(las_reader_t *self)
         *dest_vlr = *source_vlr;
         j++;
     }
-    free(laszip_vlr->data);
+    // The header is ours, the VLR is only const because of the lookup function
+    las_vlr_deinit_shared((las_vlr_t *)laszip_vlr, self->header.vlr_arena);
     free(self->header.vlrs);
     self->header.vlrs = new_vlrs;
     self->header.number_of_vlrs--;
@@ -154,6 +180,22 @@ static inline las_error_t las_reader_create_decompressor(las_reader_t *self)
 }
 #endif
 
+/// Fills the `buffer` with the bytes of the next `num_points` points
+///
+/// The bytes come from the decompressor for LAZ data,
+/// or directly from the source for LAS data.
+static inline las_error_t
+las_reader_fill_buffer(las_reader_t *self, uint8_t *buffer, const uint64_t num_points)
+{
+#ifdef WITH_LAZRS
+    if (self->decompressor)
+    {
+        return las_reader_fill_buffer_from_decompressor(self, buffer, num_points);
+    }
+#endif
+    return las_reader_fill_buffer_from_source(self, buffer, num_points);
+}
+
 static void las_reader_deinit(las_reader_t *self)
 {
     LAS_DEBUG_ASSERT(self != NULL);
@@ -170,6 +212,9 @@ static void las_reader_deinit(las_reader_t *self)
         self->point_buffer = NULL;
     }
 
+    free(self->laz_chunks);
+    self->laz_chunks = NULL;
+
 #ifdef WITH_LAZRS
     if (self->decompressor != NULL)
     {
@@ -189,46 +234,22 @@ las_error_t las_reader_read_next_raw(las_reader_t *self, las_raw_point_t *point)
     las_error_t las_err;
     las_err.kind = LAS_ERROR_OK;
 
-#ifdef WITH_LAZRS
-    if (self->decompressor)
-    {
-        las_err = las_reader_fill_point_buffer_from_decompressor(self, 1 /* Only read one point */);
-    }
-    else
+    las_err = las_reader_fill_buffer(self, self->point_buffer, 1 /* Only read one point */);
+    if (las_error_is_failure(&las_err))
     {
-        las_err = las_reader_fill_point_buffer_from_source(self, 1 /* Only read one point */);
+        return las_err;
     }
-#else
-    las_err = las_reader_fill_point_buffer_from_source(self, 1 /* Only read one point */);
-#endif
 
-    if (self->header.point_format.id <= 5)
-    {
-        las_raw_point_10_from_buffer(
-            self->point_buffer, self->header.point_format, &point->point10);
-    }
-    else
-    {
-        las_raw_point_14_from_buffer(
-            self->point_buffer, self->header.point_format, &point->point14);
-    }
+    self->decode(self->point_buffer, self->header.point_format, point, 1);
 
     return las_err;
 }
 
-las_error_t las_reader_read_many_next_raw(las_reader_t *self,
-                                          las_raw_point_t *points,
-                                          const uint64_t num_points)
+/// Grows the point buffer so that it can hold `num_points` records
+static las_error_t las_reader_reserve_buffer(las_reader_t *self, const uint64_t num_points)
 {
     las_error_t las_err = {.kind = LAS_ERROR_OK};
 
-    // return las_err;
-    if (points == NULL || num_points == 0)
-    {
-        return las_err;
-    }
-
-    // Resize the buffer if needed
     if (self->points_in_buffer < num_points)
     {
         uint8_t *new_buffer = realloc(self->point_buffer, self->point_size * num_points);
@@ -241,53 +262,197 @@ las_error_t las_reader_read_many_next_raw(las_reader_t *self,
         self->points_in_buffer = num_points;
     }
 
-#ifdef WITH_LAZRS
-    // We have to handle potential LAZ file
-    if (self->decompressor)
+    return las_err;
+}
+
+las_error_t las_reader_read_many_next_raw(las_reader_t *self,
+                                          las_raw_point_t *points,
+                                          const uint64_t num_points)
+{
+    las_error_t las_err = {.kind = LAS_ERROR_OK};
+
+    // return las_err;
+    if (points == NULL || num_points == 0)
     {
-        las_err = las_reader_fill_point_buffer_from_decompressor(self, num_points);
+        return las_err;
     }
-    else
+
+    las_err = las_reader_reserve_buffer(self, num_points);
+    if (las_error_is_failure(&las_err))
     {
-        las_err = las_reader_fill_point_buffer_from_source(self, num_points);
+        return las_err;
     }
-#else  // WITH_LAZRS
-    // Simply fill buffer
-    las_err = las_reader_fill_point_buffer_from_source(self, num_points);
+
+    las_err = las_reader_fill_buffer(self, self->point_buffer, num_points);
     if (las_error_is_failure(&las_err))
     {
         return las_err;
     }
-#endif // WITH_LAZRS
 
     // Parse points from buffer
-    const uint8_t *buffer = self->point_buffer;
-    if (self->header.point_format.id <= 5)
+    self->decode(self->point_buffer, self->header.point_format, points, num_points);
+
+    return las_err;
+}
+
+las_error_t las_reader_read_many_next_columns(las_reader_t *self,
+                                              const las_raw_point_columns_t *columns,
+                                              const uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    las_error_t las_err = {.kind = LAS_ERROR_OK};
+
+    if (columns == NULL || num_points == 0)
     {
-        for (uint64_t i = 0; i < num_points; ++i)
-        {
-            las_raw_point_10_from_buffer(buffer, self->header.point_format, &points[i].point10);
-            buffer += self->point_size;
-        }
+        return las_err;
     }
-    else
+
+    las_err = las_reader_reserve_buffer(self, num_points);
+    if (las_error_is_failure(&las_err))
     {
-        for (uint64_t i = 0; i < num_points; ++i)
-        {
-            las_raw_point_14_from_buffer(buffer, self->header.point_format, &points[i].point14);
-            buffer += self->point_size;
-        }
+        return las_err;
+    }
+
+    las_err = las_reader_fill_buffer(self, self->point_buffer, num_points);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
     }
 
+    self->decode_columns(self->point_buffer, &self->layout, num_points, columns);
+
     return las_err;
 }
 
+las_error_t
+las_reader_read_many_next_bytes(las_reader_t *self, uint8_t *bytes, const uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    las_error_t las_err = {.kind = LAS_ERROR_OK};
+
+    if (bytes == NULL || num_points == 0)
+    {
+        return las_err;
+    }
+
+    return las_reader_fill_buffer(self, bytes, num_points);
+}
+
 const las_header_t *las_reader_header(const las_reader_t *reader)
 {
     LAS_DEBUG_ASSERT(reader != NULL);
     return &reader->header;
 }
 
+las_error_t las_reader_read_evlr_data(las_reader_t *self, uint32_t index)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT(index < self->header.number_of_evlrs);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    las_evlr_t *evlr = &self->header.evlrs[index];
+    if (evlr->data != NULL || evlr->data_size == 0)
+    {
+        return las_err;
+    }
+
+    // The EVLRs are after the points, so we have to go back
+    // where we were to not disturb the reading of points
+    const uint64_t pos = las_source_tell(&self->source);
+
+    las_err = las_evlr_read_data_from(evlr, &self->source);
+
+    if (las_source_seek(&self->source, (int64_t)pos, LAS_SEEK_FROM_START) != 0 &&
+        las_error_is_ok(&las_err))
+    {
+        las_err.kind = LAS_ERROR_ERRNO;
+    }
+
+    return las_err;
+}
+
+las_error_t las_reader_laz_chunks(las_reader_t *self,
+                                  const las_laz_chunk_t **out_chunks,
+                                  uint64_t *out_num_chunks)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_chunks);
+    LAS_DEBUG_ASSERT_NOT_NULL(out_num_chunks);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    if (self->laz_chunks == NULL && self->is_data_compressed)
+    {
+        // The table is after the points, so we have to go back
+        // where we were to not disturb the decompressor
+        const uint64_t pos = las_source_tell(&self->source);
+
+        las_laz_chunk_entry_t *entries = NULL;
+        uint64_t num_entries = 0;
+        las_err = las_laz_chunk_table_read_from(&self->source,
+                                                self->header.offset_to_point_data,
+                                                self->laz_chunk_size,
+                                                self->header.point_count,
+                                                &entries,
+                                                &num_entries);
+
+        if (las_source_seek(&self->source, (int64_t)pos, LAS_SEEK_FROM_START) != 0 &&
+            las_error_is_ok(&las_err))
+        {
+            las_err.kind = LAS_ERROR_ERRNO;
+        }
+
+        if (las_error_is_ok(&las_err))
+        {
+            // Allocate at least one so that an empty table is not read again
+            self->laz_chunks = malloc(sizeof(las_laz_chunk_t) * (num_entries + 1));
+            if (self->laz_chunks == NULL)
+            {
+                las_err.kind = LAS_ERROR_MEMORY;
+            }
+            else
+            {
+                // The first chunk is after the offset to the chunk table
+                uint64_t byte_offset = self->header.offset_to_point_data + sizeof(int64_t);
+                for (uint64_t i = 0; i < num_entries; ++i)
+                {
+                    self->laz_chunks[i].point_count = entries[i].point_count;
+                    self->laz_chunks[i].byte_offset = byte_offset;
+                    self->laz_chunks[i].byte_count = entries[i].byte_count;
+                    byte_offset += entries[i].byte_count;
+                }
+                self->num_laz_chunks = num_entries;
+            }
+        }
+        free(entries);
+    }
+
+    *out_chunks = self->laz_chunks;
+    *out_num_chunks = self->num_laz_chunks;
+    return las_err;
+}
+
+las_error_t las_reader_read_all_evlr_data(las_reader_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    for (uint32_t i = 0; i < self->header.number_of_evlrs; ++i)
+    {
+        las_err = las_reader_read_evlr_data(self, i);
+        if (las_error_is_failure(&las_err))
+        {
+            break;
+        }
+    }
+
+    return las_err;
+}
+
 las_error_t las_reader_from_source(las_source_t source, las_reader_t **out_reader)
 {
     LAS_DEBUG_ASSERT(out_reader != NULL);
@@ -312,6 +477,15 @@ las_error_t las_reader_from_source(las_source_t source, las_reader_t **out_reade
         goto out;
     }
 
+    if (reader->header.version.minor >= 4)
+    {
+        las_err = las_evlrs_read_from(&reader->source, &reader->header);
+        if (las_error_is_failure(&las_err))
+        {
+            goto out;
+        }
+    }
+
     las_err = las_header_validate(&reader->header);
     if (las_error_is_failure(&las_err))
     {
@@ -320,6 +494,9 @@ las_error_t las_reader_from_source(las_source_t source, las_reader_t **out_reade
 
     const int is_compressed = reader->is_data_compressed;
     reader->point_size = las_point_format_point_size(reader->header.point_format);
+    reader->decode = las_raw_point_select_decode_many_fn(reader->header.point_format.id);
+    reader->layout = las_point_layout_from_format(reader->header.point_format);
+    reader->decode_columns = las_raw_point_columns_select_decode_fn();
 
     r = las_source_seek(
         &reader->source, (int64_t)reader->header.offset_to_point_data, LAS_SEEK_FROM_START);
@@ -0,0 +1,292 @@
+#include "las/point.h"
+
+#include <string.h>
+
+#include "private/cpu.h"
+#include "private/macro.h"
+
+#if LAS_WITH_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/// Scale and offset of one axis, before and after rescaling
+typedef struct las_rescale
+{
+    double source_scale;
+    double source_offset;
+    double dest_scale;
+    double dest_offset;
+} las_rescale_t;
+
+/// Rewrites `num_values` integers, `stride` bytes apart, from the source
+/// to the destination scale and offset of `rescale`
+///
+/// Each value is computed as `scaling_unapply(scaling_apply(value))` would,
+/// the results are the same whichever kernel is used. The caller checks
+/// beforehand that the results fit in 32 bits.
+typedef void (*las_rescale_fn)(uint8_t *values,
+                               size_t stride,
+                               uint64_t num_values,
+                               const las_rescale_t *rescale);
+
+static void las_rescale_scalar(uint8_t *values,
+                               const size_t stride,
+                               const uint64_t num_values,
+                               const las_rescale_t *rescale)
+{
+    for (uint64_t i = 0; i < num_values; ++i)
+    {
+        int32_t v;
+        memcpy(&v, values, sizeof(int32_t));
+        const double scaled = scaling_apply(rescale->source_scale, rescale->source_offset, v);
+        v = scaling_unapply(rescale->dest_scale, rescale->dest_offset, scaled);
+        memcpy(values, &v, sizeof(int32_t));
+        values += stride;
+    }
+}
+
+#if LAS_WITH_X86_SIMD
+/// Processes 2 values per iteration
+///
+/// The operations are the ones of `scaling_apply` then `scaling_unapply`,
+/// in the same order and without fused multiply-add, rounding adds
+/// 0.5 with the sign of the value then truncates.
+__attribute__((target("sse4.1"))) static void las_rescale_sse41(uint8_t *values,
+                                                                const size_t stride,
+                                                                const uint64_t num_values,
+                                                                const las_rescale_t *rescale)
+{
+    const __m128d source_scales = _mm_set1_pd(rescale->source_scale);
+    const __m128d source_offsets = _mm_set1_pd(rescale->source_offset);
+    const __m128d dest_scales = _mm_set1_pd(rescale->dest_scale);
+    const __m128d dest_offsets = _mm_set1_pd(rescale->dest_offset);
+    const __m128d halves = _mm_set1_pd(0.5);
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+
+    const uint64_t num_blocks = num_values / 2;
+    for (uint64_t i = 0; i < num_blocks; ++i)
+    {
+        int32_t lo, hi;
+        memcpy(&lo, values, sizeof(int32_t));
+        memcpy(&hi, values + stride, sizeof(int32_t));
+
+        const __m128d v = _mm_cvtepi32_pd(_mm_setr_epi32(lo, hi, 0, 0));
+        const __m128d scaled = _mm_add_pd(_mm_mul_pd(v, source_scales), source_offsets);
+        const __m128d unscaled = _mm_div_pd(_mm_sub_pd(scaled, dest_offsets), dest_scales);
+        const __m128d half = _mm_or_pd(halves, _mm_and_pd(unscaled, sign_mask));
+        const __m128i r = _mm_cvttpd_epi32(_mm_add_pd(unscaled, half));
+
+        lo = _mm_cvtsi128_si32(r);
+        hi = _mm_extract_epi32(r, 1);
+        memcpy(values, &lo, sizeof(int32_t));
+        memcpy(values + stride, &hi, sizeof(int32_t));
+
+        values += 2 * stride;
+    }
+
+    las_rescale_scalar(values, stride, num_values - num_blocks * 2, rescale);
+}
+
+/// Processes 4 values per iteration, strided values are gathered
+__attribute__((target("avx2"))) static void las_rescale_avx2(uint8_t *values,
+                                                             const size_t stride,
+                                                             const uint64_t num_values,
+                                                             const las_rescale_t *rescale)
+{
+    const __m256d source_scales = _mm256_set1_pd(rescale->source_scale);
+    const __m256d source_offsets = _mm256_set1_pd(rescale->source_offset);
+    const __m256d dest_scales = _mm256_set1_pd(rescale->dest_scale);
+    const __m256d dest_offsets = _mm256_set1_pd(rescale->dest_offset);
+    const __m256d halves = _mm256_set1_pd(0.5);
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const int s = (int)stride;
+    const __m128i indices = _mm_setr_epi32(0, s, 2 * s, 3 * s);
+
+    const uint64_t num_blocks = num_values / 4;
+    for (uint64_t i = 0; i < num_blocks; ++i)
+    {
+        const __m128i ints = (stride == sizeof(int32_t))
+                                 ? _mm_loadu_si128((const __m128i *)values)
+                                 : _mm_i32gather_epi32((const int *)values, indices, 1);
+
+        const __m256d v = _mm256_cvtepi32_pd(ints);
+        const __m256d scaled = _mm256_add_pd(_mm256_mul_pd(v, source_scales), source_offsets);
+        const __m256d unscaled =
+            _mm256_div_pd(_mm256_sub_pd(scaled, dest_offsets), dest_scales);
+        const __m256d half = _mm256_or_pd(halves, _mm256_and_pd(unscaled, sign_mask));
+        const __m128i r = _mm256_cvttpd_epi32(_mm256_add_pd(unscaled, half));
+
+        if (stride == sizeof(int32_t))
+        {
+            _mm_storeu_si128((__m128i *)values, r);
+        }
+        else
+        {
+            int32_t lanes[4];
+            _mm_storeu_si128((__m128i *)lanes, r);
+            for (int k = 0; k < 4; ++k)
+            {
+                memcpy(values + (size_t)k * stride, &lanes[k], sizeof(int32_t));
+            }
+        }
+
+        values += 4 * stride;
+    }
+
+    las_rescale_scalar(values, stride, num_values - num_blocks * 4, rescale);
+}
+#endif
+
+static las_rescale_fn las_rescale_select_fn(void)
+{
+#if LAS_WITH_X86_SIMD
+    const las_simd_level_t level = las_cpu_simd_level();
+    if (level >= LAS_SIMD_AVX2)
+    {
+        return las_rescale_avx2;
+    }
+    if (level >= LAS_SIMD_SSE41)
+    {
+        return las_rescale_sse41;
+    }
+#endif
+    return las_rescale_scalar;
+}
+
+/// Returns whether `value` rescaled fits in 32 bits
+static bool las_rescale_fits(const las_rescale_t *rescale, const int32_t value)
+{
+    const double scaled = scaling_apply(rescale->source_scale, rescale->source_offset, value);
+    const double unscaled = (scaled - rescale->dest_offset) / rescale->dest_scale;
+    const double rounded = (unscaled >= 0.0) ? unscaled + 0.5 : unscaled - 0.5;
+    // Written so that NaN does not fit
+    return rounded > -2147483649.0 && rounded < 2147483648.0;
+}
+
+/// Returns whether all the `num_values` integers, `stride` bytes apart, fit in 32 bits once
+/// rescaled
+///
+/// Rescaling is monotonic, so only the smallest and largest values are checked.
+static bool las_rescale_all_fit(const las_rescale_t *rescale,
+                                const uint8_t *values,
+                                const size_t stride,
+                                const uint64_t num_values)
+{
+    int32_t min = INT32_MAX;
+    int32_t max = INT32_MIN;
+    for (uint64_t i = 0; i < num_values; ++i)
+    {
+        int32_t v;
+        memcpy(&v, values, sizeof(int32_t));
+        min = (v < min) ? v : min;
+        max = (v > max) ? v : max;
+        values += stride;
+    }
+    return num_values == 0 || (las_rescale_fits(rescale, min) && las_rescale_fits(rescale, max));
+}
+
+/// Rescales the x, y, z integers at `x`, `y`, `z`, each one `stride` bytes
+/// after the one of the previous point
+///
+/// Nothing is written if one of the coordinates would overflow.
+static las_error_t las_rescale_xyz(uint8_t *x,
+                                   uint8_t *y,
+                                   uint8_t *z,
+                                   const size_t stride,
+                                   const uint64_t num_points,
+                                   const las_scaling_t source_scaling,
+                                   const las_scaling_t dest_scaling)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    uint8_t *values[3] = {x, y, z};
+    const las_rescale_t rescales[3] = {
+        {source_scaling.scales.x,
+         source_scaling.offsets.x,
+         dest_scaling.scales.x,
+         dest_scaling.offsets.x},
+        {source_scaling.scales.y,
+         source_scaling.offsets.y,
+         dest_scaling.scales.y,
+         dest_scaling.offsets.y},
+        {source_scaling.scales.z,
+         source_scaling.offsets.z,
+         dest_scaling.scales.z,
+         dest_scaling.offsets.z},
+    };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (!las_rescale_all_fit(&rescales[i], values[i], stride, num_points))
+        {
+            las_err.kind = LAS_ERROR_COORDINATE_OVERFLOW;
+            return las_err;
+        }
+    }
+
+    const las_rescale_fn rescale = las_rescale_select_fn();
+    for (int i = 0; i < 3; ++i)
+    {
+        const las_rescale_t *r = &rescales[i];
+        if (r->source_scale == r->dest_scale && r->source_offset == r->dest_offset)
+        {
+            continue;
+        }
+        rescale(values[i], stride, num_points, r);
+    }
+
+    return las_err;
+}
+
+las_error_t las_rescale_records(const las_point_format_t point_format,
+                                uint8_t *records,
+                                const uint64_t num_points,
+                                const las_scaling_t source_scaling,
+                                const las_scaling_t dest_scaling)
+{
+    LAS_DEBUG_ASSERT(records != NULL || num_points == 0);
+
+    const size_t point_size = las_point_format_point_size(point_format);
+    return las_rescale_xyz(records,
+                           records + sizeof(int32_t),
+                           records + 2 * sizeof(int32_t),
+                           point_size,
+                           num_points,
+                           source_scaling,
+                           dest_scaling);
+}
+
+las_error_t las_raw_point_rescale_many(las_raw_point_t *points,
+                                       const uint64_t num_points,
+                                       const las_scaling_t source_scaling,
+                                       const las_scaling_t dest_scaling)
+{
+    if (num_points == 0)
+    {
+        las_error_t las_err = {LAS_ERROR_OK};
+        return las_err;
+    }
+    LAS_DEBUG_ASSERT_NOT_NULL(points);
+
+    int32_t *x, *y, *z;
+    if (points[0].point_format_id <= 5)
+    {
+        x = &points[0].point10.x;
+        y = &points[0].point10.y;
+        z = &points[0].point10.z;
+    }
+    else
+    {
+        x = &points[0].point14.x;
+        y = &points[0].point14.y;
+        z = &points[0].point14.z;
+    }
+
+    return las_rescale_xyz((uint8_t *)x,
+                           (uint8_t *)y,
+                           (uint8_t *)z,
+                           sizeof(las_raw_point_t),
+                           num_points,
+                           source_scaling,
+                           dest_scaling);
+}
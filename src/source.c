@@ -53,7 +53,11 @@ int las_memory_source_seek(void *vself, const int64_t pos, const las_seek_from_t
         new_pos = (uint64_t)pos;
         break;
     case LAS_SEEK_FROM_CURRENT:
-        LAS_ASSERT_M(0, "todo");
+        if (pos < 0 && (uint64_t)(-pos) > self->pos)
+        {
+            return 1;
+        }
+        new_pos = self->pos + (uint64_t)pos;
         break;
     case LAS_SEEK_FROM_END:
         if (pos > 0)
@@ -62,7 +66,11 @@ int las_memory_source_seek(void *vself, const int64_t pos, const las_seek_from_t
         }
         else
         {
-            LAS_ASSERT_M(0, "todo");
+            if ((uint64_t)(-pos) > self->size)
+            {
+                return 1;
+            }
+            new_pos = self->size - (uint64_t)(-pos);
         }
         break;
     default:
@@ -159,18 +167,14 @@ int las_file_source_close(void *vself)
     return fclose(self->file);
 }
 
-int las_source_new_file(const char *filename, las_source_t *source)
+void las_source_new_from_file(FILE *file, las_source_t *source)
 {
-    LAS_DEBUG_ASSERT(filename != NULL);
     LAS_DEBUG_ASSERT(source != NULL);
 
-    //    *source = malloc(sizeof(las_source_t));
-    //    LAS_ASSERT_M(source != NULL, "out of memory");
-
     las_source_file_t *inner = malloc(sizeof(las_source_file_t));
     LAS_ASSERT_M(inner != NULL, "out of memory");
 
-    inner->file = fopen(filename, "rb");
+    inner->file = file;
 
     memset(source, 0, sizeof(las_source_t));
     source->inner = (void *)inner;
@@ -179,8 +183,17 @@ int las_source_new_file(const char *filename, las_source_t *source)
     source->tell_fn = las_file_source_tell;
     source->eof_fn = las_file_source_eof;
     source->close_fn = las_file_source_close;
+}
+
+int las_source_new_file(const char *filename, las_source_t *source)
+{
+    LAS_DEBUG_ASSERT(filename != NULL);
+    LAS_DEBUG_ASSERT(source != NULL);
+
+    FILE *file = fopen(filename, "rb");
+    las_source_new_from_file(file, source);
 
-    return inner->file == NULL;
+    return file == NULL;
 }
 
 las_source_t las_source_new_memory(const uint8_t *buffer, uint64_t size)
@@ -0,0 +1,317 @@
+#include "private/thread_pool.h"
+#include "private/macro.h"
+
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// The few primitives the pool needs, on top of the Win32 API or pthreads
+
+#if defined(_WIN32)
+
+typedef SRWLOCK las_mutex_t;
+typedef CONDITION_VARIABLE las_cond_t;
+typedef HANDLE las_thread_t;
+
+static inline void las_mutex_init(las_mutex_t *mutex)
+{
+    InitializeSRWLock(mutex);
+}
+
+static inline void las_mutex_destroy(las_mutex_t *mutex)
+{
+    (void)mutex;
+}
+
+static inline void las_mutex_lock(las_mutex_t *mutex)
+{
+    AcquireSRWLockExclusive(mutex);
+}
+
+static inline void las_mutex_unlock(las_mutex_t *mutex)
+{
+    ReleaseSRWLockExclusive(mutex);
+}
+
+static inline void las_cond_init(las_cond_t *cond)
+{
+    InitializeConditionVariable(cond);
+}
+
+static inline void las_cond_destroy(las_cond_t *cond)
+{
+    (void)cond;
+}
+
+static inline void las_cond_wait(las_cond_t *cond, las_mutex_t *mutex)
+{
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+
+static inline void las_cond_signal(las_cond_t *cond)
+{
+    WakeConditionVariable(cond);
+}
+
+static inline void las_cond_broadcast(las_cond_t *cond)
+{
+    WakeAllConditionVariable(cond);
+}
+
+#else
+
+typedef pthread_mutex_t las_mutex_t;
+typedef pthread_cond_t las_cond_t;
+typedef pthread_t las_thread_t;
+
+static inline void las_mutex_init(las_mutex_t *mutex)
+{
+    pthread_mutex_init(mutex, NULL);
+}
+
+static inline void las_mutex_destroy(las_mutex_t *mutex)
+{
+    pthread_mutex_destroy(mutex);
+}
+
+static inline void las_mutex_lock(las_mutex_t *mutex)
+{
+    pthread_mutex_lock(mutex);
+}
+
+static inline void las_mutex_unlock(las_mutex_t *mutex)
+{
+    pthread_mutex_unlock(mutex);
+}
+
+static inline void las_cond_init(las_cond_t *cond)
+{
+    pthread_cond_init(cond, NULL);
+}
+
+static inline void las_cond_destroy(las_cond_t *cond)
+{
+    pthread_cond_destroy(cond);
+}
+
+static inline void las_cond_wait(las_cond_t *cond, las_mutex_t *mutex)
+{
+    pthread_cond_wait(cond, mutex);
+}
+
+static inline void las_cond_signal(las_cond_t *cond)
+{
+    pthread_cond_signal(cond);
+}
+
+static inline void las_cond_broadcast(las_cond_t *cond)
+{
+    pthread_cond_broadcast(cond);
+}
+
+#endif
+
+struct las_thread_pool
+{
+    las_mutex_t mutex;
+    /// Signaled when a task is queued, or when the pool is stopping
+    las_cond_t task_available;
+    /// Signaled when a task is done
+    las_cond_t task_done;
+
+    /// Queue of tasks waiting for a worker
+    las_task_t *head;
+    las_task_t *tail;
+    bool is_stopping;
+
+    las_thread_t *threads;
+    uint32_t num_threads;
+};
+
+/// Executes the queued tasks until the pool stops
+static void las_thread_pool_work(las_thread_pool_t *self)
+{
+    las_mutex_lock(&self->mutex);
+    for (;;)
+    {
+        while (self->head == NULL && !self->is_stopping)
+        {
+            las_cond_wait(&self->task_available, &self->mutex);
+        }
+
+        if (self->head == NULL)
+        {
+            // stopping and there is nothing left to do
+            break;
+        }
+
+        las_task_t *task = self->head;
+        self->head = task->next;
+        if (self->head == NULL)
+        {
+            self->tail = NULL;
+        }
+
+        las_mutex_unlock(&self->mutex);
+        task->fn(task->arg);
+        las_mutex_lock(&self->mutex);
+
+        task->is_done = true;
+        las_cond_broadcast(&self->task_done);
+    }
+    las_mutex_unlock(&self->mutex);
+}
+
+#if defined(_WIN32)
+
+static DWORD WINAPI las_thread_pool_worker(LPVOID arg)
+{
+    las_thread_pool_work(arg);
+    return 0;
+}
+
+/// Returns false if the thread could not be started
+static bool las_thread_start(las_thread_t *thread, las_thread_pool_t *pool)
+{
+    *thread = CreateThread(NULL, 0, las_thread_pool_worker, pool, 0, NULL);
+    return *thread != NULL;
+}
+
+static void las_thread_join(las_thread_t thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+#else
+
+static void *las_thread_pool_worker(void *arg)
+{
+    las_thread_pool_work(arg);
+    return NULL;
+}
+
+/// Returns false if the thread could not be started
+static bool las_thread_start(las_thread_t *thread, las_thread_pool_t *pool)
+{
+    return pthread_create(thread, NULL, las_thread_pool_worker, pool) == 0;
+}
+
+static void las_thread_join(las_thread_t thread)
+{
+    pthread_join(thread, NULL);
+}
+
+#endif
+
+las_thread_pool_t *las_thread_pool_new(const uint32_t num_threads)
+{
+    LAS_DEBUG_ASSERT(num_threads > 0);
+
+    las_thread_pool_t *self = calloc(1, sizeof(las_thread_pool_t));
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    self->threads = malloc(sizeof(las_thread_t) * num_threads);
+    if (self->threads == NULL)
+    {
+        free(self);
+        return NULL;
+    }
+
+    las_mutex_init(&self->mutex);
+    las_cond_init(&self->task_available);
+    las_cond_init(&self->task_done);
+
+    for (uint32_t i = 0; i < num_threads; ++i)
+    {
+        if (!las_thread_start(&self->threads[i], self))
+        {
+            // Stop the threads that were started
+            las_thread_pool_delete(self);
+            return NULL;
+        }
+        self->num_threads++;
+    }
+
+    return self;
+}
+
+uint32_t las_thread_pool_available_parallelism(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const long n = (long)info.dwNumberOfProcessors;
+#else
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (n < 1) ? 1 : (uint32_t)n;
+}
+
+void las_thread_pool_submit(las_thread_pool_t *self, las_task_t *task)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(task);
+    LAS_DEBUG_ASSERT_NOT_NULL(task->fn);
+
+    task->is_done = false;
+    task->next = NULL;
+
+    las_mutex_lock(&self->mutex);
+    if (self->tail == NULL)
+    {
+        self->head = task;
+    }
+    else
+    {
+        self->tail->next = task;
+    }
+    self->tail = task;
+    las_cond_signal(&self->task_available);
+    las_mutex_unlock(&self->mutex);
+}
+
+void las_thread_pool_wait(las_thread_pool_t *self, las_task_t *task)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(task);
+
+    las_mutex_lock(&self->mutex);
+    while (!task->is_done)
+    {
+        las_cond_wait(&self->task_done, &self->mutex);
+    }
+    las_mutex_unlock(&self->mutex);
+}
+
+void las_thread_pool_delete(las_thread_pool_t *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    las_mutex_lock(&self->mutex);
+    self->is_stopping = true;
+    las_cond_broadcast(&self->task_available);
+    las_mutex_unlock(&self->mutex);
+
+    for (uint32_t i = 0; i < self->num_threads; ++i)
+    {
+        las_thread_join(self->threads[i]);
+    }
+
+    las_cond_destroy(&self->task_done);
+    las_cond_destroy(&self->task_available);
+    las_mutex_destroy(&self->mutex);
+    free(self->threads);
+    free(self);
+}
@@ -0,0 +1,183 @@
+#include "las/point.h"
+
+#include <string.h>
+
+#include "private/macro.h"
+#include "private/point.h"
+
+/// Maximum number of byte runs in a map, there is one per field at most
+#define LAS_TRANSCODE_MAX_RUNS 12
+
+/// Bytes copied as is from the source record to the destination record
+typedef struct las_byte_run
+{
+    uint16_t source;
+    uint16_t dest;
+    uint16_t size;
+} las_byte_run_t;
+
+/// How the fields of the points are moved from one format to another
+///
+/// Fields stored the same way in both formats are copied as byte runs
+/// (consecutive fields are merged into a single run), the return numbers,
+/// flags, classification and scan angle are converted when the formats
+/// are not of the same family (0-5 vs 6-10).
+typedef struct las_transcode_map
+{
+    las_byte_run_t runs[LAS_TRANSCODE_MAX_RUNS];
+    uint8_t num_runs;
+    bool is_source_legacy;
+    bool is_dest_legacy;
+    uint16_t source_size;
+    uint16_t dest_size;
+} las_transcode_map_t;
+
+static void las_transcode_map_add(las_transcode_map_t *map,
+                                  const uint16_t source,
+                                  const uint16_t dest,
+                                  const uint16_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    if (map->num_runs != 0)
+    {
+        las_byte_run_t *last = &map->runs[map->num_runs - 1];
+        if (last->source + last->size == source && last->dest + last->size == dest)
+        {
+            last->size = (uint16_t)(last->size + size);
+            return;
+        }
+    }
+
+    LAS_DEBUG_ASSERT(map->num_runs < LAS_TRANSCODE_MAX_RUNS);
+    las_byte_run_t *run = &map->runs[map->num_runs++];
+    run->source = source;
+    run->dest = dest;
+    run->size = size;
+}
+
+/// Adds the run of an optional field, if both formats have it
+static void las_transcode_map_add_optional(las_transcode_map_t *map,
+                                           const uint16_t source,
+                                           const uint16_t dest,
+                                           const uint16_t size)
+{
+    if (source != LAS_POINT_LAYOUT_ABSENT && dest != LAS_POINT_LAYOUT_ABSENT)
+    {
+        las_transcode_map_add(map, source, dest, size);
+    }
+}
+
+static las_transcode_map_t las_transcode_map_from_formats(const las_point_format_t source_format,
+                                                          const las_point_format_t dest_format)
+{
+    const las_point_layout_t src = las_point_layout_from_format(source_format);
+    const las_point_layout_t dst = las_point_layout_from_format(dest_format);
+
+    las_transcode_map_t map;
+    memset(&map, 0, sizeof(las_transcode_map_t));
+    map.is_source_legacy = src.is_legacy;
+    map.is_dest_legacy = dst.is_legacy;
+    map.source_size = src.point_size;
+    map.dest_size = dst.point_size;
+
+    // x, y, z, intensity
+    las_transcode_map_add(&map, 0, 0, 14);
+    if (src.is_legacy == dst.is_legacy)
+    {
+        // The return byte and the classification (and flags) bytes,
+        // then the scan angle, are stored the same way
+        const uint16_t num_bit_bytes = src.is_legacy ? 2 : 3;
+        las_transcode_map_add(&map, 14, 14, num_bit_bytes);
+        las_transcode_map_add(
+            &map, src.scan_angle, dst.scan_angle, src.is_legacy ? 1 : sizeof(uint16_t));
+    }
+    las_transcode_map_add(&map, src.user_data, dst.user_data, 1);
+    las_transcode_map_add(&map, src.point_source_id, dst.point_source_id, sizeof(uint16_t));
+    las_transcode_map_add_optional(&map, src.gps_time, dst.gps_time, sizeof(double));
+    las_transcode_map_add_optional(&map, src.rgb, dst.rgb, 3 * sizeof(uint16_t));
+    las_transcode_map_add_optional(&map, src.nir, dst.nir, sizeof(uint16_t));
+    las_transcode_map_add_optional(&map, src.wave_packet, dst.wave_packet, LAS_WAVE_PACKET_SIZE);
+
+    const uint16_t num_common_extra_bytes =
+        (source_format.num_extra_bytes < dest_format.num_extra_bytes)
+            ? source_format.num_extra_bytes
+            : dest_format.num_extra_bytes;
+    las_transcode_map_add(&map, src.extra_bytes, dst.extra_bytes, num_common_extra_bytes);
+
+    return map;
+}
+
+/// Converts the return numbers, flags, classification and scan angle
+/// of a record of format 0-5 into a record of format 6-10
+static inline void las_transcode_legacy_to_14(const uint8_t *source, uint8_t *dest)
+{
+    const uint8_t returns = source[14];
+    const uint8_t classification = source[15];
+
+    const uint8_t return_number = returns & 0b111;
+    const uint8_t number_of_returns = (returns >> 3) & 0b111;
+    dest[14] = (uint8_t)(return_number | (number_of_returns << 4));
+    // synthetic, key point, withheld are bits 5-7 of the classification byte,
+    // scan direction and edge of flight line are bits 6-7 of both the
+    // legacy return byte and the 1.4 flags byte
+    dest[15] = (uint8_t)((classification >> 5) | (returns & 0b11000000));
+    dest[16] = classification & 0b00011111;
+    const uint16_t scan_angle = las_scan_angle_from_rank(source[16]);
+    memcpy(dest + 18, &scan_angle, sizeof(uint16_t));
+}
+
+/// Converts the return numbers, flags, classification and scan angle
+/// of a record of format 6-10 into a record of format 0-5
+static inline void las_transcode_14_to_legacy(const uint8_t *source, uint8_t *dest)
+{
+    const uint8_t returns = source[14];
+    const uint8_t flags = source[15];
+
+    const uint8_t return_number = returns & 0b111;
+    const uint8_t number_of_returns = (returns >> 4) & 0b111;
+    dest[14] = (uint8_t)(return_number | (number_of_returns << 3) | (flags & 0b11000000));
+    dest[15] = (uint8_t)((source[16] & 0b00011111) | ((flags & 0b111) << 5));
+    uint16_t scan_angle;
+    memcpy(&scan_angle, source + 18, sizeof(uint16_t));
+    dest[16] = las_scan_angle_to_rank(scan_angle);
+}
+
+void las_transcode_records(const las_point_format_t source_format,
+                           const las_point_format_t dest_format,
+                           const uint8_t *source,
+                           uint8_t *dest,
+                           const uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT(source != NULL || num_points == 0);
+    LAS_DEBUG_ASSERT(dest != NULL || num_points == 0);
+
+    const las_transcode_map_t map = las_transcode_map_from_formats(source_format, dest_format);
+
+    // Fields the source format does not have are zeroed
+    memset(dest, 0, (size_t)map.dest_size * num_points);
+
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        for (uint8_t r = 0; r < map.num_runs; ++r)
+        {
+            const las_byte_run_t run = map.runs[r];
+            memcpy(dest + run.dest, source + run.source, run.size);
+        }
+
+        if (map.is_source_legacy && !map.is_dest_legacy)
+        {
+            las_transcode_legacy_to_14(source, dest);
+        }
+        else if (!map.is_source_legacy && map.is_dest_legacy)
+        {
+            las_transcode_14_to_legacy(source, dest);
+        }
+
+        source += map.source_size;
+        dest += map.dest_size;
+    }
+}
@@ -0,0 +1,50 @@
+#include "private/vlr_arena.h"
+
+#include <stdlib.h>
+
+#include "private/atomic.h"
+
+struct las_vlr_arena
+{
+    las_atomic_u32_t num_refs;
+    size_t size;
+    uint8_t data[];
+};
+
+las_vlr_arena_t *las_vlr_arena_new(const size_t size)
+{
+    las_vlr_arena_t *arena = malloc(sizeof(las_vlr_arena_t) + size);
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+    las_atomic_u32_init(&arena->num_refs, 1);
+    arena->size = size;
+    return arena;
+}
+
+void las_vlr_arena_retain(las_vlr_arena_t *self)
+{
+    if (self != NULL)
+    {
+        las_atomic_u32_increment(&self->num_refs);
+    }
+}
+
+void las_vlr_arena_release(las_vlr_arena_t *self)
+{
+    if (self != NULL && las_atomic_u32_decrement(&self->num_refs) == 0)
+    {
+        free(self);
+    }
+}
+
+uint8_t *las_vlr_arena_data(las_vlr_arena_t *self)
+{
+    return self->data;
+}
+
+bool las_vlr_arena_owns(const las_vlr_arena_t *self, const uint8_t *ptr)
+{
+    return self != NULL && ptr != NULL && ptr >= self->data && ptr < self->data + self->size;
+}
@@ -1,12 +1,41 @@
+#include <las/writer.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "private/dest.h"
 #include "private/header.h"
 #include "private/macro.h"
 #include "private/point.h"
+#include "private/point_columns.h"
+#include "private/point_stats.h"
+#include "private/quantize.h"
+#include "private/source.h"
+#include "private/thread_pool.h"
 
 #ifdef WITH_LAZRS
-#include <lazrs/lazrs.h>
+#include "private/laz_chunk_table.h"
+#include "private/laz_writer.h"
 #endif
 
+/// Batches with fewer points than this per thread are encoded by the calling thread only,
+/// the cost of waking up the threads would exceed the time saved.
+#define LAS_WRITER_MIN_POINTS_PER_ENCODE_TASK 16384
+
+/// Encodes a part of a batch of raw points into the point buffer
+typedef struct las_encode_task
+{
+    las_task_t task;
+    las_writer_t *writer;
+    const las_raw_point_t *points;
+    uint64_t first;
+    uint64_t count;
+    /// Stats of the encoded records, merged by the calling thread
+    las_point_stats_t stats;
+} las_encode_task_t;
+
 typedef struct las_writer
 {
     las_header_t *header;
@@ -17,16 +46,130 @@ typedef struct las_writer
     uint64_t num_points_in_buffer;
     uint16_t point_size;
 
+    /// Bounds and return counts of the points written so far,
+    /// they are written in the header when closing
+    las_point_stats_t stats;
+    las_point_stats_update_fn update_stats;
+    /// Encoder specialized for the point format
+    las_raw_point_encode_many_fn encode;
+    /// Offsets of the fields in the records of the point buffer
+    las_point_layout_t layout;
+    /// Packs columns into the records of the point buffer
+    las_raw_point_columns_encode_fn encode_columns;
+    /// Converts scaled coordinates into the records of the point buffer
+    las_quantize_fn quantize;
+
+    /// Is not null when large batches are encoded by multiple threads
+    las_thread_pool_t *encode_pool;
+    /// One task per pool thread, plus one for the calling thread
+    las_encode_task_t *encode_tasks;
+    uint32_t num_encode_tasks;
+
+    /// Is not null when the payloads of the EVLRs that are not loaded
+    /// are to be copied from it when closing
+    las_source_t *evlr_source;
+
 #ifdef WITH_LAZRS
     /// Is not null when we are writing points as compressed
     /// meaning we should write the bytes into the `compressor`
     /// and not the `dest`
-    Lazrs_LasZipCompressor *compressor;
+    las_laz_writer_t *compressor;
 #endif
 } las_writer_t;
 
+/// Allocates a writer and its buffer for points of the given format
+///
+/// The header, dest (and compressor) are to be set by the caller.
+static las_error_t las_writer_alloc(const las_point_format_t point_format,
+                                    las_writer_t **out_writer)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    las_writer_t *writer = calloc(1, sizeof(las_writer_t));
+    if (writer == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    writer->point_size = las_point_format_point_size(point_format);
+    writer->layout = las_point_layout_from_format(point_format);
+    writer->encode = las_raw_point_select_encode_many_fn(point_format.id);
+    writer->point_buffer = malloc(sizeof(uint8_t) * writer->point_size);
+    if (writer->point_buffer == NULL)
+    {
+        free(writer);
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+    writer->num_points_in_buffer = 1;
+    writer->update_stats = las_point_stats_select_update_fn();
+    writer->quantize = las_quantize_select_fn();
+    writer->encode_columns = las_raw_point_columns_select_encode_fn();
+
+    *out_writer = writer;
+    return las_err;
+}
+
+/// Opens the file from which the payloads of the EVLRs that are not loaded are copied
+static las_error_t las_writer_evlr_source_open(const char *file_path, las_source_t **out_source)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    las_source_t *source = calloc(1, sizeof(las_source_t));
+    if (source == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        return las_err;
+    }
+
+    if (las_source_new_file(file_path, source) != 0)
+    {
+        las_err.kind = LAS_ERROR_ERRNO;
+        las_err.errno_ = errno;
+        las_source_deinit(source);
+        free(source);
+        return las_err;
+    }
+
+    *out_source = source;
+    return las_err;
+}
+
+/// Closes and frees a source opened by `las_writer_evlr_source_open`
+static void las_writer_evlr_source_delete(las_source_t *source)
+{
+    if (source != NULL)
+    {
+        las_source_close(source);
+        las_source_deinit(source);
+        free(source);
+    }
+}
+
+/// Frees a writer allocated by `las_writer_alloc`, that failed to be opened
+static void las_writer_free(las_writer_t *writer)
+{
+    if (writer != NULL)
+    {
+        las_writer_evlr_source_delete(writer->evlr_source);
+        las_thread_pool_delete(writer->encode_pool);
+        free(writer->encode_tasks);
+        free(writer->point_buffer);
+        free(writer);
+    }
+}
+
 las_error_t
 las_writer_open_file_path(const char *file_path, las_header_t *header, las_writer_t **out_writer)
+{
+    return las_writer_open_file_path_with_options(file_path, header, NULL, out_writer);
+}
+
+las_error_t las_writer_open_file_path_with_options(const char *file_path,
+                                                   las_header_t *header,
+                                                   const las_writer_options_t *options,
+                                                   las_writer_t **out_writer)
 {
     LAS_DEBUG_ASSERT(file_path != NULL);
     LAS_DEBUG_ASSERT(header != NULL);
@@ -34,10 +177,15 @@ las_writer_open_file_path(const char *file_path, las_header_t *header, las_write
 
     las_error_t las_err = {LAS_ERROR_OK};
     las_writer_t *writer = NULL;
-    uint8_t *point_buffer = NULL;
     las_dest_t *dest = NULL;
+    las_writer_options_t default_options = {0};
+    if (options == NULL)
+    {
+        options = &default_options;
+    }
 #ifdef WITH_LAZRS
-    Lazrs_LasZipCompressor *compressor = NULL;
+    las_laz_writer_t *compressor = NULL;
+    uint32_t chunk_size = options->chunk_size;
 #endif
 
     las_err = las_header_validate_for_writing(header);
@@ -46,21 +194,43 @@ las_writer_open_file_path(const char *file_path, las_header_t *header, las_write
         goto out;
     }
 
-    writer = calloc(1, sizeof(las_writer_t));
-    if (writer == NULL)
+    las_err = las_writer_alloc(header->point_format, &writer);
+    if (las_error_is_failure(&las_err))
     {
-        las_err.kind = LAS_ERROR_MEMORY;
         goto out;
     }
 
-    const uint16_t point_size = las_point_format_point_size(header->point_format);
-    point_buffer = malloc(sizeof(uint8_t) * point_size);
-    if (point_buffer == NULL)
+    if (options->evlr_source_path != NULL)
     {
-        las_err.kind = LAS_ERROR_MEMORY;
-        goto out;
+        las_err = las_writer_evlr_source_open(options->evlr_source_path, &writer->evlr_source);
+        if (las_error_is_failure(&las_err))
+        {
+            goto out;
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < header->number_of_evlrs; ++i)
+        {
+            if (header->evlrs[i].data_size != 0 && header->evlrs[i].data == NULL)
+            {
+                las_err.kind = LAS_ERROR_EVLR_DATA_NOT_LOADED;
+                goto out;
+            }
+        }
+    }
+
+    if (options->num_encoding_threads != 0)
+    {
+        writer->num_encode_tasks = options->num_encoding_threads + 1;
+        writer->encode_tasks = calloc(writer->num_encode_tasks, sizeof(las_encode_task_t));
+        writer->encode_pool = las_thread_pool_new(options->num_encoding_threads);
+        if (writer->encode_tasks == NULL || writer->encode_pool == NULL)
+        {
+            las_err.kind = LAS_ERROR_MEMORY;
+            goto out;
+        }
     }
-    writer->num_points_in_buffer = 1;
 
     dest = calloc(1, sizeof(las_dest_t));
     if (dest == NULL)
@@ -84,41 +254,19 @@ las_writer_open_file_path(const char *file_path, las_header_t *header, las_write
     if (should_compress)
     {
 #ifdef WITH_LAZRS
-        Lazrs_CompressorParams params;
-        params.dest_type = LAZRS_DEST_CUSTOM;
-        params.dest.custom.user_data = (void *)dest;
-        params.dest.custom.write_fn =
-            (uint64_t(*)(void *, const uint8_t *, uint64_t))las_dest_write;
-        params.dest.custom.flush_fn = (int (*)(void *))las_dest_flush;
-        params.dest.custom.seek_fn = (int (*)(void *, int64_t, int))las_dest_seek;
-        params.dest.custom.tell_fn = (uint64_t(*)(void *))las_dest_tell;
-        params.point_format_id = header->point_format.id;
-        uint16_t num_extra_bytes = header->point_format.num_extra_bytes;
-        params.num_extra_bytes = num_extra_bytes;
-
-        Lazrs_Result r = lazrs_compressor_new_for_point_format(params, true /* prefer_parallel */, &compressor);
-        if (r != LAZRS_OK)
-        {
-            las_err.kind = LAS_ERROR_LAZRS;
-            las_err.lazrs = r;
-            goto out;
-        }
-
-        uint16_t len = lazrs_compressor_laszip_vlr_size(compressor);
-        LAS_ASSERT(len != 0);
-        uint8_t *laszip_vlr_data = malloc(sizeof(uint8_t) * len);
-        if (laszip_vlr_data == NULL)
+#ifndef WITH_LAZ_CHUNKED_WRITER
+        // The single lazrs compressor only uses its own chunk size
+        if (chunk_size != 0)
         {
-            las_err.kind = LAS_ERROR_MEMORY;
+            las_err.kind = LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA;
             goto out;
         }
-        memset(laszip_vlr_data, 0, sizeof(uint8_t) * len);
-
-        r = lazrs_compressor_laszip_vlr_data(compressor, laszip_vlr_data, len);
-        if (r != LAZRS_OK)
+#endif
+        uint8_t *laszip_vlr_data = NULL;
+        uint16_t len = 0;
+        las_err = las_laz_vlr_data_new(header->point_format, &chunk_size, &laszip_vlr_data, &len);
+        if (las_error_is_failure(&las_err))
         {
-            las_err.kind = LAS_ERROR_LAZRS;
-            las_err.lazrs = r;
             goto out;
         }
 
@@ -157,10 +305,13 @@ las_writer_open_file_path(const char *file_path, las_header_t *header, las_write
     }
 
     // Reset some header fields
+    header->start_of_evlrs = 0;
     header->point_count = 0;
     memset(header->number_of_points_by_return,
            0,
            sizeof(uint64_t) * LAS_NUMBER_OF_POINTS_BY_RETURN_SIZE);
+    memset(&header->mins, 0, sizeof(las_vector_3_t));
+    memset(&header->maxs, 0, sizeof(las_vector_3_t));
 
     las_err = las_header_write_to(header, dest);
     if (las_error_is_failure(&las_err))
@@ -168,31 +319,43 @@ las_writer_open_file_path(const char *file_path, las_header_t *header, las_write
         goto out;
     }
 
+#ifdef WITH_LAZRS
+    if (should_compress)
+    {
+#ifdef WITH_LAZ_CHUNKED_WRITER
+        las_err = las_laz_writer_new(
+            dest, header->point_format, chunk_size, options->num_workers, &compressor);
+#else
+        las_err = las_laz_writer_new_single(dest, header->point_format, &compressor);
+#endif
+        if (las_error_is_failure(&las_err))
+        {
+            goto out;
+        }
+    }
+#endif
+
 out:
     if (las_error_is_failure(&las_err) || writer == NULL)
     {
         las_header_delete(header);
-        if (point_buffer != NULL)
-        {
-            free(point_buffer);
-        }
         if (dest != NULL)
         {
-            // Opening was successful
-            las_dest_close(dest);
+            if (dest->inner != NULL)
+            {
+                // Opening was successful
+                las_dest_close(dest);
+                las_dest_deinit(dest);
+            }
             free(dest);
         }
-        if (writer != NULL)
-        {
-            free(writer);
-        }
+        las_writer_free(writer);
     }
     else
     {
-        writer->point_size = point_size;
-        writer->point_buffer = point_buffer;
         writer->dest = dest;
         writer->header = header;
+        las_point_stats_init(&writer->stats);
 #ifdef WITH_LAZRS
         writer->compressor = compressor;
 #endif
@@ -201,73 +364,502 @@ out:
     return las_err;
 }
 
-las_error_t las_writer_write_raw_point(las_writer_t *self, const las_raw_point_t *point)
+/// Size of the buffer through which the EVLR payloads of a file being appended to
+/// are copied to a temporary file
+#define LAS_WRITER_EVLR_STASH_BLOCK_SIZE (1024 * 1024)
+
+/// Copies the payloads of the header's EVLRs from the `source` to a temporary file,
+/// which becomes the source they are copied from when closing.
+///
+/// The payloads go through a buffer of bounded size, they are never loaded in memory.
+/// The `offset_to_data` of the EVLRs are changed to their position in the temporary file.
+static las_error_t las_writer_stash_evlr_data(las_header_t *header,
+                                              las_source_t *source,
+                                              las_source_t **out_stash)
 {
-    LAS_DEBUG_ASSERT_NOT_NULL(self);
-    LAS_DEBUG_ASSERT_NOT_NULL(point);
+    las_error_t las_err = {LAS_ERROR_OK};
+    uint8_t *block = NULL;
+    las_source_t *stash = NULL;
+
+    FILE *file = tmpfile();
+    if (file == NULL)
+    {
+        las_err.kind = LAS_ERROR_ERRNO;
+        las_err.errno_ = errno;
+        return las_err;
+    }
+
+    block = malloc(sizeof(uint8_t) * LAS_WRITER_EVLR_STASH_BLOCK_SIZE);
+    stash = calloc(1, sizeof(las_source_t));
+    if (block == NULL || stash == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    uint64_t stash_offset = 0;
+    for (uint32_t i = 0; i < header->number_of_evlrs; ++i)
+    {
+        las_evlr_t *evlr = &header->evlrs[i];
+        if (evlr->offset_to_data > (uint64_t)INT64_MAX ||
+            las_source_seek(source, (int64_t)evlr->offset_to_data, LAS_SEEK_FROM_START) != 0)
+        {
+            las_err.kind = LAS_ERROR_ERRNO;
+            las_err.errno_ = errno;
+            goto out;
+        }
+
+        uint64_t bytes_left = evlr->data_size;
+        while (bytes_left != 0)
+        {
+            const uint64_t n = (bytes_left < LAS_WRITER_EVLR_STASH_BLOCK_SIZE)
+                                   ? bytes_left
+                                   : LAS_WRITER_EVLR_STASH_BLOCK_SIZE;
+            if (las_source_read(source, n, block) != n)
+            {
+                las_err.kind = LAS_ERROR_UNEXPECTED_EOF;
+                goto out;
+            }
+            if (fwrite(block, sizeof(uint8_t), (size_t)n, file) != (size_t)n)
+            {
+                las_err.kind = LAS_ERROR_ERRNO;
+                las_err.errno_ = errno;
+                goto out;
+            }
+            bytes_left -= n;
+        }
+
+        evlr->offset_to_data = stash_offset;
+        stash_offset += evlr->data_size;
+    }
+
+    if (fflush(file) != 0)
+    {
+        las_err.kind = LAS_ERROR_ERRNO;
+        las_err.errno_ = errno;
+        goto out;
+    }
+
+    las_source_new_from_file(file, stash);
+    file = NULL;
+    *out_stash = stash;
+    stash = NULL;
+
+out:
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    free(stash);
+    free(block);
+    return las_err;
+}
+
+las_error_t las_writer_open_append(const char *file_path,
+                                   const las_point_format_t point_format,
+                                   las_writer_t **out_writer)
+{
+    LAS_DEBUG_ASSERT(file_path != NULL);
+    LAS_DEBUG_ASSERT(out_writer != NULL);
 
     las_error_t las_err = {LAS_ERROR_OK};
+    las_writer_t *writer = NULL;
+    las_dest_t *dest = NULL;
+    las_source_t source = {0};
+    las_source_t *evlr_stash = NULL;
+    bool is_compressed = false;
 
-    if (point->point_format_id != self->header->point_format.id)
+    las_header_t *header = calloc(1, sizeof(las_header_t));
+    if (header == NULL)
     {
-        las_err.kind = LAS_ERROR_INCOMPATIBLE_POINT_FORMAT;
+        las_err.kind = LAS_ERROR_MEMORY;
         return las_err;
     }
 
+    //
+    // Read what's currently in the file
+    //
+    if (las_source_new_file(file_path, &source) != 0)
+    {
+        las_err.kind = LAS_ERROR_ERRNO;
+        las_err.errno_ = errno;
+        las_source_deinit(&source);
+        goto out;
+    }
+
+    las_err = las_header_read_from(&source, header, &is_compressed);
+    if (las_error_is_ok(&las_err) && header->version.minor >= 4)
+    {
+        las_err = las_evlrs_read_from(&source, header);
+    }
+    if (las_error_is_ok(&las_err))
+    {
+        las_err = las_header_validate(header);
+    }
+    if (las_error_is_ok(&las_err) && is_compressed)
+    {
+        las_err.kind = LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA;
+    }
+    // The new points will overwrite the EVLRs, they are rewritten after them
+    if (las_error_is_ok(&las_err) && header->number_of_evlrs != 0)
+    {
+        las_err = las_writer_stash_evlr_data(header, &source, &evlr_stash);
+    }
+
+    las_source_close(&source);
+    las_source_deinit(&source);
+
+    if (las_error_is_failure(&las_err))
+    {
+        goto out;
+    }
+
+    if (header->point_format.id != point_format.id ||
+        header->point_format.num_extra_bytes != point_format.num_extra_bytes)
+    {
+        las_err.kind = LAS_ERROR_INCOMPATIBLE_POINT_FORMAT;
+        goto out;
+    }
+
+    // The header is rewritten in place when closing, which is only possible
+    // if the points start right after the VLRs (no user defined bytes in between)
+    if (header->offset_to_point_data != las_header_written_offset_to_point_data(header))
+    {
+        las_err.kind = LAS_ERROR_UNSUPPORTED_HEADER_LAYOUT;
+        goto out;
+    }
+
+    // Waveform data packets stored in the file (bit 1 of the global encoding)
+    // would be overwritten, or moved without their offset being updated
+    if (header->version.minor >= 3 &&
+        ((header->global_encoding & 0b10) != 0 || header->start_of_waveform_datapacket != 0))
+    {
+        las_err.kind = LAS_ERROR_UNSUPPORTED_HEADER_LAYOUT;
+        goto out;
+    }
+
+    las_err = las_writer_alloc(header->point_format, &writer);
+    if (las_error_is_failure(&las_err))
+    {
+        goto out;
+    }
+    writer->evlr_source = evlr_stash;
+    evlr_stash = NULL;
+
+    //
+    // Position the writes at the end of the existing points
+    //
+    dest = calloc(1, sizeof(las_dest_t));
+    if (dest == NULL)
+    {
+        las_err.kind = LAS_ERROR_MEMORY;
+        goto out;
+    }
+
+    if (las_dest_open_file(file_path, dest) != 0)
+    {
+        las_err.kind = LAS_ERROR_ERRNO;
+        las_err.errno_ = errno;
+        goto out;
+    }
+
+    const uint64_t end_of_points =
+        header->offset_to_point_data + header->point_count * writer->point_size;
+    if (las_dest_seek(dest, (int64_t)end_of_points, LAS_SEEK_FROM_START) != 0)
+    {
+        las_err = las_dest_err(dest);
+        goto out;
+    }
+
+out:
+    if (las_error_is_failure(&las_err))
+    {
+        las_writer_evlr_source_delete(evlr_stash);
+        las_header_delete(header);
+        if (dest != NULL)
+        {
+            if (dest->inner != NULL)
+            {
+                las_dest_close(dest);
+                las_dest_deinit(dest);
+            }
+            free(dest);
+        }
+        las_writer_free(writer);
+    }
+    else
+    {
+        writer->dest = dest;
+        writer->header = header;
+        las_point_stats_from_header(&writer->stats, header);
+        *out_writer = writer;
+    }
+    return las_err;
+}
+
+const las_header_t *las_writer_header(const las_writer_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+
+    return self->header;
+}
+
+/// Returns an error if writing `num_points` more points would
+/// exceed the maximum point count the header's version allows
+static inline las_error_t las_writer_check_point_count(const las_writer_t *self,
+                                                       const uint64_t num_points)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+
     const uint64_t max_point_count_allowed =
-        (self->header->version.major < 4) ? UINT32_MAX : UINT64_MAX;
-    if (self->header->point_count == max_point_count_allowed)
+        (self->header->version.minor < 4) ? UINT32_MAX : UINT64_MAX;
+    if (num_points > max_point_count_allowed - self->header->point_count)
     {
         las_err.kind = LAS_ERROR_POINT_COUNT_TOO_HIGH;
         las_err.point_count = self->header->point_count;
-        return las_err;
     }
 
-    if (self->header->point_format.id <= 5)
+    return las_err;
+}
+
+/// Makes sure the point buffer can hold at least `num_points` records
+static las_error_t las_writer_reserve(las_writer_t *self, const uint64_t num_points)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    if (self->num_points_in_buffer < num_points)
     {
-        las_raw_point_10_to_buffer(&point->point10, self->header->point_format, self->point_buffer);
-        const int max_value = LAS_LEGACY_NUMBER_OF_POINTS_BY_RETURN_SIZE - 1;
-        self->header->number_of_points_by_return[point->point10.return_number & max_value]++;
+        uint8_t *buffer = realloc(self->point_buffer, self->point_size * num_points);
+        if (buffer == NULL)
+        {
+            las_err.kind = LAS_ERROR_MEMORY;
+            return las_err;
+        }
+        self->point_buffer = buffer;
+        self->num_points_in_buffer = num_points;
     }
-    else
+
+    return las_err;
+}
+
+/// Checks that the given x, y, z columns (spaced by `stride` doubles) fit in the records
+/// once converted with the header's scaling, columns that are NULL are skipped
+///
+/// Returns `LAS_ERROR_COORDINATE_OVERFLOW` otherwise.
+static las_error_t las_writer_check_xyz_fit(const las_writer_t *self,
+                                            const double *xs,
+                                            const double *ys,
+                                            const double *zs,
+                                            const size_t stride,
+                                            const uint64_t num_points)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+    const las_scaling_t scaling = self->header->scaling;
+    const double *coordinates[3] = {xs, ys, zs};
+    const double scales[3] = {scaling.scales.x, scaling.scales.y, scaling.scales.z};
+    const double offsets[3] = {scaling.offsets.x, scaling.offsets.y, scaling.offsets.z};
+    for (size_t i = 0; i < 3; ++i)
     {
-        las_raw_point_14_to_buffer(&point->point14, self->header->point_format, self->point_buffer);
-        const int max_value = LAS_NUMBER_OF_POINTS_BY_RETURN_SIZE - 1;
-        self->header->number_of_points_by_return[point->point14.return_number & max_value]++;
+        if (coordinates[i] != NULL &&
+            !las_quantize_all_fit(coordinates[i], stride, num_points, scales[i], offsets[i]))
+        {
+            las_err.kind = LAS_ERROR_COORDINATE_OVERFLOW;
+            return las_err;
+        }
     }
+    return las_err;
+}
+
+/// Converts the x, y, z columns (spaced by `stride` doubles) into the
+/// first `num_points` records of the point buffer
+static void las_writer_quantize_xyz(las_writer_t *self,
+                                    const double *xs,
+                                    const double *ys,
+                                    const double *zs,
+                                    const size_t stride,
+                                    const uint64_t num_points)
+{
+    const las_scaling_t scaling = self->header->scaling;
+    self->quantize(xs,
+                   stride,
+                   num_points,
+                   scaling.scales.x,
+                   scaling.offsets.x,
+                   self->point_buffer,
+                   self->point_size);
+    self->quantize(ys,
+                   stride,
+                   num_points,
+                   scaling.scales.y,
+                   scaling.offsets.y,
+                   self->point_buffer + sizeof(int32_t),
+                   self->point_size);
+    self->quantize(zs,
+                   stride,
+                   num_points,
+                   scaling.scales.z,
+                   scaling.offsets.z,
+                   self->point_buffer + 2 * sizeof(int32_t),
+                   self->point_size);
+}
+
+/// Sends the point records in `buffer` to the compressor or the dest
+///
+/// The point count only includes them once they are sent,
+/// the caller accounts for the records in the writer's stats if this succeeds.
+static las_error_t las_writer_send_buffer(las_writer_t *self,
+                                          const uint8_t *buffer,
+                                          const uint64_t num_points)
+{
+    las_error_t las_err = {LAS_ERROR_OK};
+    const uint64_t num_bytes = self->point_size * num_points;
 
 #ifdef WITH_LAZRS
     if (self->compressor != NULL)
     {
-        Lazrs_Result r =
-            lazrs_compressor_compress_one(self->compressor, self->point_buffer, self->point_size);
-        if (r != LAZRS_OK)
-        {
-            las_err.kind = LAS_ERROR_LAZRS;
-            las_err.lazrs = r;
-        }
+        las_err = las_laz_writer_write(self->compressor, buffer, num_points);
     }
     else
+#endif
     {
-        uint64_t n = las_dest_write(self->dest, self->point_buffer, self->point_size);
-        if (n < self->point_size)
+        const uint64_t n = las_dest_write(self->dest, buffer, num_bytes);
+        if (n < num_bytes)
         {
             las_err = las_dest_err(self->dest);
         }
     }
-#else
-    uint64_t n = las_dest_write(self->dest, self->point_buffer, self->point_size);
-    if (n < self->point_size)
+
+    // Points that failed to be written are not counted
+    if (las_error_is_ok(&las_err))
     {
-        las_err = las_dest_err(self->dest);
+        self->header->point_count += num_points;
     }
-#endif
 
-    self->header->point_count++;
+    return las_err;
+}
+
+/// Sends the point records in `buffer` to the compressor or the dest
+///
+/// Once they are sent, the records are also accounted for in the writer's stats,
+/// while they are still hot in the cache.
+static las_error_t las_writer_write_buffer(las_writer_t *self,
+                                           const uint8_t *buffer,
+                                           const uint64_t num_points)
+{
+    las_error_t las_err = las_writer_send_buffer(self, buffer, num_points);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    self->update_stats(&self->stats,
+                       buffer,
+                       num_points,
+                       self->point_size,
+                       las_point_stats_return_mask(self->header->point_format.id));
 
     return las_err;
 }
 
+/// Encodes the `count` points starting at `first` into the
+/// records starting at `first` in the point buffer
+static void las_writer_encode_raw_points(las_writer_t *self,
+                                         const las_raw_point_t *points,
+                                         const uint64_t first,
+                                         const uint64_t count)
+{
+    LAS_DEBUG_ASSERT(first + count <= self->num_points_in_buffer);
+    self->encode(&points[first],
+                 count,
+                 self->header->point_format,
+                 self->point_buffer + first * self->point_size);
+}
+
+/// Encodes the task's part of the batch, and computes its stats
+static void las_encode_task_run(void *arg)
+{
+    las_encode_task_t *task = arg;
+    las_writer_t *self = task->writer;
+
+    las_writer_encode_raw_points(self, task->points, task->first, task->count);
+
+    las_point_stats_init(&task->stats);
+    self->update_stats(&task->stats,
+                       self->point_buffer + task->first * self->point_size,
+                       task->count,
+                       self->point_size,
+                       las_point_stats_return_mask(self->header->point_format.id));
+}
+
+/// Encodes the points into the point buffer using the encode pool
+///
+/// Each thread encodes a contiguous part of the batch, the calling thread
+/// encodes the last one. The stats of each part are kept in its task,
+/// see `las_writer_merge_encode_stats`.
+static void las_writer_encode_raw_points_in_parallel(las_writer_t *self,
+                                                     const las_raw_point_t *points,
+                                                     const uint64_t num_points,
+                                                     const uint32_t num_tasks)
+{
+    const uint64_t points_per_task = num_points / num_tasks;
+    for (uint32_t i = 0; i < num_tasks; ++i)
+    {
+        las_encode_task_t *task = &self->encode_tasks[i];
+        task->task.fn = las_encode_task_run;
+        task->task.arg = task;
+        task->writer = self;
+        task->points = points;
+        task->first = i * points_per_task;
+        task->count = (i == num_tasks - 1) ? num_points - task->first : points_per_task;
+    }
+
+    for (uint32_t i = 0; i + 1 < num_tasks; ++i)
+    {
+        las_thread_pool_submit(self->encode_pool, &self->encode_tasks[i].task);
+    }
+    las_encode_task_run(&self->encode_tasks[num_tasks - 1]);
+
+    for (uint32_t i = 0; i + 1 < num_tasks; ++i)
+    {
+        las_thread_pool_wait(self->encode_pool, &self->encode_tasks[i].task);
+    }
+}
+
+/// Merges the stats of the tasks of the last parallel encode into the writer's stats,
+/// to be called once the records were sent.
+static void las_writer_merge_encode_stats(las_writer_t *self, const uint32_t num_tasks)
+{
+    // Merged in order, so the result does not depend on which task finished first
+    for (uint32_t i = 0; i < num_tasks; ++i)
+    {
+        las_point_stats_merge(&self->stats, &self->encode_tasks[i].stats);
+    }
+}
+
+las_error_t las_writer_write_raw_point(las_writer_t *self, const las_raw_point_t *point)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(point);
+
+    las_error_t las_err = {LAS_ERROR_OK};
+
+    if (point->point_format_id != self->header->point_format.id)
+    {
+        las_err.kind = LAS_ERROR_INCOMPATIBLE_POINT_FORMAT;
+        return las_err;
+    }
+
+    las_err = las_writer_check_point_count(self, 1);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    self->encode(point, 1, self->header->point_format, self->point_buffer);
+
+    return las_writer_write_buffer(self, self->point_buffer, 1);
+}
+
 las_error_t las_writer_write_many_raw_points(las_writer_t *self,
                                              const las_raw_point_t *points,
                                              const uint64_t num_points)
@@ -286,86 +878,212 @@ las_error_t las_writer_write_many_raw_points(las_writer_t *self,
         }
     }
 
-    const uint64_t max_point_count_allowed =
-        (self->header->version.major < 4) ? UINT32_MAX : UINT64_MAX;
-    if (self->header->point_count + num_points == max_point_count_allowed)
+    las_err = las_writer_check_point_count(self, num_points);
+    if (las_error_is_failure(&las_err))
     {
-        las_err.kind = LAS_ERROR_POINT_COUNT_TOO_HIGH;
-        las_err.point_count = self->header->point_count;
         return las_err;
     }
 
-    // Resize internal buffer if needed
-    if (self->num_points_in_buffer < num_points)
+    las_err = las_writer_reserve(self, num_points);
+    if (las_error_is_failure(&las_err))
     {
-        uint8_t *buffer = realloc(self->point_buffer, self->point_size * num_points);
-        if (buffer == NULL)
-        {
-            las_err.kind = LAS_ERROR_MEMORY;
-            return las_err;
-        }
-        self->point_buffer = buffer;
-        self->num_points_in_buffer = num_points;
+        return las_err;
     }
 
     // Write the points to internal buffer
-    uint8_t *buffer = self->point_buffer;
-    if (self->header->point_format.id <= 5)
+    uint64_t num_tasks = num_points / LAS_WRITER_MIN_POINTS_PER_ENCODE_TASK;
+    num_tasks = (num_tasks < self->num_encode_tasks) ? num_tasks : self->num_encode_tasks;
+    if (num_tasks > 1)
     {
-        for (uint64_t i = 0; i < num_points; ++i)
+        las_writer_encode_raw_points_in_parallel(self, points, num_points, (uint32_t)num_tasks);
+        las_err = las_writer_send_buffer(self, self->point_buffer, num_points);
+        if (las_error_is_ok(&las_err))
         {
-            las_raw_point_10_to_buffer(&points[i].point10, self->header->point_format, buffer);
-            const int max_value = LAS_LEGACY_NUMBER_OF_POINTS_BY_RETURN_SIZE - 1;
-            self->header->number_of_points_by_return[points[i].point10.return_number % max_value]++;
-            buffer += self->point_size;
-            LAS_DEBUG_ASSERT(buffer <=
-                             self->point_buffer + (self->point_size * self->num_points_in_buffer));
+            las_writer_merge_encode_stats(self, (uint32_t)num_tasks);
         }
     }
     else
     {
-        for (uint64_t i = 0; i < num_points; ++i)
-        {
-            las_raw_point_14_to_buffer(&points[i].point14, self->header->point_format, buffer);
-            const int max_value = LAS_NUMBER_OF_POINTS_BY_RETURN_SIZE - 1;
-            self->header->number_of_points_by_return[points[i].point14.return_number % max_value]++;
-            buffer += self->point_size;
-            LAS_DEBUG_ASSERT(buffer <=
-                             self->point_buffer + (self->point_size * self->num_points_in_buffer));
-        }
+        las_writer_encode_raw_points(self, points, 0, num_points);
+        las_err = las_writer_write_buffer(self, self->point_buffer, num_points);
     }
 
-#ifdef WITH_LAZRS
-    if (self->compressor != NULL)
+    return las_err;
+}
+
+las_error_t
+las_writer_write_many_bytes(las_writer_t *self, const uint8_t *bytes, const uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(bytes);
+
+    las_error_t las_err = las_writer_check_point_count(self, num_points);
+    if (las_error_is_failure(&las_err))
     {
-        const Lazrs_Result r = lazrs_compressor_compress_many(
-            self->compressor, self->point_buffer, self->point_size * num_points);
-        if (r != LAZRS_OK)
-        {
-            las_err.kind = LAS_ERROR_LAZRS;
-            las_err.lazrs = r;
-        }
+        return las_err;
     }
-    else
+
+    return las_writer_write_buffer(self, bytes, num_points);
+}
+
+las_error_t las_writer_write_many_points(las_writer_t *self,
+                                         const las_point_t *points,
+                                         const uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT(points != NULL || num_points == 0);
+
+    las_error_t las_err = las_writer_check_point_count(self, num_points);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    if (num_points == 0)
+    {
+        return las_err;
+    }
+
+    const size_t point_stride = sizeof(las_point_t) / sizeof(double);
+    las_err = las_writer_check_xyz_fit(
+        self, &points[0].x, &points[0].y, &points[0].z, point_stride, num_points);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    las_err = las_writer_reserve(self, num_points);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    const las_point_format_t point_format = self->header->point_format;
+    uint8_t *buffer = self->point_buffer;
+    for (uint64_t i = 0; i < num_points; ++i)
     {
-        const uint64_t n =
-            las_dest_write(self->dest, self->point_buffer, self->point_size * num_points);
-        if (n < self->point_size * num_points)
+        las_point_to_buffer_without_xyz(&points[i], point_format, buffer);
+        buffer += self->point_size;
+    }
+
+    las_writer_quantize_xyz(
+        self, &points[0].x, &points[0].y, &points[0].z, point_stride, num_points);
+
+    return las_writer_write_buffer(self, self->point_buffer, num_points);
+}
+
+las_error_t las_writer_write_many_xyz(las_writer_t *self,
+                                      const double *xs,
+                                      const double *ys,
+                                      const double *zs,
+                                      const uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT((xs != NULL && ys != NULL && zs != NULL) || num_points == 0);
+
+    las_point_columns_t columns;
+    memset(&columns, 0, sizeof(las_point_columns_t));
+    columns.x = xs;
+    columns.y = ys;
+    columns.z = zs;
+    return las_writer_write_columns(self, &columns, num_points);
+}
+
+las_error_t las_writer_write_columns(las_writer_t *self,
+                                     const las_point_columns_t *columns,
+                                     const uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(columns);
+
+    las_error_t las_err = las_writer_check_point_count(self, num_points);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    if (num_points == 0)
+    {
+        return las_err;
+    }
+
+    las_err = las_writer_check_xyz_fit(self, columns->x, columns->y, columns->z, 1, num_points);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    las_err = las_writer_reserve(self, num_points);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    const las_raw_point_columns_t view = las_raw_point_columns_from_columns(columns);
+    self->encode_columns(&view, &self->layout, num_points, self->point_buffer);
+
+    // Quantize the coordinates that were given, the others stay at 0
+    const las_scaling_t scaling = self->header->scaling;
+    const double *coordinates[3] = {columns->x, columns->y, columns->z};
+    const double scales[3] = {scaling.scales.x, scaling.scales.y, scaling.scales.z};
+    const double offsets[3] = {scaling.offsets.x, scaling.offsets.y, scaling.offsets.z};
+    for (size_t i = 0; i < 3; ++i)
+    {
+        if (coordinates[i] != NULL)
         {
-            las_err = las_dest_err(self->dest);
+            self->quantize(coordinates[i],
+                           1,
+                           num_points,
+                           scales[i],
+                           offsets[i],
+                           self->point_buffer + i * sizeof(int32_t),
+                           self->point_size);
         }
     }
-#else  // WITH_LAZRS
-    const uint64_t n =
-        las_dest_write(self->dest, self->point_buffer, self->point_size * num_points);
-    if (n < self->point_size * num_points)
+
+    return las_writer_write_buffer(self, self->point_buffer, num_points);
+}
+
+las_error_t las_writer_write_raw_columns(las_writer_t *self,
+                                         const las_raw_point_columns_t *columns,
+                                         const uint64_t num_points)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
+    LAS_DEBUG_ASSERT_NOT_NULL(columns);
+
+    las_error_t las_err = las_writer_check_point_count(self, num_points);
+    if (las_error_is_failure(&las_err))
     {
-        las_err = las_dest_err(self->dest);
+        return las_err;
     }
-#endif // WITH_LAZRS
 
-    self->header->point_count += num_points;
+    if (num_points == 0)
+    {
+        return las_err;
+    }
+
+    las_err = las_writer_reserve(self, num_points);
+    if (las_error_is_failure(&las_err))
+    {
+        return las_err;
+    }
+
+    self->encode_columns(columns, &self->layout, num_points, self->point_buffer);
+
+    return las_writer_write_buffer(self, self->point_buffer, num_points);
+}
+
+las_error_t las_writer_finish_chunk(las_writer_t *self)
+{
+    LAS_DEBUG_ASSERT_NOT_NULL(self);
 
+#ifdef WITH_LAZRS
+    if (self->compressor != NULL)
+    {
+        return las_laz_writer_finish_chunk(self->compressor);
+    }
+#endif
+
+    las_error_t las_err = {LAS_ERROR_OK};
     return las_err;
 }
 
@@ -378,31 +1096,62 @@ static las_error_t las_writer_close(las_writer_t *self)
 #ifdef WITH_LAZRS
     if (self->compressor != NULL)
     {
-        Lazrs_Result r = lazrs_compressor_done(self->compressor);
-        if (r != LAZRS_OK)
+        err = las_laz_writer_done(self->compressor);
+        if (las_error_is_failure(&err))
         {
-            las_error_t err;
-            err.kind = LAS_ERROR_LAZRS;
-            err.lazrs = r;
             return err;
         }
+
+        // The header (and so the LASzip VLR) is written again below
+        if (las_laz_writer_is_variable_size(self->compressor))
+        {
+            const las_vlr_t *found = las_header_find_laszip_vlr(self->header);
+            LAS_ASSERT(found != NULL);
+            las_vlr_t *laszip_vlr = &self->header->vlrs[found - self->header->vlrs];
+            const uint32_t chunk_size = LAS_LAZ_VARIABLE_CHUNK_SIZE;
+            memcpy(laszip_vlr->data + LAS_LAZ_VLR_CHUNK_SIZE_OFFSET,
+                   &chunk_size,
+                   sizeof(uint32_t));
+        }
     }
-    self->header->point_format.id |= (2 << 7);
 #endif
 
+    if (self->header->number_of_evlrs != 0)
+    {
+        // EVLRs go after the points, which is where the last write ended.
+        // (When appending, the file may still contain the old EVLRs after that,
+        // they are overwritten)
+        self->header->start_of_evlrs = las_dest_tell(self->dest);
+
+        for (uint32_t i = 0; i < self->header->number_of_evlrs; ++i)
+        {
+            err = las_evlr_write_to(&self->header->evlrs[i], self->evlr_source, self->dest);
+            if (las_error_is_failure(&err))
+            {
+                return err;
+            }
+        }
+    }
+
+    las_point_stats_to_header(&self->stats, self->header);
+
     if (las_dest_seek(self->dest, 0, LAS_SEEK_FROM_START))
     {
         return las_dest_err(self->dest);
     }
 
-    err = las_header_write_to(self->header, self->dest);
-    if (las_error_is_failure(&err))
+#ifdef WITH_LAZRS
+    // Bit 7 of the point format id tells readers the points are compressed
+    if (self->compressor != NULL)
     {
-        return err;
+        self->header->point_format.id |= 0x80;
     }
+#endif
+
+    err = las_header_write_to(self->header, self->dest);
 
 #ifdef WITH_LAZRS
-    self->header->point_format.id &= ~(2 << 7);
+    self->header->point_format.id &= 0x7F;
 #endif
 
     return err;
@@ -433,12 +1182,18 @@ void las_writer_deinit(las_writer_t *self)
         self->point_buffer = NULL;
     }
 
+    las_writer_evlr_source_delete(self->evlr_source);
+    self->evlr_source = NULL;
+
+    las_thread_pool_delete(self->encode_pool);
+    self->encode_pool = NULL;
+    free(self->encode_tasks);
+    self->encode_tasks = NULL;
+    self->num_encode_tasks = 0;
+
 #ifdef WITH_LAZRS
-    if (self->compressor != NULL)
-    {
-        lazrs_compressor_delete(self->compressor);
-        self->compressor = NULL;
-    }
+    las_laz_writer_delete(self->compressor);
+    self->compressor = NULL;
 #endif
 }
 
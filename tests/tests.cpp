@@ -1,11 +1,49 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
 #include <vector>
 
+#if !defined(_WIN32)
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
 extern "C" {
 #include <las/las.h>
+#include <private/laz_chunk_table.h>
 #include <private/point.h>
+#ifdef WITH_LAZRS
+#include <private/laz_writer.h>
+#endif
 }
 
+/// A file in the test temporary directory, removed when it goes out of scope
+///
+/// Its name is prefixed by the name of the running test,
+/// so that tests running in parallel never write to the same file.
+struct TempFile
+{
+    std::string path;
+
+    explicit TempFile(const char *name)
+    {
+        const ::testing::TestInfo *info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = ::testing::TempDir() + info->test_suite_name() + "_" + info->name() + "_" + name;
+        std::remove(path.c_str());
+    }
+
+    TempFile(const TempFile &) = delete;
+    TempFile &operator=(const TempFile &) = delete;
+
+    ~TempFile() { std::remove(path.c_str()); }
+
+    const char *c_str() const { return path.c_str(); }
+};
+
 /// Initialize all fields of a raw_point_10
 /// which corresponds to point format id 5
 static void init_raw_point_10(las_raw_point_10_t *rp) {
@@ -253,4 +291,2794 @@ TEST(ReadWriteBuffers, RawPoint10Roundrip)
     ASSERT_DOUBLE_EQ(output_point.x, rp.x);
     ASSERT_DOUBLE_EQ(output_point.y, rp.y);
     ASSERT_DOUBLE_EQ(output_point.z, rp.z);
-}
\ No newline at end of file
+}
+
+TEST(ReadWriteBuffers, RawPoint10ScanDirectionFlagBit)
+{
+    const las_point_format_t point_format = {0, 0};
+
+    las_raw_point_10_t rp{};
+    rp.return_number = 1;
+    rp.number_of_returns = 1;
+    rp.scan_direction_flag = 1;
+    rp.edge_of_flight_line = 0;
+    // must not leak into bit 6 of the return byte
+    rp.scan_angle_rank = 234;
+
+    std::vector<uint8_t> buffer(las_point_format_point_size(point_format));
+    las_raw_point_10_to_buffer(&rp, point_format, buffer.data());
+    ASSERT_EQ(buffer[14], 0b01001001);
+
+    las_raw_point_10_t output{};
+    las_raw_point_10_from_buffer(buffer.data(), point_format, &output);
+    ASSERT_EQ(output.scan_direction_flag, 1);
+    ASSERT_EQ(output.edge_of_flight_line, 0);
+    ASSERT_EQ(output.scan_angle_rank, 234);
+}
+
+TEST(ReadWriteBuffers, RawPointEq)
+{
+    const uint8_t point_format_ids[] = {3, 6};
+    for (const uint8_t id : point_format_ids)
+    {
+        const las_point_format_t point_format = {id, 2};
+
+        las_raw_point_t lhs;
+        las_raw_point_t rhs;
+        las_raw_point_prepare(&lhs, point_format);
+        las_raw_point_prepare(&rhs, point_format);
+        ASSERT_TRUE(las_raw_point_eq(&lhs, &rhs)) << "point format " << int(id);
+
+        if (id <= 5)
+        {
+            lhs.point10.x = 1;
+        }
+        else
+        {
+            lhs.point14.x = 1;
+        }
+        ASSERT_FALSE(las_raw_point_eq(&lhs, &rhs)) << "point format " << int(id);
+        ASSERT_FALSE(las_raw_point_eq(&rhs, &lhs)) << "point format " << int(id);
+
+        las_raw_point_deinit(&rhs);
+        las_raw_point_deinit(&lhs);
+    }
+}
+
+TEST(ReadWriteBuffers, RawPointCopyFromRawOwnsItsExtraBytes)
+{
+    const uint8_t point_format_ids[] = {3, 6};
+    for (const uint8_t id : point_format_ids)
+    {
+        const las_point_format_t point_format = {id, 2};
+
+        las_raw_point_t source;
+        las_raw_point_t dest;
+        las_raw_point_prepare(&source, point_format);
+        las_raw_point_prepare(&dest, point_format);
+
+        uint8_t *source_extra_bytes =
+            (id <= 5) ? source.point10.extra_bytes : source.point14.extra_bytes;
+        source_extra_bytes[1] = 42;
+
+        las_raw_point_copy_from_raw(&dest, &source);
+
+        const uint8_t *dest_extra_bytes =
+            (id <= 5) ? dest.point10.extra_bytes : dest.point14.extra_bytes;
+        ASSERT_NE(dest_extra_bytes, source_extra_bytes) << "point format " << int(id);
+        ASSERT_EQ(dest_extra_bytes[1], 42) << "point format " << int(id);
+
+        // Each point frees its own extra bytes
+        las_raw_point_deinit(&dest);
+        las_raw_point_deinit(&source);
+    }
+}
+
+TEST(ReadWriteBuffers, RawPointCopyFromPointKeepsEachCoordinate)
+{
+    las_scaling_t scaling{};
+    scaling.scales = {1.0, 1.0, 1.0};
+
+    const uint8_t point_format_ids[] = {3, 6};
+    for (const uint8_t id : point_format_ids)
+    {
+        const las_point_format_t point_format = {id, 0};
+
+        las_point_t point;
+        las_point_prepare(&point, point_format);
+        point.x = 11.0;
+        point.y = -22.0;
+        point.z = 33.0;
+
+        las_raw_point_t raw;
+        las_raw_point_prepare(&raw, point_format);
+        las_raw_point_copy_from_point(&raw, &point, scaling);
+
+        if (id <= 5)
+        {
+            ASSERT_EQ(raw.point10.x, 11);
+            ASSERT_EQ(raw.point10.y, -22);
+            ASSERT_EQ(raw.point10.z, 33);
+        }
+        else
+        {
+            ASSERT_EQ(raw.point14.x, 11);
+            ASSERT_EQ(raw.point14.y, -22);
+            ASSERT_EQ(raw.point14.z, 33);
+        }
+
+        las_raw_point_deinit(&raw);
+        las_point_deinit(&point);
+    }
+}
+
+TEST(Scaling, UnapplyRoundsToNearest)
+{
+    las_scaling_t scaling{};
+    scaling.scales = {0.01, 0.01, 0.01};
+    scaling.offsets = {0.0, 0.0, 100.0};
+
+    // 0.29 / 0.01 is 28.999999999999996
+    ASSERT_EQ(las_scaling_unapply_x(scaling, 0.29), 29);
+    ASSERT_EQ(las_scaling_unapply_y(scaling, -0.29), -29);
+    ASSERT_EQ(las_scaling_unapply_x(scaling, 0.004), 0);
+    ASSERT_EQ(las_scaling_unapply_x(scaling, 0.005), 1);
+    ASSERT_EQ(las_scaling_unapply_y(scaling, -0.005), -1);
+    ASSERT_EQ(las_scaling_unapply_z(scaling, 99.996), 0);
+    ASSERT_EQ(las_scaling_unapply_z(scaling, 99.994), -1);
+}
+
+TEST(ReadWriteBuffers, SpecializedCodecsRoundtrip)
+{
+    for (uint8_t id = 0; id <= 10; ++id)
+    {
+        const las_point_format_t point_format = {id, 3};
+        const bool has_gps_time = id == 1 || id == 3 || id >= 6;
+        const bool has_rgb = id == 2 || id == 3 || id == 5 || id == 7 || id == 8 || id == 10;
+        const bool has_waveform = id == 4 || id == 5 || id == 9 || id == 10;
+
+        std::vector<las_raw_point_t> points(2);
+        las_raw_point_prepare_many(points.data(), 2, point_format);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            if (id <= 5)
+            {
+                las_raw_point_10_t &p = points[i].point10;
+                p.x = static_cast<int32_t>(10 + i);
+                p.intensity = 43'564;
+                p.return_number = 5;
+                p.number_of_returns = 6;
+                p.scan_direction_flag = 1;
+                p.edge_of_flight_line = 0;
+                p.classification = 26;
+                p.key_point = 1;
+                // must not leak into the scan direction flag
+                p.scan_angle_rank = 234;
+                p.point_source_id = 11'523;
+                p.gps_time = has_gps_time ? 54235.87 : 0.0;
+                p.blue = has_rgb ? 311 : 0;
+                p.wave_packet.size_in_bytes = has_waveform ? 654'812 : 0;
+                p.extra_bytes[2] = 7;
+            }
+            else
+            {
+                las_raw_point_14_t &p = points[i].point14;
+                p.x = static_cast<int32_t>(10 + i);
+                p.intensity = 43'564;
+                p.return_number = 15;
+                p.number_of_returns = 2;
+                p.overlap = 1;
+                p.scanner_channel = 2;
+                p.scan_direction_flag = 1;
+                p.classification = 164;
+                p.scan_angle = 60'348;
+                p.gps_time = 54235.87;
+                p.blue = has_rgb ? 311 : 0;
+                p.nir = (id == 8 || id == 10) ? 245 : 0;
+                p.wave_packet.size_in_bytes = has_waveform ? 654'812 : 0;
+                p.extra_bytes[2] = 7;
+            }
+        }
+
+        const uint16_t point_size = las_point_format_point_size(point_format);
+        std::vector<uint8_t> records(2 * point_size);
+        las_raw_point_select_encode_many_fn(id)(points.data(), 2, point_format, records.data());
+
+        // Same bytes as the generic encoders
+        std::vector<uint8_t> expected(point_size);
+        if (id <= 5)
+        {
+            las_raw_point_10_to_buffer(&points[1].point10, point_format, expected.data());
+        }
+        else
+        {
+            las_raw_point_14_to_buffer(&points[1].point14, point_format, expected.data());
+        }
+        ASSERT_EQ(std::memcmp(expected.data(), &records[point_size], point_size), 0);
+
+        std::vector<las_raw_point_t> decoded(2);
+        las_raw_point_prepare_many(decoded.data(), 2, point_format);
+        las_raw_point_select_decode_many_fn(id)(records.data(), point_format, decoded.data(), 2);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            ASSERT_TRUE(las_raw_point_eq(&points[i], &decoded[i])) << "point format " << int(id);
+        }
+
+        las_raw_point_deinit_many(decoded.data(), 2);
+        las_raw_point_deinit_many(points.data(), 2);
+    }
+}
+
+TEST(Vlr, ClonesShareReadPayloads)
+{
+    const TempFile file("vlr_arena_test.las");
+    const char *path = file.c_str();
+    const char payloads[2][12] = {"first VLR", "second VLR"};
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 2};
+    header->point_format = {1, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+    header->number_of_vlrs = 2;
+    header->vlrs = static_cast<las_vlr_t *>(std::calloc(2, sizeof(las_vlr_t)));
+    ASSERT_NE(header->vlrs, nullptr);
+    for (uint16_t i = 0; i < 2; ++i)
+    {
+        std::strncpy(header->vlrs[i].user_id, "Test", LAS_VLR_USER_ID_SIZE);
+        header->vlrs[i].record_id = i;
+        header->vlrs[i].data_size = sizeof(payloads[i]);
+        header->vlrs[i].data = static_cast<uint8_t *>(std::malloc(sizeof(payloads[i])));
+        ASSERT_NE(header->vlrs[i].data, nullptr);
+        std::memcpy(header->vlrs[i].data, payloads[i], sizeof(payloads[i]));
+    }
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    const las_header_t *read_header = las_reader_header(reader);
+    ASSERT_EQ(read_header->number_of_vlrs, 2);
+    ASSERT_NE(read_header->vlr_arena, nullptr);
+
+    las_header_t *clone = nullptr;
+    ASSERT_EQ(las_header_clone(read_header, &clone), 0);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        // Not copied
+        ASSERT_EQ(clone->vlrs[i].data, read_header->vlrs[i].data);
+    }
+
+    // Copy on write
+    ASSERT_EQ(las_header_vlr_make_writable(clone, 1), 0);
+    ASSERT_NE(clone->vlrs[1].data, read_header->vlrs[1].data);
+    clone->vlrs[1].data[0] = 'S';
+    ASSERT_EQ(std::memcmp(read_header->vlrs[1].data, payloads[1], sizeof(payloads[1])), 0);
+
+    // The clone outlives the header it was cloned from
+    las_reader_destroy(reader);
+    ASSERT_EQ(std::memcmp(clone->vlrs[0].data, payloads[0], sizeof(payloads[0])), 0);
+    ASSERT_EQ(std::memcmp(clone->vlrs[1].data, "Second VLR", sizeof("Second VLR")), 0);
+    las_header_delete(clone);
+}
+
+struct CountingSource
+{
+    las_source_t inner;
+    int num_reads;
+};
+
+static uint64_t counting_source_read(void *self, uint64_t n, uint8_t *out_buffer)
+{
+    auto *source = static_cast<CountingSource *>(self);
+    source->num_reads++;
+    return las_source_read(&source->inner, n, out_buffer);
+}
+
+static int counting_source_eof(void *self)
+{
+    return las_source_eof(&static_cast<CountingSource *>(self)->inner);
+}
+
+/// Writes a file with one VLR per size (filled with index + 1) and returns its bytes
+static std::vector<uint8_t> las_bytes_with_vlrs(const std::vector<uint16_t> &sizes)
+{
+    const TempFile temp_file("vlr_one_read_test.las");
+    const char *path = temp_file.c_str();
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    header->version = {1, 4};
+    header->point_format = {6, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+    header->number_of_vlrs = static_cast<uint32_t>(sizes.size());
+    header->vlrs = static_cast<las_vlr_t *>(std::calloc(sizes.size(), sizeof(las_vlr_t)));
+    for (uint16_t i = 0; i < sizes.size(); ++i)
+    {
+        header->vlrs[i].record_id = i;
+        header->vlrs[i].data_size = sizes[i];
+        header->vlrs[i].data = static_cast<uint8_t *>(std::malloc(sizes[i]));
+        std::memset(header->vlrs[i].data, i + 1, sizes[i]);
+    }
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    EXPECT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    std::vector<uint8_t> bytes;
+    FILE *file = std::fopen(path, "rb");
+    int c;
+    while (file != nullptr && (c = std::fgetc(file)) != EOF)
+    {
+        bytes.push_back(static_cast<uint8_t>(c));
+    }
+    std::fclose(file);
+    return bytes;
+}
+
+/// Reads the header from the bytes, checks the VLRs and returns the number of reads done
+static int las_read_and_check_vlrs(const std::vector<uint8_t> &bytes,
+                                   const std::vector<uint16_t> &sizes)
+{
+    CountingSource counting = {las_source_new_memory(bytes.data(), bytes.size()), 0};
+    las_source_t source{};
+    source.inner = &counting;
+    source.read_fn = counting_source_read;
+    source.eof_fn = counting_source_eof;
+
+    las_header_t header;
+    bool is_compressed = false;
+    las_error_t err = las_header_read_from(&source, &header, &is_compressed);
+    EXPECT_TRUE(las_error_is_ok(&err));
+    EXPECT_EQ(header.number_of_vlrs, sizes.size());
+    for (uint16_t i = 0; las_error_is_ok(&err) && i < sizes.size(); ++i)
+    {
+        EXPECT_EQ(header.vlrs[i].record_id, i);
+        EXPECT_EQ(header.vlrs[i].data_size, sizes[i]);
+        const std::vector<uint8_t> expected(sizes[i], static_cast<uint8_t>(i + 1));
+        if (sizes[i] != 0)
+        {
+            EXPECT_EQ(std::memcmp(header.vlrs[i].data, expected.data(), sizes[i]), 0);
+        }
+    }
+
+    las_header_deinit(&header);
+    las_source_deinit(&counting.inner);
+    return counting.num_reads;
+}
+
+TEST(Vlr, HeaderAndVlrsReadAtOnce)
+{
+    const std::vector<uint16_t> small_sizes = {10, 300, 0, 2000};
+    std::vector<uint8_t> bytes = las_bytes_with_vlrs(small_sizes);
+    ASSERT_EQ(las_read_and_check_vlrs(bytes, small_sizes), 1);
+
+    // The rest of [0, offset_to_point_data) comes with a second read
+    const std::vector<uint16_t> large_sizes = {10, 300, 40000, 30000};
+    bytes = las_bytes_with_vlrs(large_sizes);
+    ASSERT_EQ(las_read_and_check_vlrs(bytes, large_sizes), 2);
+
+    // When the offset to point data is too small, the VLRs are still read
+    const uint32_t wrong_offset_to_point_data = 375;
+    std::memcpy(&bytes[96], &wrong_offset_to_point_data, sizeof(uint32_t));
+    ASSERT_GT(las_read_and_check_vlrs(bytes, large_sizes), 2);
+}
+
+TEST(Vlr, CorruptVlrCountIsUnexpectedEof)
+{
+    const std::vector<uint8_t> valid_bytes = las_bytes_with_vlrs({10, 300});
+    const uint32_t offset_to_point_data = 0xFFFF'FFFF;
+    const uint32_t vlr_counts[2] = {100'000, 0xFFFF'FFFF};
+
+    for (const uint32_t number_of_vlrs : vlr_counts)
+    {
+        std::vector<uint8_t> bytes = valid_bytes;
+        std::memcpy(&bytes[96], &offset_to_point_data, sizeof(uint32_t));
+        std::memcpy(&bytes[100], &number_of_vlrs, sizeof(uint32_t));
+
+        las_source_t source = las_source_new_memory(bytes.data(), bytes.size());
+        las_header_t header;
+        bool is_compressed = false;
+        las_error_t err = las_header_read_from(&source, &header, &is_compressed);
+        ASSERT_EQ(err.kind, LAS_ERROR_UNEXPECTED_EOF) << number_of_vlrs;
+        las_source_deinit(&source);
+    }
+}
+
+TEST(Evlr, WriteAndLazyRead)
+{
+    const TempFile file("evlr_test.las");
+    const char *path = file.c_str();
+    const char payload[] = "Some EVLR payload";
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 4};
+    header->point_format = {6, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+
+    header->number_of_evlrs = 1;
+    header->evlrs = static_cast<las_evlr_t *>(std::calloc(1, sizeof(las_evlr_t)));
+    ASSERT_NE(header->evlrs, nullptr);
+    std::strncpy(header->evlrs[0].user_id, "Test", LAS_VLR_USER_ID_SIZE);
+    header->evlrs[0].record_id = 42;
+    header->evlrs[0].data_size = sizeof(payload);
+    header->evlrs[0].data = static_cast<uint8_t *>(std::malloc(sizeof(payload)));
+    ASSERT_NE(header->evlrs[0].data, nullptr);
+    std::memcpy(header->evlrs[0].data, payload, sizeof(payload));
+
+    las_raw_point_t point;
+    las_raw_point_prepare(&point, header->point_format);
+    point.point14.x = 17;
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_raw_point(writer, &point);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+
+    const las_header_t *read_header = las_reader_header(reader);
+    ASSERT_EQ(read_header->point_count, 1);
+    ASSERT_EQ(read_header->number_of_evlrs, 1);
+    ASSERT_EQ(read_header->evlrs[0].record_id, 42);
+    ASSERT_EQ(read_header->evlrs[0].data_size, sizeof(payload));
+    // payloads are only loaded on demand
+    ASSERT_EQ(read_header->evlrs[0].data, nullptr);
+
+    err = las_reader_read_evlr_data(reader, 0);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_NE(read_header->evlrs[0].data, nullptr);
+    ASSERT_EQ(std::memcmp(read_header->evlrs[0].data, payload, sizeof(payload)), 0);
+
+    // Loading the payload must not disturb reading points
+    point.point14.x = 0;
+    err = las_reader_read_next_raw(reader, &point);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(point.point14.x, 17);
+
+    las_raw_point_deinit(&point);
+    las_reader_destroy(reader);
+}
+
+TEST(Evlr, WriterCopiesPayloadsFromSource)
+{
+    const TempFile source_file("source.las");
+    const TempFile copy_file("copy.las");
+
+    // Larger than the block the payloads are copied through
+    std::vector<uint8_t> large_payload(2'500'000);
+    for (size_t i = 0; i < large_payload.size(); ++i)
+    {
+        large_payload[i] = static_cast<uint8_t>(i * 7);
+    }
+    const char small_payload[] = "small";
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 4};
+    header->point_format = {6, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+    header->number_of_evlrs = 2;
+    header->evlrs = static_cast<las_evlr_t *>(std::calloc(2, sizeof(las_evlr_t)));
+    ASSERT_NE(header->evlrs, nullptr);
+    header->evlrs[0].record_id = 1;
+    header->evlrs[0].data_size = large_payload.size();
+    header->evlrs[0].data = static_cast<uint8_t *>(std::malloc(large_payload.size()));
+    ASSERT_NE(header->evlrs[0].data, nullptr);
+    std::memcpy(header->evlrs[0].data, large_payload.data(), large_payload.size());
+    header->evlrs[1].record_id = 2;
+    header->evlrs[1].data_size = sizeof(small_payload);
+    header->evlrs[1].data = static_cast<uint8_t *>(std::malloc(sizeof(small_payload)));
+    ASSERT_NE(header->evlrs[1].data, nullptr);
+    std::memcpy(header->evlrs[1].data, small_payload, sizeof(small_payload));
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(source_file.c_str(), header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(source_file.c_str(), &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+
+    // The payloads of the cloned header are not loaded
+    las_header_t *copy_header = nullptr;
+    ASSERT_EQ(las_header_clone(las_reader_header(reader), &copy_header), 0);
+    err = las_writer_open_file_path(copy_file.c_str(), copy_header, &writer);
+    ASSERT_EQ(err.kind, LAS_ERROR_EVLR_DATA_NOT_LOADED);
+
+    ASSERT_EQ(las_header_clone(las_reader_header(reader), &copy_header), 0);
+    las_reader_destroy(reader);
+    las_writer_options_t options = {};
+    options.evlr_source_path = source_file.c_str();
+    err = las_writer_open_file_path_with_options(copy_file.c_str(), copy_header, &options, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    err = las_reader_open_file_path(copy_file.c_str(), &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_reader_read_all_evlr_data(reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+
+    const las_header_t *read_header = las_reader_header(reader);
+    ASSERT_EQ(read_header->number_of_evlrs, 2);
+    ASSERT_EQ(read_header->evlrs[0].record_id, 1);
+    ASSERT_EQ(read_header->evlrs[0].data_size, large_payload.size());
+    ASSERT_EQ(std::memcmp(read_header->evlrs[0].data, large_payload.data(), large_payload.size()),
+              0);
+    ASSERT_EQ(read_header->evlrs[1].record_id, 2);
+    ASSERT_EQ(read_header->evlrs[1].data_size, sizeof(small_payload));
+    ASSERT_EQ(std::memcmp(read_header->evlrs[1].data, small_payload, sizeof(small_payload)), 0);
+
+    las_reader_destroy(reader);
+}
+
+TEST(Writer, WriteManyBytesPassThrough)
+{
+    const TempFile file("source.las");
+    const TempFile copy_file("copy.las");
+    const char *path = file.c_str();
+    const char *copy_path = copy_file.c_str();
+    const uint64_t num_points = 10;
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 2};
+    header->point_format = {3, 2};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+
+    std::vector<las_raw_point_t> points(num_points);
+    las_raw_point_prepare_many(points.data(), num_points, header->point_format);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        points[i].point10.x = static_cast<int32_t>(i);
+        points[i].point10.return_number = (1 + i % 3) & 0b111;
+        points[i].point10.extra_bytes[1] = static_cast<uint8_t>(i);
+    }
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_many_raw_points(writer, points.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    const las_header_t *read_header = las_reader_header(reader);
+    ASSERT_EQ(read_header->point_format.num_extra_bytes, 2);
+    ASSERT_EQ(read_header->number_of_points_by_return[0], 4);
+    ASSERT_EQ(read_header->number_of_points_by_return[1], 3);
+    ASSERT_EQ(read_header->number_of_points_by_return[2], 3);
+
+    const uint16_t point_size = las_point_format_point_size(read_header->point_format);
+    std::vector<uint8_t> bytes(point_size * num_points);
+    err = las_reader_read_many_next_bytes(reader, bytes.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+
+    las_header_t *copy_header = nullptr;
+    ASSERT_EQ(las_header_clone(read_header, &copy_header), 0);
+    err = las_writer_open_file_path(copy_path, copy_header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_many_bytes(writer, bytes.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+    las_reader_destroy(reader);
+
+    err = las_reader_open_file_path(copy_path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    read_header = las_reader_header(reader);
+    ASSERT_EQ(read_header->point_count, num_points);
+    // Counted from the records: returns 1, 2 and 3
+    ASSERT_EQ(read_header->number_of_points_by_return[0], 4);
+    ASSERT_EQ(read_header->number_of_points_by_return[1], 3);
+    ASSERT_EQ(read_header->number_of_points_by_return[2], 3);
+    ASSERT_EQ(read_header->number_of_points_by_return[3], 0);
+
+    std::vector<uint8_t> copied_bytes(point_size * num_points);
+    err = las_reader_read_many_next_bytes(reader, copied_bytes.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(bytes, copied_bytes);
+
+    las_reader_destroy(reader);
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+
+TEST(Copy, CopyFileWithoutDecoding)
+{
+    const TempFile file("source.las");
+    const TempFile copy_file("copy.las");
+    const char *path = file.c_str();
+    const char *copy_path = copy_file.c_str();
+    const char payload[] = "EVLR after the points";
+    const uint64_t num_points = 5;
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 4};
+    header->point_format = {6, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+    header->number_of_evlrs = 1;
+    header->evlrs = static_cast<las_evlr_t *>(std::calloc(1, sizeof(las_evlr_t)));
+    ASSERT_NE(header->evlrs, nullptr);
+    header->evlrs[0].record_id = 7;
+    header->evlrs[0].data_size = sizeof(payload);
+    header->evlrs[0].data = static_cast<uint8_t *>(std::malloc(sizeof(payload)));
+    ASSERT_NE(header->evlrs[0].data, nullptr);
+    std::memcpy(header->evlrs[0].data, payload, sizeof(payload));
+
+    std::vector<las_raw_point_t> points(num_points);
+    las_raw_point_prepare_many(points.data(), num_points, header->point_format);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        points[i].point14.y = static_cast<int32_t>(i * 10);
+        points[i].point14.return_number = 1;
+    }
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_many_raw_points(writer, points.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    // The new header has a VLR, so the points and the EVLR move
+    las_header_t new_header;
+    std::memset(&new_header, 0, sizeof(las_header_t));
+    new_header.version = {1, 4};
+    new_header.point_format = {6, 0};
+    new_header.scaling.scales = {0.01, 0.01, 0.01};
+    uint8_t vlr_data[3] = {1, 2, 3};
+    las_vlr_t vlr;
+    std::memset(&vlr, 0, sizeof(las_vlr_t));
+    vlr.record_id = 1;
+    vlr.data_size = sizeof(vlr_data);
+    vlr.data = vlr_data;
+    new_header.number_of_vlrs = 1;
+    new_header.vlrs = &vlr;
+
+    err = las_copy_file_path(path, copy_path, &new_header);
+    ASSERT_TRUE(las_error_is_ok(&err));
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(copy_path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    const las_header_t *read_header = las_reader_header(reader);
+    ASSERT_EQ(read_header->point_count, num_points);
+    ASSERT_EQ(read_header->number_of_points_by_return[0], num_points);
+    ASSERT_EQ(read_header->number_of_vlrs, 1);
+    ASSERT_EQ(read_header->number_of_evlrs, 1);
+
+    err = las_reader_read_evlr_data(reader, 0);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(std::memcmp(read_header->evlrs[0].data, payload, sizeof(payload)), 0);
+
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        err = las_reader_read_next_raw(reader, &points[i]);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        ASSERT_EQ(points[i].point14.y, static_cast<int32_t>(i * 10));
+    }
+    las_reader_destroy(reader);
+
+    new_header.scaling.scales.x = 0.001;
+    err = las_copy_file_path(path, copy_path, &new_header);
+    ASSERT_EQ(err.kind, LAS_ERROR_INCOMPATIBLE_SCALING);
+
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+
+TEST(Writer, ComputesBoundsAndReturnCounts)
+{
+    const TempFile file("writer_stats.las");
+    const char *path = file.c_str();
+    const uint64_t num_points = 37;
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 4};
+    header->point_format = {6, 0};
+    header->scaling.scales = {0.01, 0.5, -1.0};
+    header->scaling.offsets = {100.0, 0.0, 0.0};
+    // Must be overwritten by the writer
+    header->mins = {-1000.0, -1000.0, -1000.0};
+
+    std::vector<las_raw_point_t> points(num_points);
+    las_raw_point_prepare_many(points.data(), num_points, header->point_format);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        const auto n = static_cast<int32_t>(i);
+        points[i].point14.x = n - 20;
+        points[i].point14.y = (n % 5) * 3;
+        points[i].point14.z = 7 * n;
+        points[i].point14.return_number = static_cast<uint8_t>(i % 16);
+    }
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    // Mix the different write paths
+    err = las_writer_write_raw_point(writer, &points[0]);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_many_raw_points(writer, &points[1], num_points - 1);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    const las_header_t *read_header = las_reader_header(reader);
+
+    ASSERT_DOUBLE_EQ(read_header->mins.x, 100.0 - 0.20);
+    ASSERT_DOUBLE_EQ(read_header->maxs.x, 100.0 + 0.16);
+    ASSERT_DOUBLE_EQ(read_header->mins.y, 0.0);
+    ASSERT_DOUBLE_EQ(read_header->maxs.y, 6.0);
+    // negative scale: the largest stored value gives the minimum
+    ASSERT_DOUBLE_EQ(read_header->mins.z, -252.0);
+    ASSERT_DOUBLE_EQ(read_header->maxs.z, 0.0);
+
+    // return numbers 0..15, 0 is not counted
+    ASSERT_EQ(read_header->number_of_points_by_return[0], 3);
+    ASSERT_EQ(read_header->number_of_points_by_return[4], 2);
+    ASSERT_EQ(read_header->number_of_points_by_return[14], 2);
+
+    las_reader_destroy(reader);
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+
+#if !defined(_WIN32)
+TEST(Writer, FailedWriteIsNotInBounds)
+{
+    const TempFile file("writer_stats.las");
+    const char *path = file.c_str();
+    const uint64_t num_points = 10'000;
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 2};
+    header->point_format = {0, 0};
+    header->scaling.scales = {1.0, 1.0, 1.0};
+
+    std::vector<las_raw_point_t> points(num_points);
+    las_raw_point_prepare_many(points.data(), num_points, header->point_format);
+    for (las_raw_point_t &point : points)
+    {
+        point.point10.x = 1000;
+        point.point10.return_number = 2;
+    }
+    points[0].point10.x = 5;
+    points[0].point10.return_number = 1;
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_raw_point(writer, &points[0]);
+    ASSERT_TRUE(las_error_is_ok(&err));
+
+    // Make the file too small for the batch
+    rlimit old_limit{};
+    ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &old_limit), 0);
+    rlimit limit = old_limit;
+    limit.rlim_cur = 16 * 1024;
+    void (*old_handler)(int) = std::signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limit), 0);
+    err = las_writer_write_many_raw_points(writer, &points[1], num_points - 1);
+    ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &old_limit), 0);
+    std::signal(SIGXFSZ, old_handler);
+    ASSERT_TRUE(las_error_is_failure(&err));
+    // The points of the failed batch are not counted either
+    ASSERT_EQ(las_writer_header(writer)->point_count, 1);
+
+    las_writer_delete(writer);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    const las_header_t *read_header = las_reader_header(reader);
+    // Only the first point made it to the file
+    ASSERT_EQ(read_header->point_count, 1);
+    ASSERT_DOUBLE_EQ(read_header->maxs.x, 5.0);
+    ASSERT_EQ(read_header->number_of_points_by_return[0], 1);
+    ASSERT_EQ(read_header->number_of_points_by_return[1], 0);
+
+    las_reader_destroy(reader);
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+#endif
+
+TEST(Writer, AppendToExistingFile)
+{
+    const TempFile file("append_test.las");
+    const char *path = file.c_str();
+    const char payload[] = "EVLR moved after the new points";
+    // Larger than the block the payloads are copied through
+    std::vector<uint8_t> large_payload(1'500'000);
+    for (size_t i = 0; i < large_payload.size(); ++i)
+    {
+        large_payload[i] = static_cast<uint8_t>(i * 13);
+    }
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 4};
+    header->point_format = {6, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+    header->number_of_evlrs = 2;
+    header->evlrs = static_cast<las_evlr_t *>(std::calloc(2, sizeof(las_evlr_t)));
+    ASSERT_NE(header->evlrs, nullptr);
+    header->evlrs[0].record_id = 3;
+    header->evlrs[0].data_size = sizeof(payload);
+    header->evlrs[0].data = static_cast<uint8_t *>(std::malloc(sizeof(payload)));
+    ASSERT_NE(header->evlrs[0].data, nullptr);
+    std::memcpy(header->evlrs[0].data, payload, sizeof(payload));
+    header->evlrs[1].record_id = 4;
+    header->evlrs[1].data_size = large_payload.size();
+    header->evlrs[1].data = static_cast<uint8_t *>(std::malloc(large_payload.size()));
+    ASSERT_NE(header->evlrs[1].data, nullptr);
+    std::memcpy(header->evlrs[1].data, large_payload.data(), large_payload.size());
+
+    las_raw_point_t point;
+    las_raw_point_prepare(&point, header->point_format);
+    point.point14.return_number = 1;
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        point.point14.x = i;
+        err = las_writer_write_raw_point(writer, &point);
+        ASSERT_TRUE(las_error_is_ok(&err));
+    }
+    las_writer_delete(writer);
+
+    err = las_writer_open_append(path, las_point_format_t{1, 0}, &writer);
+    ASSERT_EQ(err.kind, LAS_ERROR_INCOMPATIBLE_POINT_FORMAT);
+
+    err = las_writer_open_append(path, las_point_format_t{6, 0}, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(las_writer_header(writer)->point_count, 3);
+    point.point14.return_number = 2;
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        point.point14.x = -10 * (i + 1);
+        err = las_writer_write_raw_point(writer, &point);
+        ASSERT_TRUE(las_error_is_ok(&err));
+    }
+    las_writer_delete(writer);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    const las_header_t *read_header = las_reader_header(reader);
+    ASSERT_EQ(read_header->point_count, 5);
+    ASSERT_EQ(read_header->number_of_points_by_return[0], 3);
+    ASSERT_EQ(read_header->number_of_points_by_return[1], 2);
+    ASSERT_DOUBLE_EQ(read_header->mins.x, -0.20);
+    ASSERT_DOUBLE_EQ(read_header->maxs.x, 0.02);
+
+    ASSERT_EQ(read_header->number_of_evlrs, 2);
+    err = las_reader_read_all_evlr_data(reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(read_header->evlrs[0].record_id, 3);
+    ASSERT_EQ(std::memcmp(read_header->evlrs[0].data, payload, sizeof(payload)), 0);
+    ASSERT_EQ(read_header->evlrs[1].record_id, 4);
+    ASSERT_EQ(read_header->evlrs[1].data_size, large_payload.size());
+    ASSERT_EQ(std::memcmp(read_header->evlrs[1].data, large_payload.data(), large_payload.size()),
+              0);
+
+    const int32_t expected_xs[5] = {0, 1, 2, -10, -20};
+    for (int32_t expected_x : expected_xs)
+    {
+        err = las_reader_read_next_raw(reader, &point);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        ASSERT_EQ(point.point14.x, expected_x);
+    }
+
+    las_raw_point_deinit(&point);
+    las_reader_destroy(reader);
+}
+
+TEST(Writer, AppendRefusesInternalWaveforms)
+{
+    const TempFile file("append_waveform_test.las");
+    const char *path = file.c_str();
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 3};
+    header->point_format = {4, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+    // Waveform data packets internal, right after the points
+    header->global_encoding = 0b10;
+    header->start_of_waveform_datapacket = 235 + 2 * 57;
+
+    las_raw_point_t point;
+    las_raw_point_prepare(&point, header->point_format);
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        point.point10.x = i;
+        err = las_writer_write_raw_point(writer, &point);
+        ASSERT_TRUE(las_error_is_ok(&err));
+    }
+    las_writer_delete(writer);
+    las_raw_point_deinit(&point);
+
+    err = las_writer_open_append(path, las_point_format_t{4, 0}, &writer);
+    ASSERT_EQ(err.kind, LAS_ERROR_UNSUPPORTED_HEADER_LAYOUT);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(las_reader_header(reader)->point_count, 2);
+    las_reader_destroy(reader);
+}
+
+TEST(Editor, SetsFieldsInPlace)
+{
+    const TempFile file("editor_test.las");
+    const char *path = file.c_str();
+    const uint8_t point_format_ids[2] = {3, 6};
+
+    for (uint8_t point_format_id : point_format_ids)
+    {
+        auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+        ASSERT_NE(header, nullptr);
+        header->version = {1, 4};
+        header->point_format = {point_format_id, 0};
+        header->scaling.scales = {0.01, 0.01, 0.01};
+
+        las_raw_point_t point;
+        las_raw_point_prepare(&point, header->point_format);
+
+        las_writer_t *writer = nullptr;
+        las_error_t err = las_writer_open_file_path(path, header, &writer);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        for (int32_t i = 0; i < 10; ++i)
+        {
+            if (point_format_id <= 5)
+            {
+                point.point10.x = i;
+                point.point10.classification = 2;
+                point.point10.key_point = 1;
+            }
+            else
+            {
+                point.point14.x = i;
+                point.point14.classification = 2;
+                point.point14.key_point = 1;
+            }
+            err = las_writer_write_raw_point(writer, &point);
+            ASSERT_TRUE(las_error_is_ok(&err));
+        }
+        las_writer_delete(writer);
+
+        las_editor_t *editor = nullptr;
+        err = las_editor_open_file_path(path, &editor);
+        ASSERT_TRUE(las_error_is_ok(&err));
+
+        err = las_editor_set_range(editor, LAS_POINT_FIELD_CLASSIFICATION, 2, 5, 9);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        const uint64_t selection[3] = {9, 0, 4};
+        err = las_editor_set_selection(editor, LAS_POINT_FIELD_POINT_SOURCE_ID, selection, 3, 513);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        err = las_editor_set_selection(editor, LAS_POINT_FIELD_SYNTHETIC, selection, 3, 1);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        err = las_editor_set_range(editor, LAS_POINT_FIELD_USER_DATA, 0, 10, 42);
+        ASSERT_TRUE(las_error_is_ok(&err));
+
+        err = las_editor_set_range(editor, LAS_POINT_FIELD_USER_DATA, 8, 3, 1);
+        ASSERT_EQ(err.kind, LAS_ERROR_POINT_INDEX_OUT_OF_RANGE);
+        const uint64_t bad_selection[2] = {1, 10};
+        err = las_editor_set_selection(editor, LAS_POINT_FIELD_USER_DATA, bad_selection, 2, 1);
+        ASSERT_EQ(err.kind, LAS_ERROR_POINT_INDEX_OUT_OF_RANGE);
+        ASSERT_EQ(err.point_index, 10);
+        err = las_editor_set_range(editor, LAS_POINT_FIELD_SYNTHETIC, 0, 1, 2);
+        ASSERT_EQ(err.kind, LAS_ERROR_INVALID_FIELD_VALUE);
+        err = las_editor_set_range(editor, LAS_POINT_FIELD_OVERLAP, 0, 1, 1);
+        ASSERT_EQ(err.kind,
+                  point_format_id <= 5 ? LAS_ERROR_INCOMPATIBLE_POINT_FORMAT : LAS_ERROR_OK);
+        las_editor_delete(editor);
+
+        las_reader_t *reader = nullptr;
+        err = las_reader_open_file_path(path, &reader);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        for (int32_t i = 0; i < 10; ++i)
+        {
+            err = las_reader_read_next_raw(reader, &point);
+            ASSERT_TRUE(las_error_is_ok(&err));
+            const bool is_selected = i == 0 || i == 4 || i == 9;
+            const int expected_classification = (i >= 2 && i < 7) ? 9 : 2;
+            if (point_format_id <= 5)
+            {
+                ASSERT_EQ(point.point10.x, i);
+                ASSERT_EQ(point.point10.classification, expected_classification);
+                ASSERT_EQ(point.point10.key_point, 1);
+                ASSERT_EQ(point.point10.synthetic, is_selected ? 1 : 0);
+                ASSERT_EQ(point.point10.point_source_id, is_selected ? 513 : 0);
+                ASSERT_EQ(point.point10.user_data, 42);
+            }
+            else
+            {
+                ASSERT_EQ(point.point14.x, i);
+                ASSERT_EQ(point.point14.classification, expected_classification);
+                ASSERT_EQ(point.point14.key_point, 1);
+                ASSERT_EQ(point.point14.synthetic, is_selected ? 1 : 0);
+                ASSERT_EQ(point.point14.overlap, i == 0 ? 1 : 0);
+                ASSERT_EQ(point.point14.point_source_id, is_selected ? 513 : 0);
+                ASSERT_EQ(point.point14.user_data, 42);
+            }
+        }
+        las_reader_destroy(reader);
+        las_raw_point_deinit(&point);
+    }
+}
+
+TEST(Writer, WriteManyScaledPoints)
+{
+    const TempFile file("write_many_points.las");
+    const char *path = file.c_str();
+    const uint64_t num_points = 11;
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 2};
+    header->point_format = {3, 0};
+    header->scaling.scales = {0.01, 0.01, 0.001};
+    header->scaling.offsets = {10.0, 0.0, 0.0};
+    const las_scaling_t scaling = header->scaling;
+
+    std::vector<las_point_t> points(num_points);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        las_point_prepare(&points[i], header->point_format);
+        const double n = static_cast<double>(i);
+        points[i].x = 10.0 + 0.29 * n;
+        points[i].y = -0.29 * n;
+        points[i].z = 1.0005 * n;
+        points[i].return_number = 1;
+        points[i].number_of_returns = 2;
+        points[i].scan_direction_flag = 1;
+        points[i].classification = 6;
+        points[i].point_source_id = static_cast<uint16_t>(i);
+        points[i].gps_time = n * 0.5;
+        points[i].red = 300;
+    }
+    const double xs[3] = {10.004, 10.005, 9.995};
+    const double ys[3] = {0.0, -0.005, 21474836.47};
+    const double zs[3] = {0.0004, -0.0005, -1.0};
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_many_points(writer, points.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+
+    // Nothing is written when one of the coordinates does not fit
+    const double y = points[6].y;
+    points[6].y = 21474836.48;
+    err = las_writer_write_many_points(writer, points.data(), num_points);
+    ASSERT_EQ(err.kind, LAS_ERROR_COORDINATE_OVERFLOW);
+    points[6].y = y;
+    const double nan_zs[3] = {0.0, std::nan(""), 0.0};
+    err = las_writer_write_many_xyz(writer, xs, ys, nan_zs, 3);
+    ASSERT_EQ(err.kind, LAS_ERROR_COORDINATE_OVERFLOW);
+    ASSERT_EQ(las_writer_header(writer)->point_count, num_points);
+
+    err = las_writer_write_many_xyz(writer, xs, ys, zs, 3);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(las_reader_header(reader)->point_count, num_points + 3);
+
+    las_raw_point_t raw;
+    las_raw_point_prepare(&raw, las_reader_header(reader)->point_format);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        err = las_reader_read_next_raw(reader, &raw);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        // rounded, not truncated: 0.29 / 0.01 must give 29
+        const auto n = static_cast<int32_t>(i);
+        ASSERT_EQ(raw.point10.x, 29 * n);
+        ASSERT_EQ(raw.point10.y, -29 * n);
+        ASSERT_EQ(raw.point10.z, las_scaling_unapply_z(scaling, points[i].z));
+        ASSERT_EQ(raw.point10.return_number, 1);
+        ASSERT_EQ(raw.point10.number_of_returns, 2);
+        ASSERT_EQ(raw.point10.classification, 6);
+        ASSERT_EQ(raw.point10.point_source_id, i);
+        ASSERT_DOUBLE_EQ(raw.point10.gps_time, points[i].gps_time);
+        ASSERT_EQ(raw.point10.red, 300);
+    }
+
+    const int32_t expected_xs[3] = {0, 1, -1};
+    const int32_t expected_ys[3] = {0, -1, INT32_MAX};
+    const int32_t expected_zs[3] = {0, -1, -1000};
+    for (int i = 0; i < 3; ++i)
+    {
+        err = las_reader_read_next_raw(reader, &raw);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        ASSERT_EQ(raw.point10.x, expected_xs[i]);
+        ASSERT_EQ(raw.point10.y, expected_ys[i]);
+        ASSERT_EQ(raw.point10.z, expected_zs[i]);
+        ASSERT_EQ(raw.point10.classification, 0);
+    }
+
+    las_raw_point_deinit(&raw);
+    las_reader_destroy(reader);
+    for (las_point_t &point : points)
+    {
+        las_point_deinit(&point);
+    }
+}
+
+TEST(Writer, WriteColumns)
+{
+    const TempFile file("write_columns.las");
+    const char *path = file.c_str();
+    const uint64_t num_points = 1500;
+    const las_point_format_t point_formats[2] = {{1, 2}, {7, 2}};
+
+    std::vector<double> xs(num_points);
+    std::vector<uint16_t> intensities(num_points);
+    std::vector<uint8_t> return_numbers(num_points);
+    std::vector<uint8_t> classifications(num_points);
+    std::vector<uint8_t> withheld(num_points);
+    std::vector<uint8_t> edges(num_points);
+    std::vector<uint16_t> point_source_ids(num_points);
+    std::vector<double> gps_times(num_points);
+    std::vector<uint16_t> greens(num_points);
+    std::vector<uint8_t> extra_bytes(num_points * 2);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        xs[i] = static_cast<double>(i) * 0.5;
+        intensities[i] = static_cast<uint16_t>(i);
+        return_numbers[i] = static_cast<uint8_t>(1 + i % 5);
+        classifications[i] = static_cast<uint8_t>(i % 20);
+        withheld[i] = static_cast<uint8_t>(i % 2);
+        edges[i] = static_cast<uint8_t>((i / 2) % 2);
+        point_source_ids[i] = static_cast<uint16_t>(i * 3);
+        gps_times[i] = static_cast<double>(i) + 0.25;
+        greens[i] = static_cast<uint16_t>(i + 7);
+        extra_bytes[2 * i] = static_cast<uint8_t>(i);
+        extra_bytes[2 * i + 1] = 0xAB;
+    }
+
+    las_point_columns_t columns;
+    std::memset(&columns, 0, sizeof(las_point_columns_t));
+    columns.x = xs.data();
+    columns.intensity = intensities.data();
+    columns.return_number = return_numbers.data();
+    columns.classification = classifications.data();
+    columns.withheld = withheld.data();
+    columns.edge_of_flight_line = edges.data();
+    columns.point_source_id = point_source_ids.data();
+    columns.gps_time = gps_times.data();
+    columns.green = greens.data();
+    columns.extra_bytes = extra_bytes.data();
+
+    for (las_point_format_t point_format : point_formats)
+    {
+        auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+        ASSERT_NE(header, nullptr);
+        header->version = {1, 4};
+        header->point_format = point_format;
+        header->scaling.scales = {0.5, 1.0, 1.0};
+
+        las_writer_t *writer = nullptr;
+        las_error_t err = las_writer_open_file_path(path, header, &writer);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        err = las_writer_write_columns(writer, &columns, num_points);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        las_writer_delete(writer);
+
+        las_reader_t *reader = nullptr;
+        err = las_reader_open_file_path(path, &reader);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        ASSERT_EQ(las_reader_header(reader)->point_count, num_points);
+
+        las_raw_point_t raw;
+        las_raw_point_prepare(&raw, point_format);
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            err = las_reader_read_next_raw(reader, &raw);
+            ASSERT_TRUE(las_error_is_ok(&err));
+            if (point_format.id <= 5)
+            {
+                const las_raw_point_10_t &p = raw.point10;
+                ASSERT_EQ(p.x, static_cast<int32_t>(i));
+                ASSERT_EQ(p.y, 0);
+                ASSERT_EQ(p.intensity, intensities[i]);
+                ASSERT_EQ(p.return_number, return_numbers[i]);
+                ASSERT_EQ(p.number_of_returns, 0);
+                ASSERT_EQ(p.classification, classifications[i]);
+                ASSERT_EQ(p.withheld, withheld[i]);
+                ASSERT_EQ(p.edge_of_flight_line, edges[i]);
+                ASSERT_EQ(p.point_source_id, point_source_ids[i]);
+                ASSERT_DOUBLE_EQ(p.gps_time, gps_times[i]);
+                ASSERT_EQ(std::memcmp(p.extra_bytes, &extra_bytes[2 * i], 2), 0);
+            }
+            else
+            {
+                const las_raw_point_14_t &p = raw.point14;
+                ASSERT_EQ(p.x, static_cast<int32_t>(i));
+                ASSERT_EQ(p.z, 0);
+                ASSERT_EQ(p.intensity, intensities[i]);
+                ASSERT_EQ(p.return_number, return_numbers[i]);
+                ASSERT_EQ(p.classification, classifications[i]);
+                ASSERT_EQ(p.withheld, withheld[i]);
+                ASSERT_EQ(p.synthetic, 0);
+                ASSERT_EQ(p.edge_of_flight_line, edges[i]);
+                ASSERT_EQ(p.point_source_id, point_source_ids[i]);
+                ASSERT_DOUBLE_EQ(p.gps_time, gps_times[i]);
+                ASSERT_EQ(p.red, 0);
+                ASSERT_EQ(p.green, greens[i]);
+                ASSERT_EQ(std::memcmp(p.extra_bytes, &extra_bytes[2 * i], 2), 0);
+            }
+        }
+        las_raw_point_deinit(&raw);
+        las_reader_destroy(reader);
+    }
+}
+
+TEST(Writer, ParallelEncodingGivesSameRecords)
+{
+    const TempFile files[2] = {TempFile("encode_serial.las"), TempFile("encode_parallel.las")};
+    const uint32_t num_encoding_threads[2] = {0, 3};
+    const uint64_t num_points = 100003;
+
+    std::vector<las_raw_point_t> points(num_points);
+    las_raw_point_prepare_many(points.data(), num_points, las_point_format_t{7, 1});
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        const auto n = static_cast<int32_t>(i);
+        points[i].point14.x = (n * 7919) % 100000 - 50000;
+        points[i].point14.y = n;
+        points[i].point14.z = -n;
+        points[i].point14.return_number = static_cast<uint8_t>(i % 16);
+        points[i].point14.classification = static_cast<uint8_t>(i);
+        points[i].point14.green = static_cast<uint16_t>(i);
+        points[i].point14.extra_bytes[0] = static_cast<uint8_t>(i >> 8);
+    }
+
+    std::vector<std::vector<uint8_t>> records(2);
+    for (size_t k = 0; k < 2; ++k)
+    {
+        auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+        ASSERT_NE(header, nullptr);
+        header->version = {1, 4};
+        header->point_format = {7, 1};
+        header->scaling.scales = {0.01, 0.01, 0.01};
+
+        las_writer_options_t options{};
+        options.num_encoding_threads = num_encoding_threads[k];
+        las_writer_t *writer = nullptr;
+        las_error_t err =
+            las_writer_open_file_path_with_options(files[k].c_str(), header, &options, &writer);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        err = las_writer_write_many_raw_points(writer, points.data(), num_points);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        las_writer_delete(writer);
+
+        las_reader_t *reader = nullptr;
+        err = las_reader_open_file_path(files[k].c_str(), &reader);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        const las_header_t *read_header = las_reader_header(reader);
+        ASSERT_EQ(read_header->point_count, num_points);
+        ASSERT_DOUBLE_EQ(read_header->mins.x, -500.0);
+        ASSERT_DOUBLE_EQ(read_header->maxs.y, 1000.02);
+        ASSERT_DOUBLE_EQ(read_header->mins.z, -1000.02);
+        ASSERT_EQ(read_header->number_of_points_by_return[0], 6251);
+
+        const uint16_t point_size = las_point_format_point_size(read_header->point_format);
+        records[k].resize(point_size * num_points);
+        err = las_reader_read_many_next_bytes(reader, records[k].data(), num_points);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        las_reader_destroy(reader);
+    }
+    ASSERT_EQ(records[0], records[1]);
+
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+
+TEST(Reader, ReadColumns)
+{
+    const TempFile file("read_columns.las");
+    const uint8_t ids[4] = {1, 3, 6, 8};
+    const uint64_t num_points = 37;
+
+    for (const uint8_t id : ids)
+    {
+        const las_point_format_t point_format = {id, 2};
+        std::vector<las_raw_point_t> points(num_points);
+        las_raw_point_prepare_many(points.data(), num_points, point_format);
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            const auto n = static_cast<uint32_t>(i * 2654435761u);
+            if (id <= 5)
+            {
+                las_raw_point_10_t &p = points[i].point10;
+                p.x = static_cast<int32_t>(n);
+                p.y = -static_cast<int32_t>(i);
+                p.z = static_cast<int32_t>(n >> 3);
+                p.intensity = static_cast<uint16_t>(n >> 7);
+                p.return_number = n & 0b111;
+                p.number_of_returns = (n >> 3) & 0b111;
+                p.scan_direction_flag = (n >> 6) & 1;
+                p.edge_of_flight_line = (n >> 7) & 1;
+                p.classification = (n >> 8) & 0b11111;
+                p.synthetic = (n >> 13) & 1;
+                p.key_point = (n >> 14) & 1;
+                p.withheld = (n >> 15) & 1;
+                p.scan_angle_rank = static_cast<uint8_t>(n >> 16);
+                p.user_data = static_cast<uint8_t>(n >> 24);
+                p.point_source_id = static_cast<uint16_t>(n >> 12);
+                p.gps_time = static_cast<double>(n) * 0.25;
+                p.red = static_cast<uint16_t>(n);
+                p.green = static_cast<uint16_t>(n >> 1);
+                p.blue = static_cast<uint16_t>(n >> 2);
+                p.extra_bytes[1] = static_cast<uint8_t>(i);
+            }
+            else
+            {
+                las_raw_point_14_t &p = points[i].point14;
+                p.x = static_cast<int32_t>(n);
+                p.y = -static_cast<int32_t>(i);
+                p.z = static_cast<int32_t>(n >> 3);
+                p.intensity = static_cast<uint16_t>(n >> 7);
+                p.return_number = n & 0b1111;
+                p.number_of_returns = (n >> 4) & 0b1111;
+                p.synthetic = (n >> 8) & 1;
+                p.key_point = (n >> 9) & 1;
+                p.withheld = (n >> 10) & 1;
+                p.overlap = (n >> 11) & 1;
+                p.scanner_channel = (n >> 12) & 0b11;
+                p.scan_direction_flag = (n >> 14) & 1;
+                p.edge_of_flight_line = (n >> 15) & 1;
+                p.classification = static_cast<uint8_t>(n >> 16);
+                p.user_data = static_cast<uint8_t>(n >> 24);
+                p.scan_angle = static_cast<uint16_t>(n >> 5);
+                p.point_source_id = static_cast<uint16_t>(n >> 12);
+                p.gps_time = static_cast<double>(n) * 0.25;
+                p.red = static_cast<uint16_t>(n);
+                p.green = static_cast<uint16_t>(n >> 1);
+                p.blue = static_cast<uint16_t>(n >> 2);
+                p.nir = static_cast<uint16_t>(n >> 3);
+                p.extra_bytes[1] = static_cast<uint8_t>(i);
+            }
+        }
+
+        auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+        ASSERT_NE(header, nullptr);
+        header->version = {1, 4};
+        header->point_format = point_format;
+        header->scaling.scales = {0.01, 0.01, 0.01};
+
+        las_writer_t *writer = nullptr;
+        las_error_t err = las_writer_open_file_path(file.c_str(), header, &writer);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        err = las_writer_write_many_raw_points(writer, points.data(), num_points);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        las_writer_delete(writer);
+
+        std::vector<int32_t> x(num_points), y(num_points), z(num_points);
+        std::vector<uint16_t> intensity(num_points), scan_angle(num_points),
+            point_source_id(num_points), red(num_points), green(num_points), blue(num_points),
+            nir(num_points);
+        std::vector<uint8_t> return_number(num_points), number_of_returns(num_points),
+            synthetic(num_points), key_point(num_points), withheld(num_points),
+            overlap(num_points), scanner_channel(num_points), scan_direction_flag(num_points),
+            edge_of_flight_line(num_points), classification(num_points), user_data(num_points),
+            extra_bytes(2 * num_points);
+        std::vector<double> gps_time(num_points);
+
+        las_raw_point_columns_t columns{};
+        columns.x = x.data();
+        columns.y = y.data();
+        columns.z = z.data();
+        columns.intensity = intensity.data();
+        columns.return_number = return_number.data();
+        columns.number_of_returns = number_of_returns.data();
+        columns.synthetic = synthetic.data();
+        columns.key_point = key_point.data();
+        columns.withheld = withheld.data();
+        columns.overlap = overlap.data();
+        columns.scanner_channel = scanner_channel.data();
+        columns.scan_direction_flag = scan_direction_flag.data();
+        columns.edge_of_flight_line = edge_of_flight_line.data();
+        columns.classification = classification.data();
+        columns.user_data = user_data.data();
+        columns.scan_angle = scan_angle.data();
+        columns.point_source_id = point_source_id.data();
+        columns.gps_time = gps_time.data();
+        columns.red = red.data();
+        columns.green = green.data();
+        columns.blue = blue.data();
+        columns.nir = nir.data();
+        columns.extra_bytes = extra_bytes.data();
+
+        las_reader_t *reader = nullptr;
+        err = las_reader_open_file_path(file.c_str(), &reader);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        err = las_reader_read_many_next_columns(reader, &columns, num_points);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        las_reader_destroy(reader);
+
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            if (id <= 5)
+            {
+                const las_raw_point_10_t &p = points[i].point10;
+                ASSERT_EQ(x[i], p.x);
+                ASSERT_EQ(y[i], p.y);
+                ASSERT_EQ(z[i], p.z);
+                ASSERT_EQ(intensity[i], p.intensity);
+                ASSERT_EQ(return_number[i], p.return_number);
+                ASSERT_EQ(number_of_returns[i], p.number_of_returns);
+                ASSERT_EQ(scan_direction_flag[i], p.scan_direction_flag);
+                ASSERT_EQ(edge_of_flight_line[i], p.edge_of_flight_line);
+                ASSERT_EQ(classification[i], p.classification);
+                ASSERT_EQ(synthetic[i], p.synthetic);
+                ASSERT_EQ(key_point[i], p.key_point);
+                ASSERT_EQ(withheld[i], p.withheld);
+                ASSERT_EQ(scan_angle[i], p.scan_angle_rank);
+                ASSERT_EQ(user_data[i], p.user_data);
+                ASSERT_EQ(point_source_id[i], p.point_source_id);
+                ASSERT_EQ(gps_time[i], p.gps_time);
+                if (id == 3)
+                {
+                    ASSERT_EQ(red[i], p.red);
+                    ASSERT_EQ(green[i], p.green);
+                    ASSERT_EQ(blue[i], p.blue);
+                }
+                ASSERT_EQ(extra_bytes[2 * i + 1], p.extra_bytes[1]);
+            }
+            else
+            {
+                const las_raw_point_14_t &p = points[i].point14;
+                ASSERT_EQ(x[i], p.x);
+                ASSERT_EQ(y[i], p.y);
+                ASSERT_EQ(z[i], p.z);
+                ASSERT_EQ(intensity[i], p.intensity);
+                ASSERT_EQ(return_number[i], p.return_number);
+                ASSERT_EQ(number_of_returns[i], p.number_of_returns);
+                ASSERT_EQ(synthetic[i], p.synthetic);
+                ASSERT_EQ(key_point[i], p.key_point);
+                ASSERT_EQ(withheld[i], p.withheld);
+                ASSERT_EQ(overlap[i], p.overlap);
+                ASSERT_EQ(scanner_channel[i], p.scanner_channel);
+                ASSERT_EQ(scan_direction_flag[i], p.scan_direction_flag);
+                ASSERT_EQ(edge_of_flight_line[i], p.edge_of_flight_line);
+                ASSERT_EQ(classification[i], p.classification);
+                ASSERT_EQ(user_data[i], p.user_data);
+                ASSERT_EQ(scan_angle[i], p.scan_angle);
+                ASSERT_EQ(point_source_id[i], p.point_source_id);
+                ASSERT_EQ(gps_time[i], p.gps_time);
+                if (id == 8)
+                {
+                    ASSERT_EQ(red[i], p.red);
+                    ASSERT_EQ(green[i], p.green);
+                    ASSERT_EQ(blue[i], p.blue);
+                    ASSERT_EQ(nir[i], p.nir);
+                }
+                ASSERT_EQ(extra_bytes[2 * i + 1], p.extra_bytes[1]);
+            }
+        }
+
+        las_raw_point_deinit_many(points.data(), num_points);
+    }
+}
+
+TEST(Writer, WriteRawColumnsSameAsRawPoints)
+{
+    const uint8_t ids[5] = {1, 3, 6, 7, 8};
+    const uint64_t num_points = 45;
+    const TempFile files[2] = {TempFile("raw_points.las"), TempFile("raw_columns.las")};
+
+    for (const uint8_t id : ids)
+    {
+        const las_point_format_t point_format = {id, 2};
+        const bool is_legacy = id <= 5;
+
+        std::vector<int32_t> x(num_points), y(num_points), z(num_points);
+        std::vector<uint16_t> intensity(num_points), scan_angle(num_points),
+            point_source_id(num_points), red(num_points), green(num_points), blue(num_points);
+        std::vector<uint8_t> return_number(num_points), number_of_returns(num_points),
+            synthetic(num_points), key_point(num_points), withheld(num_points),
+            overlap(num_points), scanner_channel(num_points), scan_direction_flag(num_points),
+            edge_of_flight_line(num_points), classification(num_points), user_data(num_points),
+            extra_bytes(2 * num_points);
+        std::vector<double> gps_time(num_points);
+
+        std::vector<las_raw_point_t> points(num_points);
+        las_raw_point_prepare_many(points.data(), num_points, point_format);
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            const auto n = static_cast<uint32_t>((i + 1) * 2654435761u);
+            x[i] = static_cast<int32_t>(n);
+            y[i] = -static_cast<int32_t>(i);
+            z[i] = static_cast<int32_t>(n >> 3);
+            intensity[i] = static_cast<uint16_t>(n >> 7);
+            return_number[i] = static_cast<uint8_t>(n & (is_legacy ? 0b111 : 0b1111));
+            number_of_returns[i] = static_cast<uint8_t>((n >> 4) & (is_legacy ? 0b111 : 0b1111));
+            synthetic[i] = (n >> 8) & 1;
+            key_point[i] = (n >> 9) & 1;
+            withheld[i] = (n >> 10) & 1;
+            overlap[i] = (n >> 11) & 1;
+            scanner_channel[i] = (n >> 12) & 0b11;
+            scan_direction_flag[i] = (n >> 14) & 1;
+            edge_of_flight_line[i] = (n >> 15) & 1;
+            classification[i] = static_cast<uint8_t>((n >> 16) & (is_legacy ? 0b11111 : 0xFF));
+            user_data[i] = static_cast<uint8_t>(n >> 24);
+            scan_angle[i] = static_cast<uint16_t>(is_legacy ? (n >> 5) & 0xFF : n >> 5);
+            point_source_id[i] = static_cast<uint16_t>(n >> 12);
+            gps_time[i] = static_cast<double>(n) * 0.25;
+            red[i] = static_cast<uint16_t>(n);
+            green[i] = static_cast<uint16_t>(n >> 1);
+            blue[i] = static_cast<uint16_t>(n >> 2);
+            extra_bytes[2 * i] = static_cast<uint8_t>(n >> 20);
+            extra_bytes[2 * i + 1] = static_cast<uint8_t>(i);
+
+            if (is_legacy)
+            {
+                las_raw_point_10_t &p = points[i].point10;
+                p.x = x[i];
+                p.y = y[i];
+                p.z = z[i];
+                p.intensity = intensity[i];
+                p.return_number = return_number[i] & 0b111;
+                p.number_of_returns = number_of_returns[i] & 0b111;
+                p.scan_direction_flag = scan_direction_flag[i] & 0b1;
+                p.edge_of_flight_line = edge_of_flight_line[i] & 0b1;
+                p.classification = classification[i] & 0b11111;
+                p.synthetic = synthetic[i] & 0b1;
+                p.key_point = key_point[i] & 0b1;
+                p.withheld = withheld[i] & 0b1;
+                p.scan_angle_rank = static_cast<uint8_t>(scan_angle[i]);
+                p.user_data = user_data[i];
+                p.point_source_id = point_source_id[i];
+                p.gps_time = gps_time[i];
+                p.red = red[i];
+                p.green = green[i];
+                p.blue = blue[i];
+                std::memcpy(p.extra_bytes, &extra_bytes[2 * i], 2);
+            }
+            else
+            {
+                las_raw_point_14_t &p = points[i].point14;
+                p.x = x[i];
+                p.y = y[i];
+                p.z = z[i];
+                p.intensity = intensity[i];
+                p.return_number = return_number[i] & 0b1111;
+                p.number_of_returns = number_of_returns[i] & 0b1111;
+                p.synthetic = synthetic[i] & 0b1;
+                p.key_point = key_point[i] & 0b1;
+                p.withheld = withheld[i] & 0b1;
+                p.overlap = overlap[i] & 0b1;
+                p.scanner_channel = scanner_channel[i] & 0b11;
+                p.scan_direction_flag = scan_direction_flag[i] & 0b1;
+                p.edge_of_flight_line = edge_of_flight_line[i] & 0b1;
+                p.classification = classification[i];
+                p.user_data = user_data[i];
+                p.scan_angle = scan_angle[i];
+                p.point_source_id = point_source_id[i];
+                p.gps_time = gps_time[i];
+                p.red = red[i];
+                p.green = green[i];
+                p.blue = blue[i];
+                // nir is left NULL in the columns
+                p.nir = 0;
+                std::memcpy(p.extra_bytes, &extra_bytes[2 * i], 2);
+            }
+        }
+
+        las_raw_point_columns_t columns{};
+        columns.x = x.data();
+        columns.y = y.data();
+        columns.z = z.data();
+        columns.intensity = intensity.data();
+        columns.return_number = return_number.data();
+        columns.number_of_returns = number_of_returns.data();
+        columns.synthetic = synthetic.data();
+        columns.key_point = key_point.data();
+        columns.withheld = withheld.data();
+        columns.overlap = overlap.data();
+        columns.scanner_channel = scanner_channel.data();
+        columns.scan_direction_flag = scan_direction_flag.data();
+        columns.edge_of_flight_line = edge_of_flight_line.data();
+        columns.classification = classification.data();
+        columns.user_data = user_data.data();
+        columns.scan_angle = scan_angle.data();
+        columns.point_source_id = point_source_id.data();
+        columns.gps_time = gps_time.data();
+        columns.red = red.data();
+        columns.green = green.data();
+        columns.blue = blue.data();
+        columns.extra_bytes = extra_bytes.data();
+
+        std::vector<std::vector<uint8_t>> records(2);
+        for (size_t k = 0; k < 2; ++k)
+        {
+            auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+            ASSERT_NE(header, nullptr);
+            header->version = {1, 4};
+            header->point_format = point_format;
+            header->scaling.scales = {0.01, 0.01, 0.01};
+
+            las_writer_t *writer = nullptr;
+            las_error_t err = las_writer_open_file_path(files[k].c_str(), header, &writer);
+            ASSERT_TRUE(las_error_is_ok(&err));
+            if (k == 0)
+            {
+                err = las_writer_write_many_raw_points(writer, points.data(), num_points);
+            }
+            else
+            {
+                err = las_writer_write_raw_columns(writer, &columns, num_points);
+            }
+            ASSERT_TRUE(las_error_is_ok(&err));
+            las_writer_delete(writer);
+
+            las_reader_t *reader = nullptr;
+            err = las_reader_open_file_path(files[k].c_str(), &reader);
+            ASSERT_TRUE(las_error_is_ok(&err));
+            const uint16_t point_size = las_point_format_point_size(point_format);
+            records[k].resize(point_size * num_points);
+            err = las_reader_read_many_next_bytes(reader, records[k].data(), num_points);
+            ASSERT_TRUE(las_error_is_ok(&err));
+            las_reader_destroy(reader);
+        }
+        ASSERT_EQ(records[0], records[1]);
+
+        las_raw_point_deinit_many(points.data(), num_points);
+    }
+}
+
+TEST(ReadWriteBuffers, SlabPreparedPoints)
+{
+    const las_point_format_t point_format = {3, 3};
+    const uint64_t num_points = 1000;
+
+    std::vector<las_raw_point_t> points(num_points);
+    las_raw_point_prepare_slab(points.data(), num_points, point_format);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        // One contiguous allocation
+        ASSERT_EQ(points[i].point10.extra_bytes, points[0].point10.extra_bytes + 3 * i);
+        ASSERT_EQ(points[i].point10.num_extra_bytes, 3);
+        ASSERT_EQ(points[i].point10.extra_bytes[2], 0);
+        points[i].point10.x = static_cast<int32_t>(i);
+        points[i].point10.extra_bytes[1] = static_cast<uint8_t>(i);
+    }
+
+    const uint16_t point_size = las_point_format_point_size(point_format);
+    std::vector<uint8_t> records(point_size * num_points);
+    las_raw_point_select_encode_many_fn(point_format.id)(
+        points.data(), num_points, point_format, records.data());
+
+    std::vector<las_raw_point_t> decoded(num_points);
+    las_raw_point_prepare_slab(decoded.data(), num_points, point_format);
+    las_raw_point_select_decode_many_fn(point_format.id)(
+        records.data(), point_format, decoded.data(), num_points);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        ASSERT_TRUE(las_raw_point_eq(&points[i], &decoded[i]));
+    }
+
+    las_raw_point_deinit_slab(decoded.data(), num_points);
+    las_raw_point_deinit_slab(points.data(), num_points);
+    ASSERT_EQ(points[0].point10.extra_bytes, nullptr);
+}
+
+TEST(ReadWriteBuffers, PackedPointsRoundtrip)
+{
+    static_assert(std::is_trivially_copyable<las_packed_point_t>::value, "");
+
+    const uint8_t ids[2] = {3, 7};
+    const uint64_t num_points = 100;
+    for (const uint8_t id : ids)
+    {
+        const las_point_format_t point_format = {id, 2};
+        std::vector<las_raw_point_t> points(num_points);
+        las_raw_point_prepare_slab(points.data(), num_points, point_format);
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            const auto n = static_cast<uint32_t>((i + 1) * 2654435761u);
+            if (id <= 5)
+            {
+                las_raw_point_10_t &p = points[i].point10;
+                p.x = static_cast<int32_t>(i);
+                p.z = static_cast<int32_t>(n % 1000);
+                p.return_number = n & 0b111;
+                p.scan_direction_flag = (n >> 3) & 1;
+                p.withheld = (n >> 4) & 1;
+                p.classification = (n >> 5) & 0b11111;
+                p.scan_angle_rank = static_cast<uint8_t>(n >> 10);
+                p.gps_time = static_cast<double>(n);
+                p.blue = static_cast<uint16_t>(n >> 3);
+                p.extra_bytes[0] = static_cast<uint8_t>(i);
+                p.extra_bytes[1] = static_cast<uint8_t>(n);
+            }
+            else
+            {
+                las_raw_point_14_t &p = points[i].point14;
+                p.x = static_cast<int32_t>(i);
+                p.z = static_cast<int32_t>(n % 1000);
+                p.number_of_returns = n & 0b1111;
+                p.overlap = (n >> 4) & 1;
+                p.scanner_channel = (n >> 5) & 0b11;
+                p.edge_of_flight_line = (n >> 7) & 1;
+                p.classification = static_cast<uint8_t>(n >> 8);
+                p.scan_angle = static_cast<uint16_t>(n >> 10);
+                p.gps_time = static_cast<double>(n);
+                p.green = static_cast<uint16_t>(n >> 3);
+                p.extra_bytes[0] = static_cast<uint8_t>(i);
+                p.extra_bytes[1] = static_cast<uint8_t>(n);
+            }
+        }
+
+        std::vector<las_packed_point_t> packed(num_points);
+        std::vector<uint8_t> extra_bytes(2 * num_points);
+        las_packed_point_from_raw_many(
+            points.data(), num_points, packed.data(), extra_bytes.data());
+
+        // Moving packed points around keeps their extra bytes
+        std::sort(packed.begin(),
+                  packed.end(),
+                  [](const las_packed_point_t &a, const las_packed_point_t &b)
+                  { return a.z < b.z || (a.z == b.z && a.x < b.x); });
+
+        std::vector<las_raw_point_t> sorted(num_points);
+        las_raw_point_prepare_slab(sorted.data(), num_points, point_format);
+        las_packed_point_to_raw_many(
+            packed.data(), num_points, extra_bytes.data(), sorted.data());
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            const las_raw_point_t &point = sorted[i];
+            const int32_t x = (id <= 5) ? point.point10.x : point.point14.x;
+            const auto original = static_cast<uint64_t>(x);
+            ASSERT_TRUE(las_raw_point_eq(&point, &points[original]));
+        }
+
+        las_raw_point_deinit_slab(sorted.data(), num_points);
+        las_raw_point_deinit_slab(points.data(), num_points);
+    }
+}
+
+TEST(ReadWriteBuffers, CopyManyLikeCopyOne)
+{
+    const las_scaling_t scaling = {{0.01, 0.001, 0.25}, {1000.5, -20.0, 3.0}};
+    const uint8_t ids[2] = {3, 7};
+    // Not a multiple of the SIMD block sizes, to go through the remainders
+    const uint64_t num_points = 37;
+    for (const uint8_t id : ids)
+    {
+        const las_point_format_t point_format = {id, 1};
+        std::vector<las_raw_point_t> raw_points(num_points);
+        las_raw_point_prepare_slab(raw_points.data(), num_points, point_format);
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            const auto n = static_cast<uint32_t>((i + 1) * 2654435761u);
+            const auto x = static_cast<int32_t>(n) / 3;
+            const auto y = -static_cast<int32_t>(n >> 2);
+            const auto z = static_cast<int32_t>(n % 100000);
+            if (id <= 5)
+            {
+                las_raw_point_10_t &p = raw_points[i].point10;
+                p.x = x;
+                p.y = y;
+                p.z = z;
+                p.number_of_returns = n & 0b111;
+                p.key_point = (n >> 3) & 1;
+                p.classification = (n >> 4) & 0b11111;
+                p.scan_angle_rank = static_cast<uint8_t>(n >> 9);
+                p.red = static_cast<uint16_t>(n >> 5);
+            }
+            else
+            {
+                las_raw_point_14_t &p = raw_points[i].point14;
+                p.x = x;
+                p.y = y;
+                p.z = z;
+                p.return_number = n & 0b1111;
+                p.scanner_channel = (n >> 4) & 0b11;
+                p.classification = static_cast<uint8_t>(n >> 6);
+                p.scan_angle = static_cast<uint16_t>(n >> 8);
+                p.gps_time = static_cast<double>(n);
+            }
+            raw_points[i].point10.extra_bytes[0] = static_cast<uint8_t>(i);
+        }
+
+        std::vector<las_point_t> expected(num_points);
+        std::vector<las_point_t> points(num_points);
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            las_point_prepare(&expected[i], point_format);
+            las_point_prepare(&points[i], point_format);
+            las_point_copy_from_raw(&expected[i], &raw_points[i], scaling);
+        }
+        las_point_copy_many_from_raw(points.data(), raw_points.data(), num_points, scaling);
+
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            ASSERT_EQ(points[i].x, expected[i].x);
+            ASSERT_EQ(points[i].y, expected[i].y);
+            ASSERT_EQ(points[i].z, expected[i].z);
+            ASSERT_EQ(points[i].return_number, expected[i].return_number);
+            ASSERT_EQ(points[i].number_of_returns, expected[i].number_of_returns);
+            ASSERT_EQ(points[i].key_point, expected[i].key_point);
+            ASSERT_EQ(points[i].scanner_channel, expected[i].scanner_channel);
+            ASSERT_EQ(points[i].classification, expected[i].classification);
+            ASSERT_EQ(points[i].scan_angle, expected[i].scan_angle);
+            ASSERT_EQ(points[i].gps_time, expected[i].gps_time);
+            ASSERT_EQ(points[i].red, expected[i].red);
+            ASSERT_EQ(points[i].extra_bytes[0], expected[i].extra_bytes[0]);
+        }
+
+        // And back, the coordinates round to the original integers
+        std::vector<las_raw_point_t> back(num_points);
+        las_raw_point_prepare_slab(back.data(), num_points, point_format);
+        las_raw_point_copy_many_from_point(back.data(), points.data(), num_points, scaling);
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            ASSERT_TRUE(las_raw_point_eq(&back[i], &raw_points[i]));
+        }
+
+        las_raw_point_deinit_slab(back.data(), num_points);
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            las_point_deinit(&points[i]);
+            las_point_deinit(&expected[i]);
+        }
+        las_raw_point_deinit_slab(raw_points.data(), num_points);
+    }
+}
+
+TEST(ReadWriteBuffers, RescaleLikeRoundtripThroughDoubles)
+{
+    const las_scaling_t source = {{0.01, 0.01, 0.001}, {500000.0, 4000000.0, 0.0}};
+    const las_scaling_t dest = {{0.001, 0.005, 0.01}, {500100.0, 3999000.0, -10.0}};
+    const las_point_format_t point_format = {7, 0};
+    const uint16_t point_size = las_point_format_point_size(point_format);
+    // Not a multiple of the SIMD block sizes, to go through the remainders
+    const uint64_t num_points = 41;
+
+    std::vector<las_raw_point_t> points(num_points);
+    std::vector<las_raw_point_t> expected(num_points);
+    std::vector<uint8_t> records(num_points * point_size);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        const auto n = static_cast<uint32_t>((i + 1) * 2654435761u);
+        las_raw_point_prepare(&points[i], point_format);
+        las_raw_point_14_t &p = points[i].point14;
+        p.x = static_cast<int32_t>(n % 2000000) - 1000000;
+        p.y = -static_cast<int32_t>(n % 3000001);
+        p.z = static_cast<int32_t>(n % 100000) - 5000;
+        p.intensity = static_cast<uint16_t>(n);
+        las_raw_point_14_to_buffer(&p, point_format, &records[i * point_size]);
+
+        las_raw_point_prepare(&expected[i], point_format);
+        las_raw_point_14_t &e = expected[i].point14;
+        e = p;
+        e.x = las_scaling_unapply_x(dest, las_scaling_apply_x(source, p.x));
+        e.y = las_scaling_unapply_y(dest, las_scaling_apply_y(source, p.y));
+        e.z = las_scaling_unapply_z(dest, las_scaling_apply_z(source, p.z));
+    }
+
+    las_error_t err = las_raw_point_rescale_many(points.data(), num_points, source, dest);
+    ASSERT_EQ(err.kind, LAS_ERROR_OK);
+    err = las_rescale_records(point_format, records.data(), num_points, source, dest);
+    ASSERT_EQ(err.kind, LAS_ERROR_OK);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        ASSERT_TRUE(las_raw_point_eq(&points[i], &expected[i]));
+
+        las_raw_point_t decoded;
+        las_raw_point_prepare(&decoded, point_format);
+        las_raw_point_14_from_buffer(&records[i * point_size], point_format, &decoded.point14);
+        ASSERT_TRUE(las_raw_point_eq(&decoded, &expected[i]));
+        las_raw_point_deinit(&decoded);
+    }
+
+    // A scale 1000 times smaller does not fit, nothing is changed
+    const std::vector<uint8_t> before = records;
+    const las_scaling_t too_small = {{0.000001, 0.01, 0.01}, {500100.0, 3999000.0, -10.0}};
+    err = las_rescale_records(point_format, records.data(), num_points, dest, too_small);
+    ASSERT_EQ(err.kind, LAS_ERROR_COORDINATE_OVERFLOW);
+    ASSERT_EQ(records, before);
+
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        las_raw_point_deinit(&points[i]);
+        las_raw_point_deinit(&expected[i]);
+    }
+}
+
+TEST(ReadWriteBuffers, TranscodeRecordsLikeRawPoints)
+{
+    const uint8_t pairs[][2] = {{3, 7}, {1, 6}, {8, 3}, {7, 1}, {0, 10}, {6, 8}, {5, 2}};
+    const uint64_t num_points = 64;
+
+    for (const auto &pair : pairs)
+    {
+        const las_point_format_t source_format = {pair[0], 3};
+        const las_point_format_t dest_format = {pair[1], 3};
+        const uint16_t source_size = las_point_format_point_size(source_format);
+        const uint16_t dest_size = las_point_format_point_size(dest_format);
+
+        std::vector<uint8_t> source(source_size * num_points);
+        uint32_t state = 12345;
+        for (uint8_t &byte : source)
+        {
+            state = state * 1664525u + 1013904223u;
+            byte = static_cast<uint8_t>(state >> 24);
+        }
+
+        std::vector<uint8_t> transcoded(dest_size * num_points);
+        las_transcode_records(
+            source_format, dest_format, source.data(), transcoded.data(), num_points);
+
+        // Same bytes as decoding, copying and encoding each point
+        std::vector<las_raw_point_t> source_points(num_points);
+        std::vector<las_raw_point_t> dest_points(num_points);
+        las_raw_point_prepare_slab(source_points.data(), num_points, source_format);
+        las_raw_point_prepare_slab(dest_points.data(), num_points, dest_format);
+        las_raw_point_select_decode_many_fn(source_format.id)(
+            source.data(), source_format, source_points.data(), num_points);
+        for (uint64_t i = 0; i < num_points; ++i)
+        {
+            las_raw_point_copy_from_raw(&dest_points[i], &source_points[i]);
+        }
+        std::vector<uint8_t> expected(dest_size * num_points);
+        las_raw_point_select_encode_many_fn(dest_format.id)(
+            dest_points.data(), num_points, dest_format, expected.data());
+
+        ASSERT_EQ(transcoded, expected) << int(pair[0]) << " -> " << int(pair[1]);
+
+        las_raw_point_deinit_slab(source_points.data(), num_points);
+        las_raw_point_deinit_slab(dest_points.data(), num_points);
+    }
+}
+
+TEST(ReadWriteBuffers, TranscodeConvertsScanAngles)
+{
+    const las_point_format_t legacy_format = {1, 0};
+    const las_point_format_t format_14 = {6, 0};
+    const uint16_t legacy_size = las_point_format_point_size(legacy_format);
+    const uint16_t size_14 = las_point_format_point_size(format_14);
+
+    // degrees and 0.006 degree steps
+    const int8_t ranks[4] = {-30, -90, 1, 0};
+    const int16_t angles[4] = {-5000, -15000, 167, 0};
+    std::vector<uint8_t> legacy(legacy_size * 4, 0);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        legacy[i * legacy_size + 16] = static_cast<uint8_t>(ranks[i]);
+    }
+    std::vector<uint8_t> records_14(size_14 * 4);
+    las_transcode_records(legacy_format, format_14, legacy.data(), records_14.data(), 4);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        int16_t angle;
+        std::memcpy(&angle, &records_14[i * size_14 + 18], sizeof(int16_t));
+        ASSERT_EQ(angle, angles[i]) << i;
+    }
+
+    // Rounded to the nearest degree, and clamped
+    const int16_t wide_angles[4] = {-5083, 20000, -20000, 84};
+    const int8_t expected_ranks[4] = {-30, 90, -90, 1};
+    for (size_t i = 0; i < 4; ++i)
+    {
+        std::memcpy(&records_14[i * size_14 + 18], &wide_angles[i], sizeof(int16_t));
+    }
+    las_transcode_records(format_14, legacy_format, records_14.data(), legacy.data(), 4);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        ASSERT_EQ(static_cast<int8_t>(legacy[i * legacy_size + 16]), expected_ranks[i]) << i;
+    }
+
+    // Same conversions from raw point to raw point
+    las_raw_point_t point_10;
+    las_raw_point_t point_14;
+    las_raw_point_prepare(&point_10, legacy_format);
+    las_raw_point_prepare(&point_14, format_14);
+    point_10.point10.scan_angle_rank = static_cast<uint8_t>(-30);
+    las_raw_point_copy_from_raw(&point_14, &point_10);
+    ASSERT_EQ(static_cast<int16_t>(point_14.point14.scan_angle), -5000);
+    point_14.point14.scan_angle = static_cast<uint16_t>(-20000);
+    las_raw_point_copy_from_raw(&point_10, &point_14);
+    ASSERT_EQ(static_cast<int8_t>(point_10.point10.scan_angle_rank), -90);
+    las_raw_point_deinit(&point_14);
+    las_raw_point_deinit(&point_10);
+}
+
+TEST(ExtraBytes, SchemaAndScaledColumns)
+{
+    // height: i16, scaled, with a no data value
+    // count: u8
+    // weight: f64
+    std::vector<uint8_t> descriptors(3 * LAS_EXTRA_BYTES_DESCRIPTOR_SIZE, 0);
+    uint8_t *height = &descriptors[0];
+    height[2] = LAS_EXTRA_BYTES_I16;
+    height[3] = 0b11001; // no data, scale, offset
+    std::memcpy(height + 4, "height", 6);
+    const int64_t no_data = -1;
+    const double scale = 0.01;
+    const double offset = 100.0;
+    std::memcpy(height + 40, &no_data, sizeof(int64_t));
+    std::memcpy(height + 112, &scale, sizeof(double));
+    std::memcpy(height + 136, &offset, sizeof(double));
+    uint8_t *count = &descriptors[LAS_EXTRA_BYTES_DESCRIPTOR_SIZE];
+    count[2] = LAS_EXTRA_BYTES_U8;
+    std::memcpy(count + 4, "count", 5);
+    uint8_t *weight = &descriptors[2 * LAS_EXTRA_BYTES_DESCRIPTOR_SIZE];
+    weight[2] = LAS_EXTRA_BYTES_F64;
+    std::memcpy(weight + 4, "weight", 6);
+
+    las_vlr_t vlr{};
+    std::memcpy(vlr.user_id, LAS_EXTRA_BYTES_VLR_USER_ID, sizeof(LAS_EXTRA_BYTES_VLR_USER_ID));
+    vlr.record_id = LAS_EXTRA_BYTES_VLR_RECORD_ID;
+    vlr.data_size = static_cast<uint16_t>(descriptors.size());
+    vlr.data = descriptors.data();
+
+    las_header_t header{};
+    header.point_format = {1, 11};
+    header.number_of_vlrs = 1;
+    header.vlrs = &vlr;
+
+    las_extra_bytes_schema_t schema;
+    las_error_t err = las_extra_bytes_schema_from_header(&header, &schema);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(schema.num_dimensions, 3);
+    ASSERT_EQ(las_extra_bytes_schema_find(&schema, "nope"), nullptr);
+    const las_extra_bytes_dimension_t *height_dim = las_extra_bytes_schema_find(&schema, "height");
+    const las_extra_bytes_dimension_t *count_dim = las_extra_bytes_schema_find(&schema, "count");
+    const las_extra_bytes_dimension_t *weight_dim = las_extra_bytes_schema_find(&schema, "weight");
+    ASSERT_NE(height_dim, nullptr);
+    ASSERT_NE(count_dim, nullptr);
+    ASSERT_NE(weight_dim, nullptr);
+    ASSERT_EQ(height_dim->byte_offset, 0);
+    ASSERT_EQ(count_dim->byte_offset, 2);
+    ASSERT_EQ(weight_dim->byte_offset, 3);
+    ASSERT_TRUE(height_dim->has_no_data);
+    ASSERT_DOUBLE_EQ(height_dim->no_data, -1.0);
+    ASSERT_DOUBLE_EQ(count_dim->scale, 1.0);
+
+    const uint64_t num_points = 10;
+    const uint16_t point_size = las_point_format_point_size(header.point_format);
+    std::vector<uint8_t> records(point_size * num_points, 0);
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        uint8_t *extra_bytes = &records[i * point_size + las_point_standard_size(1)];
+        const int16_t h = (i == 3) ? -1 : static_cast<int16_t>(-500 + 100 * static_cast<int>(i));
+        const double w = 0.5 * static_cast<double>(i);
+        std::memcpy(extra_bytes, &h, sizeof(int16_t));
+        extra_bytes[2] = static_cast<uint8_t>(i + 1);
+        std::memcpy(extra_bytes + 3, &w, sizeof(double));
+    }
+
+    std::vector<double> heights(num_points), weights(num_points);
+    err = las_extra_bytes_read_scaled(
+        height_dim, header.point_format, records.data(), num_points, heights.data());
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_extra_bytes_read_scaled(
+        weight_dim, header.point_format, records.data(), num_points, weights.data());
+    ASSERT_TRUE(las_error_is_ok(&err));
+    std::vector<uint8_t> counts(num_points);
+    err = las_extra_bytes_read_raw(
+        count_dim, header.point_format, records.data(), num_points, counts.data());
+    ASSERT_TRUE(las_error_is_ok(&err));
+
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        if (i == 3)
+        {
+            ASSERT_TRUE(std::isnan(heights[i]));
+        }
+        else
+        {
+            ASSERT_DOUBLE_EQ(heights[i], 100.0 + 0.01 * (-500.0 + 100.0 * static_cast<double>(i)));
+        }
+        ASSERT_DOUBLE_EQ(weights[i], 0.5 * static_cast<double>(i));
+        ASSERT_EQ(counts[i], i + 1);
+    }
+    las_extra_bytes_schema_deinit(&schema);
+
+    // The VLR describes more bytes than the points have
+    header.point_format.num_extra_bytes = 10;
+    err = las_extra_bytes_schema_from_header(&header, &schema);
+    ASSERT_EQ(err.kind, LAS_ERROR_INVALID_EXTRA_BYTES_VLR);
+}
+
+/// Writes a file with 2 points at (min, min, 0) and (max, max, 1), with scale 1
+static void las_write_two_points(const char *path,
+                                 const int32_t min,
+                                 const int32_t max,
+                                 const bool with_crs)
+{
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 2};
+    header->point_format = {1, 0};
+    header->scaling.scales = {1.0, 1.0, 1.0};
+    if (with_crs)
+    {
+        header->number_of_vlrs = 1;
+        header->vlrs = static_cast<las_vlr_t *>(std::calloc(1, sizeof(las_vlr_t)));
+        ASSERT_NE(header->vlrs, nullptr);
+        std::strncpy(header->vlrs[0].user_id, "LASF_Projection", LAS_VLR_USER_ID_SIZE);
+        header->vlrs[0].record_id = 2112;
+        header->vlrs[0].data_size = 8;
+        header->vlrs[0].data = static_cast<uint8_t *>(std::malloc(8));
+        ASSERT_NE(header->vlrs[0].data, nullptr);
+        std::memcpy(header->vlrs[0].data, "WKT CRS", 8);
+    }
+
+    std::vector<las_raw_point_t> points(2);
+    las_raw_point_prepare_many(points.data(), 2, header->point_format);
+    points[0].point10.x = points[0].point10.y = min;
+    points[1].point10.x = points[1].point10.y = max;
+    points[1].point10.z = 1;
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_many_raw_points(writer, points.data(), 2);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+    las_raw_point_deinit_many(points.data(), 2);
+}
+
+TEST(Catalog, BuildQueryWriteRead)
+{
+    // The missing file is removed (and never written) by its TempFile
+    const TempFile files[4] = {TempFile("catalog_a.las"),
+                               TempFile("catalog_b.las"),
+                               TempFile("catalog_missing.las"),
+                               TempFile("catalog_c.las")};
+    const char *paths[4] = {files[0].c_str(), files[1].c_str(), files[2].c_str(), files[3].c_str()};
+    const TempFile catalog_file("catalog.bin");
+    las_write_two_points(paths[0], 0, 10, false);
+    las_write_two_points(paths[1], 20, 30, true);
+    las_write_two_points(paths[3], 5, 25, true);
+
+    las_catalog_t *catalog = nullptr;
+    las_error_t err = las_catalog_build(paths, 4, 2, &catalog);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(las_catalog_num_entries(catalog), 4);
+
+    const las_catalog_entry_t *a = las_catalog_entry(catalog, 0);
+    ASSERT_STREQ(a->path, paths[0]);
+    ASSERT_EQ(a->status, LAS_ERROR_OK);
+    ASSERT_EQ(a->version.minor, 2);
+    ASSERT_EQ(a->point_format.id, 1);
+    ASSERT_FALSE(a->is_compressed);
+    ASSERT_EQ(a->point_count, 2);
+    ASSERT_DOUBLE_EQ(a->mins.x, 0.0);
+    ASSERT_DOUBLE_EQ(a->maxs.y, 10.0);
+    ASSERT_EQ(a->crs_hash, 0);
+    ASSERT_EQ(las_catalog_entry(catalog, 2)->status, LAS_ERROR_ERRNO);
+    ASSERT_NE(las_catalog_entry(catalog, 1)->crs_hash, 0);
+    ASSERT_EQ(las_catalog_entry(catalog, 1)->crs_hash, las_catalog_entry(catalog, 3)->crs_hash);
+
+    uint64_t indices[4];
+    ASSERT_EQ(las_catalog_query_bbox(catalog, {-100.0, -100.0, 100.0, 100.0}, indices, 4), 3);
+    ASSERT_EQ(indices[0], 0);
+    ASSERT_EQ(indices[1], 1);
+    ASSERT_EQ(indices[2], 3);
+    // Touching bounds match
+    ASSERT_EQ(las_catalog_query_bbox(catalog, {10.0, 10.0, 12.0, 12.0}, indices, 4), 2);
+    ASSERT_EQ(indices[0], 0);
+    ASSERT_EQ(indices[1], 3);
+    ASSERT_EQ(las_catalog_query_bbox(catalog, {26.0, 26.0, 40.0, 40.0}, indices, 1), 1);
+    ASSERT_EQ(indices[0], 1);
+    ASSERT_EQ(las_catalog_query_bbox(catalog, {31.0, 0.0, 40.0, 40.0}, nullptr, 0), 0);
+
+    err = las_catalog_write_file_path(catalog, catalog_file.c_str());
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_catalog_t *read_catalog = nullptr;
+    err = las_catalog_read_file_path(catalog_file.c_str(), &read_catalog);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(las_catalog_num_entries(read_catalog), 4);
+    for (uint64_t i = 0; i < 4; ++i)
+    {
+        const las_catalog_entry_t *e = las_catalog_entry(catalog, i);
+        const las_catalog_entry_t *r = las_catalog_entry(read_catalog, i);
+        ASSERT_STREQ(e->path, r->path);
+        ASSERT_EQ(e->status, r->status);
+        ASSERT_EQ(e->version.minor, r->version.minor);
+        ASSERT_EQ(e->point_format.id, r->point_format.id);
+        ASSERT_EQ(e->point_count, r->point_count);
+        ASSERT_EQ(e->mins.y, r->mins.y);
+        ASSERT_EQ(e->maxs.x, r->maxs.x);
+        ASSERT_EQ(e->crs_hash, r->crs_hash);
+    }
+    ASSERT_EQ(las_catalog_query_bbox(read_catalog, {10.0, 10.0, 12.0, 12.0}, indices, 4), 2);
+    las_catalog_delete(read_catalog);
+    las_catalog_delete(catalog);
+
+    err = las_catalog_read_file_path(paths[0], &read_catalog);
+    ASSERT_EQ(err.kind, LAS_ERROR_INVALID_CATALOG);
+    ASSERT_EQ(read_catalog, nullptr);
+}
+
+/// Returns LAZ point data (with dummy chunk bytes) followed by its chunk table
+static std::vector<uint8_t> las_laz_data_with_chunk_table(
+    const std::vector<las_laz_chunk_entry_t> &entries, bool is_variable_size, bool offset_at_end)
+{
+    las_dest_t dest;
+    EXPECT_EQ(las_dest_new_memory(&dest), 0);
+    int64_t chunk_table_offset = sizeof(int64_t);
+    for (const las_laz_chunk_entry_t &entry : entries)
+    {
+        chunk_table_offset += static_cast<int64_t>(entry.byte_count);
+    }
+    const int64_t stored_offset = offset_at_end ? -1 : chunk_table_offset;
+    las_dest_write(&dest, reinterpret_cast<const uint8_t *>(&stored_offset), sizeof(int64_t));
+    const std::vector<uint8_t> chunk_bytes(static_cast<size_t>(chunk_table_offset) - 8, 0xAB);
+    las_dest_write(&dest, chunk_bytes.data(), chunk_bytes.size());
+
+    las_error_t err =
+        las_laz_chunk_table_write_to(entries.data(), entries.size(), is_variable_size, &dest);
+    EXPECT_TRUE(las_error_is_ok(&err));
+    if (offset_at_end)
+    {
+        las_dest_write(
+            &dest, reinterpret_cast<const uint8_t *>(&chunk_table_offset), sizeof(int64_t));
+    }
+
+    const auto *memory = static_cast<las_memory_dest_t *>(dest.inner);
+    std::vector<uint8_t> bytes(memory->data, memory->data + memory->size);
+    las_dest_close(&dest);
+    las_dest_deinit(&dest);
+    return bytes;
+}
+
+TEST(LazChunkTable, ReadBackWrittenTable)
+{
+    const std::vector<las_laz_chunk_entry_t> variable = {
+        {1000, 5321}, {20, 180}, {70000, 612345}, {1, 40}};
+    std::vector<uint8_t> bytes = las_laz_data_with_chunk_table(variable, true, false);
+
+    las_source_t source = las_source_new_memory(bytes.data(), bytes.size());
+    las_laz_chunk_entry_t *entries = nullptr;
+    uint64_t num_entries = 0;
+    las_error_t err = las_laz_chunk_table_read_from(
+        &source, 0, LAS_LAZ_VARIABLE_CHUNK_SIZE, 71021, &entries, &num_entries);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(num_entries, variable.size());
+    for (size_t i = 0; i < variable.size(); ++i)
+    {
+        ASSERT_EQ(entries[i].point_count, variable[i].point_count);
+        ASSERT_EQ(entries[i].byte_count, variable[i].byte_count);
+    }
+    std::free(entries);
+    las_source_deinit(&source);
+
+    // Fixed size chunks, with the offset to the table at the end of the data
+    const std::vector<las_laz_chunk_entry_t> fixed = {{500, 3000}, {500, 2800}, {123, 900}};
+    bytes = las_laz_data_with_chunk_table(fixed, false, true);
+    source = las_source_new_memory(bytes.data(), bytes.size());
+    err = las_laz_chunk_table_read_from(&source, 0, 500, 1123, &entries, &num_entries);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(num_entries, fixed.size());
+    for (size_t i = 0; i < fixed.size(); ++i)
+    {
+        ASSERT_EQ(entries[i].point_count, fixed[i].point_count);
+        ASSERT_EQ(entries[i].byte_count, fixed[i].byte_count);
+    }
+    std::free(entries);
+
+    // The chunks would overlap the table
+    err = las_laz_chunk_table_read_from(&source, 100, 500, 1123, &entries, &num_entries);
+    ASSERT_EQ(err.kind, LAS_ERROR_INVALID_LAZ_CHUNK_TABLE);
+    ASSERT_EQ(entries, nullptr);
+    las_source_deinit(&source);
+}
+
+TEST(Writer, FinishChunkOfLasIsNoOp)
+{
+    const TempFile file("finish_chunk.las");
+    const char *path = file.c_str();
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 4};
+    header->point_format = {6, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+
+    std::vector<las_raw_point_t> points(5);
+    las_raw_point_prepare_many(points.data(), 5, header->point_format);
+    for (size_t i = 0; i < 5; ++i)
+    {
+        points[i].point14.x = static_cast<int32_t>(i);
+    }
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(path, header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_finish_chunk(writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_many_raw_points(writer, points.data(), 2);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_finish_chunk(writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_many_raw_points(writer, &points[2], 3);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+
+    las_reader_t *reader = nullptr;
+    err = las_reader_open_file_path(path, &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(las_reader_header(reader)->point_count, 5);
+    std::vector<las_raw_point_t> read(5);
+    las_raw_point_prepare_many(read.data(), 5, las_reader_header(reader)->point_format);
+    err = las_reader_read_many_next_raw(reader, read.data(), 5);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    for (size_t i = 0; i < 5; ++i)
+    {
+        ASSERT_TRUE(las_raw_point_eq(&points[i], &read[i]));
+    }
+
+    // LAS data has no chunks
+    const las_laz_chunk_t *chunks = nullptr;
+    uint64_t num_chunks = 1;
+    err = las_reader_laz_chunks(reader, &chunks, &num_chunks);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(num_chunks, 0);
+
+    las_reader_destroy(reader);
+    las_raw_point_deinit_many(read.data(), 5);
+    las_raw_point_deinit_many(points.data(), 5);
+}
+
+#ifdef WITH_LAZRS
+/// Returns the content of the file at `path`
+static std::vector<uint8_t> las_read_file_bytes(const char *path)
+{
+    std::vector<uint8_t> bytes;
+    FILE *file = std::fopen(path, "rb");
+    EXPECT_NE(file, nullptr);
+    if (file == nullptr)
+    {
+        return bytes;
+    }
+    uint8_t buffer[4096];
+    size_t n = 0;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+    return bytes;
+}
+
+/// Returns `num_points` points of format 3 whose fields change from one point to the next
+static std::vector<las_raw_point_t> las_laz_test_points(const uint64_t num_points)
+{
+    std::vector<las_raw_point_t> points(num_points);
+    las_raw_point_prepare_many(points.data(), num_points, {3, 0});
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        las_raw_point_10_t &p = points[i].point10;
+        const auto n = static_cast<uint32_t>(i);
+        p.x = static_cast<int32_t>(n * 7 % 10'007);
+        p.y = static_cast<int32_t>(n * 13 % 20'011) - 10'000;
+        p.z = static_cast<int32_t>(n % 977);
+        p.intensity = static_cast<uint16_t>(n * 31);
+        p.return_number = (n % 5 + 1) & 0b111;
+        p.number_of_returns = 5;
+        p.classification = (n % 19) & 0b11111;
+        p.point_source_id = static_cast<uint16_t>(n / 1'000);
+        p.gps_time = static_cast<double>(n) * 0.25;
+        p.red = static_cast<uint16_t>(n * 3);
+        p.green = static_cast<uint16_t>(n * 5);
+        p.blue = static_cast<uint16_t>(n * 11);
+    }
+    return points;
+}
+
+/// Writes the points to a LAZ file (LAS 1.2), closing a chunk after the points
+/// at each of the `chunk_ends` indices
+static void las_write_laz(const char *path,
+                          const las_raw_point_t *points,
+                          const uint64_t num_points,
+                          const las_writer_options_t *options,
+                          const std::vector<uint64_t> &chunk_ends = {})
+{
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 2};
+    header->point_format = {3, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path_with_options(path, header, options, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    uint64_t written = 0;
+    for (const uint64_t end : chunk_ends)
+    {
+        err = las_writer_write_many_raw_points(writer, &points[written], end - written);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        err = las_writer_finish_chunk(writer);
+        ASSERT_TRUE(las_error_is_ok(&err));
+        written = end;
+    }
+    err = las_writer_write_many_raw_points(writer, &points[written], num_points - written);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    las_writer_delete(writer);
+}
+
+/// Returns the offset to the chunk table, which lazrs and LASzip write
+/// in the 8 bytes before the first chunk
+static uint64_t las_laz_chunk_table_offset(const std::vector<uint8_t> &bytes)
+{
+    uint32_t offset_to_point_data = 0;
+    std::memcpy(&offset_to_point_data, &bytes[96], sizeof(uint32_t));
+    int64_t chunk_table_offset = 0;
+    std::memcpy(&chunk_table_offset, &bytes[offset_to_point_data], sizeof(int64_t));
+    return static_cast<uint64_t>(chunk_table_offset);
+}
+
+/// Returns the chunk size stored in the LASzip VLR of the header
+static uint32_t las_laszip_vlr_chunk_size(const las_header_t *header)
+{
+    for (uint32_t i = 0; i < header->number_of_vlrs; ++i)
+    {
+        const las_vlr_t &vlr = header->vlrs[i];
+        if (std::strncmp(vlr.user_id, "laszip encoded", LAS_VLR_USER_ID_SIZE) == 0 &&
+            vlr.record_id == 22204)
+        {
+            uint32_t chunk_size = 0;
+            std::memcpy(&chunk_size, &vlr.data[LAS_LAZ_VLR_CHUNK_SIZE_OFFSET], sizeof(uint32_t));
+            return chunk_size;
+        }
+    }
+    ADD_FAILURE() << "no LASzip VLR";
+    return 0;
+}
+
+#ifdef WITH_LAZ_CHUNKED_WRITER
+/// Returns the point data of a LAZ file, with the offset to the chunk table
+/// made relative to the start of the point data, like `las_lazrs_compress` returns it
+static std::vector<uint8_t> las_laz_point_data(const std::vector<uint8_t> &bytes)
+{
+    uint32_t offset_to_point_data = 0;
+    std::memcpy(&offset_to_point_data, &bytes[96], sizeof(uint32_t));
+    std::vector<uint8_t> data(bytes.begin() + offset_to_point_data, bytes.end());
+    const uint64_t chunk_table_offset = las_laz_chunk_table_offset(bytes) - offset_to_point_data;
+    std::memcpy(data.data(), &chunk_table_offset, sizeof(uint64_t));
+    return data;
+}
+#endif
+
+/// Returns what a lazrs compressor writes when given the points (as format 3 records):
+/// the offset to the chunk table (relative to the first byte), the chunks and the chunk table
+static std::vector<uint8_t> las_lazrs_compress(const las_raw_point_t *points,
+                                               const uint64_t num_points)
+{
+    const las_point_format_t point_format = {3, 0};
+    std::vector<uint8_t> records(las_point_format_point_size(point_format) * num_points);
+    las_raw_point_select_encode_many_fn(point_format.id)(
+        points, num_points, point_format, records.data());
+
+    std::vector<uint8_t> bytes;
+    las_dest_t dest;
+    EXPECT_EQ(las_dest_new_memory(&dest), 0);
+    las_laz_writer_t *compressor = nullptr;
+    las_error_t err = las_laz_writer_new_single(&dest, point_format, &compressor);
+    EXPECT_TRUE(las_error_is_ok(&err));
+    if (las_error_is_ok(&err))
+    {
+        err = las_laz_writer_write(compressor, records.data(), num_points);
+        EXPECT_TRUE(las_error_is_ok(&err));
+        err = las_laz_writer_done(compressor);
+        EXPECT_TRUE(las_error_is_ok(&err));
+        const auto *memory = static_cast<las_memory_dest_t *>(dest.inner);
+        bytes.assign(memory->data, memory->data + memory->size);
+    }
+    las_laz_writer_delete(compressor);
+    las_dest_close(&dest);
+    las_dest_deinit(&dest);
+    return bytes;
+}
+
+/// Returns the size lazrs compresses the points to, when they are alone in a chunk
+static uint64_t las_lazrs_compressed_size(const las_raw_point_t *points, const uint64_t num_points)
+{
+    const std::vector<uint8_t> bytes = las_lazrs_compress(points, num_points);
+    uint64_t chunk_table_offset = 0;
+    std::memcpy(&chunk_table_offset, bytes.data(), sizeof(uint64_t));
+    return chunk_table_offset - sizeof(int64_t);
+}
+
+/// Writes a LAZ file (see `las_write_laz`) whose point data was compressed by lazrs,
+/// whichever LAZ writer the library is built with
+static void las_write_lazrs_laz(const char *path,
+                                const las_raw_point_t *points,
+                                const uint64_t num_points)
+{
+    las_write_laz(path, points, num_points, nullptr);
+    std::vector<uint8_t> bytes = las_read_file_bytes(path);
+    uint32_t offset_to_point_data = 0;
+    std::memcpy(&offset_to_point_data, &bytes[96], sizeof(uint32_t));
+
+    std::vector<uint8_t> point_data = las_lazrs_compress(points, num_points);
+    uint64_t chunk_table_offset = 0;
+    std::memcpy(&chunk_table_offset, point_data.data(), sizeof(uint64_t));
+    chunk_table_offset += offset_to_point_data;
+    std::memcpy(point_data.data(), &chunk_table_offset, sizeof(uint64_t));
+
+    bytes.resize(offset_to_point_data);
+    bytes.insert(bytes.end(), point_data.begin(), point_data.end());
+    FILE *file = std::fopen(path, "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(std::fwrite(bytes.data(), 1, bytes.size(), file), bytes.size());
+    std::fclose(file);
+}
+
+/// Checks that the chunks follow each other, from the first byte of the points
+/// to the chunk table
+static void las_check_laz_chunks_are_contiguous(const std::vector<uint8_t> &bytes,
+                                                const las_laz_chunk_t *chunks,
+                                                const uint64_t num_chunks)
+{
+    uint32_t offset_to_point_data = 0;
+    std::memcpy(&offset_to_point_data, &bytes[96], sizeof(uint32_t));
+    uint64_t byte_offset = offset_to_point_data + sizeof(int64_t);
+    for (uint64_t i = 0; i < num_chunks; ++i)
+    {
+        EXPECT_EQ(chunks[i].byte_offset, byte_offset) << "chunk " << i;
+        byte_offset += chunks[i].byte_count;
+    }
+    EXPECT_EQ(byte_offset, las_laz_chunk_table_offset(bytes));
+}
+
+#ifdef WITH_LAZ_CHUNKED_WRITER
+TEST(LazWriter, ChunksCompressedByWorkersMatchLazrs)
+{
+    const TempFile file("points.laz");
+    const uint64_t num_points = 2 * 50'000 + 1'234;
+    std::vector<las_raw_point_t> points = las_laz_test_points(num_points);
+    const std::vector<uint8_t> expected = las_lazrs_compress(points.data(), num_points);
+
+    for (const uint32_t num_workers : {0u, 3u})
+    {
+        las_writer_options_t options{};
+        options.num_workers = num_workers;
+        las_write_laz(file.c_str(), points.data(), num_points, &options);
+        ASSERT_EQ(las_laz_point_data(las_read_file_bytes(file.c_str())), expected)
+            << num_workers << " workers";
+    }
+
+    las_reader_t *reader = nullptr;
+    las_error_t err = las_reader_open_file_path(file.c_str(), &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(las_reader_header(reader)->point_count, num_points);
+    std::vector<las_raw_point_t> read(num_points);
+    las_raw_point_prepare_many(read.data(), num_points, las_reader_header(reader)->point_format);
+    err = las_reader_read_many_next_raw(reader, read.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        ASSERT_TRUE(las_raw_point_eq(&points[i], &read[i])) << "point " << i;
+    }
+
+    las_reader_destroy(reader);
+    las_raw_point_deinit_many(read.data(), num_points);
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+#else
+TEST(LazWriter, ChunkSizeNeedsTheChunkedWriter)
+{
+    const TempFile file("points.laz");
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 2};
+    header->point_format = {3, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+
+    las_writer_options_t options{};
+    options.chunk_size = 10'000;
+    las_writer_t *writer = nullptr;
+    las_error_t err =
+        las_writer_open_file_path_with_options(file.c_str(), header, &options, &writer);
+    ASSERT_EQ(err.kind, LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA);
+}
+#endif
+
+TEST(LazChunkTable, EncodesLikeLazrs)
+{
+    const uint64_t chunk_point_counts[3] = {50'000, 50'000, 1'234};
+    const uint64_t num_points = 2 * 50'000 + 1'234;
+    std::vector<las_raw_point_t> points = las_laz_test_points(num_points);
+
+    // The table lazrs writes for all the points
+    const std::vector<uint8_t> bytes = las_lazrs_compress(points.data(), num_points);
+    uint64_t chunk_table_offset = 0;
+    std::memcpy(&chunk_table_offset, bytes.data(), sizeof(uint64_t));
+    ASSERT_LT(chunk_table_offset, bytes.size());
+    const std::vector<uint8_t> expected(bytes.begin() + static_cast<int64_t>(chunk_table_offset),
+                                        bytes.end());
+
+    // The size of each chunk, from lazrs compressing the chunk's points alone
+    std::vector<las_laz_chunk_entry_t> entries;
+    uint64_t first = 0;
+    for (const uint64_t count : chunk_point_counts)
+    {
+        entries.push_back({count, las_lazrs_compressed_size(&points[first], count)});
+        first += count;
+    }
+
+    las_dest_t dest;
+    ASSERT_EQ(las_dest_new_memory(&dest), 0);
+    las_error_t err = las_laz_chunk_table_write_to(entries.data(), entries.size(), false, &dest);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    const auto *memory = static_cast<las_memory_dest_t *>(dest.inner);
+    const std::vector<uint8_t> encoded(memory->data, memory->data + memory->size);
+    las_dest_close(&dest);
+    las_dest_deinit(&dest);
+
+    ASSERT_EQ(encoded, expected);
+
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+
+TEST(LazChunkTable, ReaderListsLazrsChunks)
+{
+    const uint64_t chunk_point_counts[3] = {50'000, 50'000, 1'234};
+    const uint64_t num_points = 2 * 50'000 + 1'234;
+    std::vector<las_raw_point_t> points = las_laz_test_points(num_points);
+
+    // lazrs writes fixed size chunks, their point counts come from the LASzip VLR
+    const TempFile file("lazrs_chunks.laz");
+    las_write_lazrs_laz(file.c_str(), points.data(), num_points);
+    const std::vector<uint8_t> bytes = las_read_file_bytes(file.c_str());
+
+    las_reader_t *reader = nullptr;
+    las_error_t err = las_reader_open_file_path(file.c_str(), &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(las_laszip_vlr_chunk_size(las_reader_header(reader)), 50'000);
+
+    const las_laz_chunk_t *chunks = nullptr;
+    uint64_t num_chunks = 0;
+    err = las_reader_laz_chunks(reader, &chunks, &num_chunks);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(num_chunks, 3);
+    uint64_t first = 0;
+    for (uint64_t i = 0; i < num_chunks; ++i)
+    {
+        ASSERT_EQ(chunks[i].point_count, chunk_point_counts[i]);
+        ASSERT_EQ(chunks[i].byte_count,
+                  las_lazrs_compressed_size(&points[first], chunks[i].point_count));
+        first += chunks[i].point_count;
+    }
+    las_check_laz_chunks_are_contiguous(bytes, chunks, num_chunks);
+
+    // Listing the chunks does not move the reader
+    las_raw_point_t read;
+    las_raw_point_prepare(&read, las_reader_header(reader)->point_format);
+    err = las_reader_read_next_raw(reader, &read);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_TRUE(las_raw_point_eq(&points[0], &read));
+
+    las_raw_point_deinit(&read);
+    las_reader_destroy(reader);
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+
+#ifdef WITH_LAZ_CHUNKED_WRITER
+TEST(LazWriter, FinishChunkWritesVariableChunks)
+{
+    const uint64_t num_points = 30'000;
+    std::vector<las_raw_point_t> points = las_laz_test_points(num_points);
+    // Chunks still close on their own once they have chunk_size points
+    const std::vector<uint64_t> chunk_ends = {100, 2'600, 2'601, 17'000};
+    const uint64_t expected_point_counts[7] = {100, 2'500, 1, 10'000, 4'399, 10'000, 3'000};
+
+    const TempFile file("variable_chunks.laz");
+    const TempFile workers_file("variable_chunks_workers.laz");
+
+    las_writer_options_t options{};
+    options.chunk_size = 10'000;
+    las_write_laz(file.c_str(), points.data(), num_points, &options, chunk_ends);
+    options.num_workers = 2;
+    las_write_laz(workers_file.c_str(), points.data(), num_points, &options, chunk_ends);
+
+    const std::vector<uint8_t> bytes = las_read_file_bytes(file.c_str());
+    ASSERT_EQ(bytes, las_read_file_bytes(workers_file.c_str()));
+
+    las_reader_t *reader = nullptr;
+    las_error_t err = las_reader_open_file_path(file.c_str(), &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(las_laszip_vlr_chunk_size(las_reader_header(reader)), LAS_LAZ_VARIABLE_CHUNK_SIZE);
+
+    const las_laz_chunk_t *chunks = nullptr;
+    uint64_t num_chunks = 0;
+    err = las_reader_laz_chunks(reader, &chunks, &num_chunks);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(num_chunks, 7);
+    for (uint64_t i = 0; i < num_chunks; ++i)
+    {
+        ASSERT_EQ(chunks[i].point_count, expected_point_counts[i]) << "chunk " << i;
+    }
+    las_check_laz_chunks_are_contiguous(bytes, chunks, num_chunks);
+
+    ASSERT_EQ(las_reader_header(reader)->point_count, num_points);
+    std::vector<las_raw_point_t> read(num_points);
+    las_raw_point_prepare_many(read.data(), num_points, las_reader_header(reader)->point_format);
+    err = las_reader_read_many_next_raw(reader, read.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        ASSERT_TRUE(las_raw_point_eq(&points[i], &read[i])) << "point " << i;
+    }
+
+    las_reader_destroy(reader);
+
+    // Without options, the chunks are closed the same way
+    const TempFile default_file("default_chunks.laz");
+    const std::vector<uint64_t> default_chunk_ends = {100, 2'600};
+    las_write_laz(default_file.c_str(), points.data(), num_points, nullptr, default_chunk_ends);
+    err = las_reader_open_file_path(default_file.c_str(), &reader);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_reader_laz_chunks(reader, &chunks, &num_chunks);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    ASSERT_EQ(num_chunks, 3);
+    ASSERT_EQ(chunks[0].point_count, 100);
+    ASSERT_EQ(chunks[1].point_count, 2'500);
+    ASSERT_EQ(chunks[2].point_count, num_points - 2'600);
+    err = las_reader_read_many_next_raw(reader, read.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    for (uint64_t i = 0; i < num_points; ++i)
+    {
+        ASSERT_TRUE(las_raw_point_eq(&points[i], &read[i])) << "point " << i;
+    }
+
+    las_reader_destroy(reader);
+    las_raw_point_deinit_many(read.data(), num_points);
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+#else
+TEST(LazWriter, FinishChunkNeedsTheChunkedWriter)
+{
+    const TempFile file("finish_chunk.laz");
+    const uint64_t num_points = 10;
+    std::vector<las_raw_point_t> points = las_laz_test_points(num_points);
+
+    auto *header = static_cast<las_header_t *>(std::calloc(1, sizeof(las_header_t)));
+    ASSERT_NE(header, nullptr);
+    header->version = {1, 2};
+    header->point_format = {3, 0};
+    header->scaling.scales = {0.01, 0.01, 0.01};
+
+    las_writer_t *writer = nullptr;
+    las_error_t err = las_writer_open_file_path(file.c_str(), header, &writer);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    err = las_writer_write_many_raw_points(writer, points.data(), num_points);
+    ASSERT_TRUE(las_error_is_ok(&err));
+    // lazrs only closes full chunks
+    err = las_writer_finish_chunk(writer);
+    ASSERT_EQ(err.kind, LAS_ERROR_UNSUPPORTED_FOR_COMPRESSED_DATA);
+    las_writer_delete(writer);
+
+    las_raw_point_deinit_many(points.data(), num_points);
+}
+#endif
+#endif